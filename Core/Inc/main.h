@@ -53,6 +53,7 @@ extern "C" {
 void Error_Handler(void);
 
 /* USER CODE BEGIN EFP */
+void app_deferred_tick(void);  // PendSV_Handler 中调用
 
 /* USER CODE END EFP */
 
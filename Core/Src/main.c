@@ -30,8 +30,11 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "cycle_counter.h"
+#include "debug_output.h"
 #include "motion_cycle.h"
 #include "motion_engine.h"
+#include "motion_stream.h"
 #include "motion_sync.h"
 #include "protocol.h"
 #include "servo_hal.h"
@@ -64,6 +67,9 @@ volatile uint8_t button2_flag     = 0;
 uint32_t         last_press_time1 = 0;
 uint32_t         last_press_time2 = 0;
 
+// TIM1 中已挂起、尚未由 PendSV 处理的 1ms tick 数
+static uint32_t deferred_ticks = 0;
+
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -179,11 +185,14 @@ int main(void)
     MX_USART1_UART_Init();
     MX_USART3_UART_Init();
     /* USER CODE BEGIN 2 */
+    cycle_counter_init();
+    debug_output_init();  // 日志经 USART1 DMA 后台输出
     HAL_TIM_Base_Start_IT(&htim1);  // 启动带中断的定时�?
 
     servo_hal_init();
     servo_motion_init();
     motion_sync_init();
+    motion_stream_init();
     tf_uart_port_init(NULL);
     protocol_init();
 #if TEST_CYCLE_1
@@ -197,6 +206,15 @@ int main(void)
     /* USER CODE BEGIN WHILE */
     while (1) {
         tf_uart_port_poll();
+
+        // 无待处理接收事件时休眠，由 UART IDLE / DMA 半满全满 / TIM1 中断唤醒。
+        // 关中断后再检查标志：检查与 WFI 之间到来的中断会挂起并立即唤醒内核，不会丢失。
+        // 这里只能用 PRIMASK（BASEPRI 屏蔽的中断不会唤醒 WFI），只延迟 tick 几个周期
+        __disable_irq();
+        if (!tf_uart_port_rx_pending()) {
+            __WFI();
+        }
+        __enable_irq();
         /* USER CODE END WHILE */
 
         /* USER CODE BEGIN 3 */
@@ -250,6 +268,26 @@ void HAL_UART_TxCpltCallback(UART_HandleTypeDef* huart)
 {
     if (huart->Instance == USART3) {
         uart_driver_tx_complete_callback();
+    } else if (huart->Instance == USART1) {
+        debug_output_tx_complete_callback();
+    }
+}
+
+// 串口接收事件（IDLE / DMA 半满 / DMA 全满）
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef* huart, uint16_t Size)
+{
+    if (huart->Instance == USART3) {
+        uart_driver_rx_event_callback(Size);
+    }
+}
+
+// 串口错误（溢出等），重新启动接收
+void HAL_UART_ErrorCallback(UART_HandleTypeDef* huart)
+{
+    if (huart->Instance == USART3) {
+        uart_driver_error_callback();
+    } else if (huart->Instance == USART1) {
+        debug_output_error_callback();
     }
 }
 
@@ -257,7 +295,22 @@ void HAL_UART_TxCpltCallback(UART_HandleTypeDef* huart)
 void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef* htim)
 {
     if (htim->Instance == TIM1) {
+        // 这里只做舵机插补（最高优先级，不被通信中断推迟），通信部分挂到 PendSV（最低优先级）
         servo_motion_update_1ms();
+        __atomic_fetch_add(&deferred_ticks, 1U, __ATOMIC_RELAXED);
+        SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+    }
+}
+
+// PendSV：TIM1 推迟的通信部分。被推迟超过 1ms 时按挂起的 tick 数补齐，协议计时不会变慢
+void app_deferred_tick(void)
+{
+    uint32_t ticks = __atomic_exchange_n(&deferred_ticks, 0U, __ATOMIC_ACQUIRE);
+    protocol_notify_flush();  // TIM1 中记下的运动完成推送
+    uart_driver_tx_retry();   // DMA 启动失败时留在队列中的帧
+    while (ticks-- > 0) {
+        protocol_telemetry_tick_1ms();
+        protocol_estop_tick_1ms();
         tf_uart_port_tick_1ms();
     }
 }
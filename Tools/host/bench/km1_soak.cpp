@@ -0,0 +1,658 @@
+/**
+ * @file km1_soak.cpp
+ * @brief 长时间负载 / 命令风暴测试（主机端，真实串口或仿真设备）
+ *
+ * 多个命令流（worker，模拟多个主机进程共用一条链路）按给定比例混合发送 MOTION / SERVO / CYCLE
+ * 命令，每个阶段（step 秒）结束时：
+ *   - 统计各子系统的发送数、成功数、失败状态码、超时和往返延迟（p50 / p99 / 最大）
+ *   - 读取设备的 DEBUG_STATS_TX（每个发送优先级的高水位、丢帧）、DEBUG_STATS_LINK
+ *     （接收错误 / 溢出、uart_driver_send_async 失败、"TF already locked"）和 DEBUG_STATS_TICK
+ *     （该负载下 1ms 舵机插补的抖动和单次耗时；仿真设备的 tick 由主机线程补齐，抖动只有真实
+ *     设备有意义），
+ *     然后 DEBUG_CMD_RESET_STATS，使高水位按阶段统计
+ *   - 以一行 JSON 输出到 stdout
+ * 每个阶段的目标速率乘以 ramp（ramp=1 为恒定速率的长时间浸泡），直到 duration 秒或 Ctrl-C；
+ * 最后一行 JSON 为汇总：各子系统第一次饱和的阶段和原因，延迟随时间的漂移（p50 的线性
+ * 回归斜率，恒定速率时才有意义），以及插补单次耗时（各阶段最大值的中位数和最大值）。
+ *
+ * 饱和判据（每个阶段）：
+ *   - motion / servo / cycle：失败（非 OK 状态或超时）超过完成数的 1%，或 p99 超过第一阶段的 4 倍
+ *   - uart_tx：任一发送优先级丢帧，或 send_async / TinyFrame 发送锁失败
+ *   - uart_rx：设备接收错误或溢出
+ *   - link：完成速率低于目标的 90%（在途窗口已满），或主机端超时 / 无应答 / CRC 错误
+ *
+ * 用法: km1_soak [key=value ...]
+ *   port=sim                      sim（仿真设备）或串口设备路径
+ *   baud=115200                   串口波特率；仿真设备按此模拟线上传输时间（0 为不模拟）
+ *   mix=motion:4,servo:4,cycle:1  各子系统命令的比例
+ *   rate=20 ramp=1.5              第一阶段的目标速率（命令/秒，所有 worker 合计）和每阶段的倍数
+ *   step=10 duration=120          每阶段秒数、总秒数
+ *   workers=3 window=8 timeout=500  命令流数、在途请求上限、请求超时（ms）
+ *
+ * CYCLE 命令交替 CYCLE_CMD_CREATE 和释放本工具创建的 cycle，运行前已存在的 cycle 不受影响。
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "km1_client.hpp"
+#include "km1_loopback.hpp"
+
+using namespace km1;
+using namespace km1::proto;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// protocol.h proto_debug_stats_t
+constexpr uint8_t kStatsTx   = 0x03;
+constexpr uint8_t kStatsLink = 0x06;
+constexpr uint8_t kStatsTick = 0x08;
+
+constexpr double kMaxFailRatio    = 0.01;
+constexpr double kMaxLatencyRatio = 4.0;
+constexpr double kMinRateRatio    = 0.9;
+
+enum Subsystem { kMotion = 0, kServo, kCycle, kSubsystemCount };
+
+const char* const kSubsystemNames[kSubsystemCount] = {"motion", "servo", "cycle"};
+
+std::atomic<bool> g_stop{false};
+
+void on_signal(int)
+{
+    g_stop = true;
+}
+
+struct Config {
+    std::string port                 = "sim";
+    uint32_t    baud                 = 115200;
+    double      mix[kSubsystemCount] = {4, 4, 1};
+    double      rate                 = 20;
+    double      ramp                 = 1.5;
+    double      step_s               = 10;
+    double      duration             = 120;
+    size_t      workers              = 3;
+    size_t      window               = 8;
+    uint32_t    timeout              = 500;
+};
+
+bool parse_mix(const std::string& text, double (&mix)[kSubsystemCount])
+{
+    std::fill(std::begin(mix), std::end(mix), 0.0);
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t      end   = std::min(text.find(',', pos), text.size());
+        std::string item  = text.substr(pos, end - pos);
+        size_t      colon = item.find(':');
+        bool        found = false;
+        for (int i = 0; i < kSubsystemCount && colon != std::string::npos; i++) {
+            if (item.compare(0, colon, kSubsystemNames[i]) == 0) {
+                mix[i] = std::atof(item.c_str() + colon + 1);
+                found  = true;
+            }
+        }
+        if (!found) {
+            return false;
+        }
+        pos = end + 1;
+    }
+    return mix[kMotion] + mix[kServo] + mix[kCycle] > 0;
+}
+
+bool parse_args(int argc, char** argv, Config& cfg)
+{
+    for (int i = 1; i < argc; i++) {
+        const char* eq = std::strchr(argv[i], '=');
+        if (eq == nullptr) {
+            return false;
+        }
+        std::string key(argv[i], static_cast<size_t>(eq - argv[i]));
+        const char* v = eq + 1;
+        if (key == "port") {
+            cfg.port = v;
+        } else if (key == "baud") {
+            cfg.baud = static_cast<uint32_t>(std::atol(v));
+        } else if (key == "mix") {
+            if (!parse_mix(v, cfg.mix)) {
+                return false;
+            }
+        } else if (key == "rate") {
+            cfg.rate = std::atof(v);
+        } else if (key == "ramp") {
+            cfg.ramp = std::atof(v);
+        } else if (key == "step") {
+            cfg.step_s = std::atof(v);
+        } else if (key == "duration") {
+            cfg.duration = std::atof(v);
+        } else if (key == "workers") {
+            cfg.workers = static_cast<size_t>(std::atoi(v));
+        } else if (key == "window") {
+            cfg.window = static_cast<size_t>(std::atoi(v));
+        } else if (key == "timeout") {
+            cfg.timeout = static_cast<uint32_t>(std::atoi(v));
+        } else {
+            return false;
+        }
+    }
+    return cfg.rate > 0 && cfg.ramp >= 1 && cfg.step_s > 0 && cfg.duration > 0 && cfg.workers > 0;
+}
+
+// 定长消息编码成请求负载
+template <typename Msg>
+std::vector<uint8_t> encode_fixed(const Msg& msg)
+{
+    std::vector<uint8_t> out(Msg::kSize);
+    msg.encode(out.data());
+    return out;
+}
+
+double percentile(std::vector<double>& v, double p)
+{
+    if (v.empty()) {
+        return 0;
+    }
+    std::sort(v.begin(), v.end());
+    size_t idx = static_cast<size_t>(p * static_cast<double>(v.size() - 1) + 0.5);
+    return v[std::min(idx, v.size() - 1)];
+}
+
+// ==================== 负载 ====================
+
+struct SubStats {
+    uint64_t                sent     = 0;
+    uint64_t                ok       = 0;
+    uint64_t                timeouts = 0;  // 超时或无应答
+    std::map<int, uint64_t> failed;        // 设备状态码 -> 次数
+    std::vector<double>     latency_us;
+};
+
+class Load {
+public:
+    Load(Client& client, const Config& cfg) : client_(client), cfg_(cfg) {}
+
+    // 运行前已存在的 cycle 不属于本工具
+    void seed_cycles()
+    {
+        std::vector<cycle_status_t> list;
+        if (decode_cycle_list(client_.request(PROTO_TYPE_CYCLE, CYCLE_CMD_LIST).get(), list)) {
+            for (const cycle_status_t& c : list) {
+                known_cycles_.insert(c.index);
+            }
+        }
+    }
+
+    void set_rate(double rate) { worker_rate_ = rate / static_cast<double>(cfg_.workers); }
+
+    void start()
+    {
+        for (size_t w = 0; w < cfg_.workers; w++) {
+            threads_.emplace_back(&Load::worker, this, w);
+        }
+    }
+
+    void stop()
+    {
+        running_ = false;
+        for (std::thread& t : threads_) {
+            t.join();
+        }
+        threads_.clear();
+    }
+
+    // 取出本阶段的统计并清零
+    void take(SubStats (&out)[kSubsystemCount])
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (int i = 0; i < kSubsystemCount; i++) {
+            out[i]    = std::move(stats_[i]);
+            stats_[i] = SubStats{};
+        }
+    }
+
+private:
+    void worker(size_t index)
+    {
+        std::mt19937                    rng(static_cast<uint32_t>(index) + 1U);
+        std::discrete_distribution<int> pick(std::begin(cfg_.mix), std::end(cfg_.mix));
+        uint8_t                         servo = static_cast<uint8_t>((index * 2) % 6);
+        uint32_t                        n     = 0;
+        Clock::time_point               next  = Clock::now();
+
+        while (running_) {
+            next += std::chrono::microseconds(static_cast<int64_t>(1e6 / worker_rate_.load()));
+            Clock::time_point now = Clock::now();
+            if (next > now) {
+                std::this_thread::sleep_until(next);
+            } else if (now - next > std::chrono::milliseconds(100)) {
+                next = now;  // 窗口满、发不出去：不补发积压，完成速率会低于目标
+            }
+            if (!running_) {
+                break;
+            }
+            send(static_cast<Subsystem>(pick(rng)), servo, n++);
+        }
+    }
+
+    void send(Subsystem sub, uint8_t servo, uint32_t n)
+    {
+        std::vector<uint8_t> payload;
+        uint8_t              type;
+        uint8_t              cmd;
+        int                  release = -1;
+
+        switch (sub) {
+            case kMotion: {
+                // 两个舵机的同步组，20ms 完成（完成时设备推送批量状态帧）
+                motion_start_req_t req;
+                req.mode        = 0;
+                req.count       = 2;
+                req.duration_ms = 20;
+                req.servo_ids   = {servo, static_cast<uint8_t>(servo + 1)};
+                req.values      = {1000 + (n % 2) * 1000, 2000 - (n % 2) * 1000};
+                type            = PROTO_TYPE_MOTION;
+                cmd             = MOTION_CMD_START;
+                payload         = req.encode();
+                break;
+            }
+            case kServo:
+                type = PROTO_TYPE_SERVO;
+                if (n % 2 == 0) {
+                    cmd     = SERVO_CMD_SET_PWM;
+                    payload = encode_fixed(servo_set_pwm_req_t{servo, 1200 + (n % 7) * 100, 0});
+                } else {
+                    cmd     = SERVO_CMD_GET_STATUS;
+                    payload = encode_fixed(servo_id_req_t{servo});
+                }
+                break;
+            default: {
+                type = PROTO_TYPE_CYCLE;
+                std::lock_guard<std::mutex> lock(cycle_mutex_);
+                if (!owned_cycles_.empty()) {
+                    release = owned_cycles_.front();
+                    owned_cycles_.pop_front();
+                    cmd     = CYCLE_CMD_RELEASE;
+                    payload = encode_fixed(cycle_id_req_t{static_cast<uint32_t>(release)});
+                } else {
+                    CycleSpec spec;
+                    spec.angles       = false;
+                    spec.max_loops    = 1;
+                    spec.ids          = {servo};
+                    spec.durations_ms = {50, 50};
+                    spec.poses        = {{1400}, {1600}};
+                    cmd               = CYCLE_CMD_CREATE;
+                    payload           = encode_cycle_create(spec);
+                }
+                break;
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_[sub].sent++;
+        }
+        auto sent = Clock::now();
+        client_.request(type, cmd, payload.data(), payload.size(), [=](Reply reply) {
+            double us = std::chrono::duration<double, std::micro>(Clock::now() - sent).count();
+            if (sub == kCycle) {
+                track_cycles(cmd, release, reply);
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            SubStats& st = stats_[sub];
+            st.latency_us.push_back(us);
+            if (reply.ok()) {
+                st.ok++;
+            } else if (reply.status == kStatusTimeout || reply.status == kStatusNoAnswer) {
+                st.timeouts++;
+            } else {
+                st.failed[reply.status]++;
+            }
+        });
+    }
+
+    // 应答按设备处理顺序到达：CREATE 应答中新出现的下标就是刚创建的 cycle
+    void track_cycles(uint8_t cmd, int release, const Reply& reply)
+    {
+        std::lock_guard<std::mutex> lock(cycle_mutex_);
+        if (cmd == CYCLE_CMD_RELEASE) {
+            known_cycles_.erase(static_cast<uint8_t>(release));
+            return;
+        }
+        std::vector<cycle_status_t> list;
+        if (!reply.ok() || !decode_cycle_list(reply, list)) {
+            return;
+        }
+        for (const cycle_status_t& c : list) {
+            if (known_cycles_.insert(c.index).second) {
+                owned_cycles_.push_back(c.index);
+            }
+        }
+    }
+
+    Client&       client_;
+    const Config& cfg_;
+
+    std::atomic<bool>        running_{true};
+    std::atomic<double>      worker_rate_{1.0};
+    std::vector<std::thread> threads_;
+
+    std::mutex mutex_;
+    SubStats   stats_[kSubsystemCount];
+
+    std::mutex        cycle_mutex_;
+    std::set<uint8_t> known_cycles_;
+    std::deque<int>   owned_cycles_;
+};
+
+// ==================== 设备统计 ====================
+
+struct DeviceStats {
+    bool                                tx_ok   = false;
+    bool                                link_ok = false;
+    bool                                tick_ok = false;
+    std::vector<debug_tx_class_stats_t> tx;
+    debug_link_stats_resp_t             link;
+    debug_tick_stats_resp_t             tick;
+};
+
+DeviceStats read_device_stats(Client& client)
+{
+    DeviceStats out;
+    // [STATE_CMD_DEBUG][debug_tx_stats_resp]
+    debug_tx_stats_resp_t tx;
+
+    Reply r = client.request(PROTO_TYPE_DEBUG, DEBUG_CMD_GET_STATS, {kStatsTx}).get();
+    if (r.ok() && !r.data.empty() && r.data[0] == STATE_CMD_DEBUG
+        && debug_tx_stats_resp_t::decode(r.data.data() + 1, r.data.size() - 1, tx)
+        && tx.section == kStatsTx) {
+        out.tx    = std::move(tx.classes);
+        out.tx_ok = true;
+    }
+    // [STATE_CMD_DEBUG][debug_link_stats_resp]，旧固件回 INVALID_ARG
+    r = client.request(PROTO_TYPE_DEBUG, DEBUG_CMD_GET_STATS, {kStatsLink}).get();
+    out.link_ok = r.ok() && r.data.size() == 1 + debug_link_stats_resp_t::kSize
+               && r.data[0] == STATE_CMD_DEBUG
+               && debug_link_stats_resp_t::decode(r.data.data() + 1,
+                                                  debug_link_stats_resp_t::kSize, out.link);
+    r           = client.request(PROTO_TYPE_DEBUG, DEBUG_CMD_GET_STATS, {kStatsTick}).get();
+    out.tick_ok = r.ok() && r.data.size() == 1 + debug_tick_stats_resp_t::kSize
+               && r.data[0] == STATE_CMD_DEBUG
+               && debug_tick_stats_resp_t::decode(r.data.data() + 1,
+                                                  debug_tick_stats_resp_t::kSize, out.tick);
+    // 高水位和丢帧数按阶段统计
+    (void)client.request(PROTO_TYPE_DEBUG, DEBUG_CMD_RESET_STATS).get();
+    return out;
+}
+
+// ==================== 饱和判定 ====================
+
+struct Saturation {
+    int         step = -1;
+    double      rate = 0;
+    std::string reason;
+};
+
+void mark(Saturation& s, int step, double rate, const std::string& reason)
+{
+    if (s.step < 0 && !reason.empty()) {
+        s.step   = step;
+        s.rate   = rate;
+        s.reason = reason;
+    }
+}
+
+std::string fmt(const char* format, double a, double b = 0)
+{
+    char buf[96];
+    std::snprintf(buf, sizeof(buf), format, a, b);
+    return buf;
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    Config cfg;
+    if (!parse_args(argc, argv, cfg)) {
+        std::fprintf(stderr,
+                     "usage: %s [port=sim|<tty>] [baud=115200] [mix=motion:4,servo:4,cycle:1]\n"
+                     "          [rate=20] [ramp=1.5] [step=10] [duration=120] [workers=3]\n"
+                     "          [window=8] [timeout=500]\n",
+                     argv[0]);
+        return 1;
+    }
+
+    std::unique_ptr<Transport> transport;
+    if (cfg.port == "sim") {
+        auto link = std::make_unique<LoopbackTransport>(cfg.baud);
+        if (!link->start()) {
+            std::fprintf(stderr, "cannot start simulated device\n");
+            return 1;
+        }
+        transport = std::move(link);
+    } else {
+        auto serial = std::make_unique<SerialTransport>();
+        if (!serial->open(cfg.port, cfg.baud)) {
+            std::fprintf(stderr, "%s\n", serial->error().c_str());
+            return 1;
+        }
+        transport = std::move(serial);
+    }
+
+    Client::Options options;
+    options.max_in_flight = cfg.window;
+    options.timeout       = std::chrono::milliseconds(cfg.timeout);
+    Client client(*transport, options);
+
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+
+    DeviceStats prev_dev = read_device_stats(client);  // 链路计数的起点，同时清零高水位
+    Load        load(client, cfg);
+    load.seed_cycles();
+    load.set_rate(cfg.rate);
+    load.start();
+
+    const auto    start    = Clock::now();
+    auto          step_end = start;
+    double        rate     = cfg.rate;
+    double        base_p99[kSubsystemCount] = {0, 0, 0};
+    Saturation    sat_sub[kSubsystemCount];
+    Saturation    sat_tx, sat_rx, sat_link;
+    Client::Stats prev_host = client.stats();
+
+    std::vector<std::pair<double, double>> drift;     // (小时, p50 us)
+    std::vector<double>                    tick_run;  // 各阶段 1ms 插补的最长单次耗时（us）
+
+    const int steps = std::max(1, static_cast<int>(std::lround(cfg.duration / cfg.step_s)));
+    int       step  = 0;
+    for (; !g_stop; step++) {
+        load.set_rate(rate);
+        step_end += std::chrono::microseconds(static_cast<int64_t>(cfg.step_s * 1e6));
+        while (!g_stop && Clock::now() < step_end) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        double elapsed_s = std::chrono::duration<double>(Clock::now() - start).count();
+
+        SubStats subs[kSubsystemCount];
+        load.take(subs);
+        DeviceStats   dev  = read_device_stats(client);
+        Client::Stats host = client.stats();
+
+        std::printf("{\"step\": %d, \"t_s\": %.1f, \"target_rate\": %.1f", step, elapsed_s, rate);
+        uint64_t            done_total = 0;
+        std::vector<double> all_latency;
+        for (int i = 0; i < kSubsystemCount; i++) {
+            SubStats& st   = subs[i];
+            uint64_t  done = st.latency_us.size();
+            uint64_t  bad  = done - st.ok;
+            done_total += done;
+            all_latency.insert(all_latency.end(), st.latency_us.begin(), st.latency_us.end());
+            double p50 = percentile(st.latency_us, 0.50);
+            double p99 = percentile(st.latency_us, 0.99);
+            double max = st.latency_us.empty() ? 0 : st.latency_us.back();
+
+            std::printf(", \"%s\": {\"sent\": %llu, \"ok\": %llu, \"timeouts\": %llu, "
+                        "\"failed\": {",
+                        kSubsystemNames[i], static_cast<unsigned long long>(st.sent),
+                        static_cast<unsigned long long>(st.ok),
+                        static_cast<unsigned long long>(st.timeouts));
+            for (auto it = st.failed.begin(); it != st.failed.end(); ++it) {
+                std::printf("%s\"%d\": %llu", it == st.failed.begin() ? "" : ", ", it->first,
+                            static_cast<unsigned long long>(it->second));
+            }
+            std::printf("}, \"p50_us\": %.0f, \"p99_us\": %.0f, \"max_us\": %.0f}", p50, p99, max);
+
+            if (done == 0) {
+                continue;
+            }
+            if (base_p99[i] == 0) {
+                base_p99[i] = p99;
+            }
+            if (static_cast<double>(bad) > kMaxFailRatio * static_cast<double>(done)) {
+                mark(sat_sub[i], step, rate,
+                     fmt("%.1f%% of commands failed", 100.0 * bad / done));
+            } else if (p99 > kMaxLatencyRatio * base_p99[i]) {
+                mark(sat_sub[i], step, rate, fmt("p99 %.0f us (first step %.0f us)", p99,
+                                                 base_p99[i]));
+            }
+        }
+
+        // 设备端：发送队列（本阶段的高水位和丢帧）、链路计数（与上一阶段的差）
+        std::printf(", \"device\": {");
+        if (dev.tx_ok) {
+            std::printf("\"tx\": [");
+            uint64_t drops = 0;
+            for (size_t i = 0; i < dev.tx.size(); i++) {
+                std::printf("%s{\"high_water\": %u, \"sent\": %u, \"drops\": %u}", i ? ", " : "",
+                            dev.tx[i].high_water, dev.tx[i].sent, dev.tx[i].drops);
+                drops += dev.tx[i].drops;
+            }
+            std::printf("]");
+            if (drops > 0) {
+                mark(sat_tx, step, rate, fmt("%.0f frames dropped from the TX queue", drops));
+            }
+        }
+        if (dev.link_ok && prev_dev.link_ok) {
+            const debug_link_stats_resp_t& a = prev_dev.link;
+            const debug_link_stats_resp_t& b = dev.link;
+            uint32_t rx_errors    = b.rx_errors - a.rx_errors;
+            uint32_t rx_overflows = b.rx_overflows - a.rx_overflows;
+            uint32_t send_fails   = b.tx_send_fails - a.tx_send_fails;
+            uint32_t lock_fails   = b.tx_lock_fails - a.tx_lock_fails;
+            std::printf("%s\"link\": {\"rx_errors\": %u, \"rx_overflows\": %u, "
+                        "\"tx_send_fails\": %u, \"tx_lock_fails\": %u}",
+                        dev.tx_ok ? ", " : "", rx_errors, rx_overflows, send_fails, lock_fails);
+            if (send_fails + lock_fails > 0) {
+                mark(sat_tx, step, rate,
+                     fmt("%.0f send_async failures, %.0f TX lock conflicts", send_fails,
+                         lock_fails));
+            }
+            if (rx_errors + rx_overflows > 0) {
+                mark(sat_rx, step, rate,
+                     fmt("%.0f RX errors, %.0f RX overflows", rx_errors, rx_overflows));
+            }
+        }
+        if (dev.tick_ok && dev.tick.ticks > 0 && dev.tick.cpu_hz > 0) {
+            // 本阶段 1ms 插补入口间隔的抖动和单次耗时（微秒）
+            double us = 1e6 / dev.tick.cpu_hz;
+            std::printf("%s\"tick\": {\"jitter_us\": %.2f, \"period_max_us\": %.2f, "
+                        "\"run_max_us\": %.2f}",
+                        (dev.tx_ok || (dev.link_ok && prev_dev.link_ok)) ? ", " : "",
+                        (dev.tick.period_max - dev.tick.period_min) * us,
+                        dev.tick.period_max * us, dev.tick.run_max * us);
+            tick_run.push_back(dev.tick.run_max * us);
+        }
+        if (dev.link_ok) {
+            prev_dev = dev;
+        }
+
+        // 主机端：完成速率、超时、CRC 错误
+        double   achieved   = static_cast<double>(done_total) / cfg.step_s;
+        uint64_t timeouts   = (host.timeouts - prev_host.timeouts)
+                          + (host.no_answer - prev_host.no_answer);
+        uint64_t crc_errors = host.frames.crc_errors - prev_host.frames.crc_errors;
+        std::printf("}, \"host\": {\"achieved_rate\": %.1f, \"timeouts\": %llu, "
+                    "\"crc_errors\": %llu, \"unsolicited\": %llu}}\n",
+                    achieved, static_cast<unsigned long long>(timeouts),
+                    static_cast<unsigned long long>(crc_errors),
+                    static_cast<unsigned long long>(host.unsolicited - prev_host.unsolicited));
+        std::fflush(stdout);
+        prev_host = host;
+
+        if (!g_stop && achieved < kMinRateRatio * rate) {
+            mark(sat_link, step, rate, fmt("completed %.1f of %.1f commands/s", achieved, rate));
+        } else if (timeouts + crc_errors > 0) {
+            mark(sat_link, step, rate,
+                 fmt("%.0f timeouts, %.0f CRC errors", static_cast<double>(timeouts),
+                     static_cast<double>(crc_errors)));
+        }
+        if (!all_latency.empty()) {
+            drift.emplace_back(elapsed_s / 3600.0, percentile(all_latency, 0.50));
+        }
+
+        if (step + 1 >= steps) {
+            break;
+        }
+        rate *= cfg.ramp;
+    }
+
+    load.stop();
+    client.drain();
+    client.close();
+
+    // 延迟漂移：各阶段 p50 对时间的最小二乘斜率
+    double slope = 0;
+    if (drift.size() >= 2) {
+        double n = static_cast<double>(drift.size()), sx = 0, sy = 0, sxx = 0, sxy = 0;
+        for (const auto& [x, y] : drift) {
+            sx += x;
+            sy += y;
+            sxx += x * x;
+            sxy += x * y;
+        }
+        double den = n * sxx - sx * sx;
+        slope      = den > 0 ? (n * sxy - sx * sy) / den : 0;
+    }
+
+    auto print_sat = [](const char* name, const Saturation& s, bool last) {
+        if (s.step < 0) {
+            std::printf("\"%s\": null%s", name, last ? "" : ", ");
+        } else {
+            std::printf("\"%s\": {\"step\": %d, \"rate\": %.1f, \"reason\": \"%s\"}%s", name,
+                        s.step, s.rate, s.reason.c_str(), last ? "" : ", ");
+        }
+    };
+    std::printf("{\"summary\": {\"steps\": %d, \"saturation\": {", step + 1);
+    for (int i = 0; i < kSubsystemCount; i++) {
+        print_sat(kSubsystemNames[i], sat_sub[i], false);
+    }
+    print_sat("uart_tx", sat_tx, false);
+    print_sat("uart_rx", sat_rx, false);
+    print_sat("link", sat_link, true);
+    std::printf("}, \"latency_drift\": {\"first_p50_us\": %.0f, \"last_p50_us\": %.0f, "
+                "\"p50_us_per_hour\": %.1f}",
+                drift.empty() ? 0.0 : drift.front().second,
+                drift.empty() ? 0.0 : drift.back().second, slope);
+    // 插补耗时：各阶段最大值的中位数和总的最大值。仿真设备的 tick 在主机线程中执行，
+    // 单个阶段的最大值常被线程调度放大，中位数更能反映 tick 里做了多少事
+    double tick_run_p50 = percentile(tick_run, 0.50);
+    std::printf(", \"tick\": {\"run_max_us_p50\": %.2f, \"run_max_us\": %.2f}}}\n",
+                tick_run_p50, tick_run.empty() ? 0.0 : tick_run.back());
+    return 0;
+}
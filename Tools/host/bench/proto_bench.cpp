@@ -0,0 +1,338 @@
+/**
+ * @file proto_bench.cpp
+ * @brief 协议吞吐量 / 往返延迟基准测试（主机端，仿真设备）
+ *
+ * 通过 km1::LoopbackTransport 驱动固件的主机构建（TinyFrame + listener + 运动引擎），
+ * 链路按给定波特率模拟 8N1 传输时间（0 表示不模拟，只测逻辑开销）。
+ * 对每个帧类型的代表命令测量：
+ *   - 往返延迟：逐个发送、等待应答（p50 / p99 / 平均 / 最大，微秒）
+ *   - 吞吐量：最多 window 个请求在途时每秒完成的命令数
+ *   - 线上字节：每个命令两个方向的字节数（含帧头和 CRC，以及命令引起的状态推送）
+ * 结果以 JSON 输出到 stdout，便于比较传输层、帧格式和编解码的改动；ok / failed 为两轮合计
+ * （2 * count 个请求），failed 按状态码分列。
+ * 大帧模式下另测一项 max_frame_wrap：接近最大长度的 PING 依次发送，起始位置在设备的 DMA
+ * 接收缓冲区中逐帧移动，其中一部分跨越缓冲区末尾（经镜像区原地解析），PONG 必须原样回显。
+ * 每轮最后测一项 estop_then_cmds：急停（SERVO_CMD_DISABLE）后紧接着流水线发送几个命令，
+ * 急停的栅栏只跳过排在它前面的帧，之后的命令都必须正常执行（skipped 应为 0）。
+ *
+ * 用法: proto_bench [count] [baud,baud,...] [window] [small|large]
+ *   默认 1000 115200,921600,0 8 small
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "km1_client.hpp"
+#include "km1_loopback.hpp"
+
+using namespace km1;
+using namespace km1::proto;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Op {
+    const char*          name;
+    const char*          type_name;
+    uint8_t              type;
+    uint8_t              cmd;
+    std::vector<uint8_t> payload;
+};
+
+struct OpResult {
+    uint32_t                ok = 0;
+    std::map<int, uint32_t> failed;  // 状态码 -> 次数
+    double                  p50_us          = 0;
+    double                  p99_us          = 0;
+    double                  avg_us          = 0;
+    double                  max_us          = 0;
+    double                  cmds_per_s      = 0;
+    double                  to_device_bytes = 0;  // 每个命令
+    double                  to_host_bytes   = 0;
+};
+
+std::vector<uint8_t> le32(uint32_t v)
+{
+    return {static_cast<uint8_t>(v), static_cast<uint8_t>(v >> 8), static_cast<uint8_t>(v >> 16),
+            static_cast<uint8_t>(v >> 24)};
+}
+
+std::vector<uint8_t> cat(std::initializer_list<std::vector<uint8_t>> parts)
+{
+    std::vector<uint8_t> out;
+    for (const auto& p : parts) {
+        out.insert(out.end(), p.begin(), p.end());
+    }
+    return out;
+}
+
+// 每个有处理函数的帧类型至少一个代表命令。
+// MOTION_START 每次占用一个同步组（20ms 后释放），发送速率超过 8 组 / 20ms 时设备回 BUSY，
+// 计入 failed["5"]
+std::vector<Op> make_ops()
+{
+    auto f32 = [](float v) {
+        uint32_t u;
+        std::memcpy(&u, &v, sizeof(u));
+        return le32(u);
+    };
+
+    std::vector<Op> ops;
+    ops.push_back({"SYS_PING", "SYS", PROTO_TYPE_SYS, SYS_CMD_PING, {}});
+    ops.push_back({"SYS_GET_INFO", "SYS", PROTO_TYPE_SYS, SYS_CMD_GET_INFO, {}});
+    // [flags][count]{[type][cmd][len:u16][payload]}：SERVO_GET_STATUS(0) + ARM_GET_STATUS
+    ops.push_back({"BATCH_EXEC", "BATCH", PROTO_TYPE_BATCH, BATCH_CMD_EXEC,
+                   {0x00, 2, PROTO_TYPE_SERVO, SERVO_CMD_GET_STATUS, 1, 0, 0, PROTO_TYPE_ARM,
+                    ARM_CMD_GET_STATUS, 0, 0}});
+    ops.push_back({"SERVO_SET_PWM", "SERVO", PROTO_TYPE_SERVO, SERVO_CMD_SET_PWM,
+                   cat({{0}, le32(1500), le32(0)})});
+    ops.push_back({"SERVO_GET_STATUS", "SERVO", PROTO_TYPE_SERVO, SERVO_CMD_GET_STATUS, {0}});
+    ops.push_back({"MOTION_START", "MOTION", PROTO_TYPE_MOTION, MOTION_CMD_START,
+                   cat({{1, 2}, le32(20), {0, 1}, f32(30.0f), f32(60.0f)})});
+    ops.push_back({"CYCLE_LIST", "CYCLE", PROTO_TYPE_CYCLE, CYCLE_CMD_LIST, {}});
+    ops.push_back({"ARM_GET_STATUS", "ARM", PROTO_TYPE_ARM, ARM_CMD_GET_STATUS, {}});
+    ops.push_back({"TELEM_SUBSCRIBE", "TELEM", PROTO_TYPE_TELEM, TELEM_CMD_SUBSCRIBE,
+                   {0, 0, 0, 0}});  // 取消订阅：不产生遥测帧
+    ops.push_back({"CONFIG_GET", "CONFIG", PROTO_TYPE_CONFIG, CONFIG_CMD_GET, {}});
+    ops.push_back({"DEBUG_GET_STATS", "DEBUG", PROTO_TYPE_DEBUG, DEBUG_CMD_GET_STATS, {0x01}});
+    return ops;
+}
+
+struct WrapResult {
+    uint32_t ok        = 0;  // PONG 与 PING 负载一致
+    uint32_t failed    = 0;
+    uint32_t straddled = 0;  // 跨越 DMA 缓冲区末尾的 PING
+};
+
+WrapResult run_wrap_check(Client& client, LoopbackTransport& link, uint32_t count)
+{
+    WrapResult r;
+    // 设备的 DMA 接收缓冲区：UART_DMA_RX_BUFFER_SIZE = 2 * COMM_MAX_FRAME（comm_config.h），
+    // COMM_MAX_PAYLOAD 取设备在 FRAME_MODE 应答中报告的值
+    const size_t max_payload = client.max_payload();
+    const size_t ring        = 2 * (max_payload + kFrameOverhead);
+    // [cmd] 占一个负载字节；长度逐帧递减，使起始位置不会停在缓冲区的整数分点上
+    const size_t max_len = max_payload - 1;
+    for (uint32_t i = 0; i < count; i++) {
+        std::vector<uint8_t> payload(max_len - (i % 97U));
+        for (size_t k = 0; k < payload.size(); k++) {
+            payload[k] = static_cast<uint8_t>(k * 31U + i);
+        }
+        // 设备端“DMA”从上电起连续写入，起始位置即已发送字节数对缓冲区大小取模
+        size_t start = static_cast<size_t>(link.stats().to_device_bytes % ring);
+        if (start + payload.size() + 1 + kFrameOverhead > ring) {
+            r.straddled++;
+        }
+        Reply reply = client.request(PROTO_TYPE_SYS, SYS_CMD_PING, payload).get();
+        if (reply.ok() && reply.data.size() == payload.size() + 1
+            && std::equal(payload.begin(), payload.end(), reply.data.begin() + 1)) {
+            r.ok++;
+        } else {
+            r.failed++;
+        }
+    }
+    return r;
+}
+
+struct EstopResult {
+    uint32_t stops   = 0;  // 急停应答 OK
+    uint32_t ok      = 0;  // 紧随其后的命令
+    uint32_t skipped = 0;  // 被急停栅栏跳过（不应出现）
+    uint32_t failed  = 0;
+};
+
+constexpr uint32_t kEstopFollowers = 4;  // 每次急停后紧跟的命令数
+
+EstopResult run_estop_check(Client& client, uint32_t count)
+{
+    EstopResult r;
+    for (uint32_t i = 0; i < count; i++) {
+        std::vector<std::future<Reply>> pending;
+        pending.push_back(client.request(PROTO_TYPE_SERVO, SERVO_CMD_DISABLE));
+        for (uint32_t k = 0; k < kEstopFollowers; k++) {
+            pending.push_back(client.request(PROTO_TYPE_SERVO, SERVO_CMD_GET_STATUS, {0}));
+        }
+        for (size_t k = 0; k < pending.size(); k++) {
+            Reply reply = pending[k].get();
+            if (k == 0) {
+                r.stops += reply.ok() ? 1U : 0U;
+            } else if (reply.ok()) {
+                r.ok++;
+            } else if (reply.status == PROTO_STATUS_SKIPPED) {
+                r.skipped++;
+            } else {
+                r.failed++;
+            }
+        }
+    }
+    return r;
+}
+
+double percentile(std::vector<double>& sorted, double p)
+{
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t idx = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+OpResult run_op(Client& client, LoopbackTransport& link, const Op& op, uint32_t count)
+{
+    OpResult r;
+
+    // 往返延迟：一次只有一个请求在途
+    std::vector<double> rtt;
+    rtt.reserve(count);
+    LoopbackTransport::Stats before = link.stats();
+    for (uint32_t i = 0; i < count; i++) {
+        auto  t0    = Clock::now();
+        Reply reply = client.request(op.type, op.cmd, op.payload).get();
+        auto  t1    = Clock::now();
+        if (reply.ok()) {
+            r.ok++;
+        } else {
+            r.failed[reply.status]++;
+        }
+        rtt.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+    }
+    // 命令引起的推送（例如运动完成）可能在应答之后才发出，等它们计入
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    LoopbackTransport::Stats after = link.stats();
+    r.to_device_bytes = static_cast<double>(after.to_device_bytes - before.to_device_bytes) / count;
+    r.to_host_bytes   = static_cast<double>(after.to_host_bytes - before.to_host_bytes) / count;
+
+    std::sort(rtt.begin(), rtt.end());
+    r.p50_us = percentile(rtt, 0.50);
+    r.p99_us = percentile(rtt, 0.99);
+    r.max_us = rtt.empty() ? 0 : rtt.back();
+    double sum = 0;
+    for (double v : rtt) {
+        sum += v;
+    }
+    r.avg_us = rtt.empty() ? 0 : sum / static_cast<double>(rtt.size());
+
+    // 吞吐量：窗口内流水线发送
+    std::vector<std::future<Reply>> pending;
+    pending.reserve(count);
+    auto t0 = Clock::now();
+    for (uint32_t i = 0; i < count; i++) {
+        pending.push_back(client.request(op.type, op.cmd, op.payload));
+    }
+    for (auto& f : pending) {
+        Reply reply = f.get();
+        if (reply.ok()) {
+            r.ok++;
+        } else {
+            r.failed[reply.status]++;
+        }
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+    r.cmds_per_s   = seconds > 0 ? count / seconds : 0;
+    return r;
+}
+
+std::vector<uint32_t> parse_bauds(const char* arg)
+{
+    std::vector<uint32_t> bauds;
+    std::string           s(arg);
+    size_t                start = 0;
+    while (start <= s.size()) {
+        size_t end = s.find(',', start);
+        if (end == std::string::npos) {
+            end = s.size();
+        }
+        if (end > start) {
+            bauds.push_back(static_cast<uint32_t>(std::strtoul(s.c_str() + start, nullptr, 10)));
+        }
+        start = end + 1;
+    }
+    return bauds;
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    uint32_t              count  = (argc > 1) ? static_cast<uint32_t>(std::atoi(argv[1])) : 1000;
+    std::vector<uint32_t> bauds  = parse_bauds((argc > 2) ? argv[2] : "115200,921600,0");
+    size_t                window = (argc > 3) ? static_cast<size_t>(std::atoi(argv[3])) : 8;
+    bool                  large  = (argc > 4) && std::strcmp(argv[4], "large") == 0;
+    if (count == 0 || bauds.empty()) {
+        std::fprintf(stderr, "usage: %s [count] [baud,baud,...] [window] [small|large]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<Op> ops = make_ops();
+
+    std::printf("{\n  \"bench\": \"proto_bench\",\n  \"count\": %u,\n  \"window\": %zu,\n", count,
+                window);
+    std::printf("  \"frame_mode\": \"%s\",\n  \"runs\": [\n", large ? "large" : "small");
+    for (size_t b = 0; b < bauds.size(); b++) {
+        LoopbackTransport link(bauds[b]);
+        if (!link.start()) {
+            std::fprintf(stderr, "cannot start simulated device\n");
+            return 1;
+        }
+        Client::Options options;
+        options.max_in_flight = window;
+        options.timeout       = std::chrono::milliseconds(2000);
+        Client client(link, options);
+        if (!client.set_frame_mode(large)) {
+            std::fprintf(stderr, "SET_FRAME_MODE failed\n");
+            return 1;
+        }
+
+        std::printf("    {\n      \"baud\": %u,\n      \"ops\": [\n", bauds[b]);
+        for (size_t i = 0; i < ops.size(); i++) {
+            const Op& op = ops[i];
+            std::fprintf(stderr, "baud %u: %s\n", bauds[b], op.name);
+            OpResult r = run_op(client, link, op, count);
+            std::printf("        {\"name\": \"%s\", \"type\": \"%s\", "
+                        "\"type_id\": %u, \"cmd\": %u, \"ok\": %u,\n         \"failed\": {",
+                        op.name, op.type_name, op.type, op.cmd, r.ok);
+            for (auto it = r.failed.begin(); it != r.failed.end(); ++it) {
+                std::printf("%s\"%d\": %u", (it == r.failed.begin()) ? "" : ", ", it->first,
+                            it->second);
+            }
+            std::printf("},\n");
+            std::printf("         \"latency_us\": {\"p50\": %.1f, \"p99\": %.1f, \"avg\": %.1f, "
+                        "\"max\": %.1f},\n",
+                        r.p50_us, r.p99_us, r.avg_us, r.max_us);
+            std::printf("         \"cmds_per_s\": %.1f, \"bytes_to_device\": %.1f, "
+                        "\"bytes_to_host\": %.1f}%s\n",
+                        r.cmds_per_s, r.to_device_bytes, r.to_host_bytes,
+                        (i + 1 < ops.size()) ? "," : "");
+        }
+        std::printf("      ],\n");
+        if (large) {
+            std::fprintf(stderr, "baud %u: max_frame_wrap\n", bauds[b]);
+            WrapResult w = run_wrap_check(client, link, count);
+            std::printf("      \"max_frame_wrap\": {\"ok\": %u, \"failed\": %u, "
+                        "\"straddled\": %u},\n",
+                        w.ok, w.failed, w.straddled);
+        }
+        std::fprintf(stderr, "baud %u: estop_then_cmds\n", bauds[b]);
+        EstopResult e = run_estop_check(client, count);
+        std::printf("      \"estop_then_cmds\": {\"stops\": %u, \"ok\": %u, \"skipped\": %u, "
+                    "\"failed\": %u},\n",
+                    e.stops, e.ok, e.skipped, e.failed);
+        Client::Stats st = client.stats();
+        std::printf("      \"timeouts\": %llu,\n      \"no_answer\": %llu,\n",
+                    static_cast<unsigned long long>(st.timeouts),
+                    static_cast<unsigned long long>(st.no_answer));
+        std::printf("      \"crc_errors\": %llu\n    }%s\n",
+                    static_cast<unsigned long long>(st.frames.crc_errors),
+                    (b + 1 < bauds.size()) ? "," : "");
+        client.close();
+    }
+    std::printf("  ]\n}\n");
+    return 0;
+}
@@ -0,0 +1,253 @@
+/**
+ * @file tf_parse_bench.c
+ * @brief TinyFrame 接收解析吞吐量基准测试（主机端）
+ *
+ * 用固件同一份 TF_Config.h 生成一段帧流，分别用
+ *   - TF_Accept()        逐字节状态机（TF_RX_IN_PLACE=0 时的接收路径）
+ *   - TF_AcceptInPlace() 原地解析（整段缓冲区，固件默认）
+ * 解析并统计字节/秒。目标板上的对应数据由 DEBUG_CMD_GET_STATS 读取。
+ * 最后检查原地解析的超时：跨越环形缓冲区末尾的截断帧按 tf_uart_port.c 的方式分两次解析
+ * （先到末尾，再拼上回绕部分），必须在 TF_PARSER_TIMEOUT_TICKS 后被丢弃，其后的帧照常收到。
+ *
+ * 用法: tf_parse_bench [frames] [max_payload]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "TinyFrame.h"
+#include "tf_crc32.h"
+
+static uint8_t* stream     = NULL;
+static uint32_t stream_len = 0;
+static uint32_t stream_cap = 0;
+static uint32_t rx_frames  = 0;
+static uint8_t  len_bytes  = 1;  // LEN 字段宽度，负载超过 255 时使用大帧模式
+
+static void stream_grow(uint32_t len)
+{
+    if (stream_len + len > stream_cap) {
+        stream_cap = (stream_len + len) * 2U;
+        stream     = realloc(stream, stream_cap);
+        if (stream == NULL) {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+    }
+}
+
+#if TF_TX_ZERO_COPY
+// 与固件相同的零拷贝发送路径：帧直接在流缓冲区中组装
+uint8_t* TF_ReserveImpl(TinyFrame* tf, uint32_t len)
+{
+    (void)tf;
+    stream_grow(len);
+    return stream + stream_len;
+}
+
+void TF_CommitImpl(TinyFrame* tf, uint32_t len)
+{
+    (void)tf;
+    stream_len += len;
+}
+#else
+void TF_WriteImpl(TinyFrame* tf, const uint8_t* buff, uint32_t len)
+{
+    (void)tf;
+    stream_grow(len);
+    memcpy(stream + stream_len, buff, len);
+    stream_len += len;
+}
+#endif
+
+static TF_Result count_listener(TinyFrame* tf, TF_Msg* msg)
+{
+    (void)tf;
+    (void)msg;
+    rx_frames++;
+    return TF_STAY;
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+typedef enum {
+    MODE_CHAR,
+    MODE_IN_PLACE,
+} bench_mode_t;
+
+static const char* mode_name[] = {"TF_Accept", "TF_AcceptInPlace"};
+
+static void run(bench_mode_t mode, uint32_t rounds, uint32_t frames)
+{
+    static TinyFrame rx;
+    TF_InitStatic(&rx, TF_SLAVE);
+    TF_SetLenBytes(&rx, len_bytes);
+    TF_AddGenericListener(&rx, count_listener);
+    rx_frames = 0;
+
+    double t0 = now_s();
+    for (uint32_t r = 0; r < rounds; r++) {
+        switch (mode) {
+            case MODE_CHAR:
+                TF_Accept(&rx, stream, stream_len);
+                break;
+            case MODE_IN_PLACE:
+                (void)TF_AcceptInPlace(&rx, stream, stream_len);
+                break;
+        }
+    }
+    double dt = now_s() - t0;
+
+    double bytes = (double)stream_len * rounds;
+    printf("%-18s %10.1f MB/s  %10.0f frames/s  (%u/%u frames)\n",
+           mode_name[mode],
+           bytes / dt / 1e6,
+           (double)rx_frames / dt,
+           rx_frames,
+           frames * rounds);
+}
+
+// 与目标板的 DMA 接收缓冲区相同的环形缓冲区，尾部为回绕镜像区
+#define RING_SIZE  256U
+#define RING_GUARD 128U
+
+static uint8_t  ring[RING_SIZE + RING_GUARD];
+static uint32_t ring_rd = 0;  // 累计读写字节数
+static uint32_t ring_wr = 0;
+
+static void ring_write(const uint8_t* data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        ring[ring_wr % RING_SIZE] = data[i];
+        ring_wr++;
+    }
+}
+
+/**
+ * @brief 与 tf_uart_port.c 的 rx_process_in_place() 相同：解析到缓冲区末尾，
+ *        剩下不完整帧时把回绕部分拷到镜像区再试一次
+ */
+static void ring_poll(TinyFrame* rx)
+{
+    for (;;) {
+        uint32_t pos   = ring_rd % RING_SIZE;
+        uint32_t avail = ring_wr - ring_rd;
+        uint32_t n     = (avail < RING_SIZE - pos) ? avail : RING_SIZE - pos;
+        if (n == 0) {
+            return;
+        }
+        uint32_t used = TF_AcceptInPlace(rx, &ring[pos], n);
+        if (used == 0 && avail > n) {
+            memcpy(&ring[RING_SIZE], ring, avail - n);
+            used = TF_AcceptInPlace(rx, &ring[pos], avail);
+        }
+        if (used == 0) {
+            return;
+        }
+        ring_rd += used;
+    }
+}
+
+/**
+ * @brief 跨越缓冲区末尾的截断帧必须超时丢弃
+ * @return true:截断帧被丢弃，其后的完整帧收到
+ */
+static bool check_wrap_timeout(TinyFrame* tx)
+{
+    static TinyFrame rx;
+    TF_InitStatic(&rx, TF_SLAVE);
+    TF_SetLenBytes(&rx, len_bytes);
+    TF_AddGenericListener(&rx, count_listener);
+    rx_frames = 0;
+
+    uint8_t payload[40];
+    for (uint32_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = (uint8_t)(0x80U + i);  // 不含 SOF，丢弃后不会误认出帧头
+    }
+    stream_len = 0;
+    TF_SendSimple(tx, 0x10, payload, sizeof(payload));
+    uint32_t frame_len = stream_len;
+
+    // 填充字节把截断帧的起点推到缓冲区末尾前 10 字节处
+    uint8_t fill[RING_SIZE - 10U];
+    memset(fill, 0xAA, sizeof(fill));
+    ring_write(fill, sizeof(fill));
+    ring_poll(&rx);
+    ring_write(stream, frame_len - 5U);  // 少了最后 5 字节
+    ring_poll(&rx);
+
+    // 截断帧不再增长：每个 tick 都重新解析（tf_uart_port 的 rx_partial）
+    for (uint32_t t = 0; t < TF_PARSER_TIMEOUT_TICKS + 2U; t++) {
+        TF_Tick(&rx);
+        ring_poll(&rx);
+    }
+
+    ring_write(stream, frame_len);
+    ring_poll(&rx);
+    return rx_frames == 1U && ring_rd == ring_wr;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t frames      = (argc > 1) ? (uint32_t)atoi(argv[1]) : 4000U;
+    uint32_t max_payload = (argc > 2) ? (uint32_t)atoi(argv[2]) : 64U;
+    uint32_t max_len     = (1UL << (8 * TF_LEN_BYTES)) - 1U;
+
+    if (max_payload > max_len) {
+        max_payload = max_len;
+    }
+    if (max_payload > 255U) {
+        len_bytes = TF_LEN_BYTES;
+    }
+    if (max_payload > TF_MAX_PAYLOAD_RX) {
+        max_payload = TF_MAX_PAYLOAD_RX;
+    }
+
+    // 生成帧流：[cmd][payload...]，长度在 1..max_payload 之间循环
+    static TinyFrame tx;
+    TF_InitStatic(&tx, TF_MASTER);
+    TF_SetLenBytes(&tx, len_bytes);
+    uint8_t* payload = malloc(max_payload + 1U);
+    for (uint32_t i = 0; i <= max_payload; i++) {
+        payload[i] = (uint8_t)(i * 7U + 3U);
+    }
+    for (uint32_t i = 0; i < frames; i++) {
+        TF_LEN len = (TF_LEN)(1U + (i * 13U) % max_payload);
+        TF_SendSimple(&tx, 0x10, payload, len);
+    }
+    free(payload);
+
+    uint32_t rounds = (uint32_t)(200000000ULL / stream_len) + 1U;
+
+    printf("stream: %u frames, %u bytes, payload 1..%u (%u-byte len), %u rounds\n",
+           frames,
+           stream_len,
+           max_payload,
+           (unsigned)len_bytes,
+           rounds);
+    run(MODE_CHAR, rounds, frames);
+    run(MODE_IN_PLACE, rounds, frames);
+
+    // 校验开销：上面原地解析部分的 CRC 统计
+    tf_crc32_stats_t crc;
+    tf_crc32_reset_stats();
+    run(MODE_IN_PLACE, 1U, frames);
+    tf_crc32_get_stats(&crc);
+    printf("crc32 (sw): %u blocks, %u bytes, %.1f ns/frame, %.1f MB/s\n",
+           crc.blocks,
+           crc.bytes,
+           (double)crc.cycles * 2.0 / (double)crc.blocks,
+           (double)crc.bytes * 1e3 / (double)crc.cycles);
+
+    bool wrap_ok = check_wrap_timeout(&tx);
+    printf("truncated frame at the wrap: %s\n", wrap_ok ? "timed out" : "FAILED");
+
+    free(stream);
+    return wrap_ok ? 0 : 1;
+}
@@ -0,0 +1,357 @@
+/**
+ * @file km1_cap.cpp
+ * @brief 抓包工具：导出设备抓包缓冲区、查看抓包文件、在仿真设备上回放（主机端）
+ *
+ * 用法:
+ *   km1_cap dump <tty> <out.cap> [baud]   停止设备抓包（DEBUG_CMD_CAPTURE）并导出到文件
+ *   km1_cap start <tty> [baud]            清空设备抓包缓冲区并重新开始记录
+ *   km1_cap print <file.cap>              逐条打印记录
+ *   km1_cap replay <file.cap> [speed] [baud] [window]
+ *       把抓包中主机发出的帧按记录的时间间隔（除以 speed，0 为不等待）发给仿真设备，
+ *       链路按 baud 模拟传输时间（0 为不模拟）；最多 window 个请求在途（默认 16）。
+ *       每个请求的结果与抓包中设备对同一帧 ID 的第一帧应答（应答帧即成功，ACK 取其状态）比较，
+ *       统计结果以 JSON 输出到 stdout，不一致的请求打印到 stderr。
+ *
+ * 抓包文件由 dump 或 km1::TapTransport 生成，格式见 km1_capture.hpp。
+ */
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "km1_capture.hpp"
+#include "km1_client.hpp"
+#include "km1_loopback.hpp"
+
+using namespace km1;
+using namespace km1::proto;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// protocol.h proto_debug_stats_t / proto_debug_capture_op_t
+constexpr uint8_t kStatsCapture = 0x05;
+constexpr uint8_t kCaptureStop  = 0x00;
+constexpr uint8_t kCaptureStart = 0x01;
+constexpr uint8_t kCaptureRead  = 0x02;
+
+constexpr int kNoExpectation = -100;  // 抓包中没有对应的应答
+
+// STATE [STATE_CMD_DEBUG][debug_capture_resp][data...]
+bool decode_capture_reply(const Reply& r, debug_capture_resp_t& resp, size_t& data_off)
+{
+    data_off = 1 + debug_capture_resp_t::kSize;
+    return r.ok() && r.type == PROTO_TYPE_STATE && r.data.size() >= data_off
+        && r.data[0] == STATE_CMD_DEBUG && r.data[1] == kStatsCapture
+        && debug_capture_resp_t::decode(r.data.data() + 1, debug_capture_resp_t::kSize, resp);
+}
+
+bool open_serial(SerialTransport& serial, const char* path, int argc, char** argv, int baud_arg)
+{
+    uint32_t baud = (argc > baud_arg) ? static_cast<uint32_t>(std::atoi(argv[baud_arg])) : 115200;
+    if (!serial.open(path, baud)) {
+        std::fprintf(stderr, "%s\n", serial.error().c_str());
+        return false;
+    }
+    return true;
+}
+
+int cmd_start(int argc, char** argv)
+{
+    SerialTransport serial;
+    if (!open_serial(serial, argv[2], argc, argv, 3)) {
+        return 1;
+    }
+    Client client(serial);
+    Reply  r = client.request(PROTO_TYPE_DEBUG, DEBUG_CMD_CAPTURE, {kCaptureStart}).get();
+
+    debug_capture_resp_t resp;
+    size_t               off;
+    if (!decode_capture_reply(r, resp, off)) {
+        std::fprintf(stderr, "DEBUG_CMD_CAPTURE failed (status %d)\n", r.status);
+        return 1;
+    }
+    std::fprintf(stderr, "capture started\n");
+    return 0;
+}
+
+int cmd_dump(int argc, char** argv)
+{
+    SerialTransport serial;
+    if (!open_serial(serial, argv[2], argc, argv, 4)) {
+        return 1;
+    }
+    Client client(serial);
+
+    debug_capture_resp_t resp;
+    size_t               off;
+    Reply r = client.request(PROTO_TYPE_DEBUG, DEBUG_CMD_CAPTURE, {kCaptureStop}).get();
+    if (!decode_capture_reply(r, resp, off)) {
+        std::fprintf(stderr, "DEBUG_CMD_CAPTURE failed (status %d)\n", r.status);
+        return 1;
+    }
+    const debug_capture_resp_t info = resp;
+
+    std::vector<uint8_t> bytes;
+    while (bytes.size() < info.size) {
+        debug_capture_req_t req;
+        req.op         = kCaptureRead;
+        req.offset     = static_cast<uint16_t>(bytes.size());
+        req.has_offset = true;
+        r = client.request(PROTO_TYPE_DEBUG, DEBUG_CMD_CAPTURE, req.encode()).get();
+        if (!decode_capture_reply(r, resp, off) || resp.offset != req.offset
+            || r.data.size() == off) {
+            std::fprintf(stderr, "read at %u failed (status %d)\n", req.offset, r.status);
+            return 1;
+        }
+        bytes.insert(bytes.end(), r.data.begin() + static_cast<std::ptrdiff_t>(off), r.data.end());
+    }
+
+    std::vector<CaptureRecord> records;
+    if (!parse_capture_records(bytes.data(), bytes.size(), records)) {
+        std::fprintf(stderr, "warning: incomplete record at the end\n");
+    }
+    CaptureWriter out;
+    if (!out.open(argv[3], CaptureUnit::kMillis) || !out.write_raw(bytes.data(), bytes.size())) {
+        std::fprintf(stderr, "cannot write %s\n", argv[3]);
+        return 1;
+    }
+    std::fprintf(stderr, "%zu records, %u bytes (%u overwritten, %u dropped)\n", records.size(),
+                 info.size, info.overwritten, info.dropped);
+    return 0;
+}
+
+int cmd_print(int argc, char** argv)
+{
+    (void)argc;
+    CaptureUnit                unit;
+    std::vector<CaptureRecord> records;
+    std::string                error;
+    if (!read_capture_file(argv[2], unit, records, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    if (!error.empty()) {
+        std::fprintf(stderr, "warning: %s\n", error.c_str());
+    }
+    for (const CaptureRecord& rec : records) {
+        std::printf("%12.3f ms %s id=%02X type=%02X len=%-4u%s", rec.time_us(unit) / 1000.0,
+                    rec.from_device() ? "<-" : "->", rec.id, rec.type, rec.len,
+                    rec.truncated() ? " [truncated]" : "");
+        for (size_t i = 0; i < rec.data.size() && i < 32; i++) {
+            std::printf(" %02X", rec.data[i]);
+        }
+        std::printf("%s\n", rec.data.size() > 32 ? " ..." : "");
+    }
+    return 0;
+}
+
+// ==================== 回放 ====================
+
+struct ReplayItem {
+    const CaptureRecord* rec;
+    int                  expected = kNoExpectation;
+};
+
+// 抓包中设备对该请求（同一帧 ID）的第一帧应答：应答帧为成功，ACK 取其状态
+int expected_status(const std::vector<CaptureRecord>& records, size_t index)
+{
+    uint8_t id = records[index].id;
+    for (size_t j = index + 1; j < records.size(); j++) {
+        const CaptureRecord& rec = records[j];
+        if (rec.id != id) {
+            continue;
+        }
+        if (!rec.from_device()) {
+            break;  // ID 已被下一个请求复用
+        }
+        if (rec.type == PROTO_TYPE_ACK && rec.data.size() == 3) {
+            return rec.data[2];
+        }
+        return PROTO_STATUS_OK;
+    }
+    return kNoExpectation;
+}
+
+int cmd_replay(int argc, char** argv)
+{
+    double   speed  = (argc > 3) ? std::atof(argv[3]) : 1.0;
+    uint32_t baud   = (argc > 4) ? static_cast<uint32_t>(std::atoi(argv[4])) : 0;
+    size_t   window = (argc > 5) ? static_cast<size_t>(std::atoi(argv[5])) : 16;
+
+    CaptureUnit                unit;
+    std::vector<CaptureRecord> records;
+    std::string                error;
+    if (!read_capture_file(argv[2], unit, records, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    if (!error.empty()) {
+        std::fprintf(stderr, "warning: %s\n", error.c_str());
+    }
+
+    // 主机发出的帧；截断的帧无法原样重发，空帧设备不应答
+    std::vector<ReplayItem> items;
+    uint32_t                skipped_truncated = 0;
+    uint32_t                skipped_empty     = 0;
+    for (size_t i = 0; i < records.size(); i++) {
+        const CaptureRecord& rec = records[i];
+        if (rec.from_device()) {
+            continue;
+        }
+        if (rec.truncated()) {
+            skipped_truncated++;
+        } else if (rec.data.empty()) {
+            skipped_empty++;
+        } else {
+            items.push_back({&rec, expected_status(records, i)});
+        }
+    }
+    if (items.empty()) {
+        std::fprintf(stderr, "no replayable host frames in %s\n", argv[2]);
+        return 1;
+    }
+
+    LoopbackTransport link(baud);
+    if (!link.start()) {
+        std::fprintf(stderr, "cannot start simulated device\n");
+        return 1;
+    }
+    Client::Options options;
+    options.max_in_flight = window;
+    options.timeout       = std::chrono::milliseconds(1000);
+    Client client(link, options);
+
+    std::mutex              mutex;
+    std::condition_variable done_cv;
+    size_t                  done = 0;
+    uint32_t                ok = 0, matched = 0, mismatched = 0, unchecked = 0;
+    std::map<int, uint32_t> failed;
+    std::vector<double>     latency_us;
+
+    const uint64_t t0_us = items.front().rec->time_us(unit);
+    const auto     start = Clock::now();
+    for (size_t i = 0; i < items.size(); i++) {
+        const ReplayItem&    item = items[i];
+        const CaptureRecord& rec  = *item.rec;
+        if (speed > 0) {
+            auto offset = std::chrono::microseconds(
+                static_cast<int64_t>(static_cast<double>(rec.time_us(unit) - t0_us) / speed));
+            std::this_thread::sleep_until(start + offset);
+        }
+
+        // 切换帧模式 / 波特率的请求前后不能有在途请求（它们按旧的设置组帧）
+        bool barrier = rec.type == PROTO_TYPE_SYS
+                    && (rec.data[0] == SYS_CMD_SET_FRAME_MODE || rec.data[0] == SYS_CMD_SET_BAUD);
+        if (barrier) {
+            client.drain();
+        }
+
+        auto sent = Clock::now();
+        client.request(rec.type, rec.data[0], rec.data.data() + 1, rec.data.size() - 1,
+                       [&, i, sent](Reply reply) {
+                           std::lock_guard<std::mutex> lock(mutex);
+                           auto elapsed = Clock::now() - sent;
+                           latency_us.push_back(
+                               std::chrono::duration<double, std::micro>(elapsed).count());
+                           if (reply.ok()) {
+                               ok++;
+                           } else {
+                               failed[reply.status]++;
+                           }
+                           int expected = items[i].expected;
+                           if (expected == kNoExpectation) {
+                               unchecked++;
+                           } else if (expected == reply.status) {
+                               matched++;
+                           } else {
+                               mismatched++;
+                               std::fprintf(stderr,
+                                            "#%zu type=%02X cmd=%02X: expected %d, got %d\n", i,
+                                            items[i].rec->type, items[i].rec->data[0], expected,
+                                            reply.status);
+                           }
+                           done++;
+                           done_cv.notify_all();
+                       });
+
+        if (barrier) {
+            client.drain();
+            // SYS_CMD_SET_BAUD：设备应答后切换，链路模型随之切换
+            sys_set_baud_req_t baud;
+            if (rec.data[0] == SYS_CMD_SET_BAUD
+                && sys_set_baud_req_t::decode(rec.data.data() + 1, rec.data.size() - 1, baud)
+                && baud.has_baud) {
+                link.set_baud(baud.baud);
+            }
+        }
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        done_cv.wait(lock, [&] { return done == items.size(); });
+    }
+    double replay_s   = std::chrono::duration<double>(Clock::now() - start).count();
+    double recorded_s = static_cast<double>(items.back().rec->time_us(unit) - t0_us) / 1e6;
+    client.close();
+
+    std::sort(latency_us.begin(), latency_us.end());
+    auto pct = [&](double p) {
+        size_t idx = static_cast<size_t>(p * static_cast<double>(latency_us.size() - 1) + 0.5);
+        return latency_us[std::min(idx, latency_us.size() - 1)];
+    };
+
+    std::printf("{\n  \"capture\": \"%s\",\n  \"records\": %zu,\n  \"replayed\": %zu,\n", argv[2],
+                records.size(), items.size());
+    std::printf("  \"skipped_truncated\": %u,\n  \"skipped_empty\": %u,\n", skipped_truncated,
+                skipped_empty);
+    std::printf("  \"speed\": %g,\n  \"baud\": %u,\n  \"window\": %zu,\n", speed, baud, window);
+    std::printf("  \"recorded_s\": %.3f,\n  \"replay_s\": %.3f,\n  \"cmds_per_s\": %.1f,\n",
+                recorded_s, replay_s, replay_s > 0 ? items.size() / replay_s : 0.0);
+    std::printf("  \"ok\": %u,\n  \"failed\": {", ok);
+    for (auto it = failed.begin(); it != failed.end(); ++it) {
+        std::printf("%s\"%d\": %u", (it == failed.begin()) ? "" : ", ", it->first, it->second);
+    }
+    std::printf("},\n  \"matched\": %u,\n  \"mismatched\": %u,\n  \"unchecked\": %u,\n", matched,
+                mismatched, unchecked);
+    std::printf("  \"latency_us\": {\"p50\": %.1f, \"p99\": %.1f, \"max\": %.1f}\n}\n", pct(0.50),
+                pct(0.99), latency_us.back());
+    return mismatched == 0 ? 0 : 2;
+}
+
+void usage(const char* prog)
+{
+    std::fprintf(stderr,
+                 "usage: %s dump <tty> <out.cap> [baud]\n"
+                 "       %s start <tty> [baud]\n"
+                 "       %s print <file.cap>\n"
+                 "       %s replay <file.cap> [speed] [baud] [window]\n",
+                 prog, prog, prog, prog);
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc >= 4 && std::strcmp(argv[1], "dump") == 0) {
+        return cmd_dump(argc, argv);
+    }
+    if (argc >= 3 && std::strcmp(argv[1], "start") == 0) {
+        return cmd_start(argc, argv);
+    }
+    if (argc >= 3 && std::strcmp(argv[1], "print") == 0) {
+        return cmd_print(argc, argv);
+    }
+    if (argc >= 3 && std::strcmp(argv[1], "replay") == 0) {
+        return cmd_replay(argc, argv);
+    }
+    usage(argv[0]);
+    return 1;
+}
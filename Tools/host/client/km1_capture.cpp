@@ -0,0 +1,198 @@
+#include "km1_capture.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "km1_proto.hpp"
+
+namespace km1 {
+
+namespace {
+
+constexpr char    kMagic[4] = {'K', 'M', '1', 'C'};
+constexpr uint8_t kVersion  = 1;
+
+}  // namespace
+
+bool parse_capture_records(const uint8_t* data, size_t len, std::vector<CaptureRecord>& out)
+{
+    size_t pos = 0;
+    while (len - pos >= kCaptureHeadSize) {
+        const uint8_t* p = data + pos;
+        CaptureRecord  rec;
+        rec.time  = static_cast<uint32_t>(p[0] | (p[1] << 8) | (p[2] << 16))
+                   | (static_cast<uint32_t>(p[3]) << 24);
+        rec.flags = p[4];
+        rec.id    = p[5];
+        rec.type  = p[6];
+        rec.len   = static_cast<uint16_t>(p[7] | (p[8] << 8));
+
+        size_t stored = static_cast<size_t>(p[9] | (p[10] << 8));
+        if (len - pos - kCaptureHeadSize < stored) {
+            return false;
+        }
+        rec.data.assign(p + kCaptureHeadSize, p + kCaptureHeadSize + stored);
+        out.push_back(std::move(rec));
+        pos += kCaptureHeadSize + stored;
+    }
+    return pos == len;
+}
+
+void encode_capture_record(const CaptureRecord& rec, std::vector<uint8_t>& out)
+{
+    uint16_t stored = static_cast<uint16_t>(rec.data.size());
+    uint8_t  head[kCaptureHeadSize] = {
+        static_cast<uint8_t>(rec.time),
+        static_cast<uint8_t>(rec.time >> 8),
+        static_cast<uint8_t>(rec.time >> 16),
+        static_cast<uint8_t>(rec.time >> 24),
+        rec.flags,
+        rec.id,
+        rec.type,
+        static_cast<uint8_t>(rec.len),
+        static_cast<uint8_t>(rec.len >> 8),
+        static_cast<uint8_t>(stored),
+        static_cast<uint8_t>(stored >> 8),
+    };
+    out.insert(out.end(), head, head + sizeof(head));
+    out.insert(out.end(), rec.data.begin(), rec.data.end());
+}
+
+bool read_capture_file(const std::string&          path,
+                       CaptureUnit&                unit,
+                       std::vector<CaptureRecord>& records,
+                       std::string&                error)
+{
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (f == nullptr) {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::vector<uint8_t> buf;
+    uint8_t              chunk[4096];
+    size_t               n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), f)) > 0) {
+        buf.insert(buf.end(), chunk, chunk + n);
+    }
+    std::fclose(f);
+
+    if (buf.size() < 8 || std::memcmp(buf.data(), kMagic, sizeof(kMagic)) != 0
+        || buf[4] != kVersion || buf[5] > static_cast<uint8_t>(CaptureUnit::kMicros)) {
+        error = path + ": not a capture file";
+        return false;
+    }
+    unit = static_cast<CaptureUnit>(buf[5]);
+    if (!parse_capture_records(buf.data() + 8, buf.size() - 8, records)) {
+        error = path + ": truncated record at the end";  // 之前的记录仍然可用
+    }
+    return true;
+}
+
+// ==================== CaptureWriter ====================
+
+CaptureWriter::~CaptureWriter()
+{
+    close();
+}
+
+bool CaptureWriter::open(const std::string& path, CaptureUnit unit)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_ != nullptr) {
+        std::fclose(file_);
+    }
+    file_ = std::fopen(path.c_str(), "wb");
+    if (file_ == nullptr) {
+        return false;
+    }
+    uint8_t head[8] = {0};
+    std::memcpy(head, kMagic, sizeof(kMagic));
+    head[4] = kVersion;
+    head[5] = static_cast<uint8_t>(unit);
+    return std::fwrite(head, 1, sizeof(head), file_) == sizeof(head);
+}
+
+bool CaptureWriter::write(const CaptureRecord& rec)
+{
+    std::vector<uint8_t> buf;
+    encode_capture_record(rec, buf);
+    return write_raw(buf.data(), buf.size());
+}
+
+bool CaptureWriter::write_raw(const uint8_t* data, size_t len)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return file_ != nullptr && std::fwrite(data, 1, len, file_) == len;
+}
+
+void CaptureWriter::close()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_ != nullptr) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+// ==================== TapTransport ====================
+
+TapTransport::TapTransport(Transport& inner, CaptureWriter& out, size_t max_data)
+    : inner_(inner),
+      out_(out),
+      max_data_(max_data),
+      start_(std::chrono::steady_clock::now()),
+      to_device_([this](const Frame& frame) { record(frame, 0); }),
+      to_host_([this](const Frame& frame) {
+          record(frame, kCaptureTx);
+          // 帧模式应答之后两个方向都使用新模式
+          if (frame.type == proto::PROTO_TYPE_SYS && frame.data.size() >= 2
+              && frame.data[0] == proto::SYS_CMD_FRAME_MODE) {
+              bool large = frame.data[1] != 0;
+              to_host_.set_large(large);
+              std::lock_guard<std::mutex> lock(write_mutex_);
+              to_device_.set_large(large);
+          }
+      })
+{
+}
+
+void TapTransport::record(const Frame& frame, uint8_t flags)
+{
+    auto elapsed = std::chrono::steady_clock::now() - start_;
+
+    CaptureRecord rec;
+    rec.time = static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+    rec.flags = flags;
+    rec.id    = frame.id;
+    rec.type  = frame.type;
+    rec.len   = static_cast<uint16_t>(frame.data.size());
+
+    size_t stored = frame.data.size();
+    if (max_data_ != 0 && stored > max_data_) {
+        stored = max_data_;
+        rec.flags |= kCaptureTruncated;
+    }
+    rec.data.assign(frame.data.begin(), frame.data.begin() + static_cast<std::ptrdiff_t>(stored));
+    out_.write(rec);
+}
+
+bool TapTransport::write(const uint8_t* data, size_t len)
+{
+    {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        to_device_.feed(data, len);
+    }
+    return inner_.write(data, len);
+}
+
+long TapTransport::read(uint8_t* buf, size_t cap, std::chrono::milliseconds timeout)
+{
+    long n = inner_.read(buf, cap, timeout);
+    if (n > 0) {
+        to_host_.feed(buf, static_cast<size_t>(n));
+    }
+    return n;
+}
+
+}  // namespace km1
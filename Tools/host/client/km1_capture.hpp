@@ -0,0 +1,119 @@
+/**
+ * @file km1_capture.hpp
+ * @brief 抓包文件（主机端链路 tap、设备抓包缓冲区的导出）
+ *
+ * 文件格式（小端）：
+ *   [magic "KM1C"][version:u8 = 1][time_unit:u8][reserved:u16]，之后是记录，
+ *   记录格式与固件 tf_capture.h 相同：
+ *   [time:u32][flags:u8][id:u8][type:u8][len:u16][stored:u16][data * stored]
+ * time_unit：0 为毫秒（设备抓包，从上电开始计时），1 为微秒（TapTransport，从打开文件开始计时）。
+ * 方向以设备为准：flags 含 kCaptureTx 的是设备发出的帧，否则是主机发给设备的帧。
+ */
+#ifndef KM1_CAPTURE_HPP
+#define KM1_CAPTURE_HPP
+
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "km1_frame.hpp"
+#include "km1_transport.hpp"
+
+namespace km1 {
+
+constexpr uint8_t kCaptureTx        = 0x01;  // 设备发出的帧
+constexpr uint8_t kCaptureTruncated = 0x02;  // 只保存了数据的前 stored 字节
+constexpr size_t  kCaptureHeadSize  = 11;
+
+enum class CaptureUnit : uint8_t {
+    kMillis = 0,
+    kMicros = 1,
+};
+
+struct CaptureRecord {
+    uint32_t             time  = 0;
+    uint8_t              flags = 0;
+    uint8_t              id    = 0;
+    uint8_t              type  = 0;
+    uint16_t             len   = 0;  // 原始数据长度
+    std::vector<uint8_t> data;       // [cmd][payload...]，截断时短于 len
+
+    bool from_device() const { return (flags & kCaptureTx) != 0; }
+    bool truncated() const { return (flags & kCaptureTruncated) != 0; }
+
+    // 换算为微秒
+    uint64_t time_us(CaptureUnit unit) const
+    {
+        return unit == CaptureUnit::kMillis ? time * 1000ULL : time;
+    }
+};
+
+/**
+ * @brief 解析记录流（设备 DEBUG_CMD_CAPTURE 读出的数据或文件中文件头之后的部分）
+ * @return false: 末尾有不完整的记录（已解析的记录仍然追加到 out）
+ */
+bool parse_capture_records(const uint8_t* data, size_t len, std::vector<CaptureRecord>& out);
+
+void encode_capture_record(const CaptureRecord& rec, std::vector<uint8_t>& out);
+
+/**
+ * @brief 读取整个抓包文件
+ */
+bool read_capture_file(const std::string&          path,
+                       CaptureUnit&                unit,
+                       std::vector<CaptureRecord>& records,
+                       std::string&                error);
+
+/**
+ * @brief 写抓包文件（线程安全）
+ */
+class CaptureWriter {
+public:
+    CaptureWriter() = default;
+    ~CaptureWriter();
+
+    CaptureWriter(const CaptureWriter&)            = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    bool open(const std::string& path, CaptureUnit unit);
+    bool write(const CaptureRecord& rec);
+    bool write_raw(const uint8_t* data, size_t len);  // 已编码的记录（设备导出）
+    void close();
+
+private:
+    std::mutex mutex_;
+    FILE*      file_ = nullptr;
+};
+
+/**
+ * @brief 链路 tap：原样转发，同时把两个方向解析出的帧写入抓包文件（时间单位为微秒）
+ *
+ * 跟随 SYS_CMD_FRAME_MODE 应答切换帧模式，与 Client 相同。
+ * max_data 为每帧保存的数据字节数上限（0 为不截断）。
+ */
+class TapTransport : public Transport {
+public:
+    TapTransport(Transport& inner, CaptureWriter& out, size_t max_data = 0);
+
+    bool write(const uint8_t* data, size_t len) override;
+    long read(uint8_t* buf, size_t cap, std::chrono::milliseconds timeout) override;
+    bool set_baud(uint32_t baud) override { return inner_.set_baud(baud); }
+    void close() override { inner_.close(); }
+
+private:
+    void record(const Frame& frame, uint8_t flags);
+
+    Transport&                            inner_;
+    CaptureWriter&                        out_;
+    size_t                                max_data_;
+    std::chrono::steady_clock::time_point start_;
+    std::mutex                            write_mutex_;  // to_device_ 在写线程中使用
+    FrameParser                           to_device_;
+    FrameParser                           to_host_;
+};
+
+}  // namespace km1
+
+#endif  // KM1_CAPTURE_HPP
@@ -0,0 +1,534 @@
+#include "km1_client.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+namespace km1 {
+
+using namespace proto;
+
+namespace {
+
+// 角度按位放进 u32 数组（mode 1）
+uint32_t f32_bits(float v)
+{
+    uint32_t raw;
+    std::memcpy(&raw, &v, sizeof(raw));
+    return raw;
+}
+
+// STATE 应答 [state_cmd][payload...]
+bool is_state(const Reply& r, uint8_t state_cmd)
+{
+    return r.type == PROTO_TYPE_STATE && !r.data.empty() && r.data[0] == state_cmd;
+}
+
+// STATE 应答 [STATE_CMD_MOTION][MOTION_CMD_START][group_id:u32]
+bool decode_group_id(const Reply& r, uint32_t& group_id)
+{
+    motion_start_resp_t resp;
+    if (!is_state(r, STATE_CMD_MOTION)
+        || !motion_start_resp_t::decode(r.data.data() + 1, r.data.size() - 1, resp)) {
+        return false;
+    }
+    group_id = resp.group_id;
+    return true;
+}
+
+}  // namespace
+
+bool decode_telemetry(const uint8_t* data, size_t len, TelemetrySample& out)
+{
+    const uint8_t* p   = data;
+    const uint8_t* end = data + len;
+    auto           has = [&](size_t n) { return static_cast<size_t>(end - p) >= n; };
+
+    if (!has(8)) {
+        return false;
+    }
+    out = TelemetrySample{};
+    wire::get(p, out.seq);
+    wire::get(p, out.tick_ms);
+    wire::get(p, out.fields);
+    wire::get(p, out.servo_mask);
+
+    for (size_t i = 0; i < out.servo.size(); ++i) {
+        if ((out.servo_mask & (1u << i)) == 0) {
+            continue;
+        }
+        TelemetrySample::Servo& s = out.servo[i];
+        if ((out.fields & TELEM_PWM) != 0) {
+            if (!has(2)) {
+                return false;
+            }
+            wire::get(p, s.pwm);
+        }
+        if ((out.fields & TELEM_TARGET) != 0) {
+            if (!has(4)) {
+                return false;
+            }
+            wire::get(p, s.target_angle);
+        }
+        if ((out.fields & TELEM_REMAINING) != 0) {
+            if (!has(4)) {
+                return false;
+            }
+            wire::get(p, s.remaining_ms);
+        }
+    }
+    if ((out.fields & TELEM_MOVING) != 0) {
+        if (!has(1)) {
+            return false;
+        }
+        wire::get(p, out.moving_mask);
+    }
+    if ((out.fields & TELEM_CYCLE) != 0) {
+        if (!has(2)) {
+            return false;
+        }
+        wire::get(p, out.cycle_active_mask);
+        wire::get(p, out.cycle_running_mask);
+        for (size_t i = 0; i < out.cycle.size(); ++i) {
+            if ((out.cycle_active_mask & (1u << i)) == 0) {
+                continue;
+            }
+            if (!has(5)) {
+                return false;
+            }
+            wire::get(p, out.cycle[i].current_pose);
+            wire::get(p, out.cycle[i].loop_count);
+        }
+    }
+    return p == end;
+}
+
+std::vector<uint8_t> encode_cycle_create(const CycleSpec& spec)
+{
+    cycle_create_req_t req;
+    req.mode        = static_cast<uint8_t>(spec.angles ? 1 : 0);
+    req.servo_count = static_cast<uint8_t>(spec.ids.size());
+    req.pose_count  = static_cast<uint8_t>(spec.poses.size());
+    req.max_loops   = spec.max_loops;
+    req.durations_ms.assign(spec.durations_ms.begin(), spec.durations_ms.end());
+    req.servo_ids = spec.ids;
+    for (const std::vector<float>& pose : spec.poses) {
+        for (size_t i = 0; i < spec.ids.size(); ++i) {
+            float v = i < pose.size() ? pose[i] : 0.0f;
+            req.values.push_back(spec.angles ? f32_bits(v) : static_cast<uint32_t>(v));
+        }
+    }
+    return req.encode();
+}
+
+bool decode_cycle_list(const Reply& r, std::vector<cycle_status_t>& list)
+{
+    // [STATE_CMD_CYCLE][cycle_list_resp]
+    cycle_list_resp_t resp;
+    if (!is_state(r, STATE_CMD_CYCLE)
+        || !cycle_list_resp_t::decode(r.data.data() + 1, r.data.size() - 1, resp)
+        || resp.subcmd != CYCLE_CMD_LIST) {
+        return false;
+    }
+    list = std::move(resp.cycles);
+    return true;
+}
+
+// ==================== Client ====================
+
+Client::Client(Transport& transport, Options options)
+    : transport_(transport),
+      options_(options),
+      parser_([this](const Frame& frame) { on_frame_parsed(frame); })
+{
+    options_.max_in_flight = std::clamp<size_t>(options_.max_in_flight, 1, 64);
+    reader_                = std::thread(&Client::reader, this);
+}
+
+Client::~Client()
+{
+    close();
+}
+
+void Client::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+    }
+    transport_.close();
+    if (reader_.joinable()) {
+        reader_.join();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (!order_.empty()) {
+        Reply reply;
+        reply.status = kStatusClosed;
+        finish(order_.front(), std::move(reply));
+    }
+    window_cv_.notify_all();
+}
+
+std::future<Reply> Client::request(uint8_t type, uint8_t cmd, const uint8_t* payload, size_t len)
+{
+    auto promise = std::make_shared<std::promise<Reply>>();
+    auto future  = promise->get_future();
+    submit(type, cmd, payload, len, [promise](Reply&& reply) {
+        promise->set_value(std::move(reply));
+    });
+    return future;
+}
+
+void Client::request(uint8_t                    type,
+                     uint8_t                    cmd,
+                     const uint8_t*             payload,
+                     size_t                     len,
+                     std::function<void(Reply)> done)
+{
+    submit(type, cmd, payload, len, [done](Reply&& reply) { done(std::move(reply)); });
+}
+
+template <typename T>
+std::future<Result<T>> Client::typed(uint8_t                               type,
+                                     uint8_t                               cmd,
+                                     const std::vector<uint8_t>&           payload,
+                                     std::function<bool(const Reply&, T&)> decode)
+{
+    auto promise = std::make_shared<std::promise<Result<T>>>();
+    auto future  = promise->get_future();
+    submit(type, cmd, payload.data(), payload.size(), [promise, decode](Reply&& reply) {
+        Result<T> result;
+        result.status = reply.status;
+        if (reply.ok() && !decode(reply, result.value)) {
+            result.status = kStatusBadReply;
+        }
+        promise->set_value(std::move(result));
+    });
+    return future;
+}
+
+void Client::submit(uint8_t        type,
+                    uint8_t        cmd,
+                    const uint8_t* payload,
+                    size_t         len,
+                    Complete       complete)
+{
+    std::vector<uint8_t> data(1 + len);
+    data[0] = cmd;
+    if (len > 0) {
+        std::memcpy(&data[1], payload, len);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    window_cv_.wait(lock, [this] { return closed_ || order_.size() < options_.max_in_flight; });
+
+    Reply failed;
+    if (closed_) {
+        failed.status = kStatusClosed;
+        lock.unlock();
+        complete(std::move(failed));
+        return;
+    }
+
+    // 窗口不超过 64，128 个 ID 中总能找到空闲的
+    uint8_t slot = next_id_;
+    while (pending_[slot].used) {
+        slot = static_cast<uint8_t>((slot + 1) & 0x7F);
+    }
+    next_id_ = static_cast<uint8_t>((slot + 1) & 0x7F);
+
+    std::vector<uint8_t> frame;
+    uint8_t              id = static_cast<uint8_t>(kFrameIdPeerBit | slot);
+    if (data.size() > max_payload_
+        || !encode_frame(id, type, data.data(), data.size(), large_, frame)) {
+        failed.status = kStatusTooLong;
+        lock.unlock();
+        complete(std::move(failed));
+        return;
+    }
+
+    Pending& p = pending_[slot];
+    p.used     = true;
+    p.type     = type;
+    p.cmd      = cmd;
+    p.deadline = std::chrono::steady_clock::now() + options_.timeout;
+    p.complete = std::move(complete);
+    order_.push_back(slot);
+    stats_.requests++;
+
+    // 按 order_ 的顺序写出（丢失判断依赖这一点），写的时候不占用 mutex_
+    std::unique_lock<std::mutex> write_lock(write_mutex_);
+    lock.unlock();
+    bool written = transport_.write(frame.data(), frame.size());
+    write_lock.unlock();
+
+    if (!written) {
+        lock.lock();
+        if (pending_[slot].used) {
+            failed.status = kStatusClosed;
+            finish(slot, std::move(failed));
+        }
+    }
+}
+
+void Client::drain()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    window_cv_.wait(lock, [this] { return closed_ || order_.empty(); });
+}
+
+void Client::finish(uint8_t slot, Reply&& reply)
+{
+    auto it = std::find(order_.begin(), order_.end(), slot);
+    if (it != order_.end()) {
+        order_.erase(it);
+    }
+    Pending& p = pending_[slot];
+    p.used     = false;
+    switch (reply.status) {
+        case kStatusTimeout:
+            stats_.timeouts++;
+            break;
+        case kStatusNoAnswer:
+            stats_.no_answer++;
+            break;
+        case kStatusClosed:
+            break;
+        default:
+            stats_.answered++;
+            break;
+    }
+    Complete complete = std::move(p.complete);
+    p.complete        = nullptr;
+    complete(std::move(reply));
+    window_cv_.notify_all();
+}
+
+void Client::reader()
+{
+    uint8_t buf[4096];
+    for (;;) {
+        long n = transport_.read(buf, sizeof(buf), std::chrono::milliseconds(10));
+        if (n < 0) {
+            break;
+        }
+        if (n > 0) {
+            parser_.feed(buf, static_cast<size_t>(n));
+        }
+        expire();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    while (!order_.empty()) {
+        Reply reply;
+        reply.status = kStatusClosed;
+        finish(order_.front(), std::move(reply));
+    }
+    window_cv_.notify_all();
+}
+
+void Client::expire()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.frames = parser_.stats();
+
+    // 超时时间相同，最早发出的请求最先到期
+    auto now = std::chrono::steady_clock::now();
+    while (!order_.empty() && pending_[order_.front()].deadline <= now) {
+        Reply reply;
+        reply.status = kStatusTimeout;
+        finish(order_.front(), std::move(reply));
+    }
+}
+
+void Client::on_frame_parsed(const Frame& frame)
+{
+    if (!frame.is_answer()) {
+        std::function<void(const Frame&)>           frame_cb;
+        std::function<void(const TelemetrySample&)> telemetry_cb;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.unsolicited++;
+            frame_cb     = frame_cb_;
+            telemetry_cb = telemetry_cb_;
+        }
+        if (telemetry_cb && frame.type == PROTO_TYPE_STATE && !frame.data.empty()
+            && frame.data[0] == STATE_CMD_TELEMETRY) {
+            TelemetrySample sample;
+            if (decode_telemetry(frame.data.data() + 1, frame.data.size() - 1, sample)) {
+                telemetry_cb(sample);
+            }
+        }
+        if (frame_cb) {
+            frame_cb(frame);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint8_t  slot = frame.id & 0x7F;
+    Pending& p    = pending_[slot];
+    bool     ack  = frame.type == PROTO_TYPE_ACK;
+    if (!p.used || (ack && (frame.data.size() != 3 || frame.data[0] != p.type
+                            || frame.data[1] != p.cmd))) {
+        // 应答之后补发的 ACK（或已超时请求的应答）
+        stats_.late_acks += ack ? 1 : 0;
+        return;
+    }
+
+    // 设备按顺序处理请求：排在前面、还没有任何应答的请求不会再有应答了
+    while (!order_.empty() && order_.front() != slot) {
+        Reply lost;
+        lost.status = kStatusNoAnswer;
+        finish(order_.front(), std::move(lost));
+    }
+
+    Reply reply;
+    reply.type   = frame.type;
+    reply.data   = frame.data;
+    reply.status = ack ? frame.data[2] : static_cast<int>(PROTO_STATUS_OK);
+
+    // 帧模式应答之后的帧（两个方向）都使用新模式
+    if (!ack && frame.type == PROTO_TYPE_SYS && frame.data.size() >= 2
+        && frame.data[0] == SYS_CMD_FRAME_MODE) {
+        large_ = frame.data[1] != 0;
+        parser_.set_large(large_);
+        // 设备以较小的 COMM_MAX_PAYLOAD 构建时按它的上限发送；超出本端解析上限的部分不用
+        sys_frame_mode_resp_t resp;
+        max_payload_ = large_ ? kLargeMaxPayload : kSmallMaxPayload;
+        if (sys_frame_mode_resp_t::decode(frame.data.data() + 1, frame.data.size() - 1, resp)
+            && resp.max_payload < max_payload_) {
+            max_payload_ = resp.max_payload;
+        }
+    }
+    finish(slot, std::move(reply));
+}
+
+Client::Stats Client::stats()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void Client::on_frame(std::function<void(const Frame&)> callback)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    frame_cb_ = std::move(callback);
+}
+
+void Client::on_telemetry(std::function<void(const TelemetrySample&)> callback)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    telemetry_cb_ = std::move(callback);
+}
+
+// ==================== 命令 ====================
+
+std::future<Reply> Client::ping(const std::vector<uint8_t>& payload)
+{
+    return request(PROTO_TYPE_SYS, SYS_CMD_PING, payload);
+}
+
+std::future<Result<uint32_t>> Client::move_group(const std::vector<uint8_t>& ids,
+                                                 const std::vector<float>&   angles_deg,
+                                                 uint32_t                    duration_ms)
+{
+    motion_start_req_t req;
+    req.mode        = 1;
+    req.count       = static_cast<uint8_t>(ids.size());
+    req.duration_ms = duration_ms;
+    req.servo_ids   = ids;
+    for (float a : angles_deg) {
+        req.values.push_back(f32_bits(a));
+    }
+    return typed<uint32_t>(PROTO_TYPE_MOTION, MOTION_CMD_START, req.encode(), decode_group_id);
+}
+
+std::future<Result<uint32_t>> Client::move_group_pwm(const std::vector<uint8_t>&  ids,
+                                                     const std::vector<uint32_t>& pwm_us,
+                                                     uint32_t                     duration_ms)
+{
+    motion_start_req_t req;
+    req.mode        = 0;
+    req.count       = static_cast<uint8_t>(ids.size());
+    req.duration_ms = duration_ms;
+    req.servo_ids   = ids;
+    req.values      = pwm_us;
+    return typed<uint32_t>(PROTO_TYPE_MOTION, MOTION_CMD_START, req.encode(), decode_group_id);
+}
+
+std::future<Result<std::vector<cycle_status_t>>> Client::create_cycle(const CycleSpec& spec)
+{
+    using List = std::vector<cycle_status_t>;
+    return typed<List>(PROTO_TYPE_CYCLE, CYCLE_CMD_CREATE, encode_cycle_create(spec),
+                       decode_cycle_list);
+}
+
+std::future<Result<telem_subscription_resp_t>> Client::subscribe_telemetry(uint8_t  fields,
+                                                                           uint8_t  servo_mask,
+                                                                           uint16_t rate_hz)
+{
+    telem_subscribe_req_t req;
+    req.fields     = fields;
+    req.servo_mask = servo_mask;
+    req.rate_hz    = rate_hz;
+    std::vector<uint8_t> payload(telem_subscribe_req_t::kSize);
+    req.encode(payload.data());
+    using Sub = telem_subscription_resp_t;
+    return typed<Sub>(PROTO_TYPE_TELEM, TELEM_CMD_SUBSCRIBE, payload, [](const Reply& r, Sub& sub) {
+        return r.type == PROTO_TYPE_TELEM && !r.data.empty() && r.data[0] == TELEM_CMD_SUBSCRIPTION
+            && Sub::decode(r.data.data() + 1, r.data.size() - 1, sub);
+    });
+}
+
+bool Client::set_frame_mode(bool large)
+{
+    drain();
+    // 应答 [SYS_CMD_FRAME_MODE][sys_frame_mode_resp]，接收线程收到后已切换
+    sys_frame_mode_resp_t resp;
+    Reply r = request(PROTO_TYPE_SYS, SYS_CMD_SET_FRAME_MODE, {static_cast<uint8_t>(large)}).get();
+    return r.ok() && r.type == PROTO_TYPE_SYS && !r.data.empty() && r.data[0] == SYS_CMD_FRAME_MODE
+        && sys_frame_mode_resp_t::decode(r.data.data() + 1, r.data.size() - 1, resp)
+        && (resp.mode != 0) == large;
+}
+
+size_t Client::max_payload()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return max_payload_;
+}
+
+bool Client::set_baud(uint32_t baud, uint16_t timeout_ms)
+{
+    drain();
+    sys_set_baud_req_t req;
+    req.baud           = baud;
+    req.has_baud       = true;
+    req.timeout_ms     = timeout_ms;
+    req.has_timeout_ms = true;
+
+    // 应答 [SYS_CMD_BAUD][sys_baud_resp]，以旧波特率发出，设备发完后切换
+    sys_baud_resp_t resp;
+    Reply           r = request(PROTO_TYPE_SYS, SYS_CMD_SET_BAUD, req.encode()).get();
+    if (!r.ok() || r.type != PROTO_TYPE_SYS || r.data.empty() || r.data[0] != SYS_CMD_BAUD
+        || !sys_baud_resp_t::decode(r.data.data() + 1, r.data.size() - 1, resp)
+        || resp.status != 0) {
+        return false;
+    }
+    if (!transport_.set_baud(baud)) {
+        return false;  // 设备等不到确认，超时后自己恢复原波特率
+    }
+
+    // 新波特率下的任意 SYS 帧确认切换；切换瞬间发出的帧可能被设备丢弃，多试几次
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (ping().get().ok()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace km1
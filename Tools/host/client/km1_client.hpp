@@ -0,0 +1,275 @@
+/**
+ * @file km1_client.hpp
+ * @brief 主机端异步客户端（C++17）
+ *
+ * - 每个请求立即发出并返回 std::future，最多 max_in_flight 个请求同时在途（流水线）；
+ *   窗口满时 request() 等到有请求完成
+ * - 请求用帧 ID 匹配应答（protocol_spec.md "Requests and Replies"）：设备对每个请求
+ *   先回应答帧或 ACK，future 在收到第一帧时完成；设备按顺序处理请求，
+ *   所以收到较晚请求的应答时，更早而仍未收到任何应答的请求已经丢失（kNoAnswer），不必等超时
+ * - 应答之后的 ACK（处理函数在应答之后失败，实际上几乎不会发生）只计入 Stats::late_acks
+ * - 设备主动发送的帧（遥测、状态推送）交给 on_frame() / on_telemetry() 注册的回调，
+ *   回调在接收线程中执行，不能在其中等待 future
+ */
+#ifndef KM1_CLIENT_HPP
+#define KM1_CLIENT_HPP
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "km1_frame.hpp"
+#include "km1_proto.hpp"
+#include "km1_transport.hpp"
+
+namespace km1 {
+
+// TELEM_CMD_SUBSCRIBE 字段（protocol.h proto_telem_field_t）
+enum : uint8_t {
+    TELEM_PWM       = 0x01,
+    TELEM_TARGET    = 0x02,
+    TELEM_REMAINING = 0x04,
+    TELEM_MOVING    = 0x08,
+    TELEM_CYCLE     = 0x10,
+};
+
+/**
+ * @brief 请求结果：设备状态码（proto::PROTO_STATUS_*），或客户端的负值错误
+ */
+enum : int {
+    kStatusTimeout  = -1,  // 超时未收到任何应答
+    kStatusNoAnswer = -2,  // 较晚的请求已收到应答，这个请求没有（请求帧损坏、被丢弃）
+    kStatusClosed   = -3,  // 链路关闭
+    kStatusBadReply = -4,  // 应答帧格式不对
+    kStatusTooLong  = -5,  // 请求超出当前帧模式的负载上限
+};
+
+struct Reply {
+    int                  status = kStatusClosed;
+    uint8_t              type   = 0;  // 应答帧类型（ACK 时为 PROTO_TYPE_ACK）
+    std::vector<uint8_t> data;        // 应答帧的 [cmd][payload...]
+
+    bool ok() const { return status == proto::PROTO_STATUS_OK; }
+};
+
+template <typename T>
+struct Result {
+    int status = kStatusClosed;
+    T   value{};
+
+    bool ok() const { return status == proto::PROTO_STATUS_OK; }
+};
+
+/**
+ * @brief STATE_CMD_TELEMETRY 中的一个采样（只有 fields / servo_mask 选中的部分有效）
+ */
+struct TelemetrySample {
+    struct Servo {
+        uint16_t pwm          = 0;
+        float    target_angle = 0.0f;
+        uint32_t remaining_ms = 0;
+    };
+    struct Cycle {
+        uint8_t  current_pose = 0;
+        uint32_t loop_count   = 0;
+    };
+
+    uint16_t             seq                = 0;
+    uint32_t             tick_ms            = 0;
+    uint8_t              fields             = 0;
+    uint8_t              servo_mask         = 0;
+    uint8_t              moving_mask        = 0;
+    uint8_t              cycle_active_mask  = 0;
+    uint8_t              cycle_running_mask = 0;
+    std::array<Servo, 8> servo{};
+    std::array<Cycle, 8> cycle{};
+};
+
+/**
+ * @brief 解析遥测帧负载（[STATE_CMD_TELEMETRY] 之后的部分）
+ */
+bool decode_telemetry(const uint8_t* data, size_t len, TelemetrySample& out);
+
+/**
+ * @brief CYCLE_CMD_CREATE 的参数：poses[i] 为第 i 个姿态下 ids 中各舵机的值
+ */
+struct CycleSpec {
+    bool                            angles    = true;  // true: 角度（度），false: PWM（us）
+    uint32_t                        max_loops = 0;     // 0: 无限循环
+    std::vector<uint8_t>            ids;
+    std::vector<uint32_t>           durations_ms;  // 每个姿态一项
+    std::vector<std::vector<float>> poses;         // PWM 模式下按整数取值
+};
+
+/**
+ * @brief CYCLE_CMD_CREATE 的负载
+ */
+std::vector<uint8_t> encode_cycle_create(const CycleSpec& spec);
+
+/**
+ * @brief 解析 CYCLE_CMD_LIST 应答（CYCLE_CMD_CREATE 成功时也回它）
+ */
+bool decode_cycle_list(const Reply& r, std::vector<proto::cycle_status_t>& list);
+
+class Client {
+public:
+    struct Options {
+        size_t                    max_in_flight = 8;  // 1..64
+        std::chrono::milliseconds timeout{500};       // 单个请求等待应答的时间
+    };
+
+    struct Stats {
+        uint64_t           requests    = 0;
+        uint64_t           answered    = 0;
+        uint64_t           timeouts    = 0;
+        uint64_t           no_answer   = 0;
+        uint64_t           late_acks   = 0;
+        uint64_t           unsolicited = 0;  // 设备主动发送的帧
+        FrameParser::Stats frames;
+    };
+
+    explicit Client(Transport& transport) : Client(transport, Options{}) {}
+    Client(Transport& transport, Options options);
+    ~Client();
+
+    Client(const Client&)            = delete;
+    Client& operator=(const Client&) = delete;
+
+    // ==================== 通用请求 ====================
+
+    /**
+     * @brief 发出 [cmd][payload] 请求，窗口满时先等待
+     */
+    std::future<Reply> request(uint8_t type, uint8_t cmd, const uint8_t* payload, size_t len);
+
+    std::future<Reply> request(uint8_t type, uint8_t cmd, const std::vector<uint8_t>& payload = {})
+    {
+        return request(type, cmd, payload.data(), payload.size());
+    }
+
+    /**
+     * @brief 与 request() 相同，但完成时调用 done：通常在接收线程中（不能在其中等待 future），
+     *        请求没能发出时在调用线程中
+     */
+    void request(uint8_t                    type,
+                 uint8_t                    cmd,
+                 const uint8_t*             payload,
+                 size_t                     len,
+                 std::function<void(Reply)> done);
+
+    /**
+     * @brief 等待所有在途请求完成
+     */
+    void drain();
+
+    // ==================== 命令 ====================
+
+    std::future<Reply> ping(const std::vector<uint8_t>& payload = {});
+
+    /**
+     * @brief MOTION_CMD_START：ids 中的舵机同时开始、同时到达
+     * @return 同步组 ID
+     */
+    std::future<Result<uint32_t>> move_group(const std::vector<uint8_t>& ids,
+                                             const std::vector<float>&   angles_deg,
+                                             uint32_t                    duration_ms);
+
+    std::future<Result<uint32_t>> move_group_pwm(const std::vector<uint8_t>&  ids,
+                                                 const std::vector<uint32_t>& pwm_us,
+                                                 uint32_t                     duration_ms);
+
+    /**
+     * @brief CYCLE_CMD_CREATE
+     * @return 创建后设备上的全部 cycle（CYCLE_CMD_LIST 应答）
+     */
+    std::future<Result<std::vector<proto::cycle_status_t>>> create_cycle(const CycleSpec& spec);
+
+    /**
+     * @brief TELEM_CMD_SUBSCRIBE（rate_hz 或 fields 为 0 时取消订阅）
+     */
+    std::future<Result<proto::telem_subscription_resp_t>> subscribe_telemetry(uint8_t  fields,
+                                                                              uint8_t  servo_mask,
+                                                                              uint16_t rate_hz);
+
+    /**
+     * @brief SYS_CMD_SET_FRAME_MODE：等在途请求完成后切换，两端从应答之后的帧开始使用新模式
+     */
+    bool set_frame_mode(bool large);
+
+    /**
+     * @brief 当前帧模式下一帧的最大负载（含 cmd 字节）；大帧模式为设备在 FRAME_MODE 应答中报告的值
+     */
+    size_t max_payload();
+
+    /**
+     * @brief SYS_CMD_SET_BAUD：设备接受后切换本端波特率，并用 PING 确认
+     */
+    bool set_baud(uint32_t baud, uint16_t timeout_ms = 1000);
+
+    // ==================== 设备主动发送的帧 ====================
+
+    void on_frame(std::function<void(const Frame&)> callback);
+    void on_telemetry(std::function<void(const TelemetrySample&)> callback);
+
+    Stats stats();
+
+    /**
+     * @brief 停止接收线程，未完成的请求以 kStatusClosed 结束
+     */
+    void close();
+
+private:
+    using Complete = std::function<void(Reply&&)>;
+
+    struct Pending {
+        bool                                  used = false;
+        uint8_t                               type = 0;
+        uint8_t                               cmd  = 0;
+        std::chrono::steady_clock::time_point deadline;
+        Complete                              complete;
+    };
+
+    template <typename T>
+    std::future<Result<T>> typed(uint8_t                               type,
+                                 uint8_t                               cmd,
+                                 const std::vector<uint8_t>&           payload,
+                                 std::function<bool(const Reply&, T&)> decode);
+
+    void submit(uint8_t type, uint8_t cmd, const uint8_t* payload, size_t len, Complete complete);
+
+    void reader();
+    void on_frame_parsed(const Frame& frame);
+    void finish(uint8_t slot, Reply&& reply);  // 调用时持有 mutex_
+    void expire();
+
+    Transport& transport_;
+    Options    options_;
+
+    std::mutex               mutex_;
+    std::condition_variable  window_cv_;
+    std::array<Pending, 128> pending_{};  // 按帧 ID 的低 7 位索引
+    std::deque<uint8_t>      order_;      // 在途请求（pending_ 下标），按发送顺序
+    uint8_t                  next_id_     = 0;
+    bool                     large_       = false;
+    size_t                   max_payload_ = kSmallMaxPayload;  // 由 FRAME_MODE 应答更新
+    bool                     closed_      = false;
+    Stats                    stats_;
+
+    std::mutex write_mutex_;
+
+    std::function<void(const Frame&)>           frame_cb_;
+    std::function<void(const TelemetrySample&)> telemetry_cb_;
+
+    FrameParser parser_;
+    std::thread reader_;
+};
+
+}  // namespace km1
+
+#endif  // KM1_CLIENT_HPP
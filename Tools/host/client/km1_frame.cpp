@@ -0,0 +1,129 @@
+#include "km1_frame.hpp"
+
+#include <array>
+
+namespace km1 {
+
+namespace {
+
+std::array<uint32_t, 256> make_crc_table()
+{
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i << 24;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x80000000u) ? (crc << 1) ^ 0x04C11DB7u : (crc << 1);
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+const std::array<uint32_t, 256> kCrcTable = make_crc_table();
+
+void put_be32(std::vector<uint8_t>& out, uint32_t v)
+{
+    out.push_back(static_cast<uint8_t>(v >> 24));
+    out.push_back(static_cast<uint8_t>(v >> 16));
+    out.push_back(static_cast<uint8_t>(v >> 8));
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+uint32_t get_be32(const uint8_t* p)
+{
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16)
+         | (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+}  // namespace
+
+uint32_t crc32_mpeg2(const uint8_t* data, size_t len, uint32_t crc)
+{
+    for (size_t i = 0; i < len; ++i) {
+        crc = (crc << 8) ^ kCrcTable[((crc >> 24) ^ data[i]) & 0xFFu];
+    }
+    return crc;
+}
+
+bool encode_frame(uint8_t               id,
+                  uint8_t               type,
+                  const uint8_t*        data,
+                  size_t                len,
+                  bool                  large,
+                  std::vector<uint8_t>& out)
+{
+    if (len > (large ? kLargeMaxPayload : kSmallMaxPayload)) {
+        return false;
+    }
+    size_t head = out.size();
+    out.push_back(kFrameSof);
+    out.push_back(id);
+    if (large) {
+        out.push_back(static_cast<uint8_t>(len >> 8));
+    }
+    out.push_back(static_cast<uint8_t>(len));
+    out.push_back(type);
+    put_be32(out, crc32_mpeg2(&out[head], out.size() - head));
+    if (len > 0) {
+        out.insert(out.end(), data, data + len);
+        put_be32(out, crc32_mpeg2(data, len));
+    }
+    return true;
+}
+
+void FrameParser::feed(const uint8_t* data, size_t len)
+{
+    buf_.insert(buf_.end(), data, data + len);
+    parse();
+    // 已处理的部分一次性移走
+    buf_.erase(buf_.begin(), buf_.begin() + static_cast<std::ptrdiff_t>(pos_));
+    pos_ = 0;
+}
+
+void FrameParser::parse()
+{
+    while (pos_ < buf_.size()) {
+        if (buf_[pos_] != kFrameSof) {
+            ++pos_;
+            ++stats_.skipped;
+            continue;
+        }
+
+        const uint8_t* p     = &buf_[pos_];
+        size_t         avail = buf_.size() - pos_;
+        size_t         head  = head_len();
+        if (avail < head) {
+            return;
+        }
+        size_t len  = large_ ? (static_cast<size_t>(p[2]) << 8) | p[3] : p[2];
+        size_t type = head - kFrameCrcSize - 1;
+        if (get_be32(&p[type + 1]) != crc32_mpeg2(p, type + 1)
+            || len > (large_ ? kLargeMaxPayload : kSmallMaxPayload)) {
+            ++stats_.crc_errors;
+            ++stats_.skipped;
+            ++pos_;
+            continue;
+        }
+
+        size_t total = head + (len > 0 ? len + kFrameCrcSize : 0);
+        if (avail < total) {
+            return;
+        }
+        if (len > 0 && get_be32(&p[head + len]) != crc32_mpeg2(&p[head], len)) {
+            ++stats_.crc_errors;
+            ++stats_.skipped;
+            ++pos_;
+            continue;
+        }
+
+        Frame frame;
+        frame.id   = p[1];
+        frame.type = p[type];
+        frame.data.assign(p + head, p + head + len);
+        pos_ += total;
+        ++stats_.frames;
+        handler_(frame);  // 可能切换 large_，之后的字节按新模式解析
+    }
+}
+
+}  // namespace km1
@@ -0,0 +1,94 @@
+/**
+ * @file km1_frame.hpp
+ * @brief 主机端 TinyFrame 组帧 / 解析（与固件 TF_Config.h 的配置一致）
+ *
+ * [SOF:u8=0x01][id:u8][len:u8|u16][type:u8][head_crc:u32][data * len][data_crc:u32]
+ * 头部字段和 CRC 为大端；data_crc 在 len 为 0 时省略；CRC 为 CRC-32/MPEG-2。
+ * 主机是 TinyFrame 的 master：自己发起的帧 ID 最高位为 1，设备的应答沿用该 ID。
+ */
+#ifndef KM1_FRAME_HPP
+#define KM1_FRAME_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "km1_proto.hpp"
+
+namespace km1 {
+
+using proto::kLargeMaxPayload;
+using proto::kSmallMaxPayload;
+
+constexpr uint8_t  kFrameSof       = 0x01;
+constexpr uint8_t  kFrameIdPeerBit = 0x80;  // master（主机）发起的帧
+constexpr unsigned kFrameCrcSize   = 4;
+
+/**
+ * @brief CRC-32/MPEG-2（多项式 0x04C11DB7，初值 0xFFFFFFFF，不反射，无结果异或）
+ */
+uint32_t crc32_mpeg2(const uint8_t* data, size_t len, uint32_t crc = 0xFFFFFFFFu);
+
+struct Frame {
+    uint8_t              id   = 0;
+    uint8_t              type = 0;
+    std::vector<uint8_t> data;  // [cmd][payload...]（ACK 为 [type][cmd][status]）
+
+    bool is_answer() const { return (id & kFrameIdPeerBit) != 0; }  // 应答主机的请求
+};
+
+/**
+ * @brief 组帧，追加到 out
+ * @param large 2 字节 LEN（大帧模式）
+ * @return false: 负载超出当前模式的上限
+ */
+bool encode_frame(uint8_t               id,
+                  uint8_t               type,
+                  const uint8_t*        data,
+                  size_t                len,
+                  bool                  large,
+                  std::vector<uint8_t>& out);
+
+/**
+ * @brief 流式解析：字节可以任意分段喂入，头或数据 CRC 错误时跳过一个字节重新同步
+ */
+class FrameParser {
+public:
+    struct Stats {
+        uint64_t frames     = 0;
+        uint64_t crc_errors = 0;  // 头或数据 CRC 错误
+        uint64_t skipped    = 0;  // 为重新同步丢弃的字节数
+    };
+
+    using Handler = std::function<void(const Frame&)>;
+
+    explicit FrameParser(Handler handler) : handler_(std::move(handler)) {}
+
+    /**
+     * @brief 喂入字节；每解析出一帧调用一次 handler
+     * @note  handler 中调用 set_large() 对紧随其后的字节立即生效（帧模式切换）
+     */
+    void feed(const uint8_t* data, size_t len);
+
+    void set_large(bool large) { large_ = large; }
+    bool large() const { return large_; }
+
+    void reset() { buf_.clear(); }
+
+    const Stats& stats() const { return stats_; }
+
+private:
+    size_t head_len() const { return large_ ? 9u : 8u; }
+    void   parse();
+
+    Handler              handler_;
+    std::vector<uint8_t> buf_;
+    size_t               pos_   = 0;  // buf_ 中已处理的字节
+    bool                 large_ = false;
+    Stats                stats_;
+};
+
+}  // namespace km1
+
+#endif  // KM1_FRAME_HPP
@@ -0,0 +1,203 @@
+#include "km1_loopback.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+#include "sim_device.h"
+
+namespace km1 {
+
+namespace {
+
+std::atomic<bool> g_active{false};  // 同一时刻只有一个设备线程
+bool              g_inited = false;
+
+// sim_device_init() 只能调用一次，设备发出的字节交给当前运行的实例（只在设备线程中访问）
+LoopbackTransport* g_owner = nullptr;
+
+}  // namespace
+
+LoopbackTransport::~LoopbackTransport()
+{
+    close();
+}
+
+void LoopbackTransport::enqueue(std::deque<Chunk>& line,
+                                Clock::time_point& free_at,
+                                const uint8_t*     data,
+                                size_t             len)
+{
+    Chunk chunk;
+    chunk.ready = Clock::now();
+    chunk.bytes.assign(data, data + len);
+    if (baud_ != 0) {
+        // 8N1：每字节 10 位
+        auto wire   = std::chrono::nanoseconds(len * 10ULL * 1000000000ULL / baud_);
+        chunk.ready = std::max(chunk.ready, free_at) + wire;
+        free_at     = chunk.ready;
+    }
+    line.push_back(std::move(chunk));
+}
+
+void LoopbackTransport::on_device_tx(void* ctx, const uint8_t* data, uint32_t len)
+{
+    (void)ctx;
+    LoopbackTransport* self = g_owner;
+    if (self == nullptr) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(self->mutex_);
+        self->enqueue(self->to_host_, self->to_host_free_, data, len);
+        self->stats_.to_host_bytes += len;
+    }
+    self->to_host_cv_.notify_all();
+}
+
+bool LoopbackTransport::start()
+{
+    if (g_active.exchange(true)) {
+        return false;
+    }
+    if (!g_inited) {
+        if (sim_device_init(&LoopbackTransport::on_device_tx, nullptr) != 0) {
+            g_active = false;
+            return false;
+        }
+        g_inited = true;
+    }
+    g_owner  = this;
+    running_ = true;
+    device_  = std::thread(&LoopbackTransport::run, this);
+    return true;
+}
+
+void LoopbackTransport::run()
+{
+    constexpr auto kTick = std::chrono::milliseconds(1);
+    auto           next  = Clock::now() + kTick;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_) {
+        // 已经到达的字节由“DMA”写入接收缓冲区，放不下的部分留到缓冲区被消费后再写
+        auto now = Clock::now();
+        while (!to_device_.empty() && to_device_.front().ready <= now) {
+            Chunk&   chunk = to_device_.front();
+            uint32_t len   = static_cast<uint32_t>(chunk.bytes.size() - chunk.pos);
+            uint32_t n     = sim_device_rx(chunk.bytes.data() + chunk.pos, len);
+            chunk.pos += n;
+            if (n < len) {
+                break;
+            }
+            to_device_.pop_front();
+        }
+
+        // 固件代码在锁外运行，发送回调会重新加锁
+        lock.unlock();
+        sim_device_poll();
+        now = Clock::now();
+        if (now - next > std::chrono::milliseconds(100)) {
+            next = now;  // 主机线程被挂起太久时不追赶
+        }
+        while (now >= next) {
+            sim_device_tick_1ms();
+            next += kTick;
+        }
+        lock.lock();
+
+        if (!sim_device_rx_pending()) {
+            auto wake = next;
+            if (!to_device_.empty()) {
+                wake = std::min(wake, to_device_.front().ready);
+            }
+            to_device_cv_.wait_until(lock, wake);
+        }
+    }
+}
+
+bool LoopbackTransport::write(const uint8_t* data, size_t len)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return false;
+        }
+        enqueue(to_device_, to_device_free_, data, len);
+        stats_.to_device_bytes += len;
+    }
+    to_device_cv_.notify_one();
+    return true;
+}
+
+long LoopbackTransport::read(uint8_t* buf, size_t cap, std::chrono::milliseconds timeout)
+{
+    auto deadline = Clock::now() + timeout;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        if (!running_) {
+            return -1;
+        }
+        auto now = Clock::now();
+        if (!to_host_.empty() && to_host_.front().ready <= now) {
+            break;
+        }
+        if (now >= deadline) {
+            return 0;
+        }
+        auto wake = deadline;
+        if (!to_host_.empty()) {
+            wake = std::min(wake, to_host_.front().ready);
+        }
+        to_host_cv_.wait_until(lock, wake);
+    }
+
+    size_t n   = 0;
+    auto   now = Clock::now();
+    while (n < cap && !to_host_.empty() && to_host_.front().ready <= now) {
+        Chunk& chunk = to_host_.front();
+        size_t take  = std::min(cap - n, chunk.bytes.size() - chunk.pos);
+        std::copy_n(chunk.bytes.begin() + static_cast<std::ptrdiff_t>(chunk.pos), take, buf + n);
+        chunk.pos += take;
+        n += take;
+        if (chunk.pos == chunk.bytes.size()) {
+            to_host_.pop_front();
+        }
+    }
+    return static_cast<long>(n);
+}
+
+bool LoopbackTransport::set_baud(uint32_t baud)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (baud_ != 0) {
+        baud_ = baud;  // 设备已在旧速率下发完应答后切换，两端同时生效
+    }
+    return true;
+}
+
+LoopbackTransport::Stats LoopbackTransport::stats()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void LoopbackTransport::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    to_device_cv_.notify_all();
+    to_host_cv_.notify_all();
+    if (device_.joinable()) {
+        device_.join();
+    }
+    g_owner  = nullptr;
+    g_active = false;
+}
+
+}  // namespace km1
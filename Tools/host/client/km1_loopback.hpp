@@ -0,0 +1,84 @@
+/**
+ * @file km1_loopback.hpp
+ * @brief 进程内回环链路：把 Client 接到固件的主机构建（Tools/host/sim）上
+ *
+ * 设备在自己的线程中运行：循环执行主循环迭代（sim_device_poll），按墙上时钟每 1ms
+ * 执行一次定时中断（sim_device_tick_1ms），没有数据时休眠到下一个 tick。
+ * baud 为 0 时字节立即送达，测到的是主机 + 固件逻辑本身的开销；否则按 8N1（每字节 10 位）
+ * 模拟两个方向各自的线上传输时间：每次写入（主机的请求帧、设备的一帧）在前面的字节发完后
+ * 开始发送，全部发完时才交给对端，近似于 IDLE 中断按帧交付。
+ * 固件状态是全局的：同一时刻只能有一个 LoopbackTransport，设备状态在整个进程中保留。
+ */
+#ifndef KM1_LOOPBACK_HPP
+#define KM1_LOOPBACK_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "km1_transport.hpp"
+
+namespace km1 {
+
+class LoopbackTransport : public Transport {
+public:
+    struct Stats {
+        uint64_t to_device_bytes = 0;
+        uint64_t to_host_bytes   = 0;
+    };
+
+    explicit LoopbackTransport(uint32_t baud = 0) : baud_(baud) {}
+    ~LoopbackTransport() override;
+
+    LoopbackTransport(const LoopbackTransport&)            = delete;
+    LoopbackTransport& operator=(const LoopbackTransport&) = delete;
+
+    /**
+     * @brief 初始化固件（第一次）并启动设备线程
+     * @return false: 另一个 LoopbackTransport 正在运行或固件初始化失败
+     */
+    bool start();
+
+    bool write(const uint8_t* data, size_t len) override;
+    long read(uint8_t* buf, size_t cap, std::chrono::milliseconds timeout) override;
+    bool set_baud(uint32_t baud) override;  // 改变模拟的线上速率（构造时为 0 则不模拟）
+    void close() override;
+
+    Stats stats();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Chunk {
+        Clock::time_point    ready;  // 最后一个字节到达对端的时间
+        std::vector<uint8_t> bytes;
+        size_t               pos = 0;
+    };
+
+    static void on_device_tx(void* ctx, const uint8_t* data, uint32_t len);
+    void        run();
+
+    // 调用时持有 mutex_
+    void enqueue(std::deque<Chunk>& line,
+                 Clock::time_point& free_at,
+                 const uint8_t*     data,
+                 size_t             len);
+
+    std::thread             device_;
+    std::mutex              mutex_;
+    std::condition_variable to_device_cv_;
+    std::condition_variable to_host_cv_;
+    std::deque<Chunk>       to_device_;
+    std::deque<Chunk>       to_host_;
+    Clock::time_point       to_device_free_;  // 该方向线路空闲的时间
+    Clock::time_point       to_host_free_;
+    uint32_t                baud_;
+    bool                    running_ = false;
+    Stats                   stats_;
+};
+
+}  // namespace km1
+
+#endif  // KM1_LOOPBACK_HPP
@@ -0,0 +1,174 @@
+#include "km1_transport.hpp"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+namespace km1 {
+
+namespace {
+
+speed_t baud_constant(uint32_t baud)
+{
+    switch (baud) {
+        case 9600:
+            return B9600;
+        case 19200:
+            return B19200;
+        case 38400:
+            return B38400;
+        case 57600:
+            return B57600;
+        case 115200:
+            return B115200;
+        case 230400:
+            return B230400;
+#ifdef B460800
+        case 460800:
+            return B460800;
+#endif
+#ifdef B921600
+        case 921600:
+            return B921600;
+#endif
+#ifdef B1000000
+        case 1000000:
+            return B1000000;
+#endif
+#ifdef B1500000
+        case 1500000:
+            return B1500000;
+#endif
+#ifdef B2000000
+        case 2000000:
+            return B2000000;
+#endif
+        default:
+            return B0;
+    }
+}
+
+}  // namespace
+
+SerialTransport::~SerialTransport()
+{
+    release();
+}
+
+void SerialTransport::release()
+{
+    for (int fd : {fd_, wake_[0], wake_[1]}) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+    fd_      = -1;
+    wake_[0] = -1;
+    wake_[1] = -1;
+}
+
+bool SerialTransport::open(const std::string& path, uint32_t baud)
+{
+    release();
+    closed_ = false;
+    error_.clear();
+    fd_ = ::open(path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (fd_ < 0) {
+        error_ = path + ": " + std::strerror(errno);
+        return false;
+    }
+    if (!isatty(fd_)) {
+        error_ = path + ": not a terminal";
+    } else if (set_baud(baud) && pipe(wake_) == 0) {
+        return true;
+    }
+    release();
+    return false;
+}
+
+bool SerialTransport::set_baud(uint32_t baud)
+{
+    speed_t speed = baud_constant(baud);
+    termios tio{};
+    if (speed == B0 || tcgetattr(fd_, &tio) != 0) {
+        error_ = "unsupported baud rate " + std::to_string(baud);
+        return false;
+    }
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~(CSTOPB | PARENB);
+#ifdef CRTSCTS
+    tio.c_cflag &= ~CRTSCTS;
+#endif
+    tio.c_cc[VMIN]  = 0;
+    tio.c_cc[VTIME] = 0;
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+    // 伪终端不关心速率，照样接受这些设置
+    if (tcsetattr(fd_, TCSADRAIN, &tio) != 0) {
+        error_ = std::string("tcsetattr: ") + std::strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+bool SerialTransport::write(const uint8_t* data, size_t len)
+{
+    while (len > 0) {
+        if (fd_ < 0 || closed_) {
+            return false;
+        }
+        ssize_t n = ::write(fd_, data, len);
+        if (n > 0) {
+            data += n;
+            len -= static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno != EAGAIN && errno != EINTR) {
+            return false;
+        }
+        // 内核发送缓冲区满，等到可写
+        pollfd pfd{fd_, POLLOUT, 0};
+        (void)poll(&pfd, 1, 100);
+    }
+    return true;
+}
+
+long SerialTransport::read(uint8_t* buf, size_t cap, std::chrono::milliseconds timeout)
+{
+    if (fd_ < 0 || closed_) {
+        return -1;
+    }
+    pollfd pfd[2] = {{fd_, POLLIN, 0}, {wake_[0], POLLIN, 0}};
+    int    ready  = poll(pfd, 2, static_cast<int>(timeout.count()));
+    if (ready < 0) {
+        return (errno == EINTR) ? 0 : -1;
+    }
+    if (pfd[1].revents != 0) {
+        return -1;
+    }
+    if (ready == 0) {
+        return 0;
+    }
+    ssize_t n = ::read(fd_, buf, cap);
+    if (n > 0) {
+        return static_cast<long>(n);
+    }
+    // 伪终端的另一端关闭时读到 EOF 或 EIO
+    return (n < 0 && (errno == EAGAIN || errno == EINTR)) ? 0 : -1;
+}
+
+void SerialTransport::close()
+{
+    // 描述符在析构时才关闭，读线程可能还在 poll() 中
+    if (!closed_.exchange(true) && wake_[1] >= 0) {
+        uint8_t b = 0;
+        (void)::write(wake_[1], &b, 1);
+    }
+}
+
+}  // namespace km1
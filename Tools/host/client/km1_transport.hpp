@@ -0,0 +1,82 @@
+/**
+ * @file km1_transport.hpp
+ * @brief 客户端的字节链路
+ *
+ * Client 只通过这个接口收发字节：
+ *   - SerialTransport：串口或伪终端（例如 km1_sim_pty 打印的从端路径）
+ *   - LoopbackTransport（km1_loopback.hpp）：同一进程中的固件主机构建，不需要硬件
+ */
+#ifndef KM1_TRANSPORT_HPP
+#define KM1_TRANSPORT_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace km1 {
+
+class Transport {
+public:
+    virtual ~Transport() = default;
+
+    /**
+     * @brief 写入全部字节（可以被多个线程调用，由 Client 串行化）
+     * @return false: 链路已关闭或出错
+     */
+    virtual bool write(const uint8_t* data, size_t len) = 0;
+
+    /**
+     * @brief 读取已到达的字节，最多等待 timeout
+     * @return 读到的字节数，0 表示超时，-1 表示链路已关闭
+     */
+    virtual long read(uint8_t* buf, size_t cap, std::chrono::milliseconds timeout) = 0;
+
+    /**
+     * @brief 切换本端波特率（SYS_CMD_SET_BAUD 协商成功后由 Client 调用）
+     * @return false: 不支持
+     */
+    virtual bool set_baud(uint32_t baud) = 0;
+
+    /**
+     * @brief 关闭链路，正在等待的 read() 返回 -1
+     */
+    virtual void close() = 0;
+};
+
+/**
+ * @brief POSIX 串口 / 伪终端（原始模式，8N1，无流控）
+ */
+class SerialTransport : public Transport {
+public:
+    SerialTransport() = default;
+    ~SerialTransport() override;
+
+    SerialTransport(const SerialTransport&)            = delete;
+    SerialTransport& operator=(const SerialTransport&) = delete;
+
+    /**
+     * @return false: 打不开或不是终端设备（见 error()）
+     */
+    bool open(const std::string& path, uint32_t baud = 115200);
+
+    bool write(const uint8_t* data, size_t len) override;
+    long read(uint8_t* buf, size_t cap, std::chrono::milliseconds timeout) override;
+    bool set_baud(uint32_t baud) override;
+    void close() override;
+
+    const std::string& error() const { return error_; }
+
+private:
+    void release();
+
+    int               fd_      = -1;
+    int               wake_[2] = {-1, -1};  // close() 唤醒正在等待的 read()
+    std::atomic<bool> closed_{false};
+    std::string       error_;
+};
+
+}  // namespace km1
+
+#endif  // KM1_TRANSPORT_HPP
@@ -0,0 +1,250 @@
+/**
+ * @file log_decode.c
+ * @brief 令牌化日志解码器（主机端）
+ *
+ * 读取固件构建时导出的字典（km1-one.logdict，即 .km1_log 段的内容），
+ * 把 USART1 上的日志流还原为文本：
+ *   - 记录 [0xA5][token:u16][len:u8][参数]，token 为格式字符串在字典中的偏移
+ *   - 其余字节（printf 输出的文本）原样输出
+ * 参数编码见 User/comm/utils/debug_token.h。
+ *
+ * 用法: log_decode <dict> [capture]   （不给 capture 时从标准输入读取，例如串口）
+ */
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SYNC        0xA5U
+#define HEADER_SIZE 4U
+
+static uint8_t* dict      = NULL;
+static uint32_t dict_size = 0;
+
+static uint32_t records     = 0;
+static uint32_t bad_records = 0;
+
+static uint8_t* read_file(const char* path, uint32_t* size)
+{
+    FILE* f = fopen(path, "rb");
+    if (f == NULL) {
+        return NULL;
+    }
+    uint8_t* buf = NULL;
+    uint32_t len = 0;
+    uint32_t cap = 0;
+    for (;;) {
+        if (len == cap) {
+            cap = cap ? cap * 2U : 4096U;
+            buf = realloc(buf, cap + 1U);
+            if (buf == NULL) {
+                fclose(f);
+                return NULL;
+            }
+        }
+        size_t n = fread(buf + len, 1, cap - len, f);
+        if (n == 0) {
+            break;
+        }
+        len += (uint32_t)n;
+    }
+    fclose(f);
+    buf[len] = 0;  // 保证最后一个格式字符串有结尾
+    *size    = len;
+    return buf;
+}
+
+static uint32_t get_u32(const uint8_t* p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief token 是否指向字典中某个格式字符串的开头
+ */
+static const char* lookup(uint16_t token)
+{
+    if (token >= dict_size || dict[token] == 0 || (token > 0 && dict[token - 1U] != 0)) {
+        return NULL;
+    }
+    return (const char*)&dict[token];
+}
+
+// 一条记录渲染出的文本，确认记录有效后才输出
+static char   text[4096];
+static size_t text_len = 0;
+
+static void emit(const char* fmt, ...)
+{
+    if (text_len >= sizeof(text)) {
+        return;
+    }
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(text + text_len, sizeof(text) - text_len, fmt, ap);
+    va_end(ap);
+    if (n > 0) {
+        text_len += (size_t)n;
+        if (text_len > sizeof(text) - 1U) {
+            text_len = sizeof(text) - 1U;
+        }
+    }
+}
+
+/**
+ * @brief 按格式字符串把一条记录的参数渲染到 text
+ * @return true: 参数恰好用完 len 字节
+ */
+static bool render(const char* fmt, const uint8_t* args, uint32_t len)
+{
+    uint32_t off = 0;
+    text_len     = 0;
+    for (const char* p = fmt; *p != '\0'; ++p) {
+        if (*p != '%') {
+            emit("%c", *p);
+            continue;
+        }
+        if (p[1] == '%') {
+            emit("%%");
+            ++p;
+            continue;
+        }
+
+        // 复制标志、宽度、精度，去掉长度修饰符（参数统一为 32 位）
+        char        spec[32];
+        size_t      n = 0;
+        const char* q = p;
+        spec[n++]     = *q++;
+        while (*q != '\0' && strchr("-+ #0123456789.*", *q) != NULL && n < sizeof(spec) - 4U) {
+            spec[n++] = *q++;
+        }
+        while (*q != '\0' && strchr("hlLqjzt", *q) != NULL) {
+            ++q;
+        }
+        char conv = *q;
+        if (conv == '\0') {
+            return false;
+        }
+        p = q;
+
+        if (conv == 's' || conv == 'H') {
+            if (off + 1U > len || off + 1U + args[off] > len) {
+                return false;
+            }
+            uint8_t        sn = args[off];
+            const uint8_t* s  = &args[off + 1U];
+            if (conv == 's') {
+                emit("%.*s", (int)sn, (const char*)s);
+            } else {
+                for (uint8_t i = 0; i < sn; ++i) {
+                    emit(" %02X", s[i]);
+                }
+            }
+            off += 1U + sn;
+            continue;
+        }
+
+        if (off + 4U > len) {
+            return false;
+        }
+        uint32_t v = get_u32(&args[off]);
+        off += 4U;
+        spec[n]     = conv;
+        spec[n + 1] = '\0';
+        switch (conv) {
+            case 'd':
+            case 'i':
+                emit(spec, (int)(int32_t)v);
+                break;
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G': {
+                float f;
+                memcpy(&f, &v, sizeof(f));
+                emit(spec, (double)f);
+                break;
+            }
+            case 'p':
+                emit("0x%08X", (unsigned)v);
+                break;
+            default:  // u x X o c
+                emit(spec, (unsigned)v);
+                break;
+        }
+    }
+    return off == len;
+}
+
+// rec 中积累一条未完成的记录
+static uint8_t  rec[HEADER_SIZE + 255U];
+static uint32_t have = 0;
+
+static void feed(uint8_t c)
+{
+    if (have == 0 && c != SYNC) {
+        fputc(c, stdout);  // printf 文本
+        if (c == '\n') {
+            fflush(stdout);
+        }
+        return;
+    }
+    rec[have++] = c;
+    if (have < HEADER_SIZE || have < HEADER_SIZE + rec[3]) {
+        return;
+    }
+
+    uint16_t    token = (uint16_t)(rec[1] | (rec[2] << 8));
+    const char* fmt   = lookup(token);
+    if (fmt != NULL && render(fmt, &rec[HEADER_SIZE], rec[3])) {
+        fwrite(text, 1, text_len, stdout);
+        records++;
+        have = 0;
+        fflush(stdout);
+        return;
+    }
+
+    // 不是有效记录：丢弃同步字节，其后的内容重新按流处理
+    bad_records++;
+    uint8_t  rest[sizeof(rec)];
+    uint32_t rest_len = have - 1U;
+    memcpy(rest, &rec[1], rest_len);
+    have = 0;
+    for (uint32_t i = 0; i < rest_len; ++i) {
+        feed(rest[i]);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <dict> [capture]\n", argv[0]);
+        return 1;
+    }
+    dict = read_file(argv[1], &dict_size);
+    if (dict == NULL) {
+        fprintf(stderr, "cannot read dictionary %s\n", argv[1]);
+        return 1;
+    }
+    FILE* in = (argc > 2) ? fopen(argv[2], "rb") : stdin;
+    if (in == NULL) {
+        fprintf(stderr, "cannot open %s\n", argv[2]);
+        return 1;
+    }
+
+    int c;
+    while ((c = fgetc(in)) != EOF) {
+        feed((uint8_t)c);
+    }
+
+    if (in != stdin) {
+        fclose(in);
+    }
+    fprintf(stderr, "%u records, %u bad\n", (unsigned)records, (unsigned)bad_records);
+    free(dict);
+    return 0;
+}
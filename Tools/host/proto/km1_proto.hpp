@@ -0,0 +1,334 @@
+/**
+ * @file km1_proto.hpp
+ * @brief 主机端协议定义（C++17），由固件的 protocol_schema.h 展开生成
+ *
+ * 与固件共用同一份描述，类型 / 命令编号、消息的字段顺序和长度不会与固件不一致：
+ *   - 类型与命令：PROTO_TYPE_* / <类型>_CMD_*，与固件同名（<类型>_CMD_LIMIT 为 cmd 上限）
+ *   - 定长消息：<名称>_t，kSize 为编码长度，encode() / decode() 为小端逐字段读写
+ *   - 变长消息（请求和应答）：<名称>_t，数组为 std::vector，个数字段由调用方填写；
+ *     size() 为编码长度，encode() / decode() 的长度检查与固件相同
+ *   - request_size()：固件分发表对请求负载长度的要求
+ *   - 帧长度：kSmallMaxPayload / kLargeMaxPayload / kFrameOverhead，取自 comm_config.h
+ * 遥测帧、BATCH 条目等字段表描述不了的负载仍按 protocol_spec.md 手工组帧 / 解析。
+ *
+ * 使用的工程需要把 User/comm/protocol 加入头文件搜索路径。
+ */
+#ifndef KM1_PROTO_HPP
+#define KM1_PROTO_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "../comm_config.h"
+#include "protocol_schema.h"
+
+namespace km1::proto {
+
+// ==================== 类型与命令 ====================
+
+#define KM1_PROTO_TYPE(name, id, handler) PROTO_TYPE_##name = id,
+#define KM1_PROTO_CMD(type, name, id, req) type##_CMD_##name = id,
+#define KM1_PROTO_CMDS(name, id, handler)                                                          \
+    enum : uint8_t {                                                                               \
+        PROTO_SCHEMA_##name##_CMDS(KM1_PROTO_CMD) name##_CMD_LIMIT = PROTO_SCHEMA_MAX_CMDS         \
+    };
+
+enum : uint8_t { PROTO_SCHEMA_TYPES(KM1_PROTO_TYPE) };
+PROTO_SCHEMA_TYPES(KM1_PROTO_CMDS)
+
+// 应答 / ACK 中的状态
+enum : uint8_t {
+    PROTO_STATUS_OK          = 0x00,
+    PROTO_STATUS_UNKNOWN_CMD = 0x01,
+    PROTO_STATUS_BAD_PAYLOAD = 0x02,
+    PROTO_STATUS_INVALID_ARG = 0x03,
+    PROTO_STATUS_FAILED      = 0x04,
+    PROTO_STATUS_BUSY        = 0x05,
+    PROTO_STATUS_UNSUPPORTED = 0x06,
+    PROTO_STATUS_SKIPPED     = 0x07,
+};
+
+// ==================== 帧长度 ====================
+
+// 与固件的 comm_config.h 相同。固件以其他 COMM_MAX_PAYLOAD 构建时（KM1_COMM_MAX_PAYLOAD），
+// 设备实际的上限以 SYS_CMD_FRAME_MODE 应答中的 max_payload 为准（Client::max_payload()）
+constexpr size_t kSmallMaxPayload = COMM_SMALL_MAX_PAYLOAD;  // 1 字节 LEN（上电默认）
+constexpr size_t kLargeMaxPayload = COMM_MAX_PAYLOAD;        // 2 字节 LEN（大帧模式）
+constexpr size_t kFrameOverhead   = COMM_FRAME_OVERHEAD;     // 大帧模式下每帧的开销
+
+// ==================== 字段读写 ====================
+
+namespace wire {
+
+inline void put(uint8_t*& p, uint8_t v)
+{
+    *p++ = v;
+}
+
+inline void put(uint8_t*& p, uint16_t v)
+{
+    *p++ = static_cast<uint8_t>(v);
+    *p++ = static_cast<uint8_t>(v >> 8);
+}
+
+inline void put(uint8_t*& p, uint32_t v)
+{
+    for (int i = 0; i < 4; ++i) {
+        *p++ = static_cast<uint8_t>(v >> (8 * i));
+    }
+}
+
+inline void put(uint8_t*& p, float v)
+{
+    uint32_t raw;
+    std::memcpy(&raw, &v, sizeof(raw));
+    put(p, raw);
+}
+
+inline void get(const uint8_t*& p, uint8_t& v)
+{
+    v = *p++;
+}
+
+inline void get(const uint8_t*& p, uint16_t& v)
+{
+    v = static_cast<uint16_t>(p[0] | (p[1] << 8));
+    p += 2;
+}
+
+inline void get(const uint8_t*& p, uint32_t& v)
+{
+    v = static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8)
+      | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    p += 4;
+}
+
+inline void get(const uint8_t*& p, float& v)
+{
+    uint32_t raw;
+    get(p, raw);
+    std::memcpy(&v, &raw, sizeof(v));
+}
+
+}  // namespace wire
+
+// ==================== 定长消息 ====================
+
+using u8  = uint8_t;
+using u16 = uint16_t;
+using u32 = uint32_t;
+using f32 = float;
+
+#define KM1_PROTO_FIELD(kind, field)      kind field{};
+#define KM1_PROTO_FIELD_SIZE(kind, field) +PROTO_WIRE_SIZE_##kind
+#define KM1_PROTO_PUT(kind, field)        wire::put(p, field);
+#define KM1_PROTO_GET(kind, field)        wire::get(p, out.field);
+
+#define KM1_PROTO_MESSAGE(name, NAME)                                                              \
+    struct name##_t {                                                                              \
+        PROTO_MSG_##NAME(KM1_PROTO_FIELD)                                                          \
+                                                                                                   \
+        static constexpr size_t kSize = 0U PROTO_MSG_##NAME(KM1_PROTO_FIELD_SIZE);                 \
+                                                                                                   \
+        /* 写入 out（至少 kSize 字节），返回 kSize */                                              \
+        size_t encode(uint8_t* out) const                                                          \
+        {                                                                                          \
+            uint8_t* p = out;                                                                      \
+            PROTO_MSG_##NAME(KM1_PROTO_PUT) return static_cast<size_t>(p - out);                   \
+        }                                                                                          \
+                                                                                                   \
+        /* 负载长度必须恰好为 kSize */                                                             \
+        static bool decode(const uint8_t* in, size_t len, name##_t& out)                           \
+        {                                                                                          \
+            if (in == nullptr || len != kSize) {                                                   \
+                return false;                                                                      \
+            }                                                                                      \
+            const uint8_t* p = in;                                                                 \
+            PROTO_MSG_##NAME(KM1_PROTO_GET) return true;                                           \
+        }                                                                                          \
+    };
+
+PROTO_SCHEMA_MESSAGES(KM1_PROTO_MESSAGE)
+
+// ==================== 变长消息 ====================
+
+#define KM1_PROTO_VAR_ARRAY(kind, field, count)     std::vector<kind> field;
+#define KM1_PROTO_VAR_MSGS(name, NAME, field, count) std::vector<name##_t> field;
+#define KM1_PROTO_VAR_REST(kind, field)              std::vector<kind> field;
+#define KM1_PROTO_VAR_OPT(kind, field)                                                             \
+    kind field{};                                                                                  \
+    bool has_##field = false;
+
+#define KM1_PROTO_VAR_SIZE_FIELD(kind, field)        n += PROTO_WIRE_SIZE_##kind;
+#define KM1_PROTO_VAR_SIZE_ARRAY(kind, field, count) n += size_t(count) * PROTO_WIRE_SIZE_##kind;
+#define KM1_PROTO_VAR_SIZE_MSGS(name, NAME, field, count) n += size_t(count) * name##_t::kSize;
+#define KM1_PROTO_VAR_SIZE_REST(kind, field)         n += field.size() * PROTO_WIRE_SIZE_##kind;
+#define KM1_PROTO_VAR_SIZE_OPT(kind, field)                                                        \
+    opt = opt && has_##field;                                                                      \
+    n += opt ? PROTO_WIRE_SIZE_##kind : 0U;
+
+// 数组比个数短时补 0
+#define KM1_PROTO_VAR_PUT_ARRAY(kind, field, count)                                                \
+    for (size_t i = 0; i < size_t(count); ++i) {                                                   \
+        wire::put(p, i < field.size() ? field[i] : kind{});                                        \
+    }
+#define KM1_PROTO_VAR_PUT_MSGS(name, NAME, field, count)                                           \
+    for (size_t i = 0; i < size_t(count); ++i) {                                                   \
+        p += (i < field.size() ? field[i] : name##_t{}).encode(p);                                 \
+    }
+#define KM1_PROTO_VAR_PUT_REST(kind, field)                                                        \
+    for (kind v : field) {                                                                         \
+        wire::put(p, v);                                                                           \
+    }
+#define KM1_PROTO_VAR_PUT_OPT(kind, field)                                                         \
+    opt = opt && has_##field;                                                                      \
+    if (opt) {                                                                                     \
+        wire::put(p, field);                                                                       \
+    }
+
+#define KM1_PROTO_VAR_GET_FIELD(kind, field)                                                       \
+    if (size_t(end - p) < PROTO_WIRE_SIZE_##kind) {                                                \
+        return false;                                                                              \
+    }                                                                                              \
+    wire::get(p, out.field);
+#define KM1_PROTO_VAR_GET_ARRAY(kind, field, count)                                                \
+    if (size_t(end - p) < size_t(count) * PROTO_WIRE_SIZE_##kind) {                                \
+        return false;                                                                              \
+    }                                                                                              \
+    out.field.resize(size_t(count));                                                               \
+    for (kind & v : out.field) {                                                                   \
+        wire::get(p, v);                                                                           \
+    }
+#define KM1_PROTO_VAR_GET_MSGS(name, NAME, field, count)                                           \
+    if (size_t(end - p) < size_t(count) * name##_t::kSize) {                                       \
+        return false;                                                                              \
+    }                                                                                              \
+    out.field.resize(size_t(count));                                                               \
+    for (name##_t & v : out.field) {                                                               \
+        (void)name##_t::decode(p, name##_t::kSize, v);                                             \
+        p += name##_t::kSize;                                                                      \
+    }
+#define KM1_PROTO_VAR_GET_REST(kind, field)                                                        \
+    if (size_t(end - p) % PROTO_WIRE_SIZE_##kind != 0U) {                                          \
+        return false;                                                                              \
+    }                                                                                              \
+    out.field.resize(size_t(end - p) / PROTO_WIRE_SIZE_##kind);                                    \
+    for (kind & v : out.field) {                                                                   \
+        wire::get(p, v);                                                                           \
+    }
+#define KM1_PROTO_VAR_GET_OPT(kind, field)                                                         \
+    out.has_##field = opt && size_t(end - p) >= PROTO_WIRE_SIZE_##kind;                            \
+    opt             = out.has_##field;                                                             \
+    if (opt) {                                                                                     \
+        wire::get(p, out.field);                                                                   \
+    }
+
+#define KM1_PROTO_VAR_MESSAGE(name, NAME)                                                          \
+    struct name##_t {                                                                              \
+        PROTO_MSG_##NAME(KM1_PROTO_FIELD,                                                          \
+                         KM1_PROTO_VAR_ARRAY,                                                      \
+                         KM1_PROTO_VAR_MSGS,                                                       \
+                         KM1_PROTO_VAR_REST,                                                       \
+                         KM1_PROTO_VAR_OPT)                                                        \
+                                                                                                   \
+        /* 编码长度，数组个数取自个数字段（m->...） */                                             \
+        size_t size() const                                                                        \
+        {                                                                                          \
+            const name##_t* m   = this;                                                            \
+            size_t          n   = 0;                                                               \
+            bool            opt = true;                                                            \
+            PROTO_MSG_##NAME(KM1_PROTO_VAR_SIZE_FIELD,                                             \
+                             KM1_PROTO_VAR_SIZE_ARRAY,                                             \
+                             KM1_PROTO_VAR_SIZE_MSGS,                                              \
+                             KM1_PROTO_VAR_SIZE_REST,                                              \
+                             KM1_PROTO_VAR_SIZE_OPT)                                               \
+            (void)m;                                                                               \
+            (void)opt;                                                                             \
+            return n;                                                                              \
+        }                                                                                          \
+                                                                                                   \
+        /* 写入 out（至少 size() 字节），返回 size() */                                            \
+        size_t encode(uint8_t* out) const                                                          \
+        {                                                                                          \
+            const name##_t* m   = this;                                                            \
+            uint8_t*        p   = out;                                                             \
+            bool            opt = true;                                                            \
+            PROTO_MSG_##NAME(KM1_PROTO_PUT,                                                        \
+                             KM1_PROTO_VAR_PUT_ARRAY,                                              \
+                             KM1_PROTO_VAR_PUT_MSGS,                                               \
+                             KM1_PROTO_VAR_PUT_REST,                                               \
+                             KM1_PROTO_VAR_PUT_OPT)                                                \
+            (void)m;                                                                               \
+            (void)opt;                                                                             \
+            return static_cast<size_t>(p - out);                                                   \
+        }                                                                                          \
+                                                                                                   \
+        std::vector<uint8_t> encode() const                                                        \
+        {                                                                                          \
+            std::vector<uint8_t> out(size());                                                      \
+            encode(out.data());                                                                    \
+            return out;                                                                            \
+        }                                                                                          \
+                                                                                                   \
+        /* 负载长度必须与字段表完全一致 */                                                         \
+        static bool decode(const uint8_t* in, size_t len, name##_t& out)                           \
+        {                                                                                          \
+            if (in == nullptr && len != 0) {                                                       \
+                return false;                                                                      \
+            }                                                                                      \
+            const name##_t* m   = &out;                                                            \
+            const uint8_t*  p   = in;                                                              \
+            const uint8_t*  end = in + len;                                                        \
+            bool            opt = true;                                                            \
+            PROTO_MSG_##NAME(KM1_PROTO_VAR_GET_FIELD,                                              \
+                             KM1_PROTO_VAR_GET_ARRAY,                                              \
+                             KM1_PROTO_VAR_GET_MSGS,                                               \
+                             KM1_PROTO_VAR_GET_REST,                                               \
+                             KM1_PROTO_VAR_GET_OPT)                                                \
+            (void)m;                                                                               \
+            (void)opt;                                                                             \
+            return p == end;                                                                       \
+        }                                                                                          \
+    };
+
+PROTO_SCHEMA_VAR_REQUESTS(KM1_PROTO_VAR_MESSAGE)
+PROTO_SCHEMA_VAR_REPLIES(KM1_PROTO_VAR_MESSAGE)
+
+// ==================== 请求长度 ====================
+
+#define KM1_PROTO_SIZE(name, NAME) inline constexpr unsigned PROTO_SIZE_##NAME = name##_t::kSize;
+PROTO_SCHEMA_MESSAGES(KM1_PROTO_SIZE)
+
+inline constexpr int kUndefined = -1;  // 固件不接受的 [type][cmd]
+inline constexpr int kVariable  = -2;  // 变长 / 可选负载
+
+constexpr int request_size_of(unsigned size)
+{
+    return size == PROTO_SIZE_OUT ? kUndefined
+         : size == PROTO_SIZE_VAR ? kVariable
+                                  : static_cast<int>(size);
+}
+
+/**
+ * @brief 固件分发表对 [type][cmd] 请求负载（[cmd] 之后）长度的要求
+ * @return 固定长度，kVariable 或 kUndefined
+ */
+constexpr int request_size(uint8_t type, uint8_t cmd)
+{
+#define KM1_PROTO_REQ(t, name, id, req)                                                            \
+    if (cmd == (id)) {                                                                             \
+        return request_size_of(PROTO_SIZE_##req);                                                  \
+    }
+#define KM1_PROTO_REQS(name, id, handler)                                                          \
+    if (type == (id)) {                                                                            \
+        PROTO_SCHEMA_##name##_CMDS(KM1_PROTO_REQ) return kUndefined;                               \
+    }
+    PROTO_SCHEMA_TYPES(KM1_PROTO_REQS)
+    return kUndefined;
+}
+
+}  // namespace km1::proto
+
+#endif  // KM1_PROTO_HPP
@@ -0,0 +1,80 @@
+#include "sim_device.h"
+
+#include <stdbool.h>
+
+#include "cycle_counter.h"
+#include "debug_output.h"
+#include "motion_engine.h"
+#include "motion_stream.h"
+#include "motion_sync.h"
+#include "protocol.h"
+#include "servo_hal.h"
+#include "sim_uart.h"
+#include "tf_uart_port.h"
+
+static uint32_t servo_pwm[MAX_SERVOS];
+static bool     inited = false;
+
+// ==================== servo_hal.h ====================
+
+void servo_hal_init(void) {}
+
+void servo_hal_set_pwm(uint32_t servo_id, uint32_t pwm_us)
+{
+    if (servo_id < MAX_SERVOS) {
+        servo_pwm[servo_id] = pwm_us;
+    }
+}
+
+// ==================== 仿真设备 ====================
+
+int sim_device_init(sim_tx_sink_t sink, void* ctx)
+{
+    if (inited) {
+        return -1;
+    }
+    sim_uart_set_sink(sink, ctx);
+
+    // 与 main() 相同的顺序
+    cycle_counter_init();
+    debug_output_init();
+    servo_hal_init();
+    servo_motion_init();
+    motion_sync_init();
+    motion_stream_init();
+    if (!tf_uart_port_init(NULL) || !protocol_init()) {
+        return -1;
+    }
+    inited = true;
+    return 0;
+}
+
+uint32_t sim_device_rx(const uint8_t* data, uint32_t len)
+{
+    return sim_uart_rx_write(data, len);
+}
+
+void sim_device_poll(void)
+{
+    tf_uart_port_poll();
+}
+
+void sim_device_tick_1ms(void)
+{
+    // HAL_TIM_PeriodElapsedCallback(TIM1)，然后是它挂起的 PendSV（app_deferred_tick()）
+    servo_motion_update_1ms();
+    protocol_notify_flush();
+    protocol_telemetry_tick_1ms();
+    protocol_estop_tick_1ms();
+    tf_uart_port_tick_1ms();
+}
+
+int sim_device_rx_pending(void)
+{
+    return tf_uart_port_rx_pending();
+}
+
+uint32_t sim_device_servo_pwm(uint32_t servo_id)
+{
+    return (servo_id < MAX_SERVOS) ? servo_pwm[servo_id] : 0U;
+}
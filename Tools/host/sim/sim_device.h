@@ -0,0 +1,66 @@
+#ifndef SIM_DEVICE_H
+#define SIM_DEVICE_H
+
+/**
+ * @file sim_device.h
+ * @brief 固件的主机构建（仿真设备）
+ *
+ * 协议层、运动控制和 TinyFrame 使用与目标板相同的源码，只替换硬件层：
+ *   - USART3（uart_driver.h）：sim_uart.c，接收为内存中的“DMA 缓冲区”，发送帧直接交给 tx sink
+ *   - 舵机 PWM（servo_hal.h）：记录在内存中
+ *   - 调试日志（debug_output.h）：设置 KM1_SIM_LOG 环境变量时输出到 stderr
+ * 主循环和 1ms 定时中断由调用者驱动：sim_device_poll() 相当于主循环的一次迭代，
+ * sim_device_tick_1ms() 相当于 TIM1 中断，二者必须在同一线程中调用（中断只在迭代之间发生）。
+ * 固件状态都是全局变量，一个进程中只有一个仿真设备。
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 设备发出的字节（USART3 TX），在 sim_device_poll() / sim_device_tick_1ms() 中调用
+ */
+typedef void (*sim_tx_sink_t)(void* ctx, const uint8_t* data, uint32_t len);
+
+/**
+ * @brief 初始化（与 main() 中的初始化顺序相同），只能调用一次
+ * @param sink 发送回调
+ * @param ctx  传给 sink 的参数
+ * @return 0:成功, -1:失败
+ */
+int sim_device_init(sim_tx_sink_t sink, void* ctx);
+
+/**
+ * @brief 主机发给设备的字节，写入接收缓冲区
+ * @return 写入的字节数；缓冲区满时少于 len（剩余部分稍后再写，不会像真实 DMA 那样覆盖）
+ */
+uint32_t sim_device_rx(const uint8_t* data, uint32_t len);
+
+/**
+ * @brief 主循环的一次迭代（解析接收数据、执行命令、推进波特率协商）
+ */
+void sim_device_poll(void);
+
+/**
+ * @brief 1ms 定时中断（运动插补）及其后的 PendSV（遥测采样、协议计时、TinyFrame 超时）
+ */
+void sim_device_tick_1ms(void);
+
+/**
+ * @brief 是否有尚未处理的接收数据（为假时主循环可以休眠到下一个 tick）
+ */
+int sim_device_rx_pending(void);
+
+/**
+ * @brief 舵机当前输出的 PWM（us），id 超出范围时为 0
+ */
+uint32_t sim_device_servo_pwm(uint32_t servo_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SIM_DEVICE_H
@@ -0,0 +1,102 @@
+/**
+ * @file sim_log.c
+ * @brief debug_output.h 的主机实现（仿真设备的 USART1）
+ *
+ * 仿真设备以 DEBUG_OUTPUT_TOKENIZED=0 构建，日志在主机上直接格式化；
+ * 只有设置了 KM1_SIM_LOG 环境变量时才写到 stderr，否则只计数。
+ * TinyFrame 的 dumpFrame / dumpFrameInfo 同样走这里。
+ */
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "TinyFrame.h"
+#include "debug_output.h"
+#include "utils.h"
+
+#if DEBUG_OUTPUT_TOKENIZED
+#error "the simulated device formats logs on the host, build with DEBUG_OUTPUT_TOKENIZED=0"
+#endif
+
+static FILE*                log_out = NULL;
+static debug_output_stats_t log_stats;
+
+void debug_output_init(void)
+{
+    log_out = (getenv("KM1_SIM_LOG") != NULL) ? stderr : NULL;
+    memset(&log_stats, 0, sizeof(log_stats));
+}
+
+int debug_output_printf(const char* fmt, ...)
+{
+    char    line[DEBUG_OUTPUT_LINE_MAX];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(line, sizeof(line), fmt, ap);
+    va_end(ap);
+    if (n <= 0) {
+        return 0;
+    }
+    if (n > (int)sizeof(line) - 1) {
+        n = (int)sizeof(line) - 1;
+    }
+    return (int)debug_output_write(line, (uint32_t)n);
+}
+
+uint32_t debug_output_write(const void* data, uint32_t len)
+{
+    log_stats.writes++;
+    log_stats.bytes += len;
+    log_stats.sent += len;
+    if (log_out != NULL) {
+        fwrite(data, 1, len, log_out);
+    }
+    return len;
+}
+
+void debug_output_tx_complete_callback(void) {}
+
+void debug_output_error_callback(void) {}
+
+void debug_output_get_stats(debug_output_stats_t* stats)
+{
+    if (stats != NULL) {
+        *stats = log_stats;
+    }
+}
+
+void debug_output_dump(const char* prefix, const char* label, const uint8_t* data, uint32_t len)
+{
+    if (log_out == NULL) {
+        return;
+    }
+    fprintf(log_out, "%s %s (len=%lu):", prefix, label, (unsigned long)len);
+    for (uint32_t i = 0; i < len; ++i) {
+        fprintf(log_out, " %02X", data[i]);
+    }
+    fputc('\n', log_out);
+}
+
+void debug_output_reset_stats(void)
+{
+    memset(&log_stats, 0, sizeof(log_stats));
+}
+
+// ==================== TinyFrame utils.h ====================
+
+void dumpFrame(const uint8_t* buff, size_t len)
+{
+    debug_output_dump("[tf]", "frame", buff, (uint32_t)len);
+}
+
+void dumpFrameInfo(TF_Msg* msg)
+{
+    if (log_out != NULL) {
+        fprintf(log_out,
+                "[tf] frame type=%02Xh len=%u id=%Xh\n",
+                (unsigned)msg->type,
+                (unsigned)msg->len,
+                (unsigned)msg->frame_id);
+    }
+}
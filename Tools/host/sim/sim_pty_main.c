@@ -0,0 +1,112 @@
+/**
+ * @file sim_pty_main.c
+ * @brief 把仿真设备挂在伪终端上（主机端）
+ *
+ * 打开一个伪终端，在 stdout 打印从端路径，之后像 USART3 一样在主端收发协议帧。
+ * 主机工具（km1::SerialTransport、串口调试助手等）打开从端即可，不需要硬件。
+ * 波特率设置被忽略：伪终端没有线上速率。
+ *
+ * 用法: km1_sim_pty
+ */
+#define _DEFAULT_SOURCE
+#define _XOPEN_SOURCE 600
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "sim_device.h"
+
+static int pty_fd = -1;
+
+static void pty_write(void* ctx, const uint8_t* data, uint32_t len)
+{
+    (void)ctx;
+    while (len > 0) {
+        ssize_t n = write(pty_fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            return;  // 没有从端打开时丢弃，与断开的串口一样
+        }
+        data += n;
+        len -= (uint32_t)n;
+    }
+}
+
+static uint64_t now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL;
+}
+
+int main(void)
+{
+    pty_fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (pty_fd < 0 || grantpt(pty_fd) != 0 || unlockpt(pty_fd) != 0) {
+        perror("posix_openpt");
+        return 1;
+    }
+
+    // 主端也设为原始模式，否则行规程会改写二进制帧
+    struct termios tio;
+    if (tcgetattr(pty_fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(pty_fd, TCSANOW, &tio);
+    }
+
+    if (sim_device_init(pty_write, NULL) != 0) {
+        fprintf(stderr, "sim_device_init failed\n");
+        return 1;
+    }
+    printf("%s\n", ptsname(pty_fd));
+    fflush(stdout);
+
+    // 主端保持一个从端引用：客户端关闭后重新打开时 read() 不会一直返回 EIO
+    int hold = open(ptsname(pty_fd), O_RDWR | O_NOCTTY);
+
+    uint8_t  rx[512];
+    uint32_t rx_len = 0;
+    uint64_t next   = now_ms() + 1;
+    for (;;) {
+        int timeout = (rx_len > 0 || sim_device_rx_pending()) ? 0 : 1;
+
+        struct pollfd pfd = {.fd = pty_fd, .events = POLLIN};
+        if (rx_len < sizeof(rx) && poll(&pfd, 1, timeout) > 0 && (pfd.revents & POLLIN) != 0) {
+            ssize_t n = read(pty_fd, rx + rx_len, sizeof(rx) - rx_len);
+            if (n > 0) {
+                rx_len += (uint32_t)n;
+            }
+        }
+
+        // 接收缓冲区放不下的部分留到下一次迭代
+        if (rx_len > 0) {
+            uint32_t n = sim_device_rx(rx, rx_len);
+            for (uint32_t i = n; i < rx_len; i++) {
+                rx[i - n] = rx[i];
+            }
+            rx_len -= n;
+        }
+
+        sim_device_poll();
+
+        uint64_t now = now_ms();
+        if (now - next > 100U) {
+            next = now;  // 进程被挂起太久时不追赶
+        }
+        while (now >= next) {
+            sim_device_tick_1ms();
+            next++;
+        }
+    }
+
+    close(hold);
+    return 0;
+}
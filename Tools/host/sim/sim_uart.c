@@ -0,0 +1,287 @@
+/**
+ * @file sim_uart.c
+ * @brief uart_driver.h 的主机实现（仿真设备的 USART3）
+ *
+ * - 接收：与目标板相同的循环“DMA 缓冲区”和尾部镜像区，peek / consume 语义不变；
+ *   写入只接受空闲空间，不会覆盖未处理的数据
+ * - 发送：提交的帧立即交给 tx sink（没有线上传输时间），帧槽随即释放；
+ *   批量帧的配额与目标板相同，同时预留的帧槽超过配额时丢弃
+ */
+#include <string.h>
+
+#include "sim_uart.h"
+#include "uart_driver.h"
+
+#define SIM_UART_PCLK 36000000UL  // 与目标板 USART3 的 APB1 时钟相同
+
+static sim_tx_sink_t tx_sink     = NULL;
+static void*         tx_sink_ctx = NULL;
+
+static uint8_t  rx_buffer[UART_DMA_RX_BUFFER_SIZE + UART_RX_WRAP_GUARD];
+static uint16_t rx_write_pos  = 0;  // “DMA” 写入位置
+static uint16_t rx_read_pos   = 0;
+static uint16_t rx_mirror_len = 0;
+static int      rx_event      = 0;
+
+static uart_rx_callback_t rx_isr_hook = NULL;
+
+static uint32_t baudrate      = 115200;
+static uint32_t tx_fail_count = 0;
+
+static void tx_emit(const uint8_t* data, uint32_t len)
+{
+    if (tx_sink != NULL && len > 0) {
+        tx_sink(tx_sink_ctx, data, len);
+    }
+}
+
+void sim_uart_set_sink(sim_tx_sink_t sink, void* ctx)
+{
+    tx_sink     = sink;
+    tx_sink_ctx = ctx;
+}
+
+uint32_t sim_uart_rx_write(const uint8_t* data, uint32_t len)
+{
+    // 保留一个字节：读写位置相等表示空
+    uint32_t used = (uint32_t)(rx_write_pos + UART_DMA_RX_BUFFER_SIZE - rx_read_pos)
+                  % UART_DMA_RX_BUFFER_SIZE;
+    uint32_t room = UART_DMA_RX_BUFFER_SIZE - 1U - used;
+    if (len > room) {
+        len = room;
+    }
+    for (uint32_t i = 0; i < len; ++i) {
+        rx_buffer[rx_write_pos] = data[i];
+        rx_write_pos = (uint16_t)((rx_write_pos + 1U) % UART_DMA_RX_BUFFER_SIZE);
+    }
+    if (len > 0) {
+        rx_event = 1;
+        // 相当于目标板的接收事件中断：调用方线程里、早于 sim_device_poll() 的解析
+        if (rx_isr_hook != NULL) {
+            rx_isr_hook(data, len);
+        }
+    }
+    return len;
+}
+
+// ==================== uart_driver.h ====================
+
+int uart_driver_init(uart_rx_callback_t rx_callback)
+{
+    (void)rx_callback;  // 只支持 peek / consume 接口（TF_RX_IN_PLACE）
+    return 0;
+}
+
+int uart_driver_send(const uint8_t* data, uint32_t len)
+{
+    if (data == NULL || len == 0) {
+        return -1;
+    }
+    tx_emit(data, len);
+    return (int)len;
+}
+
+int uart_driver_send_async(const uint8_t* data, uint32_t len)
+{
+    if (uart_driver_send(data, len) < 0) {
+        tx_fail_count++;
+        return -1;
+    }
+    return 0;
+}
+
+#if UART_DRIVER_USE_TX_QUEUE
+
+#define TX_SLOTS (UART_TX_SMALL_SLOTS + UART_TX_LARGE_SLOTS)
+
+static uint8_t  tx_slot[TX_SLOTS][UART_TX_LARGE_SLOT_SIZE];
+static uint8_t  tx_slot_class[TX_SLOTS];
+static uint32_t tx_slot_used = 0;  // 位图
+
+static uart_tx_class_stats_t tx_stats[UART_TX_CLASS_COUNT];
+
+uint8_t* uart_driver_tx_reserve(uint32_t len, uart_tx_class_t cls)
+{
+    if (cls >= UART_TX_CLASS_COUNT) {
+        return NULL;
+    }
+    uart_tx_class_stats_t* st = &tx_stats[cls];
+    if (len > UART_TX_LARGE_SLOT_SIZE
+        || (cls == UART_TX_CLASS_BULK && st->queued >= UART_TX_BULK_MAX_SLOTS)) {
+        st->drops++;
+        return NULL;
+    }
+    for (uint32_t i = 0; i < TX_SLOTS; ++i) {
+        if ((tx_slot_used & (1UL << i)) == 0) {
+            tx_slot_used |= 1UL << i;
+            tx_slot_class[i] = (uint8_t)cls;
+            if (++st->queued > st->high_water) {
+                st->high_water = st->queued;
+            }
+            return tx_slot[i];
+        }
+    }
+    st->drops++;
+    return NULL;
+}
+
+int uart_driver_tx_commit(uint8_t* frame, uint32_t len)
+{
+    for (uint32_t i = 0; i < TX_SLOTS; ++i) {
+        if (frame != tx_slot[i] || (tx_slot_used & (1UL << i)) == 0) {
+            continue;
+        }
+        uart_tx_class_stats_t* st = &tx_stats[tx_slot_class[i]];
+        if (len > 0 && len <= UART_TX_LARGE_SLOT_SIZE) {
+            tx_emit(frame, len);
+            st->sent++;
+        }
+        tx_slot_used &= ~(1UL << i);
+        st->queued--;
+        return (len <= UART_TX_LARGE_SLOT_SIZE) ? 0 : -1;
+    }
+    return -1;
+}
+
+void uart_driver_get_tx_stats(uart_tx_class_t cls, uart_tx_class_stats_t* stats)
+{
+    if (cls < UART_TX_CLASS_COUNT && stats != NULL) {
+        *stats = tx_stats[cls];
+    }
+}
+
+void uart_driver_reset_tx_stats(void)
+{
+    for (uint32_t c = 0; c < UART_TX_CLASS_COUNT; ++c) {
+        tx_stats[c].sent       = 0;
+        tx_stats[c].drops      = 0;
+        tx_stats[c].high_water = tx_stats[c].queued;
+    }
+}
+#endif
+
+int uart_driver_baudrate_supported(uint32_t baud)
+{
+    if (baud == 0) {
+        return 0;
+    }
+    uint32_t brr = (SIM_UART_PCLK + baud / 2U) / baud;
+    if (brr < 16U || brr > 0xFFFFU) {
+        return 0;
+    }
+    uint32_t actual = SIM_UART_PCLK / brr;
+    uint32_t error  = (actual > baud) ? (actual - baud) : (baud - actual);
+    return (error * 1000U / baud) <= UART_BAUD_MAX_ERROR_PERMILLE;
+}
+
+int uart_driver_set_baudrate(uint32_t baud)
+{
+    if (!uart_driver_baudrate_supported(baud)) {
+        return -1;
+    }
+    baudrate = baud;
+    // 与目标板相同：重新启动接收，丢弃旧波特率下收到的数据
+    rx_read_pos   = rx_write_pos;
+    rx_mirror_len = 0;
+    rx_event      = 0;
+    return 0;
+}
+
+uint32_t uart_driver_get_baudrate(void)
+{
+    return baudrate;
+}
+
+void uart_driver_poll(void)
+{
+    (void)uart_driver_rx_take_event();
+}
+
+int uart_driver_rx_pending(void)
+{
+    return rx_event;
+}
+
+int uart_driver_rx_take_event(void)
+{
+    int event = rx_event;
+    rx_event  = 0;
+    return event;
+}
+
+uint32_t uart_driver_rx_peek(const uint8_t** data)
+{
+    *data = &rx_buffer[rx_read_pos];
+    if (rx_write_pos >= rx_read_pos) {
+        return (uint32_t)(rx_write_pos - rx_read_pos);
+    }
+    return UART_DMA_RX_BUFFER_SIZE - rx_read_pos;
+}
+
+uint32_t uart_driver_rx_peek_wrap(const uint8_t** data)
+{
+    *data = &rx_buffer[rx_read_pos];
+    if (rx_write_pos >= rx_read_pos) {
+        return (uint32_t)(rx_write_pos - rx_read_pos);
+    }
+    uint16_t head = (rx_write_pos < UART_RX_WRAP_GUARD) ? rx_write_pos : UART_RX_WRAP_GUARD;
+    if (head > rx_mirror_len) {
+        memcpy(&rx_buffer[UART_DMA_RX_BUFFER_SIZE + rx_mirror_len],
+               &rx_buffer[rx_mirror_len],
+               head - rx_mirror_len);
+        rx_mirror_len = head;
+    }
+    return (UART_DMA_RX_BUFFER_SIZE - rx_read_pos) + rx_mirror_len;
+}
+
+void uart_driver_rx_consume(uint32_t len)
+{
+    uint32_t pos = rx_read_pos + len;
+    if (pos >= UART_DMA_RX_BUFFER_SIZE) {
+        pos -= UART_DMA_RX_BUFFER_SIZE;
+        rx_mirror_len = 0;
+    }
+    rx_read_pos = (uint16_t)pos;
+}
+
+int uart_driver_rx_take_overrun(void)
+{
+    return 0;  // 写入只接受空闲空间，不会套圈
+}
+
+void uart_driver_rx_event_callback(uint16_t pos)
+{
+    (void)pos;
+    rx_event = 1;
+}
+
+void uart_driver_set_rx_isr_hook(uart_rx_callback_t hook)
+{
+    rx_isr_hook = hook;
+}
+
+void uart_driver_error_callback(void) {}
+
+uint32_t uart_driver_get_rx_error_count(void)
+{
+    return 0;
+}
+
+uint32_t uart_driver_get_rx_overflow_count(void)
+{
+    return 0;  // 接收缓冲区满时由写入方等待，不丢数据
+}
+
+uint32_t uart_driver_get_tx_fail_count(void)
+{
+    return tx_fail_count;
+}
+
+int uart_driver_is_tx_done(void)
+{
+    return 1;  // 帧在提交时已交给 tx sink
+}
+
+void uart_driver_tx_complete_callback(void) {}
+
+void uart_driver_tx_retry(void) {}
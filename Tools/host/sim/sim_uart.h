@@ -0,0 +1,13 @@
+#ifndef SIM_UART_H
+#define SIM_UART_H
+
+// sim_uart.c（uart_driver.h 的主机实现）与 sim_device.c 之间的接口
+
+#include <stdint.h>
+
+#include "sim_device.h"
+
+void     sim_uart_set_sink(sim_tx_sink_t sink, void* ctx);
+uint32_t sim_uart_rx_write(const uint8_t* data, uint32_t len);
+
+#endif  // SIM_UART_H
@@ -0,0 +1,72 @@
+#ifndef __COMM_CONFIG_H__
+#define __COMM_CONFIG_H__
+
+/**
+ * @brief 通信链路尺寸配置
+ *
+ * TF_Config.h、protocol.h、uart_driver.h 的缓冲区大小都从这里推导，
+ * 修改最大帧长时只需要改这一处。
+ */
+
+// ==================== 帧长度 ====================
+
+// 兼容模式（1 字节 LEN 字段，上电默认）的最大负载
+#define COMM_SMALL_MAX_PAYLOAD 255
+
+// 大帧模式（2 字节 LEN 字段，由 SYS_CMD_SET_FRAME_MODE 协商）的最大负载。
+// 接收区和大帧槽都按它分配（默认约 5.2 KB）；取 COMM_SMALL_MAX_PAYLOAD 时约 1.3 KB，
+// 大帧模式仍可协商，只是负载上限与兼容模式相同
+#ifndef COMM_MAX_PAYLOAD
+#define COMM_MAX_PAYLOAD 1024
+#endif
+
+// 帧开销：SOF + ID + LEN(2) + TYPE + 头 CRC32 + 数据 CRC32
+#define COMM_FRAME_OVERHEAD (1 + 1 + 2 + 1 + 4 + 4)
+#define COMM_MAX_FRAME      (COMM_MAX_PAYLOAD + COMM_FRAME_OVERHEAD)
+
+// ==================== UART 缓冲区 ====================
+
+// 接收只有这一块 RAM（帧在其中原地解析，没有 tf->data）：
+//   DMA 缓冲区 2 * COMM_MAX_FRAME + 镜像区 COMM_MAX_FRAME - 1，默认 2074 + 1036 = 3110 字节，
+//   COMM_MAX_PAYLOAD 为 255 时 536 + 267 = 803 字节
+
+// DMA 接收缓冲区：主循环解析一帧期间 DMA 还能再收一整帧，不会覆盖未处理的数据
+#ifndef UART_DMA_RX_BUFFER_SIZE
+#define UART_DMA_RX_BUFFER_SIZE (2 * COMM_MAX_FRAME)
+#endif
+
+// 回绕镜像区：跨越缓冲区末尾的帧至少有一个字节在末尾之前，其余部分必须放得下
+#ifndef UART_RX_WRAP_GUARD
+#define UART_RX_WRAP_GUARD (COMM_MAX_FRAME - 1)
+#endif
+
+// 发送帧槽：大帧槽必须放得下一整帧（小帧槽的配置见 uart_driver.h）
+#ifndef UART_TX_LARGE_SLOT_SIZE
+#define UART_TX_LARGE_SLOT_SIZE COMM_MAX_FRAME
+#endif
+
+// ==================== 抓包 ====================
+
+// 收发帧记录到 RAM 环形缓冲区（tf_capture.h），默认关闭；打开后占用 TF_CAPTURE_BUFFER_SIZE 字节
+#ifndef TF_CAPTURE_ENABLE
+#define TF_CAPTURE_ENABLE 0
+#endif
+
+#ifndef TF_CAPTURE_BUFFER_SIZE
+#define TF_CAPTURE_BUFFER_SIZE 2048  // 2 的幂
+#endif
+
+// 每帧最多保存的数据字节数，超出部分截断（记录中保留原长度）
+#ifndef TF_CAPTURE_MAX_DATA
+#define TF_CAPTURE_MAX_DATA 48
+#endif
+
+#if COMM_MAX_PAYLOAD < COMM_SMALL_MAX_PAYLOAD || COMM_MAX_PAYLOAD > 0xFFFF
+#error "COMM_MAX_PAYLOAD must be within 255..65535"
+#endif
+
+#if (TF_CAPTURE_BUFFER_SIZE & (TF_CAPTURE_BUFFER_SIZE - 1)) != 0
+#error "TF_CAPTURE_BUFFER_SIZE must be a power of 2"
+#endif
+
+#endif /* __COMM_CONFIG_H__ */
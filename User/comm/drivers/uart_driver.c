@@ -1,66 +1,160 @@
 #include "uart_driver.h"
 
+#include <stdbool.h>
 #include <string.h>
 
+#include "irq_prio.h"
 #include "usart.h"
 
 
-#if UART_DRIVER_USE_RINGBUFFER
-#include "ringbuffer.h"
-
-// 接收 ringbuffer 实例和缓冲区
-static uint8_t      ringbuffer_data[UART_RINGBUFFER_SIZE];
-static ringbuffer_t uart_ringbuffer;
+#if UART_DRIVER_USE_TX_QUEUE
+#include "frame_pool.h"
 #endif
 
-// DMA 接收缓冲区
-static uint8_t      dma_rx_buffer[UART_DMA_RX_BUFFER_SIZE];
+// DMA 接收缓冲区，尾部附加回绕镜像区（DMA 只写前 UART_DMA_RX_BUFFER_SIZE 字节）
+static uint8_t      dma_rx_buffer[UART_DMA_RX_BUFFER_SIZE + UART_RX_WRAP_GUARD];
 static uint16_t     last_dma_pos   = 0;
+static uint16_t     rx_mirror_len  = 0;  // 镜像区中已有效的字节数
 static volatile int tx_in_progress = 0;  // 当前是否有 DMA 发送正在进行
 
+// 接收事件（IDLE / DMA 半满 / 全满）由中断置位，主循环消费
+static volatile uint8_t  rx_event_pending   = 0;
+static uint8_t           rx_restart_pending = 0;  // 接收错误停止了 DMA，等主循环重新启动
+static volatile uint32_t rx_error_count     = 0;
+static volatile uint32_t rx_overrun_count   = 0;  // 硬件溢出（ORE）：DMA 没能及时取走数据
+static volatile uint32_t tx_fail_count      = 0;  // uart_driver_send_async() 失败次数
+
+// DMA 套圈检测：接收事件中断累计写入量，主循环累计消费量，未消费的数据达到整个缓冲区时
+// 最早的字节已被覆盖。主循环只读到 rx_event_pos 为止：接收中断钩子（急停）总是先于解析
+// 看到每个字节，否则主循环可能先处理了急停帧，钩子随后才为它立起栅栏
+static volatile uint16_t rx_event_pos = 0;  // 上次接收事件时的 DMA 位置
+static uint32_t          rx_written   = 0;
+static volatile uint32_t rx_consumed  = 0;
+static volatile uint8_t  rx_lapped    = 0;
+static volatile uint32_t rx_lap_count = 0;  // 套圈次数：未处理的数据被覆盖
+
 // 接收回调函数
 static uart_rx_callback_t user_rx_callback = NULL;
 
-// ==================== 发送队列（环形缓冲区） ====================
+// 接收中断钩子，每个接收事件中看到上次事件以来的新数据
+static uart_rx_callback_t rx_isr_hook = NULL;
+
+// ==================== 发送帧槽与发送队列 ====================
 #if UART_DRIVER_USE_TX_QUEUE
-static uint8_t           tx_buffer[UART_TX_BUFFER_SIZE];
-static volatile uint16_t tx_wr_idx      = 0;  // 写索引
-static volatile uint16_t tx_rd_idx      = 0;  // 读索引
-static volatile uint32_t tx_current_len = 0;  // 当前正在发送的数据长度（用于回调推进队列）
+// 每个生产者（主循环、各级中断）在自己的帧槽中组帧，提交后按顺序排队，
+// 由 DMA 完成中断逐帧发出
+static uint8_t            tx_small_buffer[UART_TX_SMALL_SLOTS * UART_TX_SMALL_SLOT_SIZE];
+static uint8_t            tx_large_buffer[UART_TX_LARGE_SLOTS * UART_TX_LARGE_SLOT_SIZE];
+static frame_pool_t       tx_small_pool;
+static frame_pool_t       tx_large_pool;
+static const uint8_t*     tx_current       = NULL;  // 当前正在发送的帧（发送完成后释放其槽）
+static uart_tx_class_t    tx_current_class = UART_TX_CLASS_CONTROL;
+static uint8_t            tx_retry_pending = 0;  // DMA 启动失败，帧还在队列中，等 uart_driver_tx_retry()
+
+#define UART_TX_SLOTS (UART_TX_SMALL_SLOTS + UART_TX_LARGE_SLOTS)
+
+// 每个优先级一条有序队列；DMA 每发完一帧都先看高优先级队列，
+// 所以控制应答最多等待一帧批量数据
+typedef struct {
+    frame_queue_t      queue;
+    frame_queue_cell_t cells[UART_TX_QUEUE_DEPTH];
+    uint32_t           limit;       // 最多占用的帧槽数
+    volatile uint32_t  queued;      // 当前占用的帧槽数（已分配、未发送完）
+    volatile uint32_t  high_water;  // queued 的历史最大值
+    volatile uint32_t  sent;        // 已发送帧数
+    volatile uint32_t  drops;       // 丢弃的帧数（超出配额或没有空闲帧槽）
+} tx_class_t;
+
+static tx_class_t tx_classes[UART_TX_CLASS_COUNT];
+static uint8_t    tx_slot_class[UART_TX_SLOTS];  // 每个帧槽当前属于哪个优先级
+
+_Static_assert((UART_TX_QUEUE_DEPTH & (UART_TX_QUEUE_DEPTH - 1)) == 0,
+               "UART_TX_QUEUE_DEPTH must be a power of two");
+// 每个已提交的帧都占着一个槽，队列深度不小于槽总数时入队不会失败
+_Static_assert(UART_TX_QUEUE_DEPTH >= UART_TX_SLOTS,
+               "UART_TX_QUEUE_DEPTH smaller than the number of TX slots");
+_Static_assert(UART_TX_LARGE_SLOT_SIZE >= UART_TX_SMALL_SLOT_SIZE,
+               "large TX slot smaller than small");
+_Static_assert(UART_TX_LARGE_SLOT_SIZE >= COMM_MAX_FRAME, "UART_TX_LARGE_SLOT_SIZE too small");
+_Static_assert(UART_TX_BULK_MAX_SLOTS > 0 && UART_TX_BULK_MAX_SLOTS < UART_TX_SLOTS,
+               "UART_TX_BULK_MAX_SLOTS must leave slots for control frames");
 #endif
 
 // ==================== 接收处理====================
-#if UART_DRIVER_USE_RINGBUFFER
-static void process_with_ringbuffer(void)
+
+/**
+ * @brief 启动（或重新启动）IDLE + DMA 循环接收
+ */
+static void rx_start(void)
 {
-    uint16_t cur_pos = UART_DMA_RX_BUFFER_SIZE - __HAL_DMA_GET_COUNTER(huart3.hdmarx);
-    if (cur_pos != last_dma_pos) {
-        if (cur_pos > last_dma_pos) {
-            uint32_t new_data_size = cur_pos - last_dma_pos;
-            ringbuffer_write(&uart_ringbuffer, &dma_rx_buffer[last_dma_pos], new_data_size);
+    last_dma_pos  = 0;
+    rx_mirror_len = 0;
+    rx_event_pos  = 0;
+    rx_written    = 0;
+    rx_consumed   = 0;
+    rx_lapped     = 0;
+    HAL_UARTEx_ReceiveToIdle_DMA(&huart3, dma_rx_buffer, UART_DMA_RX_BUFFER_SIZE);
+}
+
+/**
+ * @brief DMA 当前写入位置
+ */
+static inline uint16_t rx_dma_pos(void)
+{
+    uint16_t pos = UART_DMA_RX_BUFFER_SIZE - __HAL_DMA_GET_COUNTER(huart3.hdmarx);
+    return (pos >= UART_DMA_RX_BUFFER_SIZE) ? 0 : pos;
+}
+
+/**
+ * @brief 接收事件：累计上次事件以来 DMA 写入的字节数并检查是否套圈，把新数据交给接收中断钩子，
+ *        最后才向主循环公布新的 DMA 位置
+ * @param run_hook 是否调用钩子（设置钩子时只跳过已收到的数据）
+ * @note  在接收事件中断中调用，或在主循环中屏蔽本链路中断后调用；
+ *        半满 / 全满事件保证两次事件之间 DMA 最多写半个缓冲区
+ */
+static void rx_event_update(bool run_hook)
+{
+    uint16_t           cur_pos = rx_dma_pos();
+    uint16_t           from    = rx_event_pos;
+    uart_rx_callback_t hook    = run_hook ? rx_isr_hook : NULL;
+
+    if (cur_pos >= from) {
+        rx_written += (uint32_t)(cur_pos - from);
+    } else {
+        rx_written += (uint32_t)(UART_DMA_RX_BUFFER_SIZE - from) + cur_pos;
+    }
+    // 主循环可能已经消费了本次事件之前到达的数据，差值按有符号数比较
+    if ((int32_t)(rx_written - rx_consumed) >= (int32_t)UART_DMA_RX_BUFFER_SIZE) {
+        rx_lapped = 1;
+    }
+
+    if (hook != NULL && cur_pos != from) {
+        if (cur_pos > from) {
+            hook(&dma_rx_buffer[from], (uint32_t)(cur_pos - from));
         } else {
-            uint32_t first_part = UART_DMA_RX_BUFFER_SIZE - last_dma_pos;
-            ringbuffer_write(&uart_ringbuffer, &dma_rx_buffer[last_dma_pos], first_part);
+            hook(&dma_rx_buffer[from], UART_DMA_RX_BUFFER_SIZE - from);
             if (cur_pos > 0) {
-                ringbuffer_write(&uart_ringbuffer, dma_rx_buffer, cur_pos);
-            }
-        }
-        last_dma_pos = cur_pos;
-
-        if (user_rx_callback != NULL) {
-            uint8_t  temp_buffer[64];
-            uint32_t read_size;
-            while ((read_size = ringbuffer_read(&uart_ringbuffer, temp_buffer, sizeof(temp_buffer)))
-                   > 0) {
-                user_rx_callback(temp_buffer, read_size);
+                hook(dma_rx_buffer, cur_pos);
             }
         }
     }
+    __atomic_store_n(&rx_event_pos, cur_pos, __ATOMIC_RELEASE);
 }
-#else
-static void process_without_ringbuffer(void)
+
+/**
+ * @brief 主循环可以读到的位置（钩子已看过的数据）
+ */
+static inline uint16_t rx_ready_pos(void)
 {
-    uint16_t cur_pos = UART_DMA_RX_BUFFER_SIZE - __HAL_DMA_GET_COUNTER(huart3.hdmarx);
+    return __atomic_load_n(&rx_event_pos, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief 把 DMA 新收到的数据交给接收回调（回绕时分两段）
+ */
+static void rx_process_callback(void)
+{
+    uint16_t cur_pos = rx_ready_pos();
     if (cur_pos != last_dma_pos) {
         if (cur_pos > last_dma_pos) {
             uint32_t new_data_size = cur_pos - last_dma_pos;
@@ -76,91 +170,123 @@ static void process_without_ringbuffer(void)
                 user_rx_callback(dma_rx_buffer, cur_pos);
             }
         }
-        last_dma_pos = cur_pos;
+        uint32_t len = (cur_pos >= last_dma_pos)
+                         ? (uint32_t)(cur_pos - last_dma_pos)
+                         : (uint32_t)(UART_DMA_RX_BUFFER_SIZE - last_dma_pos) + cur_pos;
+        uart_driver_rx_consume(len);
     }
 }
-#endif
 
 // ==================== 发送队列内部函数 ====================
 #if UART_DRIVER_USE_TX_QUEUE
 
 /**
- * @brief 向发送队列写入数据（拷贝）
- * @param data 源数据指针
- * @param len  数据长度
- * @return 0:成功, -1:队列空间不足
+ * @brief 帧槽的全局序号（小帧槽在前）
+ * @param pool 输出参数，帧槽所属的槽池
+ * @return 序号，不是发送帧槽时返回 -1
  */
-static int tx_queue_write(const uint8_t* data, uint32_t len)
+static int32_t tx_slot_id(const uint8_t* frame, frame_pool_t** pool)
 {
-    uint32_t free_space;
-    uint32_t wr, rd;
-
-    __disable_irq();  // 进入临界区
-    wr = tx_wr_idx;
-    rd = tx_rd_idx;
-
-    // 计算剩余空间（环形缓冲区满条件：预留一个单元，避免 wr == rd 歧义）
-    if (wr >= rd) {
-        free_space = (UART_TX_BUFFER_SIZE - wr) + rd - 1;
-    } else {
-        free_space = rd - wr - 1;
+    int32_t index = frame_pool_index(&tx_small_pool, frame);
+    if (index >= 0) {
+        *pool = &tx_small_pool;
+        return index;
     }
-
-    if (len > free_space) {
-        __enable_irq();
-        return -1;  // 队列满
+    index = frame_pool_index(&tx_large_pool, frame);
+    if (index >= 0) {
+        *pool = &tx_large_pool;
+        return UART_TX_SMALL_SLOTS + index;
     }
+    return -1;
+}
 
-    // 拷贝数据
-    for (uint32_t i = 0; i < len; i++) {
-        tx_buffer[wr] = data[i];
-        wr++;
-        if (wr >= UART_TX_BUFFER_SIZE) {
-            wr = 0;
-        }
+/**
+ * @brief 释放帧槽，归还所属优先级的配额
+ */
+static void tx_slot_release(const uint8_t* frame)
+{
+    frame_pool_t* pool;
+    int32_t       id = tx_slot_id(frame, &pool);
+    if (id < 0) {
+        return;
     }
-    tx_wr_idx = wr;  // 更新写索引
-    __enable_irq();
-    return 0;
+    tx_class_t* c = &tx_classes[tx_slot_class[id]];
+    frame_pool_free(pool, frame);
+    __atomic_fetch_sub(&c->queued, 1U, __ATOMIC_RELEASE);
 }
 
 /**
- * @brief 获取待发送数据的连续块
- * @param ptr 输出参数，指向连续数据块的起始地址
- * @return 连续数据块的字节数（0 表示无数据）
+ * @brief 占用优先级配额中的一个帧槽，并更新高水位
+ * @return true:成功, false:配额已用完
  */
-static uint32_t tx_queue_read_linear(uint8_t** ptr)
+static bool tx_class_acquire(tx_class_t* c)
 {
-    uint32_t size;
-    __disable_irq();
-    if (tx_rd_idx == tx_wr_idx) {
-        __enable_irq();
-        *ptr = NULL;
-        return 0;
+    uint32_t n = __atomic_load_n(&c->queued, __ATOMIC_ACQUIRE);
+    do {
+        if (n >= c->limit) {
+            return false;
+        }
+    } while (!__atomic_compare_exchange_n(
+        &c->queued, &n, n + 1U, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+    uint32_t hw = __atomic_load_n(&c->high_water, __ATOMIC_RELAXED);
+    while (n + 1U > hw
+           && !__atomic_compare_exchange_n(
+               &c->high_water, &hw, n + 1U, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
     }
+    return true;
+}
 
-    *ptr = &tx_buffer[tx_rd_idx];
-    if (tx_wr_idx > tx_rd_idx) {
-        size = tx_wr_idx - tx_rd_idx;
-    } else {
-        size = UART_TX_BUFFER_SIZE - tx_rd_idx;  // 到缓冲区末尾
+/**
+ * @brief 按优先级取下一帧
+ * @return true:有已发布的帧
+ */
+static bool tx_next_frame(const uint8_t** p, uint16_t* len, uart_tx_class_t* cls)
+{
+    for (uint32_t i = 0; i < UART_TX_CLASS_COUNT; i++) {
+        if (frame_queue_peek(&tx_classes[i].queue, p, len)) {
+            *cls = (uart_tx_class_t)i;
+            return true;
+        }
     }
-    __enable_irq();
-    return size;
+    return false;
 }
 
 /**
- * @brief DMA 发送完成后，推进读指针
- * @param len 已发送的字节数
+ * @brief 空闲时启动一次 DMA 发送（主循环、中断和发送完成中断都会调用）
+ * @note  用原子交换抢占发送权，不需要关中断
  */
-static void tx_queue_advance(uint32_t len)
+static void tx_kick(void)
 {
-    __disable_irq();
-    tx_rd_idx += len;
-    if (tx_rd_idx >= UART_TX_BUFFER_SIZE) {
-        tx_rd_idx -= UART_TX_BUFFER_SIZE;
+    const uint8_t*  p;
+    uint16_t        len;
+    uart_tx_class_t cls;
+
+    for (;;) {
+        if (__atomic_exchange_n(&tx_in_progress, 1, __ATOMIC_ACQUIRE)) {
+            return;  // 已在发送，完成中断会继续
+        }
+
+        if (tx_next_frame(&p, &len, &cls)) {
+            tx_current       = p;  // 记录本次发送的帧，供回调释放
+            tx_current_class = cls;
+            if (HAL_UART_Transmit_DMA(&huart3, (uint8_t*)p, len) != HAL_OK) {
+                // 启动失败（外设忙，如阻塞发送中）：帧留在队列中。不会有完成中断，
+                // 如果之后没有新帧提交，最后一帧会一直留着，由 uart_driver_tx_retry() 重试
+                tx_current = NULL;
+                __atomic_store_n(&tx_retry_pending, 1U, __ATOMIC_RELAXED);
+                __atomic_store_n(&tx_in_progress, 0, __ATOMIC_RELEASE);
+            }
+            return;
+        }
+
+        __atomic_store_n(&tx_in_progress, 0, __ATOMIC_RELEASE);
+        // 释放发送权之后再检查一次，避免与同时发布的帧错过；
+        // 队首帧尚未发布时直接返回，由它的生产者发布后再启动
+        if (!tx_next_frame(&p, &len, &cls)) {
+            return;
+        }
     }
-    __enable_irq();
 }
 
 #endif /* UART_DRIVER_USE_TX_QUEUE */
@@ -173,18 +299,29 @@ int uart_driver_init(uart_rx_callback_t rx_callback)
     last_dma_pos     = 0;
     tx_in_progress   = 0;
 
-#if UART_DRIVER_USE_RINGBUFFER
-    ringbuffer_init(&uart_ringbuffer, ringbuffer_data, UART_RINGBUFFER_SIZE);
-#endif
-
 #if UART_DRIVER_USE_TX_QUEUE
-    tx_wr_idx      = 0;
-    tx_rd_idx      = 0;
-    tx_current_len = 0;
+    frame_pool_init(&tx_small_pool, tx_small_buffer, UART_TX_SMALL_SLOT_SIZE, UART_TX_SMALL_SLOTS);
+    frame_pool_init(&tx_large_pool, tx_large_buffer, UART_TX_LARGE_SLOT_SIZE, UART_TX_LARGE_SLOTS);
+    for (uint32_t i = 0; i < UART_TX_CLASS_COUNT; i++) {
+        tx_class_t* c = &tx_classes[i];
+        frame_queue_init(&c->queue, c->cells, UART_TX_QUEUE_DEPTH);
+        c->limit      = (i == UART_TX_CLASS_BULK) ? UART_TX_BULK_MAX_SLOTS : UART_TX_SLOTS;
+        c->queued     = 0;
+        c->high_water = 0;
+        c->sent       = 0;
+        c->drops      = 0;
+    }
+    tx_current = NULL;
 #endif
 
-    // 启动 DMA 接收（循环模式）
-    HAL_UART_Receive_DMA(&huart3, dma_rx_buffer, UART_DMA_RX_BUFFER_SIZE);
+    rx_event_pending = 0;
+    rx_error_count   = 0;
+    rx_overrun_count = 0;
+    tx_fail_count    = 0;
+    __atomic_store_n(&rx_restart_pending, 0U, __ATOMIC_RELAXED);
+
+    // 启动 DMA 接收（循环模式），IDLE / 半满 / 全满 事件通过中断通知
+    rx_start();
 
     return 0;
 }
@@ -206,101 +343,343 @@ int uart_driver_send_async(const uint8_t* data, uint32_t len)
     }
 
 #if UART_DRIVER_USE_TX_QUEUE
-    // 1. 将数据写入发送队列
-    if (tx_queue_write(data, len) != 0) {
-        return -1;  // 队列满，发送失败
-    }
-
-    // 2. 如果当前没有正在进行的 DMA 传输，则立即启动一包
-    if (!tx_in_progress) {
-        uint8_t* p;
-        uint32_t chunk = tx_queue_read_linear(&p);
-        if (chunk > 0) {
-            tx_in_progress           = 1;
-            tx_current_len           = chunk;  // 记录本次发送长度，供回调使用
-            HAL_StatusTypeDef status = HAL_UART_Transmit_DMA(&huart3, p, chunk);
-            if (status != HAL_OK) {
-                // DMA 启动失败：回退写指针（丢弃刚入队的数据）
-                __disable_irq();
-                tx_wr_idx -= len;  // 简化回退，实际需循环处理
-                if (tx_wr_idx >= UART_TX_BUFFER_SIZE) {
-                    tx_wr_idx += UART_TX_BUFFER_SIZE;  // 修正负值情况
-                }
-                __enable_irq();
-                tx_in_progress = 0;
-                return -1;
-            }
-        }
+    // 拷贝到一个帧槽中，按控制优先级排队发送
+    uint8_t* slot = uart_driver_tx_reserve(len, UART_TX_CLASS_CONTROL);
+    if (slot == NULL) {
+        __atomic_fetch_add(&tx_fail_count, 1U, __ATOMIC_RELAXED);
+        return -1;  // 没有空闲帧槽，发送失败
     }
-    return 0;  // 数据已入队，发送将在完成后自动继续
+    memcpy(slot, data, len);
+    if (uart_driver_tx_commit(slot, len) != 0) {
+        __atomic_fetch_add(&tx_fail_count, 1U, __ATOMIC_RELAXED);
+        return -1;
+    }
+    return 0;
 
 #else /* 无发送队列，保持原有逻辑 */
     if (tx_in_progress) {
+        tx_fail_count++;
         return -1;
     }
     tx_in_progress           = 1;
     HAL_StatusTypeDef status = HAL_UART_Transmit_DMA(&huart3, (uint8_t*)data, len);
-    return (status == HAL_OK) ? 0 : -1;
+    if (status != HAL_OK) {
+        tx_fail_count++;
+        return -1;
+    }
+    return 0;
 #endif
 }
 
-void uart_driver_poll(void)
+#if UART_DRIVER_USE_TX_QUEUE
+uint8_t* uart_driver_tx_reserve(uint32_t len, uart_tx_class_t cls)
 {
-#if UART_DRIVER_USE_RINGBUFFER
-    process_with_ringbuffer();
-#else
-    process_without_ringbuffer();
-#endif
+    if (len == 0 || len > UART_TX_LARGE_SLOT_SIZE || cls >= UART_TX_CLASS_COUNT) {
+        return NULL;
+    }
+
+    tx_class_t* c = &tx_classes[cls];
+    if (!tx_class_acquire(c)) {
+        __atomic_fetch_add(&c->drops, 1U, __ATOMIC_RELAXED);
+        return NULL;  // 本优先级的配额已用完（批量帧不能占满帧槽）
+    }
+
+    // 小帧优先用小帧槽，小帧槽用完时借用大帧槽
+    uint8_t* slot = NULL;
+    if (len <= UART_TX_SMALL_SLOT_SIZE) {
+        slot = frame_pool_alloc(&tx_small_pool);
+    }
+    if (slot == NULL) {
+        slot = frame_pool_alloc(&tx_large_pool);
+    }
+    if (slot == NULL) {
+        __atomic_fetch_sub(&c->queued, 1U, __ATOMIC_RELEASE);
+        __atomic_fetch_add(&c->drops, 1U, __ATOMIC_RELAXED);
+        return NULL;
+    }
+
+    frame_pool_t* pool;
+    tx_slot_class[tx_slot_id(slot, &pool)] = (uint8_t)cls;
+    return slot;
 }
 
-int uart_driver_is_tx_done(void)
+int uart_driver_tx_commit(uint8_t* frame, uint32_t len)
 {
-#if UART_DRIVER_USE_TX_QUEUE
-    // 当没有正在进行的 DMA 传输且发送队列为空时，才算发送完成
-    return (!tx_in_progress && (tx_rd_idx == tx_wr_idx));
-#else
-    return !tx_in_progress;
+    frame_pool_t* pool;
+    int32_t       id = tx_slot_id(frame, &pool);
+    if (id < 0) {
+        return -1;
+    }
+    if (len == 0) {
+        tx_slot_release(frame);  // 放弃该帧
+        return 0;
+    }
+    if (len > pool->size
+        || !frame_queue_push(&tx_classes[tx_slot_class[id]].queue, frame, (uint16_t)len)) {
+        tx_slot_release(frame);
+        return -1;
+    }
+    tx_kick();
+    return 0;
+}
+
+void uart_driver_get_tx_stats(uart_tx_class_t cls, uart_tx_class_stats_t* stats)
+{
+    if (stats == NULL || cls >= UART_TX_CLASS_COUNT) {
+        return;
+    }
+    const tx_class_t* c = &tx_classes[cls];
+    stats->sent         = c->sent;
+    stats->drops        = c->drops;
+    stats->queued       = (uint16_t)c->queued;
+    stats->high_water   = (uint16_t)c->high_water;
+}
+
+void uart_driver_reset_tx_stats(void)
+{
+    for (uint32_t i = 0; i < UART_TX_CLASS_COUNT; i++) {
+        tx_class_t* c = &tx_classes[i];
+        c->sent       = 0;
+        c->drops      = 0;
+        c->high_water = c->queued;  // 高水位从当前占用量重新开始
+    }
+}
 #endif
+
+void uart_driver_poll(void)
+{
+    // 没有接收事件时直接返回，不再忙等读取 DMA 计数器
+    if (!uart_driver_rx_take_event()) {
+        return;
+    }
+
+    // 套圈时丢弃缓冲区中的数据，被截断的帧由 TinyFrame 的校验和超时丢弃
+    (void)uart_driver_rx_take_overrun();
+    rx_process_callback();
 }
 
-void uart_driver_tx_complete_callback(void)
+int uart_driver_rx_pending(void)
 {
-    // 无论有无队列，先清除发送标志
-    tx_in_progress = 0;
+    return rx_event_pending != 0;
+}
 
-#if UART_DRIVER_USE_TX_QUEUE
-    // 1. 推进队列读指针（释放已发送的数据）
-    if (tx_current_len > 0) {
-        tx_queue_advance(tx_current_len);
-        tx_current_len = 0;
+int uart_driver_rx_take_event(void)
+{
+    if (!rx_event_pending) {
+        return 0;
     }
+    // 先清标志再处理：处理期间到达的新事件会重新置位，不会丢失
+    rx_event_pending = 0;
+    return 1;
+}
 
-    // 2. 检查队列中是否还有待发数据
-    uint8_t* p;
-    uint32_t chunk = tx_queue_read_linear(&p);
-    if (chunk > 0) {
-        tx_in_progress = 1;
-        tx_current_len = chunk;
-        HAL_UART_Transmit_DMA(&huart3, p, chunk);
+uint32_t uart_driver_rx_peek(const uint8_t** data)
+{
+    uint16_t wr = rx_ready_pos();
+
+    *data = &dma_rx_buffer[last_dma_pos];
+    if (wr >= last_dma_pos) {
+        return wr - last_dma_pos;
     }
-#else
-    // 无队列时仅清除标志
+    return UART_DMA_RX_BUFFER_SIZE - last_dma_pos;
+}
+
+uint32_t uart_driver_rx_peek_wrap(const uint8_t** data)
+{
+    uint16_t wr = rx_ready_pos();
+
+    *data = &dma_rx_buffer[last_dma_pos];
+    if (wr >= last_dma_pos) {
+        return wr - last_dma_pos;
+    }
+
+    // 回绕：把缓冲区开头新到的部分补拷到镜像区
+    uint16_t head = (wr < UART_RX_WRAP_GUARD) ? wr : UART_RX_WRAP_GUARD;
+    if (head > rx_mirror_len) {
+        memcpy(&dma_rx_buffer[UART_DMA_RX_BUFFER_SIZE + rx_mirror_len],
+               &dma_rx_buffer[rx_mirror_len], head - rx_mirror_len);
+        rx_mirror_len = head;
+    }
+    return (UART_DMA_RX_BUFFER_SIZE - last_dma_pos) + rx_mirror_len;
+}
+
+void uart_driver_rx_consume(uint32_t len)
+{
+    uint32_t pos = last_dma_pos + len;
+    if (pos >= UART_DMA_RX_BUFFER_SIZE) {
+        pos -= UART_DMA_RX_BUFFER_SIZE;  // 读指针回绕，镜像区失效
+        rx_mirror_len = 0;
+    }
+    last_dma_pos = (uint16_t)pos;
+    rx_consumed += len;
+}
+
+int uart_driver_rx_take_overrun(void)
+{
+    // 接收错误后在这里（主循环）重新启动接收：rx_start() 会清零读写位置，
+    // 在中断里做会打断正在进行的 peek / consume。重启前钩子照样看一遍最后收到的数据
+    if (__atomic_exchange_n(&rx_restart_pending, 0U, __ATOMIC_ACQUIRE)) {
+        uint32_t mask = irq_mask_from(IRQ_PRIO_LINK);
+        rx_event_update(true);
+        if (rx_lapped) {
+            rx_lap_count++;
+        }
+        rx_start();
+        irq_unmask(mask);
+        return 1;
+    }
+
+    if (!rx_lapped) {
+        return 0;
+    }
+
+    // 丢弃缓冲区中的全部数据，从 DMA 当前位置重新开始；与接收事件中断互斥。
+    // 丢弃前钩子照样看一遍最新的数据，其中的急停帧不会因套圈漏掉
+    uint32_t mask = irq_mask_from(IRQ_PRIO_LINK);
+    rx_event_update(true);
+    last_dma_pos  = rx_event_pos;
+    rx_mirror_len = 0;
+    rx_consumed   = rx_written;
+    rx_lapped     = 0;
+    irq_unmask(mask);
+
+    rx_lap_count++;
+    return 1;
+}
+
+void uart_driver_rx_event_callback(uint16_t pos)
+{
+    (void)pos;  // 位置直接从 DMA 计数器读取
+    rx_event_update(true);
+    rx_event_pending = 1;
+}
+
+void uart_driver_error_callback(void)
+{
+    rx_error_count++;
+    if ((huart3.ErrorCode & HAL_UART_ERROR_ORE) != 0U) {
+        rx_overrun_count++;
+    }
+
+    // 溢出 / 噪声 / 帧错误会让 HAL 终止 DMA 接收；这里只停下接收，
+    // 由主循环在 uart_driver_rx_take_overrun() 中重新启动（同 tx_retry_pending）
+    HAL_UART_AbortReceive(&huart3);
+    __atomic_store_n(&rx_restart_pending, 1U, __ATOMIC_RELEASE);
+    rx_event_pending = 1;  // 唤醒主循环
+}
+
+void uart_driver_set_rx_isr_hook(uart_rx_callback_t hook)
+{
+    uint32_t mask = irq_mask_from(IRQ_PRIO_LINK);  // 与接收事件中断互斥
+    rx_event_update(false);                         // 只看设置之后收到的数据
+    rx_isr_hook = hook;
+    irq_unmask(mask);
+}
+
+int uart_driver_baudrate_supported(uint32_t baud)
+{
+    if (baud == 0) {
+        return 0;
+    }
+
+    // 16 倍过采样：BRR = PCLK / baud（含 4 位小数），取最接近的值
+    uint32_t pclk = HAL_RCC_GetPCLK1Freq();
+    uint32_t brr  = (pclk + baud / 2U) / baud;
+    if (brr < 16U || brr > 0xFFFFU) {
+        return 0;
+    }
+
+    uint32_t actual = pclk / brr;
+    uint32_t error  = (actual > baud) ? (actual - baud) : (baud - actual);
+    return (error * 1000U / baud) <= UART_BAUD_MAX_ERROR_PERMILLE;
+}
+
+int uart_driver_set_baudrate(uint32_t baud)
+{
+    if (!uart_driver_baudrate_supported(baud)) {
+        return -1;
+    }
+    // 占住发送权：切换期间中断里提交的帧留在队列中，切换后以新波特率发出
+    if (__atomic_exchange_n(&tx_in_progress, 1, __ATOMIC_ACQUIRE)) {
+        return -1;  // 最后一帧还没有移出移位寄存器
+    }
+
+    // 停止接收后重新配置外设（状态为 READY 时 HAL_UART_Init 不会重新初始化引脚和 DMA）。
+    // 期间屏蔽本链路的中断（错误回调会请求重新启动接收），插补 tick 不受影响
+    uint32_t mask = irq_mask_from(IRQ_PRIO_LINK);
+    HAL_UART_AbortReceive(&huart3);
+    huart3.Init.BaudRate = baud;
+    int ret = (HAL_UART_Init(&huart3) == HAL_OK) ? 0 : -1;
+
+    rx_event_pending = 0;
+    __atomic_store_n(&rx_restart_pending, 0U, __ATOMIC_RELAXED);  // 这里已经重新启动
+    rx_start();
+    irq_unmask(mask);
+
+    __atomic_store_n(&tx_in_progress, 0, __ATOMIC_RELEASE);
+#if UART_DRIVER_USE_TX_QUEUE
+    tx_kick();
 #endif
+    return ret;
+}
+
+uint32_t uart_driver_get_baudrate(void)
+{
+    return huart3.Init.BaudRate;
 }
 
-#if UART_DRIVER_USE_RINGBUFFER
-uint32_t uart_driver_read_buffer(uint8_t* buffer, uint32_t size)
+uint32_t uart_driver_get_rx_error_count(void)
 {
-    return ringbuffer_read(&uart_ringbuffer, buffer, size);
+    return rx_error_count;
 }
 
-uint32_t uart_driver_get_available(void)
+uint32_t uart_driver_get_rx_overflow_count(void)
 {
-    return ringbuffer_available(&uart_ringbuffer);
+    return rx_overrun_count + rx_lap_count;
 }
 
-void uart_driver_clear_buffer(void)
+uint32_t uart_driver_get_tx_fail_count(void)
 {
-    ringbuffer_clear(&uart_ringbuffer);
+    return tx_fail_count;
 }
+
+int uart_driver_is_tx_done(void)
+{
+#if UART_DRIVER_USE_TX_QUEUE
+    // 当没有正在进行的 DMA 传输且发送队列为空时，才算发送完成
+    return (!tx_in_progress && frame_queue_is_empty(&tx_classes[UART_TX_CLASS_CONTROL].queue)
+            && frame_queue_is_empty(&tx_classes[UART_TX_CLASS_BULK].queue));
+#else
+    return !tx_in_progress;
+#endif
+}
+
+void uart_driver_tx_retry(void)
+{
+#if UART_DRIVER_USE_TX_QUEUE
+    if (__atomic_exchange_n(&tx_retry_pending, 0U, __ATOMIC_ACQUIRE)) {
+        tx_kick();  // 再次失败时重新置位
+    }
 #endif
+}
+
+void uart_driver_tx_complete_callback(void)
+{
+#if UART_DRIVER_USE_TX_QUEUE
+    // 1. 移出已发送的帧，释放其帧槽
+    if (tx_current != NULL) {
+        tx_class_t* c = &tx_classes[tx_current_class];
+        frame_queue_pop(&c->queue);
+        c->sent++;
+        tx_slot_release(tx_current);
+        tx_current = NULL;
+    }
+
+    // 2. 释放发送权，按优先级发送下一帧（控制帧在批量帧之前插队）
+    __atomic_store_n(&tx_in_progress, 0, __ATOMIC_RELEASE);
+    tx_kick();
+#else
+    // 无队列时仅清除标志
+    tx_in_progress = 0;
+#endif
+}
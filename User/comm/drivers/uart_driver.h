@@ -8,34 +8,69 @@ extern "C" {
 #include <stddef.h>
 #include <stdint.h>
 
+#include "../comm_config.h"
+
 // ==================== 配置选项 ====================
 // 外部可以在 comm_config.h 中定义这些选项来覆盖默认值
 
-#ifndef UART_DRIVER_USE_RINGBUFFER
-#define UART_DRIVER_USE_RINGBUFFER 0  // 接收环形缓冲区（默认关闭）
-#endif
-
 #ifndef UART_DRIVER_USE_TX_QUEUE
 #define UART_DRIVER_USE_TX_QUEUE 1  // 发送队列（默认开启）
 #endif
 
-#ifndef UART_DMA_RX_BUFFER_SIZE
-#define UART_DMA_RX_BUFFER_SIZE 1024  // DMA 接收缓冲区大小
+// 与帧长度相关的尺寸由 comm_config.h 从 COMM_MAX_FRAME 推导，这里不再给默认值
+#if !defined(UART_DMA_RX_BUFFER_SIZE) || !defined(UART_RX_WRAP_GUARD) \
+    || !defined(UART_TX_LARGE_SLOT_SIZE)
+#error "UART buffer sizes are derived from COMM_MAX_FRAME in comm_config.h"
 #endif
 
-#if UART_DRIVER_USE_RINGBUFFER
-#ifndef UART_RINGBUFFER_SIZE
-#define UART_RINGBUFFER_SIZE 512  // 软件接收 ringbuffer 大小
-#endif
+#ifndef UART_BAUD_MAX_ERROR_PERMILLE
+#define UART_BAUD_MAX_ERROR_PERMILLE 20  // 可接受的波特率误差（‰），超出的波特率视为不支持
 #endif
 
 #if UART_DRIVER_USE_TX_QUEUE
-#ifndef UART_TX_BUFFER_SIZE
-#define UART_TX_BUFFER_SIZE 512  // 发送队列缓冲区大小
+#ifndef UART_TX_SMALL_SLOT_SIZE
+#define UART_TX_SMALL_SLOT_SIZE 64  // 小帧槽大小（应答、状态帧）
+#endif
+
+#ifndef UART_TX_SMALL_SLOTS
+#define UART_TX_SMALL_SLOTS 8  // 小帧槽数量
+#endif
+
+#ifndef UART_TX_LARGE_SLOTS
+#define UART_TX_LARGE_SLOTS 2  // 大帧槽数量
+#endif
+
+#ifndef UART_TX_BULK_MAX_SLOTS
+#define UART_TX_BULK_MAX_SLOTS (UART_TX_SMALL_SLOTS + UART_TX_LARGE_SLOTS - 2)  // 批量帧最多占用的帧槽数
+#endif
+
+#ifndef UART_TX_QUEUE_DEPTH
+#define UART_TX_QUEUE_DEPTH 16  // 待发送帧队列深度（2 的幂，不小于槽总数）
 #endif
 #endif
 // ================================================
 
+/**
+ * @brief 发送优先级
+ * @note  每发完一帧都先发高优先级队列中的帧；批量帧最多占用
+ *        UART_TX_BULK_MAX_SLOTS 个帧槽，其余帧槽留给控制帧
+ */
+typedef enum {
+    UART_TX_CLASS_CONTROL = 0,  // 控制应答 / 确认
+    UART_TX_CLASS_BULK,         // 批量遥测（状态推送等）
+    UART_TX_CLASS_COUNT,
+} uart_tx_class_t;
+
+/**
+ * @brief 单个发送优先级的统计
+ */
+typedef struct {
+    uint32_t sent;        // 已发送帧数
+    uint32_t drops;       // 丢弃的帧数（超出配额或没有空闲帧槽）
+    uint16_t queued;      // 当前占用的帧槽数（含正在发送的帧）
+    uint16_t high_water;  // queued 的历史最大值
+} uart_tx_class_stats_t;
+
 /**
  * @brief UART 数据接收回调函数
  * @param data 接收到的数据
@@ -62,47 +97,171 @@ int uart_driver_send(const uint8_t* data, uint32_t len);
  * @brief 发送数据（异步，非阻塞）
  * @param data 要发送的数据
  * @param len  数据长度
- * @return 0:成功, -1:失败（队列满或 DMA 启动失败）
+ * @return 0:成功, -1:失败（没有足够大的空闲帧槽或 DMA 启动失败）
+ * @note  有发送队列时数据被拷贝到一个帧槽中（控制优先级），长度不能超过大帧槽
  */
 int uart_driver_send_async(const uint8_t* data, uint32_t len);
 
+#if UART_DRIVER_USE_TX_QUEUE
+/**
+ * @brief 分配一个发送帧槽，调用者直接在其中组帧（零拷贝发送）
+ * @param len 最多要写入的字节数
+ * @param cls 发送优先级
+ * @return 帧槽指针，NULL 表示该优先级的配额已用完或没有足够大的空闲槽（计入丢弃数）
+ * @note  主循环和中断都可以调用，各自持有自己的槽，互不等待；
+ *        必须随后用同一指针调用 uart_driver_tx_commit()
+ */
+uint8_t* uart_driver_tx_reserve(uint32_t len, uart_tx_class_t cls);
+
+/**
+ * @brief 提交帧槽：排入所属优先级的发送队列并启动发送
+ * @param frame uart_driver_tx_reserve() 返回的指针
+ * @param len 实际写入的字节数（不超过预留长度，0 表示放弃并释放该槽）
+ * @return 0:成功, -1:指针或长度无效（槽已释放）
+ * @note  同一优先级内按提交顺序发送
+ */
+int uart_driver_tx_commit(uint8_t* frame, uint32_t len);
+
+/**
+ * @brief 获取发送优先级统计
+ * @param cls 发送优先级
+ * @param stats 输出
+ */
+void uart_driver_get_tx_stats(uart_tx_class_t cls, uart_tx_class_stats_t* stats);
+
+/**
+ * @brief 清零发送计数，高水位从当前占用量重新开始
+ */
+void uart_driver_reset_tx_stats(void);
+#endif
+
+/**
+ * @brief 波特率能否由当前外设时钟准确产生
+ * @param baud 波特率
+ * @return 1:支持, 0:不支持（分频系数超出范围或误差超过 UART_BAUD_MAX_ERROR_PERMILLE）
+ * @note  USART3 挂在 APB1（36MHz）上，16 倍过采样时最高 2.25Mbaud
+ */
+int uart_driver_baudrate_supported(uint32_t baud);
+
+/**
+ * @brief 切换波特率，并重新启动 DMA 接收
+ * @param baud 新波特率
+ * @return 0:成功, -1:不支持该波特率或 DMA 发送正在进行（稍后重试）
+ * @note  只能在主循环中调用，先等 uart_driver_is_tx_done() 为真，已排队的帧会以新波特率发出；
+ *        接收缓冲区中尚未处理的数据（旧波特率下收到的）被丢弃
+ */
+int uart_driver_set_baudrate(uint32_t baud);
+
+/**
+ * @brief 当前波特率
+ */
+uint32_t uart_driver_get_baudrate(void);
+
 /**
  * @brief 轮询处理（在主循环中调用，用于接收）
+ * @note  仅在中断报告过接收事件后才处理数据，无事件时立即返回
  */
 void uart_driver_poll(void);
 
 /**
- * @brief 检查发送是否完成（仅当无队列且无发送时）
- * @return 1:完成, 0:进行中
+ * @brief 是否有尚未处理的接收事件
+ * @return 1:有待处理数据, 0:无
+ * @note  主循环可在关中断状态下检查此标志后执行 __WFI()
  */
-int uart_driver_is_tx_done(void);
+int uart_driver_rx_pending(void);
 
-#if UART_DRIVER_USE_RINGBUFFER
 /**
- * @brief 从内部接收缓冲区读取数据
- * @param buffer 输出缓冲区
- * @param size   缓冲区大小
- * @return 实际读取的字节数
+ * @brief 取走接收事件标志
+ * @return 1:自上次调用以来有接收事件, 0:无
+ * @note  使用 peek/consume 接口直接解析时，用它代替 uart_driver_poll()
  */
-uint32_t uart_driver_read_buffer(uint8_t* buffer, uint32_t size);
+int uart_driver_rx_take_event(void);
 
 /**
- * @brief 获取内部接收缓冲区中可用数据量
- * @return 可用数据字节数
+ * @brief 查看 DMA 缓冲区中未消费的数据（不拷贝）
+ * @param data 输出参数，指向第一个未消费字节
+ * @return 从 data 开始的连续字节数（数据回绕时只到缓冲区末尾）
+ * @note  只到最近一次接收事件为止：接收中断钩子已经看过这些字节，之后到达的等下一个事件
  */
-uint32_t uart_driver_get_available(void);
+uint32_t uart_driver_rx_peek(const uint8_t** data);
 
 /**
- * @brief 清空内部接收缓冲区
+ * @brief 同 uart_driver_rx_peek，但数据回绕时把开头部分镜像到缓冲区尾部的保护区，
+ *        使跨越末尾的帧在内存中连续
+ * @param data 输出参数，指向第一个未消费字节
+ * @return 连续字节数（回绕部分最多 UART_RX_WRAP_GUARD 字节）
+ * @note  只拷贝跨越末尾的那一小段，每个字节最多镜像一次
  */
-void uart_driver_clear_buffer(void);
-#endif
+uint32_t uart_driver_rx_peek_wrap(const uint8_t** data);
+
+/**
+ * @brief 消费（释放）已处理的接收数据
+ * @param len 字节数，不得超过最近一次 peek 返回值
+ */
+void uart_driver_rx_consume(uint32_t len);
+
+/**
+ * @brief 检查 DMA 是否套圈（未消费的数据达到整个缓冲区，最早的字节已被覆盖），
+ *        以及接收错误后重新启动接收
+ * @return 1:套圈过或接收已重新启动，缓冲区中的数据已全部丢弃；0:正常
+ * @note  在主循环中解析前调用；返回 1 时调用者应复位解析器（跨越丢失数据的半帧无效）。
+ *        套圈计入 uart_driver_get_rx_overflow_count()
+ */
+int uart_driver_rx_take_overrun(void);
+
+/**
+ * @brief 接收事件回调（由 HAL_UARTEx_RxEventCallback 调用）
+ * @param pos DMA 缓冲区中的当前写入位置
+ * @note  IDLE、DMA 半满、DMA 全满都会触发
+ */
+void uart_driver_rx_event_callback(uint16_t pos);
+
+/**
+ * @brief 设置接收中断钩子：每个接收事件中以新收到的数据调用（DMA 回绕时分两段）
+ * @param hook 钩子，NULL 取消
+ * @note  在接收事件中断中执行，必须短而有界；数据仍留在 DMA 缓冲区中，照常由主循环处理。
+ *        钩子看过的数据才交给主循环，所以钩子总是先于解析看到每一帧
+ */
+void uart_driver_set_rx_isr_hook(uart_rx_callback_t hook);
+
+/**
+ * @brief 错误回调（由 HAL_UART_ErrorCallback 调用），停止接收并请求重新启动
+ * @note  接收由主循环在 uart_driver_rx_take_overrun() 中重新启动
+ */
+void uart_driver_error_callback(void);
+
+/**
+ * @brief 获取接收错误（溢出/噪声/帧错误）次数
+ */
+uint32_t uart_driver_get_rx_error_count(void);
+
+/**
+ * @brief 获取接收溢出次数（硬件溢出错误 + DMA 套圈），接收到的数据有丢失
+ */
+uint32_t uart_driver_get_rx_overflow_count(void);
+
+/**
+ * @brief 获取 uart_driver_send_async() 失败次数
+ */
+uint32_t uart_driver_get_tx_fail_count(void);
+
+/**
+ * @brief 检查发送是否完成（仅当无队列且无发送时）
+ * @return 1:完成, 0:进行中
+ */
+int uart_driver_is_tx_done(void);
 
 /**
  * @brief DMA 传输完成回调（由 HAL_UART_TxCpltCallback 调用）
  */
 void uart_driver_tx_complete_callback(void);
 
+/**
+ * @brief 重试启动失败的 DMA 发送（帧留在队列中，没有完成中断来接着发）
+ * @note  在 1ms tick 推迟的部分（PendSV）中调用；没有失败时只读一个标志
+ */
+void uart_driver_tx_retry(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,42 @@
+#include "batch_codec.h"
+
+#include "protocol_codec.h"
+
+uint16_t proto_decode_batch_item(const uint8_t* data, uint16_t len, proto_batch_item_t* out)
+{
+    uint16_t item_len = 0U;
+    if (data == 0 || out == 0 || !proto_read_u16_le(data, len, 2U, &item_len)) {
+        return 0U;
+    }
+    if ((uint32_t)4U + item_len > len) {
+        return 0U;
+    }
+    out->type    = data[0];
+    out->cmd     = data[1];
+    out->len     = item_len;
+    out->payload = &data[4];
+    return (uint16_t)(4U + item_len);
+}
+
+bool proto_decode_batch_req(const uint8_t* payload, uint16_t len, proto_batch_req_t* out)
+{
+    if (payload == 0 || out == 0 || len < 2U) {
+        return false;
+    }
+    out->flags     = payload[0];
+    out->count     = payload[1];
+    out->items     = &payload[2];
+    out->items_len = (uint16_t)(len - 2U);
+
+    uint16_t           off = 0U;
+    proto_batch_item_t item;
+    for (uint8_t i = 0; i < out->count; ++i) {
+        uint16_t used =
+            proto_decode_batch_item(&out->items[off], (uint16_t)(out->items_len - off), &item);
+        if (used == 0U) {
+            return false;
+        }
+        off = (uint16_t)(off + used);
+    }
+    return out->count > 0U && off == out->items_len;
+}
@@ -0,0 +1,35 @@
+#ifndef BATCH_CODEC_H
+#define BATCH_CODEC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint8_t        flags;
+    uint8_t        count;
+    const uint8_t* items;  // count * [type:u8][cmd:u8][len:u16][payload...]
+    uint16_t       items_len;
+} proto_batch_req_t;
+
+typedef struct {
+    uint8_t        type;
+    uint8_t        cmd;
+    const uint8_t* payload;
+    uint16_t       len;
+} proto_batch_item_t;
+
+// Validates every item up front, so a malformed batch runs nothing.
+bool proto_decode_batch_req(const uint8_t* payload, uint16_t len, proto_batch_req_t* out);
+
+// Decodes the item at data; returns the bytes it occupies, 0 if truncated.
+uint16_t proto_decode_batch_item(const uint8_t* data, uint16_t len, proto_batch_item_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // BATCH_CODEC_H
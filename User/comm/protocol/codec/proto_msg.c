@@ -0,0 +1,211 @@
+#include "proto_msg.h"
+
+#include <stddef.h>
+
+#include "protocol_codec.h"
+
+// 长度已整体检查过，逐字段读写不再检查边界
+
+static inline uint16_t put_u8(uint8_t* buf, uint16_t off, uint8_t v)
+{
+    buf[off] = v;
+    return (uint16_t)(off + 1U);
+}
+
+static inline uint16_t put_u16(uint8_t* buf, uint16_t off, uint16_t v)
+{
+    proto_write_u16_le(buf, off, v);
+    return (uint16_t)(off + 2U);
+}
+
+static inline uint16_t put_u32(uint8_t* buf, uint16_t off, uint32_t v)
+{
+    proto_write_u32_le(buf, off, v);
+    return (uint16_t)(off + 4U);
+}
+
+static inline uint16_t put_f32(uint8_t* buf, uint16_t off, float v)
+{
+    proto_write_f32_le(buf, off, v);
+    return (uint16_t)(off + 4U);
+}
+
+static inline uint16_t get_u8(const uint8_t* data, uint16_t len, uint16_t off, uint8_t* out)
+{
+    (void)len;
+    *out = data[off];
+    return (uint16_t)(off + 1U);
+}
+
+static inline uint16_t get_u16(const uint8_t* data, uint16_t len, uint16_t off, uint16_t* out)
+{
+    (void)proto_read_u16_le(data, len, off, out);
+    return (uint16_t)(off + 2U);
+}
+
+static inline uint16_t get_u32(const uint8_t* data, uint16_t len, uint16_t off, uint32_t* out)
+{
+    (void)proto_read_u32_le(data, len, off, out);
+    return (uint16_t)(off + 4U);
+}
+
+static inline uint16_t get_f32(const uint8_t* data, uint16_t len, uint16_t off, float* out)
+{
+    (void)proto_read_f32_le(data, len, off, out);
+    return (uint16_t)(off + 4U);
+}
+
+#define PUT_FIELD(kind, field) off = put_##kind(buf, off, in->field);
+#define GET_FIELD(kind, field) off = get_##kind(payload, len, off, &out->field);
+
+#define PROTO_MSG_CODEC(name, NAME)                                                                \
+    uint16_t proto_encode_##name(const proto_##name##_t* in, uint8_t* buf, uint16_t buf_size)      \
+    {                                                                                              \
+        if (in == NULL || buf == NULL || buf_size < PROTO_SIZE_##NAME) {                           \
+            return 0U;                                                                             \
+        }                                                                                          \
+        uint16_t off = 0U;                                                                         \
+        PROTO_MSG_##NAME(PUT_FIELD) return off;                                                    \
+    }                                                                                              \
+                                                                                                   \
+    bool proto_decode_##name(const uint8_t* payload, uint16_t len, proto_##name##_t* out)          \
+    {                                                                                              \
+        if (payload == NULL || out == NULL || len != PROTO_SIZE_##NAME) {                          \
+            return false;                                                                          \
+        }                                                                                          \
+        uint16_t off = 0U;                                                                         \
+        PROTO_MSG_##NAME(GET_FIELD)(void) off;                                                     \
+        return true;                                                                               \
+    }
+
+PROTO_SCHEMA_MESSAGES(PROTO_MSG_CODEC)
+
+// ==================== 变长请求 ====================
+// off 用 32 位，个数相乘后也不会回绕；每一项先检查剩余长度再读
+
+// 从 *off 起取 size 字节作为数组，剩余长度不够时返回 false
+static inline bool var_take(const uint8_t*  payload,
+                            uint16_t        len,
+                            uint32_t*       off,
+                            uint32_t        size,
+                            const uint8_t** out)
+{
+    if (size > len - *off) {
+        return false;
+    }
+    *out = (size != 0U) ? &payload[*off] : NULL;
+    *off += size;
+    return true;
+}
+
+#define VAR_GET_FIELD(kind, field)                                                                 \
+    if (len - off < PROTO_WIRE_SIZE_##kind) {                                                      \
+        return false;                                                                              \
+    }                                                                                              \
+    off = get_##kind(payload, len, (uint16_t)off, &out->field);
+#define VAR_GET_ARRAY(kind, field, count)                                                          \
+    if (!var_take(payload, len, &off, (uint32_t)(count)*PROTO_WIRE_SIZE_##kind, &out->field)) {    \
+        return false;                                                                              \
+    }
+#define VAR_GET_MSGS(name, NAME, field, count)                                                     \
+    if (!var_take(payload, len, &off, (uint32_t)(count)*PROTO_SIZE_##NAME, &out->field)) {         \
+        return false;                                                                              \
+    }
+#define VAR_GET_REST(kind, field)                                                                  \
+    if ((len - off) % PROTO_WIRE_SIZE_##kind != 0U) {                                              \
+        return false;                                                                              \
+    }                                                                                              \
+    out->field##_count = (uint16_t)((len - off) / PROTO_WIRE_SIZE_##kind);                         \
+    (void)var_take(payload, len, &off, len - off, &out->field);
+// 负载在前一个可选字段处结束后，后面的可选字段都不再出现
+#define VAR_GET_OPT(kind, field)                                                                   \
+    out->field       = 0;                                                                          \
+    out->has_##field = opt && len - off >= PROTO_WIRE_SIZE_##kind;                                 \
+    if (out->has_##field) {                                                                        \
+        off = get_##kind(payload, len, (uint16_t)off, &out->field);                                \
+    } else {                                                                                       \
+        opt = false;                                                                               \
+    }
+
+// 字段表中的个数表达式通过 m 引用已解出的字段
+#define PROTO_VAR_REQ_CODEC(name, NAME)                                                            \
+    bool proto_decode_##name(const uint8_t* payload, uint16_t len, proto_##name##_t* out)          \
+    {                                                                                              \
+        if ((payload == NULL && len != 0U) || out == NULL) {                                       \
+            return false;                                                                          \
+        }                                                                                          \
+        const proto_##name##_t* m   = out;                                                         \
+        uint32_t                off = 0U;                                                          \
+        bool                    opt = true;                                                        \
+        PROTO_MSG_##NAME(VAR_GET_FIELD, VAR_GET_ARRAY, VAR_GET_MSGS, VAR_GET_REST, VAR_GET_OPT)    \
+        (void)m;                                                                                   \
+        (void)opt;                                                                                 \
+        return off == len;                                                                         \
+    }
+
+PROTO_SCHEMA_VAR_REQUESTS(PROTO_VAR_REQ_CODEC)
+
+// ==================== 变长应答 ====================
+
+#define VAR_SIZE_FIELD(kind, field)             size += PROTO_WIRE_SIZE_##kind;
+#define VAR_SIZE_ARRAY(kind, field, count)      size += (uint32_t)(count)*PROTO_WIRE_SIZE_##kind;
+#define VAR_SIZE_MSGS(name, NAME, field, count) size += (uint32_t)(count)*PROTO_SIZE_##NAME;
+#define VAR_SIZE_REST(kind, field) \
+    size += (uint32_t)m->field##_count * PROTO_WIRE_SIZE_##kind;
+#define VAR_SIZE_OPT(kind, field)                                                                  \
+    if (opt && m->has_##field) {                                                                   \
+        size += PROTO_WIRE_SIZE_##kind;                                                            \
+    } else {                                                                                       \
+        opt = false;                                                                               \
+    }
+
+#define VAR_PUT_ARRAY(kind, field, count)                                                          \
+    for (uint32_t i = 0; i < (uint32_t)(count); ++i) {                                             \
+        off = put_##kind(buf, off, in->field[i]);                                                  \
+    }
+#define VAR_PUT_MSGS(name, NAME, field, count)                                                     \
+    for (uint32_t i = 0; i < (uint32_t)(count); ++i) {                                             \
+        off = (uint16_t)(off + proto_encode_##name(&in->field[i], &buf[off], PROTO_SIZE_##NAME));  \
+    }
+#define VAR_PUT_REST(kind, field)                                                                  \
+    for (uint16_t i = 0; i < in->field##_count; ++i) {                                             \
+        off = put_##kind(buf, off, in->field[i]);                                                  \
+    }
+#define VAR_PUT_OPT(kind, field)                                                                   \
+    if (opt && in->has_##field) {                                                                  \
+        off = put_##kind(buf, off, in->field);                                                     \
+    } else {                                                                                       \
+        opt = false;                                                                               \
+    }
+
+#define PROTO_VAR_RESP_CODEC(name, NAME)                                                           \
+    uint32_t proto_size_##name(const proto_##name##_t* in)                                         \
+    {                                                                                              \
+        if (in == NULL) {                                                                          \
+            return 0U;                                                                             \
+        }                                                                                          \
+        const proto_##name##_t* m    = in;                                                         \
+        uint32_t                size = 0U;                                                         \
+        bool                    opt  = true;                                                       \
+        PROTO_MSG_##NAME(                                                                          \
+            VAR_SIZE_FIELD, VAR_SIZE_ARRAY, VAR_SIZE_MSGS, VAR_SIZE_REST, VAR_SIZE_OPT)            \
+        (void)m;                                                                                   \
+        (void)opt;                                                                                 \
+        return size;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    uint16_t proto_encode_##name(const proto_##name##_t* in, uint8_t* buf, uint16_t buf_size)      \
+    {                                                                                              \
+        if (in == NULL || buf == NULL || proto_size_##name(in) > buf_size) {                       \
+            return 0U;                                                                             \
+        }                                                                                          \
+        const proto_##name##_t* m   = in;                                                          \
+        uint16_t                off = 0U;                                                          \
+        bool                    opt = true;                                                        \
+        PROTO_MSG_##NAME(PUT_FIELD, VAR_PUT_ARRAY, VAR_PUT_MSGS, VAR_PUT_REST, VAR_PUT_OPT)        \
+        (void)m;                                                                                   \
+        (void)opt;                                                                                 \
+        return off;                                                                                \
+    }
+
+PROTO_SCHEMA_VAR_REPLIES(PROTO_VAR_RESP_CODEC)
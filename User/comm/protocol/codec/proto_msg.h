@@ -0,0 +1,139 @@
+#ifndef PROTO_MSG_H
+#define PROTO_MSG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "protocol_schema.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ------------------------------------------------------------------
+// 定长消息，由 PROTO_SCHEMA_MESSAGES 生成：
+//   proto_<名称>_t          字段按线上顺序排列
+//   PROTO_SIZE_<大写名称>   编码长度（字节）
+//   proto_encode_<名称>()   返回 PROTO_SIZE_<大写名称>，buf_size 不够时返回 0
+//   proto_decode_<名称>()   负载长度必须恰好为 PROTO_SIZE_<大写名称>
+// ------------------------------------------------------------------
+
+#define PROTO_MSG_CTYPE_u8  uint8_t
+#define PROTO_MSG_CTYPE_u16 uint16_t
+#define PROTO_MSG_CTYPE_u32 uint32_t
+#define PROTO_MSG_CTYPE_f32 float
+
+#define PROTO_MSG_FIELD(kind, field) PROTO_MSG_CTYPE_##kind field;
+#define PROTO_MSG_STRUCT(name, NAME)                                                               \
+    typedef struct {                                                                               \
+        PROTO_MSG_##NAME(PROTO_MSG_FIELD)                                                          \
+    } proto_##name##_t;
+
+#define PROTO_MSG_FIELD_SIZE(kind, field) +PROTO_WIRE_SIZE_##kind
+#define PROTO_MSG_SIZE(name, NAME) \
+    PROTO_SIZE_##NAME = 0U PROTO_MSG_##NAME(PROTO_MSG_FIELD_SIZE),
+
+#define PROTO_MSG_PROTOTYPES(name, NAME)                                                           \
+    uint16_t proto_encode_##name(const proto_##name##_t* in, uint8_t* buf, uint16_t buf_size);     \
+    bool     proto_decode_##name(const uint8_t* payload, uint16_t len, proto_##name##_t* out);
+
+PROTO_SCHEMA_MESSAGES(PROTO_MSG_STRUCT)
+
+enum { PROTO_SCHEMA_MESSAGES(PROTO_MSG_SIZE) };
+
+PROTO_SCHEMA_MESSAGES(PROTO_MSG_PROTOTYPES)
+
+// ------------------------------------------------------------------
+// 变长请求，由 PROTO_SCHEMA_VAR_REQUESTS 生成：
+//   proto_<名称>_t          定长字段按值保存；数组字段指向负载中的原始字节（不拷贝，
+//                           只在处理函数返回前有效），元素用 proto_wire_<类型>() 读取
+//   proto_decode_<名称>()   按字段表逐项检查长度，负载长度必须与字段表完全一致
+// ------------------------------------------------------------------
+
+#define PROTO_VAR_REQ_ARRAY(kind, field, count)     const uint8_t* field;
+#define PROTO_VAR_REQ_MSGS(name, NAME, field, count) const uint8_t* field;
+#define PROTO_VAR_REQ_REST(kind, field)                                                            \
+    const uint8_t* field;                                                                          \
+    uint16_t field##_count;
+#define PROTO_VAR_OPT(kind, field)                                                                 \
+    PROTO_MSG_CTYPE_##kind field;                                                                  \
+    bool has_##field;
+
+#define PROTO_VAR_REQ_STRUCT(name, NAME)                                                           \
+    typedef struct {                                                                               \
+        PROTO_MSG_##NAME(PROTO_MSG_FIELD,                                                          \
+                         PROTO_VAR_REQ_ARRAY,                                                      \
+                         PROTO_VAR_REQ_MSGS,                                                       \
+                         PROTO_VAR_REQ_REST,                                                       \
+                         PROTO_VAR_OPT)                                                            \
+    } proto_##name##_t;
+
+#define PROTO_VAR_REQ_PROTOTYPES(name, NAME)                                                       \
+    bool proto_decode_##name(const uint8_t* payload, uint16_t len, proto_##name##_t* out);
+
+PROTO_SCHEMA_VAR_REQUESTS(PROTO_VAR_REQ_STRUCT)
+
+PROTO_SCHEMA_VAR_REQUESTS(PROTO_VAR_REQ_PROTOTYPES)
+
+// 请求数组的第 i 个元素（小端，不要求对齐）
+static inline uint8_t proto_wire_u8(const uint8_t* array, uint16_t i)
+{
+    return array[i];
+}
+
+static inline uint16_t proto_wire_u16(const uint8_t* array, uint16_t i)
+{
+    const uint8_t* p = &array[(uint32_t)i * 2U];
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t proto_wire_u32(const uint8_t* array, uint16_t i)
+{
+    const uint8_t* p = &array[(uint32_t)i * 4U];
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline float proto_wire_f32(const uint8_t* array, uint16_t i)
+{
+    uint32_t raw = proto_wire_u32(array, i);
+    float    v;
+    memcpy(&v, &raw, sizeof(v));
+    return v;
+}
+
+// ------------------------------------------------------------------
+// 变长应答，由 PROTO_SCHEMA_VAR_REPLIES 生成：
+//   proto_<名称>_t          数组字段指向调用方的元素（个数由前面的计数字段给出）
+//   proto_size_<名称>()     编码长度（字节）
+//   proto_encode_<名称>()   返回编码长度，buf_size 不够时返回 0
+// ------------------------------------------------------------------
+
+#define PROTO_VAR_RESP_ARRAY(kind, field, count)     const PROTO_MSG_CTYPE_##kind* field;
+#define PROTO_VAR_RESP_MSGS(name, NAME, field, count) const proto_##name##_t* field;
+#define PROTO_VAR_RESP_REST(kind, field)                                                           \
+    const PROTO_MSG_CTYPE_##kind* field;                                                           \
+    uint16_t field##_count;
+
+#define PROTO_VAR_RESP_STRUCT(name, NAME)                                                          \
+    typedef struct {                                                                               \
+        PROTO_MSG_##NAME(PROTO_MSG_FIELD,                                                          \
+                         PROTO_VAR_RESP_ARRAY,                                                     \
+                         PROTO_VAR_RESP_MSGS,                                                      \
+                         PROTO_VAR_RESP_REST,                                                      \
+                         PROTO_VAR_OPT)                                                            \
+    } proto_##name##_t;
+
+#define PROTO_VAR_RESP_PROTOTYPES(name, NAME)                                                      \
+    uint32_t proto_size_##name(const proto_##name##_t* in);                                        \
+    uint16_t proto_encode_##name(const proto_##name##_t* in, uint8_t* buf, uint16_t buf_size);
+
+PROTO_SCHEMA_VAR_REPLIES(PROTO_VAR_RESP_STRUCT)
+
+PROTO_SCHEMA_VAR_REPLIES(PROTO_VAR_RESP_PROTOTYPES)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // PROTO_MSG_H
@@ -57,6 +57,12 @@ bool proto_read_f32_le(const uint8_t* data, uint16_t len, uint16_t off, float* o
     return true;
 }
 
+void proto_write_u16_le(uint8_t* data, uint16_t off, uint16_t value)
+{
+    data[off + 0U] = (uint8_t)(value & 0xFFU);
+    data[off + 1U] = (uint8_t)((value >> 8U) & 0xFFU);
+}
+
 void proto_write_u32_le(uint8_t* data, uint16_t off, uint32_t value)
 {
     data[off + 0U] = (uint8_t)(value & 0xFFU);
@@ -20,6 +20,7 @@ bool proto_read_u16_le(const uint8_t* data, uint16_t len, uint16_t off, uint16_t
 bool proto_read_u32_le(const uint8_t* data, uint16_t len, uint16_t off, uint32_t* out);
 bool proto_read_f32_le(const uint8_t* data, uint16_t len, uint16_t off, float* out);
 
+void proto_write_u16_le(uint8_t* data, uint16_t off, uint16_t value);
 void proto_write_u32_le(uint8_t* data, uint16_t off, uint32_t value);
 void proto_write_f32_le(uint8_t* data, uint16_t off, float value);
 
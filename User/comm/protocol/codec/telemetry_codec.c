@@ -0,0 +1,94 @@
+#include "telemetry_codec.h"
+
+#include "protocol.h"
+#include "protocol_codec.h"
+
+#define TELEM_HEAD_SIZE 8U  // [seq:u16][tick_ms:u32][fields:u8][servo_mask:u8]
+
+static uint16_t telem_servo_size(uint8_t fields)
+{
+    uint16_t size = 0U;
+    if ((fields & (uint8_t)PROTO_TELEM_PWM) != 0U) {
+        size = (uint16_t)(size + 2U);
+    }
+    if ((fields & (uint8_t)PROTO_TELEM_TARGET) != 0U) {
+        size = (uint16_t)(size + 4U);
+    }
+    if ((fields & (uint8_t)PROTO_TELEM_REMAINING) != 0U) {
+        size = (uint16_t)(size + 4U);
+    }
+    return size;
+}
+
+static uint16_t telem_frame_size(uint8_t fields, uint8_t servo_mask, uint8_t cycles)
+{
+    uint16_t servos = (uint16_t)__builtin_popcount(servo_mask);
+    uint16_t size   = (uint16_t)(TELEM_HEAD_SIZE + servos * telem_servo_size(fields));
+    if ((fields & (uint8_t)PROTO_TELEM_MOVING) != 0U) {
+        size = (uint16_t)(size + 1U);
+    }
+    if ((fields & (uint8_t)PROTO_TELEM_CYCLE) != 0U) {
+        size = (uint16_t)(size + 2U + cycles * 5U);  // masks + [pose:u8][loops:u32] per cycle
+    }
+    return size;
+}
+
+uint16_t proto_telem_frame_max_size(uint8_t fields, uint8_t servo_mask)
+{
+    return telem_frame_size(fields, servo_mask, (uint8_t)PROTO_TELEM_MAX_CYCLES);
+}
+
+uint16_t proto_encode_telem_frame(const proto_telem_sample_t* sample,
+                                  uint8_t* buf,
+                                  uint16_t buf_size)
+{
+    if (sample == 0 || buf == 0) {
+        return 0U;
+    }
+    uint8_t  fields = sample->fields;
+    uint16_t size   = telem_frame_size(
+        fields, sample->servo_mask, (uint8_t)__builtin_popcount(sample->cycle_active_mask));
+    if (buf_size < size) {
+        return 0U;
+    }
+
+    proto_write_u16_le(buf, 0U, sample->seq);
+    proto_write_u32_le(buf, 2U, sample->tick_ms);
+    buf[6] = fields;
+    buf[7] = sample->servo_mask;
+
+    uint16_t off = TELEM_HEAD_SIZE;
+    for (uint8_t i = 0; i < PROTO_TELEM_MAX_SERVOS; ++i) {
+        if ((sample->servo_mask & (1U << i)) == 0U) {
+            continue;
+        }
+        if ((fields & (uint8_t)PROTO_TELEM_PWM) != 0U) {
+            proto_write_u16_le(buf, off, sample->pwm[i]);
+            off = (uint16_t)(off + 2U);
+        }
+        if ((fields & (uint8_t)PROTO_TELEM_TARGET) != 0U) {
+            proto_write_f32_le(buf, off, sample->target_angle[i]);
+            off = (uint16_t)(off + 4U);
+        }
+        if ((fields & (uint8_t)PROTO_TELEM_REMAINING) != 0U) {
+            proto_write_u32_le(buf, off, sample->remaining_ms[i]);
+            off = (uint16_t)(off + 4U);
+        }
+    }
+    if ((fields & (uint8_t)PROTO_TELEM_MOVING) != 0U) {
+        buf[off++] = sample->moving_mask;
+    }
+    if ((fields & (uint8_t)PROTO_TELEM_CYCLE) != 0U) {
+        buf[off++] = sample->cycle_active_mask;
+        buf[off++] = sample->cycle_running_mask;
+        for (uint8_t i = 0; i < PROTO_TELEM_MAX_CYCLES; ++i) {
+            if ((sample->cycle_active_mask & (1U << i)) == 0U) {
+                continue;
+            }
+            buf[off] = sample->cycle[i].pose_index;
+            proto_write_u32_le(buf, (uint16_t)(off + 1U), sample->cycle[i].loop_count);
+            off = (uint16_t)(off + 5U);
+        }
+    }
+    return off;
+}
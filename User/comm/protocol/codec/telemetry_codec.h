@@ -0,0 +1,50 @@
+#ifndef TELEMETRY_CODEC_H
+#define TELEMETRY_CODEC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "proto_msg.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PROTO_TELEM_MAX_SERVOS 8U  // servo_mask is one byte
+#define PROTO_TELEM_MAX_CYCLES 8U  // cycle masks are one byte
+
+// telem_subscribe_req and telem_subscription_resp (period_ms 0: not subscribed) are generated in
+// proto_msg.h
+
+typedef struct {
+    uint8_t  pose_index;
+    uint32_t loop_count;
+} proto_telem_cycle_t;
+
+// One sample; only the fields selected by fields/servo_mask are encoded.
+typedef struct {
+    uint16_t            seq;
+    uint32_t            tick_ms;
+    uint8_t             fields;
+    uint8_t             servo_mask;
+    uint16_t            pwm[PROTO_TELEM_MAX_SERVOS];
+    float               target_angle[PROTO_TELEM_MAX_SERVOS];
+    uint32_t            remaining_ms[PROTO_TELEM_MAX_SERVOS];
+    uint8_t             moving_mask;
+    uint8_t             cycle_active_mask;
+    uint8_t             cycle_running_mask;
+    proto_telem_cycle_t cycle[PROTO_TELEM_MAX_CYCLES];
+} proto_telem_sample_t;
+
+// Worst-case size of a sample with these fields (cycle part: every cycle active).
+uint16_t proto_telem_frame_max_size(uint8_t fields, uint8_t servo_mask);
+
+uint16_t proto_encode_telem_frame(const proto_telem_sample_t* sample,
+                                  uint8_t* buf,
+                                  uint16_t buf_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TELEMETRY_CODEC_H
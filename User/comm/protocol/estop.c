@@ -0,0 +1,207 @@
+#include <string.h>
+
+#include "cycle_counter.h"
+#include "motion_engine.h"
+#include "motion_stream.h"
+#include "protocol.h"
+#include "tf_crc32.h"
+#include "tf_uart_port.h"
+#include "tinyframe/TinyFrame.h"
+
+/*
+ * 急停快速通道：在 USART3 接收事件中断里直接扫描原始字节流，识别“全部停止”帧
+ * （PROTO_TYPE_SERVO，data = [SERVO_CMD_DISABLE]），不等主循环解析排在它前面的帧。
+ *
+ *   小帧：[SOF][id][len:u8 = 1][type][head_crc:4][cmd][data_crc:4]          13 字节
+ *   大帧：[SOF][id][len:u16 = 0x0001][type][head_crc:4][cmd][data_crc:4]    14 字节
+ *
+ * data_crc 只与 cmd 有关，初始化时算好；只有收到的字节等于它的最后一个字节时才核对
+ * 整个窗口，再用 head_crc 校验帧头，其余字节只是写入窗口。
+ *
+ * uart_driver 只把钩子看过的字节交给主循环，栅栏总是在急停帧被解析之前立起；
+ * 否则主循环先处理了急停帧，迟到的栅栏等的帧 ID 不会再来，之后的命令都被跳过直到超时。
+ */
+
+#define ESTOP_WINDOW       16U  // 2 的幂，放得下大帧
+#define ESTOP_HEAD_MAX     5U   // SOF..type（大帧）；小帧 4 字节
+#define ESTOP_FENCE_ACTIVE 0x100U
+
+// 最近收到的字节（主机构建中 sim_uart 在调用方线程里调用钩子，与目标板的中断等价）
+static uint8_t s_window[ESTOP_WINDOW];
+static uint8_t s_window_pos = 0;
+static uint8_t s_data_crc[4];
+
+// 栅栏：[deadline_ms:u16][ESTOP_FENCE_ACTIVE][frame_id:u8]，0 为无。
+// 中断里整体写入，主循环用 CAS 清除，期间又来的急停不会被清掉
+static uint32_t          s_fence       = 0;
+static uint32_t          s_fence_start = 0;  // 急停时的周期计数
+static volatile uint16_t s_ms          = 0;
+
+static proto_estop_stats_t s_stats;
+
+static inline uint8_t window_at(uint8_t back)
+{
+    return s_window[(uint8_t)(s_window_pos - 1U - back) & (ESTOP_WINDOW - 1U)];
+}
+
+static void put_be32(uint8_t* out, uint32_t v)
+{
+    out[0] = (uint8_t)(v >> 24);
+    out[1] = (uint8_t)(v >> 16);
+    out[2] = (uint8_t)(v >> 8);
+    out[3] = (uint8_t)v;
+}
+
+/**
+ * @brief 窗口末尾是否是一个完整的急停帧
+ * @param frame_id 输出：帧 ID
+ */
+static bool window_match(uint8_t* frame_id)
+{
+    // 末尾：[type][head_crc:4][cmd][data_crc:4]，倒数第 0 字节已由调用方核对
+    for (uint8_t i = 1; i < 4U; i++) {
+        if (window_at(i) != s_data_crc[3U - i]) {
+            return false;
+        }
+    }
+    if (window_at(4) != (uint8_t)SERVO_CMD_DISABLE || window_at(9) != (uint8_t)PROTO_TYPE_SERVO) {
+        return false;
+    }
+
+    // 帧头：小帧 [SOF][id][01]，大帧 [SOF][id][00][01]；大帧的 id 可能恰好等于 SOF，两种都试
+    if (window_at(10) != 1U) {
+        return false;
+    }
+    uint8_t head[ESTOP_HEAD_MAX];
+    for (uint8_t head_len = 4U; head_len <= ESTOP_HEAD_MAX; head_len++) {
+        if (window_at((uint8_t)(9U + head_len - 1U)) != TF_SOF_BYTE
+            || (head_len == ESTOP_HEAD_MAX && window_at(11) != 0U)) {
+            continue;
+        }
+        for (uint8_t i = 0; i < head_len; i++) {
+            head[i] = window_at((uint8_t)(9U + head_len - 1U - i));
+        }
+        uint8_t crc[4];
+        put_be32(crc, tf_crc32_compute(head, head_len));
+        if (window_at(8) == crc[0] && window_at(7) == crc[1] && window_at(6) == crc[2]
+            && window_at(5) == crc[3]) {
+            *frame_id = head[1];
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 接收中断钩子（uart_driver 接收事件中断）
+ */
+static void estop_rx_hook(const uint8_t* data, uint32_t len)
+{
+    uint32_t start = cycle_counter_now();
+    uint8_t  last  = s_data_crc[3];
+
+    for (uint32_t i = 0; i < len; i++) {
+        s_window[s_window_pos & (ESTOP_WINDOW - 1U)] = data[i];
+        s_window_pos++;
+
+        uint8_t frame_id;
+        if (data[i] != last || !window_match(&frame_id)) {
+            continue;
+        }
+
+        uint32_t stop_start = cycle_counter_now();
+        protocol_estop_now();
+        uint32_t stop_cycles = cycle_counter_now() - stop_start;
+
+        s_fence_start     = stop_start;
+        uint16_t deadline = (uint16_t)(s_ms + PROTO_ESTOP_FENCE_TIMEOUT_MS);
+        __atomic_store_n(&s_fence,
+                         ((uint32_t)deadline << 16) | ESTOP_FENCE_ACTIVE | frame_id,
+                         __ATOMIC_RELEASE);
+
+        s_stats.stops++;
+        if (stop_cycles > s_stats.stop_cycles_max) {
+            s_stats.stop_cycles_max = stop_cycles;
+        }
+    }
+
+    uint32_t cycles = cycle_counter_now() - start;
+    s_stats.bytes += len;
+    if (cycles > s_stats.hook_cycles_max) {
+        s_stats.hook_cycles_max = cycles;
+    }
+}
+
+// ==================== Public API ====================
+
+void protocol_estop_init(void)
+{
+    const uint8_t cmd = (uint8_t)SERVO_CMD_DISABLE;
+    put_be32(s_data_crc, tf_crc32_compute(&cmd, 1U));
+
+    memset(s_window, 0, sizeof(s_window));
+    s_window_pos = 0;
+    __atomic_store_n(&s_fence, 0U, __ATOMIC_RELAXED);
+    memset(&s_stats, 0, sizeof(s_stats));
+
+#if PROTO_ESTOP_ENABLE
+    tf_uart_port_set_rx_isr_hook(estop_rx_hook);
+#endif
+}
+
+void protocol_estop_now(void)
+{
+    // 先停流：否则下一个 1ms tick 会按流里的下一帧重新设置 PWM
+    motion_stream_stop();
+    servo_emergency_stop();
+}
+
+bool protocol_estop_fenced(uint8_t type, uint8_t cmd, uint16_t payload_len, uint8_t frame_id)
+{
+    uint32_t fence = __atomic_load_n(&s_fence, __ATOMIC_ACQUIRE);
+    if (fence == 0U) {
+        return false;
+    }
+
+    // 停止命令从不跳过；急停帧本身到达主循环时解除栅栏
+    if (type == (uint8_t)PROTO_TYPE_SERVO && cmd == (uint8_t)SERVO_CMD_DISABLE) {
+        if (payload_len == 0U && frame_id == (uint8_t)fence
+            && __atomic_compare_exchange_n(
+                &s_fence, &fence, 0U, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            uint32_t cycles = cycle_counter_now() - s_fence_start;
+            if (cycles > s_stats.fence_cycles_max) {
+                s_stats.fence_cycles_max = cycles;
+            }
+        }
+        return false;
+    }
+
+    // 急停帧没有到达（解析时出错被丢弃）：超时后恢复
+    if ((int16_t)(s_ms - (uint16_t)(fence >> 16)) >= 0) {
+        if (__atomic_compare_exchange_n(
+                &s_fence, &fence, 0U, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            s_stats.fence_timeouts++;
+        }
+        return false;
+    }
+
+    s_stats.skipped++;
+    return true;
+}
+
+void protocol_estop_tick_1ms(void)
+{
+    s_ms++;
+}
+
+void protocol_estop_get_stats(proto_estop_stats_t* stats)
+{
+    if (stats != NULL) {
+        *stats = s_stats;
+    }
+}
+
+void protocol_estop_reset_stats(void)
+{
+    memset(&s_stats, 0, sizeof(s_stats));
+}
@@ -1,75 +1,61 @@
 #include "../protocol.h"
 #include "../transport/TinyFrame/TinyFrame.h"
-#include <string.h>
-#include "arm_codec.h"
 #include "motion_engine.h"
+#include "proto_msg.h"
 #include "robot_arm_control.h"
 
-TF_Result protocol_arm_listener(TinyFrame* tf, TF_Msg* msg)
-{
-    (void)tf;
-    if (msg == NULL) {
-        return TF_NEXT;
-    }
-
-    proto_cmd_view_t cmd_view;
-    if (!proto_parse_cmd(msg->data, msg->len, &cmd_view)) {
-        return TF_NEXT;
-    }
-
-    (void)protocol_arm_handle(cmd_view.cmd, cmd_view.payload, cmd_view.payload_len);
-    return TF_STAY;
-}
-
-bool protocol_arm_handle(uint8_t cmd, const uint8_t* payload, uint16_t len)
+proto_status_t protocol_arm_handle(uint8_t cmd, const uint8_t* payload, uint16_t len)
 {
     // Payload format: [cmd][payload...]
     switch (cmd) {
         case ARM_CMD_HOME: {
+            // Payload format: [duration:u32 (optional, default 1000)]
             proto_arm_home_req_t req;
-            if (!proto_decode_arm_home_req(payload, len, 1000U, &req)) {
-                return false;
+            if (!proto_decode_arm_home_req(payload, len, &req)) {
+                return PROTO_STATUS_BAD_PAYLOAD;
             }
+            uint32_t duration_ms = req.has_duration_ms ? req.duration_ms : 1000U;
             for (uint8_t id = 0; id < ARM_JOINT_COUNT; ++id) {
-                servo_move_home(id, req.duration_ms, NULL);
+                servo_move_home(id, duration_ms, NULL);
             }
-            return true;
+            return PROTO_STATUS_OK;
         }
         case ARM_CMD_STOP:
             servo_stop_all();
-            return true;
+            return PROTO_STATUS_OK;
         case ARM_CMD_SET_POSE: {
             // Payload format: [duration:u32][angles:f32 * ARM_JOINT_COUNT]
             proto_arm_set_pose_req_t req;
-            if (!proto_decode_arm_set_pose_req(payload, len, ARM_JOINT_COUNT, &req)) {
-                return false;
+            if (!proto_decode_arm_set_pose_req(payload, len, &req)
+                || req.angles_count != ARM_JOINT_COUNT) {
+                return PROTO_STATUS_BAD_PAYLOAD;
             }
             float angles[ARM_JOINT_COUNT];
             for (uint8_t i = 0; i < ARM_JOINT_COUNT; ++i) {
-                memcpy(&angles[i], &req.angles_raw[(uint16_t)i * 4U], sizeof(float));
+                angles[i] = proto_wire_f32(req.angles, i);
             }
             uint8_t ids[ARM_JOINT_COUNT];
             for (uint8_t i = 0; i < ARM_JOINT_COUNT; ++i) {
                 ids[i] = i;
             }
             servo_move_angle_multiple(ids, angles, ARM_JOINT_COUNT, req.duration_ms, NULL);
-            return true;
+            return PROTO_STATUS_OK;
         }
         case ARM_CMD_GET_STATUS: {
-            uint8_t resp_buf[4];
             proto_arm_status_resp_t resp = {
                 .moving_mask = servo_get_moving_mask(),
             };
-            uint16_t resp_len =
-                proto_encode_arm_status_resp(&resp, resp_buf, (uint16_t)sizeof(resp_buf));
-            if (resp_len == 0U) {
-                return false;
+            const uint16_t size     = PROTO_SIZE_ARM_STATUS_RESP;
+            uint8_t*       resp_buf = protocol_state_begin(STATE_CMD_ARM, size);
+            if (resp_buf == NULL) {
+                return PROTO_STATUS_BUSY;
             }
-            return protocol_send_state(STATE_CMD_ARM, resp_buf, resp_len);
+            return protocol_reply_status(protocol_state_commit(
+                resp_buf, proto_encode_arm_status_resp(&resp, resp_buf, size)));
         }
         case ARM_CMD_STATUS:
-            return true;
+            return PROTO_STATUS_OK;
         default:
-            return false;
+            return PROTO_STATUS_UNKNOWN_CMD;
     }
 }
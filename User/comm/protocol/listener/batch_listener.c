@@ -0,0 +1,96 @@
+#include "../protocol.h"
+#include "../transport/TinyFrame/TinyFrame.h"
+#include "batch_codec.h"
+#include "motion_engine.h"
+#include "tf_uart_port.h"
+
+// 不能放进 BATCH 的子命令：嵌套 BATCH；SYS 和 TELEM 命令以本类型的帧应答（PONG、INFO、
+// SUBSCRIPTION 等），不是 STATE 帧，收不进结果帧，帧模式 / 波特率切换还会改变链路本身
+static bool batch_allowed(const proto_batch_item_t* item)
+{
+    switch (item->type) {
+        case PROTO_TYPE_BATCH:
+        case PROTO_TYPE_SYS:
+        case PROTO_TYPE_TELEM:
+            return false;
+        default:
+            return true;
+    }
+}
+
+// 子命令与单独成帧的请求查同一张分发表
+static proto_status_t batch_dispatch(const proto_batch_item_t* item)
+{
+    proto_status_t     status;
+    protocol_handler_t handler = protocol_route(item->type, item->cmd, item->len, &status);
+    if (handler == NULL) {
+        return status;
+    }
+    return handler(item->cmd, item->payload, item->len);
+}
+
+static proto_status_t batch_exec(const uint8_t* payload, uint16_t len)
+{
+    proto_batch_req_t req;
+    if (!proto_decode_batch_req(payload, len, &req)) {
+        return PROTO_STATUS_BAD_PAYLOAD;
+    }
+
+    // 结果帧: [BATCH_CMD_RESULT][count:u8][status:u8 * count][应答记录...]，直接在发送帧槽中组帧
+    uint16_t max_len = tf_uart_port_max_payload();
+    uint16_t head    = (uint16_t)(2U + req.count);
+    if (head > max_len) {
+        return PROTO_STATUS_INVALID_ARG;
+    }
+    uint8_t* frame = protocol_reply_begin(max_len);
+    if (frame == NULL) {
+        return PROTO_STATUS_BUSY;
+    }
+    frame[0]        = (uint8_t)BATCH_CMD_RESULT;
+    frame[1]        = req.count;
+    uint8_t* status = &frame[2];
+
+    bool atomic = (req.flags & (uint8_t)PROTO_BATCH_ATOMIC) != 0U;
+    bool stop   = false;
+    if (atomic) {
+        servo_motion_hold();  // 所有子命令在同一个 1ms tick 生效
+    }
+    protocol_state_capture_begin(&frame[head], (uint16_t)(max_len - head));
+
+    uint16_t           off = 0U;
+    proto_batch_item_t item;
+    for (uint8_t i = 0; i < req.count; ++i) {
+        uint16_t used =
+            proto_decode_batch_item(&req.items[off], (uint16_t)(req.items_len - off), &item);
+        off = (uint16_t)(off + used);
+        if (stop || !batch_allowed(&item)) {
+            status[i] = stop ? (uint8_t)PROTO_STATUS_SKIPPED : (uint8_t)PROTO_STATUS_UNSUPPORTED;
+            continue;
+        }
+        protocol_state_capture_index(i);
+        proto_status_t st = batch_dispatch(&item);
+        status[i]         = (uint8_t)st;
+        if (st != PROTO_STATUS_OK && (req.flags & (uint8_t)PROTO_BATCH_STOP_ON_ERROR) != 0U) {
+            stop = true;
+        }
+    }
+
+    uint16_t captured = protocol_state_capture_end();
+    if (atomic) {
+        servo_motion_release();
+    }
+    bool sent = protocol_reply_commit(frame, PROTO_TYPE_BATCH, (uint16_t)(head + captured));
+    return protocol_reply_status(sent);
+}
+
+proto_status_t protocol_batch_handle(uint8_t cmd, const uint8_t* payload, uint16_t len)
+{
+    switch (cmd) {
+        case BATCH_CMD_EXEC:
+            return batch_exec(payload, len);
+        case BATCH_CMD_RESULT:
+            return PROTO_STATUS_OK;
+        default:
+            return PROTO_STATUS_UNKNOWN_CMD;
+    }
+}
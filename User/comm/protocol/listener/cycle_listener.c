@@ -1,9 +1,9 @@
 #include <stdio.h>
-#include <string.h>
 
-#include "cycle_codec.h"
+#include "debug_output.h"
 #include "motion_cycle.h"
 #include "motion_engine.h"
+#include "proto_msg.h"
 #include "protocol.h"
 #include "tinyframe/TinyFrame.h"
 
@@ -12,55 +12,54 @@
 #endif
 
 #if CYCLE_LISTENER_LOG_ENABLE
-#define CYCLE_LOG(fmt, ...) printf("[cycle] " fmt "\n", ##__VA_ARGS__)
-#define CYCLE_DUMP(label, data, len)                            \
-    do {                                                        \
-        printf("[cycle] %s (len=%u):", label, (unsigned)(len)); \
-        for (uint16_t _i = 0; _i < (len); ++_i) {               \
-            printf(" %02X", (unsigned)(data)[_i]);              \
-        }                                                       \
-        printf("\n");                                           \
-    } while (0)
+#define CYCLE_LOG(fmt, ...)          DEBUG_LOG("[cycle] " fmt "\n", ##__VA_ARGS__)
+#define CYCLE_DUMP(label, data, len) DEBUG_DUMP("[cycle] ", label, data, len)
 #else
 #define CYCLE_LOG(fmt, ...)          ((void)0)
 #define CYCLE_DUMP(label, data, len) ((void)0)
 #endif
 
-static bool send_cycle_payload(const uint8_t* payload, uint16_t payload_len)
-{
-    return protocol_send_state(STATE_CMD_CYCLE, payload, payload_len);
-}
-
 #define PROTO_CYCLE_MAX_SERVO MAX_SERVOS
 #define PROTO_CYCLE_MAX_POSE  8
 
+// 每个 cycle 常驻一份，按模式只用其中一组数值和指针（与 motion_cycle_config_t 相同）
 typedef struct {
-    uint8_t  servo_ids[PROTO_CYCLE_MAX_SERVO];
-    uint32_t servo_count;
+    uint8_t servo_ids[PROTO_CYCLE_MAX_SERVO];
+    uint8_t servo_count;
+    uint8_t pose_count;
+    uint8_t mode;       // 0=PWM, 1=Angle
+    uint8_t allocated;  // allocated flag
 
     union {
         uint32_t pose_pwm[PROTO_CYCLE_MAX_POSE][PROTO_CYCLE_MAX_SERVO];
         float    pose_angle[PROTO_CYCLE_MAX_POSE][PROTO_CYCLE_MAX_SERVO];
     };
-    uint32_t* pose_pwm_ptrs[PROTO_CYCLE_MAX_POSE];
-    float*    pose_angle_ptrs[PROTO_CYCLE_MAX_POSE];
+    union {
+        uint32_t* pose_pwm_ptrs[PROTO_CYCLE_MAX_POSE];
+        float*    pose_angle_ptrs[PROTO_CYCLE_MAX_POSE];
+    };
 
     uint32_t pose_duration[PROTO_CYCLE_MAX_POSE];
-    uint32_t pose_count;
-
-    uint8_t mode;       // 0=PWM, 1=Angle
-    uint8_t allocated;  // allocated flag
 } proto_cycle_data_t;
 
 static proto_cycle_data_t s_proto_cycle_data[MAX_CYCLE] = {0};
 static uint32_t           s_cycle_notify_mask           = 0;
 
+// 待推送的循环：状态回调记下计数并置位，protocol_cycle_notify_flush()（PendSV）取走
+typedef struct {
+    uint32_t loop_count;
+    uint32_t max_loops;
+} cycle_notify_t;
+
+static cycle_notify_t s_cycle_notify[MAX_CYCLE];
+static uint32_t       s_cycle_pending_mask  = 0;
+static uint32_t       s_cycle_finished_mask = 0;  // 待推送且已结束
+
 static bool encode_and_send_cycle_status_update(uint32_t cycle_index,
                                                 uint32_t loop_count,
                                                 uint32_t remaining,
                                                 uint8_t  finished)
 {
-    uint8_t                          payload[14];
     proto_cycle_status_update_resp_t resp = {
         .subcmd      = (uint8_t)CYCLE_CMD_STATUS,
         .cycle_index = cycle_index,
@@ -69,18 +68,20 @@ static bool encode_and_send_cycle_status_update(uint32_t cycle_index,
         .finished    = finished,
     };
 
-    uint16_t payload_len =
-        proto_encode_cycle_status_update_resp(&resp, payload, (uint16_t)sizeof(payload));
-    if (payload_len == 0U) {
+    // 循环状态推送（批量优先级），突发时不挤占命令应答
+    const uint16_t size    = PROTO_SIZE_CYCLE_STATUS_UPDATE_RESP;
+    uint8_t*       payload = protocol_telemetry_begin(STATE_CMD_CYCLE, size);
+    if (payload == NULL) {
         return false;
     }
-    return send_cycle_payload(payload, payload_len);
+    return protocol_state_commit(payload,
+                                 proto_encode_cycle_status_update_resp(&resp, payload, size));
 }
 
-static bool encode_and_send_cycle_status(uint32_t cycle_index, const motion_cycle_status_t* st)
+static bool encode_and_send_cycle_status(uint32_t                     cycle_index,
+                                         const motion_cycle_status_t* st,
+                                         bool                         push)
 {
-    uint8_t payload[21];
-
     proto_cycle_status_resp_t resp = {
         .subcmd          = (uint8_t)CYCLE_CMD_GET_STATUS,
         .cycle_index     = cycle_index,
@@ -93,18 +94,24 @@ static bool encode_and_send_cycle_status(uint32_t cycle_index, const motion_cycl
         .active_group_id = st->active_group_id,
     };
 
-    uint16_t payload_len =
-        proto_encode_cycle_status_resp(&resp, payload, (uint16_t)sizeof(payload));
-    if (payload_len == 0U) {
+    // 状态推送（PendSV）走批量优先级，GET_STATUS 应答走控制优先级
+    const uint16_t size    = PROTO_SIZE_CYCLE_STATUS_RESP;
+    uint8_t*       payload = push ? protocol_telemetry_begin(STATE_CMD_CYCLE, size)
+                                  : protocol_state_begin(STATE_CMD_CYCLE, size);
+    if (payload == NULL) {
         return false;
     }
-    return send_cycle_payload(payload, payload_len);
+    return protocol_state_commit(payload, proto_encode_cycle_status_resp(&resp, payload, size));
 }
 
 static bool encode_and_send_cycle_list(void)
 {
-    proto_cycle_status_t cycles[MAX_CYCLE];
-    uint8_t              cycle_count = 0U;
+    // 状态先收集到协议层的暂存区，不占处理函数的栈
+    proto_cycle_status_t* cycles = protocol_scratch((uint16_t)(sizeof(*cycles) * MAX_CYCLE));
+    uint8_t               cycle_count = 0U;
+    if (cycles == NULL) {
+        return false;
+    }
 
     for (uint8_t i = 0; i < MAX_CYCLE; ++i) {
         motion_cycle_status_t st;
@@ -150,21 +157,22 @@ static bool encode_and_send_cycle_list(void)
         }
     }
 
-    uint8_t payload[PROTO_MAX_PAYLOAD];
-
     proto_cycle_list_resp_t resp = {
         .subcmd      = (uint8_t)CYCLE_CMD_LIST,
         .cycle_count = cycle_count,
         .cycles      = cycles,
     };
 
-    uint16_t payload_len = proto_encode_cycle_list_resp(&resp, payload, (uint16_t)sizeof(payload));
-    if (payload_len == 0U) {
+    // [subcmd][count] + one cycle_status per cycle, encoded straight into the TX queue
+    uint16_t max_len = (uint16_t)proto_size_cycle_list_resp(&resp);
+    uint8_t* payload = protocol_state_begin(STATE_CMD_CYCLE, max_len);
+    if (payload == NULL) {
         return false;
     }
+    uint16_t payload_len = proto_encode_cycle_list_resp(&resp, payload, max_len);
 
     CYCLE_LOG("CYCLE_LIST count=%u total_len=%u", (unsigned)cycle_count, (unsigned)payload_len);
-    return send_cycle_payload(payload, payload_len);
+    return protocol_state_commit(payload, payload_len);
 }
 
 // Find free protocol cycle data slot
@@ -185,6 +193,8 @@ static void release_proto_cycle_data(uint8_t slot)
     s_proto_cycle_data[slot].allocated = 0;
 }
 
+// 在 1ms 中断（分组完成）或主循环（启动、停止、释放）中调用：只记下要推送的内容，不在这里发帧。
+// 同一 tick 内的多次回调合并为一次推送（最新的计数）
 static void protocol_cycle_status_cb(uint32_t cycle_index,
                                      uint32_t loop_count,
                                      uint32_t max_loops,
@@ -205,50 +215,61 @@ static void protocol_cycle_status_cb(uint32_t cycle_index,
     }
 
     // Check notify mask.
-    if (cycle_index >= 32) {
+    if (cycle_index >= MAX_CYCLE) {
         return;
     }
-    if ((s_cycle_notify_mask & (1U << cycle_index)) == 0) {
+    uint32_t bit = 1U << cycle_index;
+    if ((s_cycle_notify_mask & bit) == 0) {
         return;
     }
 
-    uint32_t remaining =
-        (max_loops == 0) ? 0xFFFFFFFFu : (max_loops > loop_count ? (max_loops - loop_count) : 0);
-    (void)encode_and_send_cycle_status_update(
-        cycle_index, loop_count, remaining, finished ? 1U : 0U);
-
-    CYCLE_LOG("Cycle status: index=%lu loop=%lu/%lu remaining=%lu finished=%u",
-              (unsigned long)cycle_index,
-              (unsigned long)loop_count,
-              (unsigned long)max_loops,
-              (unsigned long)remaining,
-              (unsigned)finished);
-
-    motion_cycle_status_t st;
-    if (!motion_cycle_get_status(cycle_index, &st)) {
-        return;
+    s_cycle_notify[cycle_index].loop_count = loop_count;
+    s_cycle_notify[cycle_index].max_loops  = max_loops;
+    // 先记结束标志再记待推送，flush 取走待推送位时一定能看到对应的结束标志
+    if (finished) {
+        __atomic_fetch_or(&s_cycle_finished_mask, bit, __ATOMIC_RELAXED);
     }
-
-    (void)encode_and_send_cycle_status(cycle_index, &st);
+    __atomic_fetch_or(&s_cycle_pending_mask, bit, __ATOMIC_RELEASE);
 }
 
-TF_Result protocol_cycle_listener(TinyFrame* tf, TF_Msg* msg)
+void protocol_cycle_notify_flush(void)
 {
-    (void)tf;
-    if (msg == NULL) {
-        return TF_NEXT;
+    uint32_t pending = __atomic_exchange_n(&s_cycle_pending_mask, 0U, __ATOMIC_ACQUIRE);
+    if (pending == 0U) {
+        return;
     }
+    uint32_t finished = __atomic_fetch_and(&s_cycle_finished_mask, ~pending, __ATOMIC_RELAXED);
+
+    while (pending != 0U) {
+        uint32_t cycle_index = (uint32_t)__builtin_ctz(pending);
+        uint32_t bit         = 1U << cycle_index;
+        pending &= ~bit;
+
+        uint32_t loop_count = s_cycle_notify[cycle_index].loop_count;
+        uint32_t max_loops  = s_cycle_notify[cycle_index].max_loops;
+        uint32_t remaining  = 0xFFFFFFFFu;  // 无限循环
+        if (max_loops != 0) {
+            remaining = (max_loops > loop_count) ? (max_loops - loop_count) : 0;
+        }
+        uint8_t done = (finished & bit) ? 1U : 0U;
+        (void)encode_and_send_cycle_status_update(cycle_index, loop_count, remaining, done);
 
-    proto_cmd_view_t cmd_view;
-    if (!proto_parse_cmd(msg->data, msg->len, &cmd_view)) {
-        return TF_NEXT;
-    }
+        CYCLE_LOG("Cycle status: index=%lu loop=%lu/%lu remaining=%lu finished=%u",
+                  (unsigned long)cycle_index,
+                  (unsigned long)loop_count,
+                  (unsigned long)max_loops,
+                  (unsigned long)remaining,
+                  (unsigned)done);
 
-    (void)protocol_cycle_handle(cmd_view.cmd, cmd_view.payload, cmd_view.payload_len);
-    return TF_STAY;
+        motion_cycle_status_t st;
+        if (!motion_cycle_get_status(cycle_index, &st)) {
+            continue;  // 已释放
+        }
+        (void)encode_and_send_cycle_status(cycle_index, &st, true);
+    }
 }
 
-bool protocol_cycle_handle(uint8_t cmd, const uint8_t* payload, uint16_t len)
+proto_status_t protocol_cycle_handle(uint8_t cmd, const uint8_t* payload, uint16_t len)
 {
     // Payload format: [cmd][payload...]
     switch (cmd) {
@@ -260,26 +281,26 @@ bool protocol_cycle_handle(uint8_t cmd, const uint8_t* payload, uint16_t len)
             // [durations:u32 * pose_count][ids:u8 * servo_count]
             // [values:pose_count * servo_count * 4]
             proto_cycle_create_req_t req;
-            if (!proto_decode_cycle_create(payload, len, &req)) {
-                return false;
+            if (!proto_decode_cycle_create_req(payload, len, &req)) {
+                return PROTO_STATUS_BAD_PAYLOAD;
             }
             CYCLE_LOG("mode=%u servo_count=%u pose_count=%u max_loops=%lu",
                       (unsigned)req.mode,
                       (unsigned)req.servo_count,
                       (unsigned)req.pose_count,
                       (unsigned long)req.max_loops);
-            if (req.servo_count == 0U || req.pose_count == 0U) {
-                return false;
+            if (req.mode > 1U || req.servo_count == 0U || req.pose_count == 0U) {
+                return PROTO_STATUS_INVALID_ARG;
             }
             if (req.servo_count > PROTO_CYCLE_MAX_SERVO || req.pose_count > PROTO_CYCLE_MAX_POSE) {
-                return false;
+                return PROTO_STATUS_INVALID_ARG;
             }
 
             // Allocate a protocol cycle data slot.
             int8_t data_slot = find_free_proto_cycle_data();
             if (data_slot < 0) {
                 CYCLE_LOG("No free protocol cycle data slot available");
-                return false;
+                return PROTO_STATUS_BUSY;
             }
 
             proto_cycle_data_t* pdata = &s_proto_cycle_data[data_slot];
@@ -296,8 +317,7 @@ bool protocol_cycle_handle(uint8_t cmd, const uint8_t* payload, uint16_t len)
 
             // Copy per-pose durations.
             for (uint8_t p = 0; p < req.pose_count; ++p) {
-                uint32_t dur = 0U;
-                memcpy(&dur, &req.pose_durations_raw[(uint16_t)p * 4U], sizeof(uint32_t));
+                uint32_t dur            = proto_wire_u32(req.durations_ms, p);
                 pdata->pose_duration[p] = dur;
                 CYCLE_LOG("durations[%u]=%lu", (unsigned)p, (unsigned long)dur);
             }
@@ -308,8 +328,7 @@ bool protocol_cycle_handle(uint8_t cmd, const uint8_t* payload, uint16_t len)
                     pdata->pose_pwm_ptrs[p] = pdata->pose_pwm[p];
                     for (uint8_t i = 0; i < req.servo_count; ++i) {
                         uint16_t value_index = (uint16_t)p * req.servo_count + i;
-                        uint32_t pwm         = 0U;
-                        memcpy(&pwm, &req.values_raw[value_index * 4U], sizeof(uint32_t));
+                        uint32_t pwm         = proto_wire_u32(req.values, value_index);
                         pdata->pose_pwm[p][i] = pwm;
                         CYCLE_LOG(
                             "pose_pwm[%u][%u]=%lu", (unsigned)p, (unsigned)i, (unsigned long)pwm);
@@ -318,8 +337,7 @@ bool protocol_cycle_handle(uint8_t cmd, const uint8_t* payload, uint16_t len)
                     pdata->pose_angle_ptrs[p] = pdata->pose_angle[p];
                     for (uint8_t i = 0; i < req.servo_count; ++i) {
                         uint16_t value_index = (uint16_t)p * req.servo_count + i;
-                        float    angle       = 0.0f;
-                        memcpy(&angle, &req.values_raw[value_index * 4U], sizeof(float));
+                        float    angle       = proto_wire_f32(req.values, value_index);
                         pdata->pose_angle[p][i] = angle;
                         CYCLE_LOG(
                             "pose_angle[%u][%u]=%.3f", (unsigned)p, (unsigned)i, (double)angle);
@@ -349,7 +367,7 @@ bool protocol_cycle_handle(uint8_t cmd, const uint8_t* payload, uint16_t len)
             if (cycle_index < 0) {
                 CYCLE_LOG("motion_cycle_create failed");
                 release_proto_cycle_data((uint8_t)data_slot);
-                return false;
+                return PROTO_STATUS_BUSY;
             }
 
             // Set back-reference user data.
@@ -357,7 +375,7 @@ bool protocol_cycle_handle(uint8_t cmd, const uint8_t* payload, uint16_t len)
                 CYCLE_LOG("motion_cycle_set_user_data failed");
                 motion_cycle_release(cycle_index);
                 release_proto_cycle_data((uint8_t)data_slot);
-                return false;
+                return PROTO_STATUS_FAILED;
             }
 
             // Update notify mask.
@@ -385,15 +403,16 @@ bool protocol_cycle_handle(uint8_t cmd, const uint8_t* payload, uint16_t len)
                 }
             }
 
-            return encode_and_send_cycle_list();
+            return protocol_reply_status(encode_and_send_cycle_list());
         }
         case CYCLE_CMD_START: {
             CYCLE_LOG("CMD CYCLE_START");
             CYCLE_DUMP("payload", payload, len);
-            uint32_t idx = 0;
-            if (!proto_decode_cycle_id(payload, len, &idx)) {
-                return false;
+            proto_cycle_id_req_t req;
+            if (!proto_decode_cycle_id_req(payload, len, &req)) {
+                return PROTO_STATUS_BAD_PAYLOAD;
             }
+            uint32_t idx = req.cycle_index;
             int result = motion_cycle_start(idx);
             if (result == 0) {
                 CYCLE_LOG("CYCLE_START success: index=%lu", (unsigned long)idx);
@@ -410,15 +429,16 @@ bool protocol_cycle_handle(uint8_t cmd, const uint8_t* payload, uint16_t len)
                               (unsigned long)st.active_group_id);
                 }
             }
-            return result == 0;
+            return (result == 0) ? PROTO_STATUS_OK : PROTO_STATUS_FAILED;
         }
         case CYCLE_CMD_RESTART: {
             CYCLE_LOG("CMD CYCLE_RESTART");
             CYCLE_DUMP("payload", payload, len);
-            uint32_t idx = 0;
-            if (!proto_decode_cycle_id(payload, len, &idx)) {
-                return false;
+            proto_cycle_id_req_t req;
+            if (!proto_decode_cycle_id_req(payload, len, &req)) {
+                return PROTO_STATUS_BAD_PAYLOAD;
             }
+            uint32_t idx = req.cycle_index;
             int result = motion_cycle_restart(idx);
             if (result == 0) {
                 CYCLE_LOG("CYCLE_RESTART success: index=%lu", (unsigned long)idx);
@@ -435,15 +455,16 @@ bool protocol_cycle_handle(uint8_t cmd, const uint8_t* payload, uint16_t len)
                               (unsigned long)st.active_group_id);
                 }
             }
-            return result == 0;
+            return (result == 0) ? PROTO_STATUS_OK : PROTO_STATUS_FAILED;
         }
         case CYCLE_CMD_PAUSE: {
             CYCLE_LOG("CMD CYCLE_PAUSE");
             CYCLE_DUMP("payload", payload, len);
-            uint32_t idx = 0;
-            if (!proto_decode_cycle_id(payload, len, &idx)) {
-                return false;
+            proto_cycle_id_req_t req;
+            if (!proto_decode_cycle_id_req(payload, len, &req)) {
+                return PROTO_STATUS_BAD_PAYLOAD;
             }
+            uint32_t idx = req.cycle_index;
             int result = motion_cycle_pause(idx);
             if (result == 0) {
                 CYCLE_LOG("CYCLE_PAUSE success: index=%lu", (unsigned long)idx);
@@ -460,15 +481,16 @@ bool protocol_cycle_handle(uint8_t cmd, const uint8_t* payload, uint16_t len)
                               (unsigned long)st.active_group_id);
                 }
             }
-            return result == 0;
+            return (result == 0) ? PROTO_STATUS_OK : PROTO_STATUS_FAILED;
         }
         case CYCLE_CMD_RELEASE: {
             CYCLE_LOG("CMD CYCLE_RELEASE");
             CYCLE_DUMP("payload", payload, len);
-            uint32_t idx = 0;
-            if (!proto_decode_cycle_id(payload, len, &idx)) {
-                return false;
+            proto_cycle_id_req_t req;
+            if (!proto_decode_cycle_id_req(payload, len, &req)) {
+                return PROTO_STATUS_BAD_PAYLOAD;
             }
+            uint32_t idx = req.cycle_index;
 
             // Fetch protocol user data.
             proto_cycle_data_t* pdata = (proto_cycle_data_t*)motion_cycle_get_user_data(idx);
@@ -493,20 +515,21 @@ bool protocol_cycle_handle(uint8_t cmd, const uint8_t* payload, uint16_t len)
                 s_cycle_notify_mask &= ~(1U << idx);
             }
 
-            return encode_and_send_cycle_list();
+            return protocol_reply_status(encode_and_send_cycle_list());
         }
         case CYCLE_CMD_GET_STATUS:
         case CYCLE_CMD_STATUS: {
             CYCLE_LOG("CMD CYCLE_GET_STATUS/STATUS");
             CYCLE_DUMP("payload", payload, len);
-            uint32_t idx = 0;
-            if (!proto_decode_cycle_id(payload, len, &idx)) {
-                return false;
+            proto_cycle_id_req_t req;
+            if (!proto_decode_cycle_id_req(payload, len, &req)) {
+                return PROTO_STATUS_BAD_PAYLOAD;
             }
+            uint32_t idx = req.cycle_index;
             CYCLE_LOG("cycle_index=%lu", (unsigned long)idx);
             motion_cycle_status_t st;
             if (!motion_cycle_get_status(idx, &st)) {
-                return false;
+                return PROTO_STATUS_INVALID_ARG;
             }
             CYCLE_LOG(
                 "active=%u running=%u current_pose=%u pose_count=%u loop_count=%lu max_loops=%lu "
@@ -527,14 +550,14 @@ bool protocol_cycle_handle(uint8_t cmd, const uint8_t* payload, uint16_t len)
                           (unsigned)pdata->mode);
             }
 
-            return encode_and_send_cycle_status(idx, &st);
+            return protocol_reply_status(encode_and_send_cycle_status(idx, &st, false));
         }
         case CYCLE_CMD_LIST: {
             CYCLE_LOG("CMD CYCLE_LIST");
             CYCLE_DUMP("payload", payload, len);
-            return encode_and_send_cycle_list();
+            return protocol_reply_status(encode_and_send_cycle_list());
         }
         default:
-            return false;
+            return PROTO_STATUS_UNKNOWN_CMD;
     }
 }
\ No newline at end of file
@@ -0,0 +1,280 @@
+#include "../protocol.h"
+#include "../transport/TinyFrame/TinyFrame.h"
+#include "cycle_counter.h"
+#include "debug_output.h"
+#include "motion_engine.h"
+#include "proto_msg.h"
+#include "tf_capture.h"
+#include "tf_crc32.h"
+#include "tf_uart_port.h"
+
+static bool send_rx_stats(void)
+{
+    tf_uart_port_stats_t stats;
+    tf_uart_port_get_stats(&stats);
+
+    proto_debug_rx_stats_resp_t resp = {
+        .section   = (uint8_t)DEBUG_STATS_RX,
+        .cpu_hz    = stats.cpu_hz,
+        .rx_bytes  = stats.rx_bytes,
+        .rx_cycles = stats.rx_cycles,
+        .rx_errors = stats.rx_errors,
+    };
+    const uint16_t size     = PROTO_SIZE_DEBUG_RX_STATS_RESP;
+    uint8_t*       resp_buf = protocol_state_begin(STATE_CMD_DEBUG, size);
+    if (resp_buf == NULL) {
+        return false;
+    }
+    return protocol_state_commit(resp_buf, proto_encode_debug_rx_stats_resp(&resp, resp_buf, size));
+}
+
+static bool send_crc_stats(void)
+{
+    tf_crc32_stats_t stats;
+    tf_crc32_get_stats(&stats);
+
+    proto_debug_crc_stats_resp_t resp = {
+        .section = (uint8_t)DEBUG_STATS_CRC,
+        .cpu_hz  = cycle_counter_hz(),
+        .blocks  = stats.blocks,
+        .bytes   = stats.bytes,
+        .cycles  = stats.cycles,
+        .hw      = (uint8_t)TF_CRC32_USE_HW,
+    };
+    const uint16_t size     = PROTO_SIZE_DEBUG_CRC_STATS_RESP;
+    uint8_t*       resp_buf = protocol_state_begin(STATE_CMD_DEBUG, size);
+    if (resp_buf == NULL) {
+        return false;
+    }
+    return protocol_state_commit(resp_buf,
+                                 proto_encode_debug_crc_stats_resp(&resp, resp_buf, size));
+}
+
+#define DEBUG_TX_CLASSES 2U  // control, bulk
+
+static bool send_tx_stats(void)
+{
+    proto_debug_tx_class_stats_t classes[DEBUG_TX_CLASSES];
+    for (uint8_t i = 0; i < DEBUG_TX_CLASSES; i++) {
+        tf_uart_tx_stats_t stats = {0};
+        (void)tf_uart_port_get_tx_stats((tf_uart_tx_class_t)i, &stats);
+        classes[i].queued     = (uint8_t)stats.queued;
+        classes[i].high_water = (uint8_t)stats.high_water;
+        classes[i].sent       = stats.sent;
+        classes[i].drops      = stats.drops;
+    }
+    proto_debug_tx_stats_resp_t resp = {
+        .section     = (uint8_t)DEBUG_STATS_TX,
+        .class_count = (uint8_t)DEBUG_TX_CLASSES,
+        .classes     = classes,
+    };
+    const uint16_t size     = (uint16_t)proto_size_debug_tx_stats_resp(&resp);
+    uint8_t*       resp_buf = protocol_state_begin(STATE_CMD_DEBUG, size);
+    if (resp_buf == NULL) {
+        return false;
+    }
+    return protocol_state_commit(resp_buf, proto_encode_debug_tx_stats_resp(&resp, resp_buf, size));
+}
+
+static bool send_log_stats(void)
+{
+    debug_output_stats_t stats;
+    debug_output_get_stats(&stats);
+
+    proto_debug_log_stats_resp_t resp = {
+        .section       = (uint8_t)DEBUG_STATS_LOG,
+        .cpu_hz        = cycle_counter_hz(),
+        .writes        = stats.writes,
+        .bytes         = stats.bytes,
+        .drops         = stats.drops,
+        .dropped_bytes = stats.dropped_bytes,
+        .cycles        = stats.cycles,
+        .sent          = stats.sent,
+        .pending       = stats.pending,
+        .high_water    = stats.high_water,
+    };
+    const uint16_t size     = PROTO_SIZE_DEBUG_LOG_STATS_RESP;
+    uint8_t*       resp_buf = protocol_state_begin(STATE_CMD_DEBUG, size);
+    if (resp_buf == NULL) {
+        return false;
+    }
+    return protocol_state_commit(resp_buf,
+                                 proto_encode_debug_log_stats_resp(&resp, resp_buf, size));
+}
+
+static bool send_link_stats(void)
+{
+    tf_uart_link_stats_t stats;
+    tf_uart_port_get_link_stats(&stats);
+
+    proto_debug_link_stats_resp_t resp = {
+        .section        = (uint8_t)DEBUG_STATS_LINK,
+        .rx_errors      = stats.rx_errors,
+        .rx_overflows   = stats.rx_overflows,
+        .tx_send_fails  = stats.tx_send_fails,
+        .tx_lock_fails  = stats.tx_lock_fails,
+        .baud_fallbacks = stats.baud_fallbacks,
+    };
+    const uint16_t size     = PROTO_SIZE_DEBUG_LINK_STATS_RESP;
+    uint8_t*       resp_buf = protocol_state_begin(STATE_CMD_DEBUG, size);
+    if (resp_buf == NULL) {
+        return false;
+    }
+    return protocol_state_commit(resp_buf,
+                                 proto_encode_debug_link_stats_resp(&resp, resp_buf, size));
+}
+
+static bool send_estop_stats(void)
+{
+    proto_estop_stats_t stats;
+    protocol_estop_get_stats(&stats);
+
+    proto_debug_estop_stats_resp_t resp = {
+        .section          = (uint8_t)DEBUG_STATS_ESTOP,
+        .cpu_hz           = cycle_counter_hz(),
+        .stops            = stats.stops,
+        .skipped          = stats.skipped,
+        .fence_timeouts   = stats.fence_timeouts,
+        .bytes            = stats.bytes,
+        .stop_cycles_max  = stats.stop_cycles_max,
+        .hook_cycles_max  = stats.hook_cycles_max,
+        .fence_cycles_max = stats.fence_cycles_max,
+    };
+    const uint16_t size     = PROTO_SIZE_DEBUG_ESTOP_STATS_RESP;
+    uint8_t*       resp_buf = protocol_state_begin(STATE_CMD_DEBUG, size);
+    if (resp_buf == NULL) {
+        return false;
+    }
+    return protocol_state_commit(resp_buf,
+                                 proto_encode_debug_estop_stats_resp(&resp, resp_buf, size));
+}
+
+static bool send_tick_stats(void)
+{
+    servo_tick_stats_t stats;
+    servo_motion_get_tick_stats(&stats);
+
+    proto_debug_tick_stats_resp_t resp = {
+        .section    = (uint8_t)DEBUG_STATS_TICK,
+        .cpu_hz     = cycle_counter_hz(),
+        .ticks      = stats.ticks,
+        .period_min = stats.period_min,
+        .period_max = stats.period_max,
+        .run_max    = stats.run_max,
+    };
+    const uint16_t size     = PROTO_SIZE_DEBUG_TICK_STATS_RESP;
+    uint8_t*       resp_buf = protocol_state_begin(STATE_CMD_DEBUG, size);
+    if (resp_buf == NULL) {
+        return false;
+    }
+    return protocol_state_commit(resp_buf,
+                                 proto_encode_debug_tick_stats_resp(&resp, resp_buf, size));
+}
+
+/**
+ * @brief 抓包状态，read 时后跟从 offset 开始、放得下一帧的抓包数据
+ */
+static bool send_capture(bool read, uint16_t offset)
+{
+    tf_capture_info_t info;
+    tf_capture_get_info(&info);
+
+    proto_debug_capture_resp_t resp = {
+        .section     = (uint8_t)DEBUG_STATS_CAPTURE,
+        .state       = (uint8_t)info.running,
+        .records     = info.records,
+        .overwritten = info.overwritten,
+        .dropped     = info.dropped,
+        .size        = info.size,
+        .offset      = offset,
+    };
+    const uint16_t head = PROTO_SIZE_DEBUG_CAPTURE_RESP;
+    uint16_t       size = head;
+    if (read) {
+        size = (uint16_t)(tf_uart_port_max_payload() - 1U);  // 减去 [STATE_CMD_DEBUG]
+    }
+    uint8_t* resp_buf = protocol_state_begin(STATE_CMD_DEBUG, size);
+    if (resp_buf == NULL) {
+        return false;
+    }
+    uint16_t len = proto_encode_debug_capture_resp(&resp, resp_buf, head);
+    if (read && len != 0U) {
+        len = (uint16_t)(len + tf_capture_read(offset, &resp_buf[head], (uint16_t)(size - head)));
+    }
+    return protocol_state_commit(resp_buf, len);
+}
+
+proto_status_t protocol_debug_handle(uint8_t cmd, const uint8_t* payload, uint16_t len)
+{
+    switch (cmd) {
+        case DEBUG_CMD_GET_STATS: {
+            proto_debug_get_stats_req_t req;
+            if (!proto_decode_debug_get_stats_req(payload, len, &req)) {
+                return PROTO_STATUS_BAD_PAYLOAD;
+            }
+            switch (req.section) {
+                case DEBUG_STATS_RX:
+                    return protocol_reply_status(send_rx_stats());
+                case DEBUG_STATS_CRC:
+                    return protocol_reply_status(send_crc_stats());
+                case DEBUG_STATS_TX:
+                    return protocol_reply_status(send_tx_stats());
+                case DEBUG_STATS_LOG:
+                    return protocol_reply_status(send_log_stats());
+                case DEBUG_STATS_CAPTURE:
+                    return protocol_reply_status(send_capture(false, 0U));
+                case DEBUG_STATS_LINK:
+                    return protocol_reply_status(send_link_stats());
+                case DEBUG_STATS_ESTOP:
+                    return protocol_reply_status(send_estop_stats());
+                case DEBUG_STATS_TICK:
+                    return protocol_reply_status(send_tick_stats());
+                default:
+                    return PROTO_STATUS_INVALID_ARG;
+            }
+        }
+        case DEBUG_CMD_RESET_STATS:
+            tf_uart_port_reset_stats();
+            tf_crc32_reset_stats();
+            debug_output_reset_stats();
+            protocol_estop_reset_stats();
+            servo_motion_reset_tick_stats();
+            return PROTO_STATUS_OK;
+        case DEBUG_CMD_CAPTURE: {
+            // [op:u8]，读出时 [op:u8 = DEBUG_CAPTURE_READ][offset:u16]
+            if (!TF_CAPTURE_ENABLE) {
+                return PROTO_STATUS_UNSUPPORTED;
+            }
+            proto_debug_capture_req_t req;
+            if (!proto_decode_debug_capture_req(payload, len, &req)) {
+                return PROTO_STATUS_BAD_PAYLOAD;
+            }
+            switch (req.op) {
+                case DEBUG_CAPTURE_STOP:
+                    tf_capture_stop();
+                    return protocol_reply_status(send_capture(false, 0U));
+                case DEBUG_CAPTURE_START:
+                    tf_capture_start();
+                    return protocol_reply_status(send_capture(false, 0U));
+                case DEBUG_CAPTURE_READ: {
+                    if (!req.has_offset) {
+                        return PROTO_STATUS_BAD_PAYLOAD;
+                    }
+                    tf_capture_info_t info;
+                    tf_capture_get_info(&info);
+                    if (info.running) {
+                        return PROTO_STATUS_BUSY;  // 先停止，读出期间内容不变
+                    }
+                    if (req.offset > info.size) {
+                        return PROTO_STATUS_INVALID_ARG;
+                    }
+                    return protocol_reply_status(send_capture(true, req.offset));
+                }
+                default:
+                    return PROTO_STATUS_INVALID_ARG;
+            }
+        }
+        default:
+            return PROTO_STATUS_UNKNOWN_CMD;
+    }
+}
@@ -1,9 +1,10 @@
 #include <stdio.h>
-#include <string.h>
 
+#include "debug_output.h"
 #include "motion_engine.h"
+#include "motion_stream.h"
 #include "motion_sync.h"
-#include "motion_codec.h"
+#include "proto_msg.h"
 #include "protocol.h"
 #include "tinyframe/TinyFrame.h"
 
@@ -12,60 +13,48 @@
 #endif
 
 #if MOTION_LISTENER_LOG_ENABLE
-#define MOTION_LOG(fmt, ...) printf("[motion] " fmt "\n", ##__VA_ARGS__)
-#define MOTION_DUMP(label, data, len)                            \
-    do {                                                         \
-        printf("[motion] %s (len=%u):", label, (unsigned)(len)); \
-        for (uint16_t _i = 0; _i < (len); ++_i) {                \
-            printf(" %02X", (unsigned)(data)[_i]);               \
-        }                                                        \
-        printf("\n");                                            \
-    } while (0)
+#define MOTION_LOG(fmt, ...)          DEBUG_LOG("[motion] " fmt "\n", ##__VA_ARGS__)
+#define MOTION_DUMP(label, data, len) DEBUG_DUMP("[motion] ", label, data, len)
 #else
 #define MOTION_LOG(fmt, ...)          ((void)0)
 #define MOTION_DUMP(label, data, len) ((void)0)
 #endif
 
 
-static bool send_motion_payload(const uint8_t* payload, uint16_t payload_len)
-{
-    return protocol_send_state(STATE_CMD_MOTION, payload, payload_len);
-}
-
 static bool encode_and_send_motion_start(uint32_t group_id)
 {
-    uint8_t payload[5];
     proto_motion_start_resp_t resp = {
         .subcmd = (uint8_t)MOTION_CMD_START,
         .group_id = group_id,
     };
 
-    uint16_t payload_len = proto_encode_motion_start_resp(&resp, payload, (uint16_t)sizeof(payload));
-    if (payload_len == 0U) {
+    const uint16_t size    = PROTO_SIZE_MOTION_START_RESP;
+    uint8_t*       payload = protocol_state_begin(STATE_CMD_MOTION, size);
+    if (payload == NULL) {
         return false;
     }
-    return send_motion_payload(payload, payload_len);
+    return protocol_state_commit(payload, proto_encode_motion_start_resp(&resp, payload, size));
 }
 
 static bool encode_and_send_motion_status(uint8_t subcmd, uint32_t group_id, uint8_t complete)
 {
-    uint8_t payload[6];
     proto_motion_status_resp_t resp = {
         .subcmd = subcmd,
         .group_id = group_id,
         .complete = complete,
     };
 
-    uint16_t payload_len = proto_encode_motion_status_resp(&resp, payload, (uint16_t)sizeof(payload));
-    if (payload_len == 0U) {
+    // 只用于分组完成推送（批量优先级）
+    const uint16_t size    = PROTO_SIZE_MOTION_STATUS_RESP;
+    uint8_t*       payload = protocol_telemetry_begin(STATE_CMD_MOTION, size);
+    if (payload == NULL) {
         return false;
     }
-    return send_motion_payload(payload, payload_len);
+    return protocol_state_commit(payload, proto_encode_motion_status_resp(&resp, payload, size));
 }
 
 static bool encode_and_send_motion_get_status(uint32_t group_id, uint32_t mask, uint8_t complete)
 {
-    uint8_t payload[10];
     proto_motion_get_status_resp_t resp = {
         .subcmd = (uint8_t)MOTION_CMD_GET_STATUS,
         .group_id = group_id,
@@ -73,38 +62,77 @@ static bool encode_and_send_motion_get_status(uint32_t group_id, uint32_t mask,
         .complete = complete,
     };
 
-    uint16_t payload_len =
-        proto_encode_motion_get_status_resp(&resp, payload, (uint16_t)sizeof(payload));
-    if (payload_len == 0U) {
+    const uint16_t size    = PROTO_SIZE_MOTION_GET_STATUS_RESP;
+    uint8_t*       payload = protocol_state_begin(STATE_CMD_MOTION, size);
+    if (payload == NULL) {
         return false;
     }
-    return send_motion_payload(payload, payload_len);
+    return protocol_state_commit(payload,
+                                 proto_encode_motion_get_status_resp(&resp, payload, size));
 }
 
+static bool encode_and_send_motion_stream_status(void)
+{
+    motion_stream_status_t st;
+    motion_stream_get_status(&st);
 
+    proto_motion_stream_status_resp_t resp = {
+        .subcmd          = (uint8_t)MOTION_CMD_STREAM_GET_STATUS,
+        .active          = (uint8_t)(st.active ? 1U : 0U),
+        .servo_mask      = (uint8_t)st.servo_mask,
+        .latency_ms      = st.latency_ms,
+        .extrapolate_ms  = st.extrapolate_ms,
+        .buffered        = st.buffered,
+        .points          = st.stats.points,
+        .late            = st.stats.late,
+        .overflows       = st.stats.overflows,
+        .underruns       = st.stats.underruns,
+        .extrapolated_ms = st.stats.extrapolated_ms,
+    };
 
-static void protocol_motion_group_done(uint32_t group_id)
-{
-    (void)encode_and_send_motion_status((uint8_t)MOTION_CMD_STATUS, group_id, 1U);
+    const uint16_t size    = PROTO_SIZE_MOTION_STREAM_STATUS_RESP;
+    uint8_t*       payload = protocol_state_begin(STATE_CMD_MOTION, size);
+    if (payload == NULL) {
+        return false;
+    }
+    return protocol_state_commit(payload,
+                                 proto_encode_motion_stream_status_resp(&resp, payload, size));
 }
 
-TF_Result protocol_motion_listener(TinyFrame* tf, TF_Msg* msg)
+// 完成的分组 ID：完成回调（TIM1）写入，protocol_motion_notify_flush()（PendSV）读出，单生产者单消费者
+#define MOTION_DONE_QUEUE_SIZE 8U  // 2 的幂
+_Static_assert(MOTION_DONE_QUEUE_SIZE >= MAX_SYNC_GROUPS, "one entry per sync group");
+_Static_assert((MOTION_DONE_QUEUE_SIZE & (MOTION_DONE_QUEUE_SIZE - 1U)) == 0U, "power of two");
+
+static uint32_t s_group_done[MOTION_DONE_QUEUE_SIZE];
+static uint32_t s_group_done_head = 0;  // 只由完成回调写
+static uint32_t s_group_done_tail = 0;  // 只由 flush 写
+
+// 在 servo_motion_update_1ms()（TIM1，最高优先级）中调用：只记下分组 ID，不在这里发帧。
+// 队列满（PendSV 被推迟了好几个 tick）时丢弃，与推送帧池满时一样
+static void protocol_motion_group_done(uint32_t group_id)
 {
-    (void)tf;
-    if (msg == NULL) {
-        return TF_NEXT;
+    uint32_t head = s_group_done_head;
+    if (head - __atomic_load_n(&s_group_done_tail, __ATOMIC_ACQUIRE) >= MOTION_DONE_QUEUE_SIZE) {
+        return;
     }
+    s_group_done[head & (MOTION_DONE_QUEUE_SIZE - 1U)] = group_id;
+    __atomic_store_n(&s_group_done_head, head + 1U, __ATOMIC_RELEASE);
+}
 
-    proto_cmd_view_t cmd_view;
-    if (!proto_parse_cmd(msg->data, msg->len, &cmd_view)) {
-        return TF_NEXT;
+void protocol_motion_notify_flush(void)
+{
+    uint32_t tail = s_group_done_tail;
+    uint32_t head = __atomic_load_n(&s_group_done_head, __ATOMIC_ACQUIRE);
+    while (tail != head) {
+        uint32_t group_id = s_group_done[tail & (MOTION_DONE_QUEUE_SIZE - 1U)];
+        tail++;
+        __atomic_store_n(&s_group_done_tail, tail, __ATOMIC_RELEASE);
+        (void)encode_and_send_motion_status((uint8_t)MOTION_CMD_STATUS, group_id, 1U);
     }
-
-    (void)protocol_motion_handle(cmd_view.cmd, cmd_view.payload, cmd_view.payload_len);
-    return TF_STAY;
 }
 
-bool protocol_motion_handle(uint8_t cmd, const uint8_t* payload, uint16_t len)
+proto_status_t protocol_motion_handle(uint8_t cmd, const uint8_t* payload, uint16_t len)
 {
     // Payload format: [cmd][payload...]
     switch (cmd) {
@@ -113,22 +141,22 @@ bool protocol_motion_handle(uint8_t cmd, const uint8_t* payload, uint16_t len)
             MOTION_DUMP("payload", payload, len);
             // Payload format: [mode:u8][count:u8][duration:u32][ids...][values...]
             proto_motion_start_req_t req;
-            if (!proto_decode_motion_start(payload, len, &req)) {
-                return false;
+            if (!proto_decode_motion_start_req(payload, len, &req)) {
+                return PROTO_STATUS_BAD_PAYLOAD;
             }
             MOTION_LOG("mode=%u count=%u duration=%lu",
                        (unsigned)req.mode,
-                       (unsigned)req.servo_count,
+                       (unsigned)req.count,
                        (unsigned long)req.duration_ms);
-            if (req.servo_count == 0U || req.servo_count > MAX_SERVOS) {
-                return false;
+            if (req.count == 0U || req.count > MAX_SERVOS) {
+                return PROTO_STATUS_INVALID_ARG;
             }
 
             uint32_t gid = 0;
             if (req.mode == 0U) {
                 uint32_t pwms[MAX_SERVOS];
-                for (uint8_t i = 0; i < req.servo_count; ++i) {
-                    memcpy(&pwms[i], &req.values_raw[(uint16_t)i * 4U], sizeof(uint32_t));
+                for (uint8_t i = 0; i < req.count; ++i) {
+                    pwms[i] = proto_wire_u32(req.values, i);
                     MOTION_LOG("ids[%u]=%u pwm[%u]=%lu",
                                (unsigned)i,
                                (unsigned)req.servo_ids[i],
@@ -137,13 +165,13 @@ bool protocol_motion_handle(uint8_t cmd, const uint8_t* payload, uint16_t len)
                 }
                 gid = motion_sync_move_pwm(req.servo_ids,
                                            pwms,
-                                           req.servo_count,
+                                           req.count,
                                            req.duration_ms,
                                            protocol_motion_group_done);
             } else if (req.mode == 1U) {
                 float angles[MAX_SERVOS];
-                for (uint8_t i = 0; i < req.servo_count; ++i) {
-                    memcpy(&angles[i], &req.values_raw[(uint16_t)i * 4U], sizeof(float));
+                for (uint8_t i = 0; i < req.count; ++i) {
+                    angles[i] = proto_wire_f32(req.values, i);
                     MOTION_LOG("ids[%u]=%u angle[%u]=%.3f",
                                (unsigned)i,
                                (unsigned)req.servo_ids[i],
@@ -152,68 +180,135 @@ bool protocol_motion_handle(uint8_t cmd, const uint8_t* payload, uint16_t len)
                 }
                 gid = motion_sync_move_angle(req.servo_ids,
                                              angles,
-                                             req.servo_count,
+                                             req.count,
                                              req.duration_ms,
                                              protocol_motion_group_done);
             } else {
-                return false;
+                return PROTO_STATUS_INVALID_ARG;
+            }
+            if (gid == 0U) {
+                return PROTO_STATUS_BUSY;  // 没有空闲的同步组（组 ID 0 无效）
             }
 
-            return encode_and_send_motion_start(gid);
+            return protocol_reply_status(encode_and_send_motion_start(gid));
         }
         case MOTION_CMD_STOP: {
             MOTION_LOG("CMD STOP");
             MOTION_DUMP("payload", payload, len);
-            uint32_t gid = 0;
-            if (!proto_decode_motion_id(payload, len, &gid)) {
-                return false;
+            proto_motion_id_req_t req;
+            if (!proto_decode_motion_id_req(payload, len, &req)) {
+                return PROTO_STATUS_BAD_PAYLOAD;
             }
+            uint32_t gid = req.group_id;
             MOTION_LOG("group_id=%lu", (unsigned long)gid);
-            return motion_sync_release_group(gid);
+            return motion_sync_release_group(gid) ? PROTO_STATUS_OK : PROTO_STATUS_FAILED;
         }
         case MOTION_CMD_PAUSE: {
             MOTION_LOG("CMD PAUSE");
             MOTION_DUMP("payload", payload, len);
-            uint32_t gid = 0;
-            if (!proto_decode_motion_id(payload, len, &gid)) {
-                return false;
+            proto_motion_id_req_t req;
+            if (!proto_decode_motion_id_req(payload, len, &req)) {
+                return PROTO_STATUS_BAD_PAYLOAD;
             }
+            uint32_t gid = req.group_id;
             MOTION_LOG("group_id=%lu", (unsigned long)gid);
-            return motion_sync_pause_group(gid);
+            return motion_sync_pause_group(gid) ? PROTO_STATUS_OK : PROTO_STATUS_FAILED;
         }
         case MOTION_CMD_RESUME: {
             MOTION_LOG("CMD RESUME");
             MOTION_DUMP("payload", payload, len);
-            uint32_t gid = 0;
-            if (!proto_decode_motion_id(payload, len, &gid)) {
-                return false;
+            proto_motion_id_req_t req;
+            if (!proto_decode_motion_id_req(payload, len, &req)) {
+                return PROTO_STATUS_BAD_PAYLOAD;
             }
+            uint32_t gid = req.group_id;
             MOTION_LOG("group_id=%lu", (unsigned long)gid);
-            return motion_sync_restart_group(gid);
+            return motion_sync_restart_group(gid) ? PROTO_STATUS_OK : PROTO_STATUS_FAILED;
         }
         case MOTION_CMD_GET_STATUS: {
             MOTION_LOG("CMD GET_STATUS");
             MOTION_DUMP("payload", payload, len);
-            uint32_t gid = 0;
-            if (!proto_decode_motion_id(payload, len, &gid)) {
-                return false;
+            proto_motion_id_req_t req;
+            if (!proto_decode_motion_id_req(payload, len, &req)) {
+                return PROTO_STATUS_BAD_PAYLOAD;
             }
+            uint32_t gid = req.group_id;
             MOTION_LOG("group_id=%lu", (unsigned long)gid);
-            return encode_and_send_motion_get_status(
+            return protocol_reply_status(encode_and_send_motion_get_status(
                 gid,
                 motion_sync_get_group_mask(gid),
-                (uint8_t)(motion_sync_is_group_complete(gid) ? 1U : 0U));
+                (uint8_t)(motion_sync_is_group_complete(gid) ? 1U : 0U)));
         }
         case MOTION_CMD_SET_PLAN:
             MOTION_LOG("CMD SET_PLAN");
             MOTION_DUMP("payload", payload, len);
-            return false;
+            return PROTO_STATUS_UNSUPPORTED;
         case MOTION_CMD_STATUS:
             MOTION_LOG("CMD STATUS");
             MOTION_DUMP("payload", payload, len);
-            return true;
+            return PROTO_STATUS_OK;
+        case MOTION_CMD_STREAM_START: {
+            MOTION_LOG("CMD STREAM_START");
+            MOTION_DUMP("payload", payload, len);
+            // Payload format: [servo_mask:u8][latency_ms:u16][extrapolate_ms:u16 (optional)]
+            proto_motion_stream_start_req_t req;
+            if (!proto_decode_motion_stream_start_req(payload, len, &req)) {
+                return PROTO_STATUS_BAD_PAYLOAD;
+            }
+            uint16_t extrapolate_ms = req.has_extrapolate_ms
+                                          ? req.extrapolate_ms
+                                          : (uint16_t)MOTION_STREAM_DEFAULT_EXTRAPOLATE_MS;
+            MOTION_LOG("mask=0x%02X latency=%u extrapolate=%u",
+                       (unsigned)req.servo_mask,
+                       (unsigned)req.latency_ms,
+                       (unsigned)extrapolate_ms);
+            if (!motion_stream_start(req.servo_mask, req.latency_ms, extrapolate_ms)) {
+                return PROTO_STATUS_INVALID_ARG;
+            }
+            motion_stream_reset_stats();
+            return PROTO_STATUS_OK;
+        }
+        case MOTION_CMD_STREAM_POINT: {
+            // 高频命令，不打印日志
+            // Payload format: [t_ms:u32][pwm:u16 * servo count]，按 servo_mask 中的 ID 升序
+            proto_motion_stream_point_req_t req;
+            if (!proto_decode_motion_stream_point_req(payload, len, &req)) {
+                return PROTO_STATUS_BAD_PAYLOAD;
+            }
+            motion_stream_status_t st;
+            motion_stream_get_status(&st);
+            if (!st.active) {
+                return PROTO_STATUS_FAILED;
+            }
+            if (req.pwms_count != (uint16_t)__builtin_popcount(st.servo_mask)) {
+                return PROTO_STATUS_BAD_PAYLOAD;
+            }
+
+            uint16_t pwm[MAX_SERVOS] = {0};
+            uint16_t n               = 0U;
+            for (uint8_t id = 0; id < MAX_SERVOS; ++id) {
+                if ((st.servo_mask & (1U << id)) != 0U) {
+                    pwm[id] = proto_wire_u16(req.pwms, n++);
+                }
+            }
+            switch (motion_stream_push(req.t_ms, pwm)) {
+                case MOTION_STREAM_OK:
+                    return PROTO_STATUS_OK;
+                case MOTION_STREAM_FULL:
+                    return PROTO_STATUS_BUSY;
+                default:
+                    return PROTO_STATUS_FAILED;  // 未开启 / 迟到，计入状态中的计数
+            }
+        }
+        case MOTION_CMD_STREAM_STOP:
+            MOTION_LOG("CMD STREAM_STOP");
+            motion_stream_stop();
+            return PROTO_STATUS_OK;
+        case MOTION_CMD_STREAM_GET_STATUS:
+            MOTION_LOG("CMD STREAM_GET_STATUS");
+            return protocol_reply_status(encode_and_send_motion_stream_status());
         
         default:
-            return false;
+            return PROTO_STATUS_UNKNOWN_CMD;
     }
 }
@@ -1,8 +1,9 @@
 #include <stdio.h>
 
+#include "debug_output.h"
 #include "motion_engine.h"
+#include "proto_msg.h"
 #include "protocol.h"
-#include "servo_codec.h"
 #include "tinyframe/TinyFrame.h"
 
 #ifndef SERVO_LISTENER_LOG_ENABLE
@@ -10,25 +11,22 @@
 #endif
 
 #if SERVO_LISTENER_LOG_ENABLE
-#define SERVO_LOG(fmt, ...) printf("[servo] " fmt "\n", ##__VA_ARGS__)
-#define SERVO_DUMP(label, data, len)                            \
-    do {                                                        \
-        printf("[servo] %s (len=%u):", label, (unsigned)(len)); \
-        for (uint16_t _i = 0; _i < (len); ++_i) {               \
-            printf(" %02X", (unsigned)(data)[_i]);              \
-        }                                                       \
-        printf("\n");                                           \
-    } while (0)
+#define SERVO_LOG(fmt, ...)          DEBUG_LOG("[servo] " fmt "\n", ##__VA_ARGS__)
+#define SERVO_DUMP(label, data, len) DEBUG_DUMP("[servo] ", label, data, len)
 #else
 #define SERVO_LOG(fmt, ...)          ((void)0)
 #define SERVO_DUMP(label, data, len) ((void)0)
 #endif
 
+#define SERVO_HOME_DURATION_MS 1000U
+
+// 要推送完成状态的舵机：处理函数（主循环）置位，完成回调（TIM1）清除，两边都用原子操作
 static uint32_t s_servo_notify_mask = 0;
+// 已完成、待推送的舵机：完成回调置位，protocol_servo_notify_flush()（PendSV）取走
+static uint32_t s_servo_done_mask = 0;
 
 static bool protocol_send_servo_status(uint8_t subcmd, uint8_t id)
 {
-    uint8_t resp_buf[18];
     proto_servo_status_resp_t resp = {
         .subcmd = subcmd,
         .servo_id = id,
@@ -38,43 +36,42 @@ static bool protocol_send_servo_status(uint8_t subcmd, uint8_t id)
         .remaining_time = servo_get_remaining_time(id),
     };
 
-    uint16_t resp_len = proto_encode_servo_status_resp(&resp, resp_buf, (uint16_t)sizeof(resp_buf));
-    if (resp_len == 0U) {
+    // 运动完成推送走批量优先级，GET_STATUS 应答走控制优先级
+    const uint16_t size     = PROTO_SIZE_SERVO_STATUS_RESP;
+    uint8_t*       resp_buf = (subcmd == (uint8_t)SERVO_CMD_STATUS)
+                                  ? protocol_telemetry_begin(STATE_CMD_SERVO, size)
+                                  : protocol_state_begin(STATE_CMD_SERVO, size);
+    if (resp_buf == NULL) {
         return false;
     }
-    return protocol_send_state(STATE_CMD_SERVO, resp_buf, resp_len);
+    return protocol_state_commit(resp_buf, proto_encode_servo_status_resp(&resp, resp_buf, size));
 }
 
+// 在 servo_motion_update_1ms()（TIM1，最高优先级）中调用：只记下完成的舵机，不在这里发帧
 static void protocol_servo_complete_cb(uint8_t id)
 {
     if (id >= MAX_SERVOS) {
         return;
     }
-    if ((s_servo_notify_mask & (1U << id)) == 0) {
+
+    uint32_t bit = 1U << id;
+    if ((__atomic_fetch_and(&s_servo_notify_mask, ~bit, __ATOMIC_RELAXED) & bit) == 0U) {
         return;
     }
-
-    s_servo_notify_mask &= ~(1U << id);
-    (void)protocol_send_servo_status((uint8_t)SERVO_CMD_STATUS, id);
+    __atomic_fetch_or(&s_servo_done_mask, bit, __ATOMIC_RELEASE);
 }
 
-TF_Result protocol_servo_listener(TinyFrame* tf, TF_Msg* msg)
+void protocol_servo_notify_flush(void)
 {
-    (void)tf;
-    if (msg == NULL) {
-        return TF_NEXT;
-    }
-
-    proto_cmd_view_t cmd_view;
-    if (!proto_parse_cmd(msg->data, msg->len, &cmd_view)) {
-        return TF_NEXT;
+    uint32_t done = __atomic_exchange_n(&s_servo_done_mask, 0U, __ATOMIC_ACQUIRE);
+    while (done != 0U) {
+        uint8_t id = (uint8_t)__builtin_ctz(done);
+        done &= done - 1U;
+        (void)protocol_send_servo_status((uint8_t)SERVO_CMD_STATUS, id);
     }
-
-    (void)protocol_servo_handle(cmd_view.cmd, cmd_view.payload, cmd_view.payload_len);
-    return TF_STAY;
 }
 
-bool protocol_servo_handle(uint8_t cmd, const uint8_t* payload, uint16_t len)
+proto_status_t protocol_servo_handle(uint8_t cmd, const uint8_t* payload, uint16_t len)
 {
     // Payload format: [cmd][payload...]
     switch (cmd) {
@@ -83,91 +80,91 @@ bool protocol_servo_handle(uint8_t cmd, const uint8_t* payload, uint16_t len)
             SERVO_DUMP("payload", payload, len);
             // No explicit enable in current motor layer; sync outputs.
             servo_sync_to_hardware();
-            return true;
+            return PROTO_STATUS_OK;
         }
         case SERVO_CMD_DISABLE: {
             SERVO_LOG("CMD DISABLE");
             SERVO_DUMP("payload", payload, len);
-            if (len == 1) {
-                uint8_t id = payload[0];
-                if (id >= MAX_SERVOS) {
-                    return false;
+            if (len != 0U) {
+                proto_servo_id_req_t req;
+                if (!proto_decode_servo_id_req(payload, len, &req)) {
+                    return PROTO_STATUS_BAD_PAYLOAD;
+                }
+                if (req.id >= MAX_SERVOS) {
+                    return PROTO_STATUS_INVALID_ARG;
                 }
-                SERVO_LOG("id=%u", (unsigned)id);
-                servo_stop(id);
-                return true;
+                SERVO_LOG("id=%u", (unsigned)req.id);
+                servo_stop(req.id);
+                return PROTO_STATUS_OK;
             }
-            servo_emergency_stop();
-            return true;
+            protocol_estop_now();  // 通常接收中断里已经停过（PROTO_ESTOP_ENABLE），这里再停一次
+            return PROTO_STATUS_OK;
         }
         case SERVO_CMD_SET_PWM: {
             SERVO_LOG("CMD SET_PWM");
             SERVO_DUMP("payload", payload, len);
             proto_servo_set_pwm_req_t req;
             if (!proto_decode_servo_set_pwm_req(payload, len, &req)) {
-                return false;
+                return PROTO_STATUS_BAD_PAYLOAD;
             }
             if (req.id >= MAX_SERVOS) {
-                return false;
+                return PROTO_STATUS_INVALID_ARG;
             }
             SERVO_LOG("id=%u pwm=%lu duration=%lu",
                       (unsigned)req.id,
                       (unsigned long)req.pwm,
                       (unsigned long)req.duration_ms);
             servo_move_pwm(req.id, req.pwm, req.duration_ms, protocol_servo_complete_cb);
-            s_servo_notify_mask |= (1U << req.id);
-            return true;
+            __atomic_fetch_or(&s_servo_notify_mask, 1U << req.id, __ATOMIC_RELAXED);
+            return PROTO_STATUS_OK;
         }
         case SERVO_CMD_SET_POS: {
             SERVO_LOG("CMD SET_POS");
             SERVO_DUMP("payload", payload, len);
             proto_servo_set_pos_req_t req;
             if (!proto_decode_servo_set_pos_req(payload, len, &req)) {
-                return false;
+                return PROTO_STATUS_BAD_PAYLOAD;
             }
             if (req.id >= MAX_SERVOS) {
-                return false;
+                return PROTO_STATUS_INVALID_ARG;
             }
             SERVO_LOG("id=%u angle=%.3f duration=%lu",
                       (unsigned)req.id,
                       (double)req.angle,
                       (unsigned long)req.duration_ms);
             servo_move_angle(req.id, req.angle, req.duration_ms, protocol_servo_complete_cb);
-            s_servo_notify_mask |= (1U << req.id);
-            return true;
+            __atomic_fetch_or(&s_servo_notify_mask, 1U << req.id, __ATOMIC_RELAXED);
+            return PROTO_STATUS_OK;
         }
         case SERVO_CMD_HOME: {
             SERVO_LOG("CMD HOME");
             SERVO_DUMP("payload", payload, len);
-            proto_servo_home_req_t req;
-            if (!proto_decode_servo_home_req(payload, len, &req)) {
-                return false;
-            }
-
+            // 一键回零：无负载（分发表已检查），固定 1000ms
             for (uint8_t i = 0; i < MAX_SERVOS; ++i) {
-                servo_move_home(i, req.duration_ms, protocol_servo_complete_cb);
-                s_servo_notify_mask |= (1U << i);
+                servo_move_home(i, SERVO_HOME_DURATION_MS, protocol_servo_complete_cb);
+                __atomic_fetch_or(&s_servo_notify_mask, 1U << i, __ATOMIC_RELAXED);
             }
-            return true;
+            return PROTO_STATUS_OK;
         }
         case SERVO_CMD_GET_STATUS: {
             SERVO_LOG("CMD GET_STATUS");
             SERVO_DUMP("payload", payload, len);
-            uint8_t id = 0;
-            if (!proto_decode_servo_id_req(payload, len, &id)) {
-                return false;
+            proto_servo_id_req_t req;
+            if (!proto_decode_servo_id_req(payload, len, &req)) {
+                return PROTO_STATUS_BAD_PAYLOAD;
             }
-            if (id >= MAX_SERVOS) {
-                return false;
+            if (req.id >= MAX_SERVOS) {
+                return PROTO_STATUS_INVALID_ARG;
             }
-            SERVO_LOG("id=%u", (unsigned)id);
-            return protocol_send_servo_status((uint8_t)SERVO_CMD_GET_STATUS, id);
+            SERVO_LOG("id=%u", (unsigned)req.id);
+            return protocol_reply_status(
+                protocol_send_servo_status((uint8_t)SERVO_CMD_GET_STATUS, req.id));
         }
         case SERVO_CMD_STATUS:
             SERVO_LOG("CMD STATUS");
             SERVO_DUMP("payload", payload, len);
-            return true;
+            return PROTO_STATUS_OK;
         default:
-            return false;
+            return PROTO_STATUS_UNKNOWN_CMD;
     }
 }
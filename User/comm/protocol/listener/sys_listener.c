@@ -1,75 +1,212 @@
 #include "../protocol.h"
 #include "../transport/TinyFrame/TinyFrame.h"
+#include "motion_cycle.h"
+#include "motion_engine.h"
+#include "motion_sync.h"
+#include "proto_msg.h"
 #include "tf_uart_port.h"
 
-TF_Result protocol_sys_listener(TinyFrame* tf, TF_Msg* msg)
+// 快照副本：snapshot_resp 的各数组指向这里
+typedef struct {
+    proto_snapshot_servo_t servo[MAX_SERVOS];
+    proto_snapshot_group_t group[MAX_SYNC_GROUPS];
+    proto_snapshot_cycle_t cycle[MAX_CYCLE];
+} snapshot_copy_t;
+
+// 舵机掩码只有一个字节
+_Static_assert(MAX_SERVOS <= 8U, "too many servos for a snapshot");
+_Static_assert(sizeof(snapshot_copy_t) <= PROTO_SCRATCH_SIZE, "snapshot does not fit the scratch");
+
+// 在两个 1ms tick 之间复制全部运动状态：hold 期间 tick 不推进（之后补上），
+// 舵机、同步组和 cycle 的完成回调也都不会执行，复制出的值相互一致
+static void snapshot_take(snapshot_copy_t* copy, proto_snapshot_resp_t* snap)
 {
-    (void)tf;
-    if (msg == NULL) {
-        return TF_NEXT;
-    }
+    snap->servo_count = (uint8_t)MAX_SERVOS;
+    snap->group_count = 0U;
+    snap->cycle_count = 0U;
+    snap->servos      = copy->servo;
+    snap->groups      = copy->group;
+    snap->cycles      = copy->cycle;
 
-    proto_cmd_view_t cmd_view;
-    if (!proto_parse_cmd(msg->data, msg->len, &cmd_view)) {
-        return TF_NEXT;
+    servo_motion_hold();
+    for (uint8_t id = 0; id < MAX_SERVOS; ++id) {
+        proto_snapshot_servo_t* s = &copy->servo[id];
+        s->moving                 = (uint8_t)(servo_is_moving(id) ? 1U : 0U);
+        s->current_pwm            = (uint16_t)servo_get_current_pwm(id);
+        s->target_angle           = servo_get_target_angle(id);
+        s->remaining_ms           = servo_get_remaining_time(id);
     }
-
-    if (protocol_sys_handle(cmd_view.cmd, cmd_view.payload, cmd_view.payload_len)) {
-        return TF_STAY;
+    for (uint8_t slot = 0; slot < MAX_SYNC_GROUPS; ++slot) {
+        sync_group_status_t gs;
+        if (!motion_sync_get_group_status(slot, &gs)) {
+            continue;
+        }
+        proto_snapshot_group_t* g = &copy->group[snap->group_count++];
+        g->group_id               = gs.id;
+        g->mask                   = (uint8_t)gs.mask;
+        g->done_mask              = (uint8_t)gs.done_mask;
     }
-
-    return TF_NEXT;
+    for (uint8_t i = 0; i < MAX_CYCLE; ++i) {
+        motion_cycle_status_t cs;
+        if (!motion_cycle_get_status(i, &cs) || !cs.active) {
+            continue;
+        }
+        proto_snapshot_cycle_t* c = &copy->cycle[snap->cycle_count++];
+        c->index                  = i;
+        c->running                = (uint8_t)(cs.running ? 1U : 0U);
+        c->current_pose           = cs.current_pose_index;
+        c->pose_count             = cs.pose_count;
+        c->loop_count             = cs.loop_count;
+        c->max_loops              = cs.max_loops;
+        c->active_group_id        = cs.active_group_id;
+    }
+    servo_motion_release();
 }
 
-bool protocol_sys_handle(uint8_t cmd, const uint8_t* payload, uint16_t len)
+proto_status_t protocol_sys_handle(uint8_t cmd, const uint8_t* payload, uint16_t len)
 {
     // Payload format: [cmd][payload...]
     switch (cmd) {
         case SYS_CMD_PING: {
-            uint8_t  frame[1U + PROTO_MAX_PAYLOAD];
+            // 回显负载，直接写入发送队列
+            uint8_t* frame = protocol_reply_begin((uint16_t)(1U + len));
+            if (frame == NULL) {
+                return PROTO_STATUS_BUSY;
+            }
             uint16_t frame_len = 0U;
             if (!proto_encode_cmd_frame(
-                    (uint8_t)SYS_CMD_PONG, payload, len, frame, (uint16_t)sizeof(frame), &frame_len)) {
-                return false;
+                    (uint8_t)SYS_CMD_PONG, payload, len, frame, (uint16_t)(1U + len), &frame_len)) {
+                (void)protocol_reply_commit(frame, PROTO_TYPE_SYS, 0U);
+                return PROTO_STATUS_BAD_PAYLOAD;
             }
-            return tf_uart_port_send_frame(PROTO_TYPE_SYS, frame, frame_len);
+            return protocol_reply_status(protocol_reply_commit(frame, PROTO_TYPE_SYS, frame_len));
         }
         case SYS_CMD_PONG:
-            return true;
+            return PROTO_STATUS_OK;
         case SYS_CMD_HEARTBEAT:
-            return true;
+            return PROTO_STATUS_OK;
         case SYS_CMD_GET_INFO: {
+            // 应答: [SYS_CMD_INFO][major:u8][minor:u8][name_len:u8][name...]，直接写入发送帧槽
             const char* name = PROTO_DEVICE_NAME;
             uint8_t name_len = 0;
-            while (name[name_len] != '\0' && name_len < (uint8_t)(PROTO_MAX_PAYLOAD - 3)) {
+            while (name[name_len] != '\0' && name_len < (uint8_t)(sizeof(PROTO_DEVICE_NAME) - 1U)) {
                 name_len++;
             }
-            uint8_t payload_buf[3 + PROTO_MAX_PAYLOAD];
-            uint8_t frame[1U + PROTO_MAX_PAYLOAD];
-            payload_buf[0] = (uint8_t)PROTO_VERSION_MAJOR;
-            payload_buf[1] = (uint8_t)PROTO_VERSION_MINOR;
-            payload_buf[2] = name_len;
-            for (uint8_t i = 0; i < name_len; ++i) {
-                payload_buf[3 + i] = (uint8_t)name[i];
+            proto_sys_info_resp_t resp = {
+                .major    = (uint8_t)PROTO_VERSION_MAJOR,
+                .minor    = (uint8_t)PROTO_VERSION_MINOR,
+                .name_len = name_len,
+                .name     = (const uint8_t*)name,
+            };
+            uint16_t size  = (uint16_t)proto_size_sys_info_resp(&resp);
+            uint8_t* frame = protocol_reply_begin((uint16_t)(1U + size));
+            if (frame == NULL) {
+                return PROTO_STATUS_BUSY;
+            }
+            frame[0]   = (uint8_t)SYS_CMD_INFO;
+            uint16_t n = proto_encode_sys_info_resp(&resp, &frame[1], size);
+            return protocol_reply_status(
+                protocol_reply_commit(frame, PROTO_TYPE_SYS, (uint16_t)(1U + n)));
+        }
+        case SYS_CMD_INFO:
+            return PROTO_STATUS_OK;
+        case SYS_CMD_SET_FRAME_MODE: {
+            // 请求: [mode:u8]，无负载时仅查询
+            // 应答: [mode:u8][max_payload:u16]，以切换前的格式发送，发送后再切换
+            uint8_t mode = tf_uart_port_is_large_frames() ? (uint8_t)PROTO_FRAME_MODE_LARGE
+                                                          : (uint8_t)PROTO_FRAME_MODE_SMALL;
+            if (len != 0U) {
+                proto_sys_frame_mode_req_t req;
+                if (!proto_decode_sys_frame_mode_req(payload, len, &req)) {
+                    return PROTO_STATUS_BAD_PAYLOAD;
+                }
+                if (req.mode != (uint8_t)PROTO_FRAME_MODE_SMALL
+                    && req.mode != (uint8_t)PROTO_FRAME_MODE_LARGE) {
+                    return PROTO_STATUS_INVALID_ARG;
+                }
+                mode = req.mode;
+            }
+
+            proto_sys_frame_mode_resp_t resp = {
+                .mode        = mode,
+                .max_payload = (mode == (uint8_t)PROTO_FRAME_MODE_LARGE) ? COMM_MAX_PAYLOAD
+                                                                         : COMM_SMALL_MAX_PAYLOAD,
+            };
+            uint8_t frame[1U + PROTO_SIZE_SYS_FRAME_MODE_RESP];
+            frame[0] = (uint8_t)SYS_CMD_FRAME_MODE;
+            (void)proto_encode_sys_frame_mode_resp(&resp, &frame[1], sizeof(frame) - 1U);
+            if (!protocol_send_reply(PROTO_TYPE_SYS, frame, (uint16_t)sizeof(frame))) {
+                return PROTO_STATUS_BUSY;
+            }
+            return tf_uart_port_set_large_frames(mode == (uint8_t)PROTO_FRAME_MODE_LARGE)
+                       ? PROTO_STATUS_OK
+                       : PROTO_STATUS_FAILED;
+        }
+        case SYS_CMD_FRAME_MODE:
+            return PROTO_STATUS_OK;
+        case SYS_CMD_SET_BAUD: {
+            // 请求: [baud:u32][timeout_ms:u16]，超时可省略，无负载时仅查询
+            // 应答: [status:u8][baud:u32]，以旧波特率发送，发完后再切换
+            proto_sys_set_baud_req_t req;
+            if (!proto_decode_sys_set_baud_req(payload, len, &req)) {
+                return PROTO_STATUS_BAD_PAYLOAD;
+            }
+            proto_sys_baud_resp_t resp = {
+                .status = (uint8_t)PROTO_BAUD_OK,
+                .baud   = tf_uart_port_get_baud(),
+            };
+            if (req.has_baud) {
+                uint16_t timeout = (req.has_timeout_ms && req.timeout_ms != 0U)
+                                       ? req.timeout_ms
+                                       : (uint16_t)PROTO_BAUD_CONFIRM_TIMEOUT_MS;
+                if (tf_uart_port_request_baud(req.baud, timeout)) {
+                    resp.baud = req.baud;
+                } else {
+                    resp.status = (uint8_t)PROTO_BAUD_UNSUPPORTED;
+                }
             }
 
-            uint16_t frame_len = 0U;
-            if (!proto_encode_cmd_frame((uint8_t)SYS_CMD_INFO,
-                                        payload_buf,
-                                        (uint16_t)(3U + name_len),
-                                        frame,
-                                        (uint16_t)sizeof(frame),
-                                        &frame_len)) {
-                return false;
+            uint8_t frame[1U + PROTO_SIZE_SYS_BAUD_RESP];
+            frame[0] = (uint8_t)SYS_CMD_BAUD;
+            (void)proto_encode_sys_baud_resp(&resp, &frame[1], PROTO_SIZE_SYS_BAUD_RESP);
+            return protocol_reply_status(
+                protocol_send_reply(PROTO_TYPE_SYS, frame, (uint16_t)sizeof(frame)));
+        }
+        case SYS_CMD_BAUD:
+            return PROTO_STATUS_OK;
+        case SYS_CMD_GET_SNAPSHOT: {
+            // 应答: [SYS_CMD_SNAPSHOT][snapshot]，先复制再编码，hold 时间只包括复制。
+            // 副本放在协议层的暂存区，不占处理函数的栈
+            snapshot_copy_t* copy = protocol_scratch((uint16_t)sizeof(*copy));
+            if (copy == NULL) {
+                return PROTO_STATUS_FAILED;
+            }
+            proto_snapshot_resp_t snap;
+            snapshot_take(copy, &snap);
+
+            uint32_t size = proto_size_snapshot_resp(&snap);
+            if (1U + size > tf_uart_port_max_payload()) {
+                return PROTO_STATUS_FAILED;
             }
-            return tf_uart_port_send_frame(PROTO_TYPE_SYS, frame, frame_len);
+            uint8_t* frame = protocol_reply_begin((uint16_t)(1U + size));
+            if (frame == NULL) {
+                return PROTO_STATUS_BUSY;
+            }
+            frame[0] = (uint8_t)SYS_CMD_SNAPSHOT;
+            uint16_t n = proto_encode_snapshot_resp(&snap, &frame[1], (uint16_t)size);
+            if (n == 0U) {
+                (void)protocol_reply_commit(frame, PROTO_TYPE_SYS, 0U);
+                return PROTO_STATUS_FAILED;
+            }
+            return protocol_reply_status(
+                protocol_reply_commit(frame, PROTO_TYPE_SYS, (uint16_t)(1U + n)));
         }
-        case SYS_CMD_INFO:
-            return true;
+        case SYS_CMD_SNAPSHOT:
+            return PROTO_STATUS_OK;
         case SYS_CMD_RESET:
             // No platform reset hooked yet.
-            return true;
+            return PROTO_STATUS_UNSUPPORTED;
         default:
-            return false;
+            return PROTO_STATUS_UNKNOWN_CMD;
     }
 }
@@ -0,0 +1,145 @@
+#include "../protocol.h"
+#include "../transport/TinyFrame/TinyFrame.h"
+#include "motion_cycle.h"
+#include "motion_engine.h"
+#include "telemetry_codec.h"
+#include "tf_uart_port.h"
+
+_Static_assert(MAX_SERVOS <= PROTO_TELEM_MAX_SERVOS, "servo_mask is one byte");
+_Static_assert(MAX_CYCLE <= PROTO_TELEM_MAX_CYCLES, "cycle masks are one byte");
+
+// 订阅配置打包成一个字，主循环一次写入，1ms 中断一次读出，不需要关中断
+// [period_ms:u16][servo_mask:u8][fields:u8]，period_ms 为 0 表示未订阅
+static volatile uint32_t s_telem_config = 0;
+
+// 以下只在 1ms 中断中访问
+static uint32_t s_telem_tick_ms   = 0;
+static uint16_t s_telem_countdown = 0;
+static uint16_t s_telem_seq       = 0;
+
+static inline uint32_t telem_pack(uint8_t fields, uint8_t servo_mask, uint16_t period_ms)
+{
+    return ((uint32_t)period_ms << 16) | ((uint32_t)servo_mask << 8) | fields;
+}
+
+static void telem_sample(uint32_t config)
+{
+    proto_telem_sample_t sample;
+    sample.seq        = s_telem_seq++;  // 发送失败也占用序号，主机据此发现丢帧
+    sample.tick_ms    = s_telem_tick_ms;
+    sample.fields     = (uint8_t)(config & 0xFFU);
+    sample.servo_mask = (uint8_t)((config >> 8) & 0xFFU);
+
+    for (uint8_t id = 0; id < MAX_SERVOS; ++id) {
+        if ((sample.servo_mask & (1U << id)) == 0U) {
+            continue;
+        }
+        sample.pwm[id]          = (uint16_t)servo_get_current_pwm(id);
+        sample.target_angle[id] = servo_get_target_angle(id);
+        sample.remaining_ms[id] = servo_get_remaining_time(id);
+    }
+    sample.moving_mask = (uint8_t)servo_get_moving_mask();
+
+    sample.cycle_active_mask  = 0U;
+    sample.cycle_running_mask = 0U;
+    if ((sample.fields & (uint8_t)PROTO_TELEM_CYCLE) != 0U) {
+        for (uint8_t i = 0; i < MAX_CYCLE; ++i) {
+            motion_cycle_status_t st;
+            if (!motion_cycle_get_status(i, &st) || !st.active) {
+                continue;
+            }
+            sample.cycle_active_mask |= (uint8_t)(1U << i);
+            if (st.running) {
+                sample.cycle_running_mask |= (uint8_t)(1U << i);
+            }
+            sample.cycle[i].pose_index = st.current_pose_index;
+            sample.cycle[i].loop_count = st.loop_count;
+        }
+    }
+
+    uint16_t max_len = proto_telem_frame_max_size(sample.fields, sample.servo_mask);
+    uint8_t* buf     = protocol_telemetry_begin(STATE_CMD_TELEMETRY, max_len);
+    if (buf == NULL) {
+        return;  // 没有空闲帧槽，计入 DEBUG_STATS_TX 的批量丢弃数
+    }
+    (void)protocol_state_commit(buf, proto_encode_telem_frame(&sample, buf, max_len));
+}
+
+void protocol_telemetry_tick_1ms(void)
+{
+    s_telem_tick_ms++;
+
+    uint32_t config    = s_telem_config;
+    uint16_t period_ms = (uint16_t)(config >> 16);
+    if (period_ms == 0U) {
+        s_telem_countdown = 0;
+        return;
+    }
+    if (s_telem_countdown > period_ms) {
+        s_telem_countdown = period_ms;  // 周期变短时不必等完旧周期
+    }
+    if (s_telem_countdown > 1U) {
+        s_telem_countdown--;
+        return;
+    }
+    s_telem_countdown = period_ms;
+    telem_sample(config);
+}
+
+static proto_status_t telem_send_subscription(void)
+{
+    uint32_t                        config = s_telem_config;
+    proto_telem_subscription_resp_t resp   = {
+          .fields     = (uint8_t)(config & 0xFFU),
+          .servo_mask = (uint8_t)((config >> 8) & 0xFFU),
+          .period_ms  = (uint16_t)(config >> 16),
+    };
+
+    const uint16_t size  = PROTO_SIZE_TELEM_SUBSCRIPTION_RESP;
+    uint8_t*       frame = protocol_reply_begin((uint16_t)(1U + size));
+    if (frame == NULL) {
+        return PROTO_STATUS_BUSY;
+    }
+    frame[0] = (uint8_t)TELEM_CMD_SUBSCRIPTION;
+    uint16_t len = proto_encode_telem_subscription_resp(&resp, &frame[1], size);
+    return protocol_reply_status(
+        protocol_reply_commit(frame, PROTO_TYPE_TELEM, (uint16_t)(len + 1U)));
+}
+
+proto_status_t protocol_telem_handle(uint8_t cmd, const uint8_t* payload, uint16_t len)
+{
+    switch (cmd) {
+        case TELEM_CMD_SUBSCRIBE: {
+            // 请求: [fields:u8][servo_mask:u8][rate_hz:u16]，rate_hz 或 fields 为 0 时取消订阅，
+            // 无负载时仅查询
+            // 应答: TELEM_CMD_SUBSCRIPTION [fields:u8][servo_mask:u8][period_ms:u16]
+            if (len == 0U) {
+                return telem_send_subscription();
+            }
+            proto_telem_subscribe_req_t req;
+            if (!proto_decode_telem_subscribe_req(payload, len, &req)) {
+                return PROTO_STATUS_BAD_PAYLOAD;
+            }
+            if (req.rate_hz == 0U || req.fields == 0U) {
+                s_telem_config = 0;
+                return telem_send_subscription();
+            }
+            if ((req.fields & ~PROTO_TELEM_FIELDS_ALL) != 0U
+                || (req.servo_mask >> MAX_SERVOS) != 0U || req.rate_hz > PROTO_TELEM_MAX_RATE_HZ) {
+                return PROTO_STATUS_INVALID_ARG;
+            }
+            // STATE 帧: [STATE_CMD_TELEMETRY][sample]，必须放进当前模式的一帧
+            if (1U + proto_telem_frame_max_size(req.fields, req.servo_mask)
+                > tf_uart_port_max_payload()) {
+                return PROTO_STATUS_INVALID_ARG;
+            }
+            s_telem_config =
+                telem_pack(req.fields, req.servo_mask, (uint16_t)(1000U / req.rate_hz));
+            return telem_send_subscription();
+        }
+        case TELEM_CMD_SUBSCRIPTION:
+            return PROTO_STATUS_OK;
+        default:
+            return PROTO_STATUS_UNKNOWN_CMD;
+    }
+}
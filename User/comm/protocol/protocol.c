@@ -1,15 +1,177 @@
 #include "protocol.h"
 
+#include <string.h>
+
+#include "proto_msg.h"
 #include "tf_uart_port.h"
 #include "tinyframe/TinyFrame.h"
 
-// Per-type listeners defined in their respective files
-extern TF_Result protocol_sys_listener(TinyFrame* tf, TF_Msg* msg);
-extern TF_Result protocol_servo_listener(TinyFrame* tf, TF_Msg* msg);
-extern TF_Result protocol_motion_listener(TinyFrame* tf, TF_Msg* msg);
-extern TF_Result protocol_cycle_listener(TinyFrame* tf, TF_Msg* msg);
-extern TF_Result protocol_arm_listener(TinyFrame* tf, TF_Msg* msg);
-extern TF_Result protocol_config_listener(TinyFrame* tf, TF_Msg* msg);
+// 正在处理的请求（只在主循环中设置）
+static struct {
+    bool     active;
+    bool     replied;
+    uint8_t  type;
+    uint8_t  cmd;
+    TF_ID    frame_id;
+    uint8_t* reply;  // 本请求的应答帧（负载指针），提交时带上请求的帧 ID
+} request;
+
+// 命令处理函数共用的暂存区（union 保证对齐）
+static union {
+    uint8_t  bytes[PROTO_SCRATCH_SIZE];
+    uint32_t align;
+} s_scratch;
+
+// ==================== 分发表（由 protocol_schema.h 生成） ====================
+
+#define ROUTE_SLOT(name, id, handler)      ROUTE_SLOT_##name,
+#define ROUTE_TYPE_SLOT(name, id, handler) [id] = ROUTE_SLOT_##name + 1U,
+#define ROUTE_TYPE_ID(name, id, handler)   [ROUTE_SLOT_##name] = id,
+#define ROUTE_HANDLER(name, id, handler)   [ROUTE_SLOT_##name] = handler,
+#define ROUTE_CMD(type, name, id, req)     [ROUTE_SLOT_##type][id] = ROUTE_ENTRY(PROTO_SIZE_##req),
+#define ROUTE_ENTRY(size)                  (uint16_t)((size) + 1U)
+#define ROUTE_CMDS(name, id, handler)      PROTO_SCHEMA_##name##_CMDS(ROUTE_CMD)
+
+enum { PROTO_SCHEMA_TYPES(ROUTE_SLOT) ROUTE_SLOT_COUNT };
+
+// type -> 槽位 + 1（0: 未定义的类型）
+static const uint8_t s_type_slot[256] = {PROTO_SCHEMA_TYPES(ROUTE_TYPE_SLOT)};
+
+static const uint8_t            s_type_id[ROUTE_SLOT_COUNT] = {PROTO_SCHEMA_TYPES(ROUTE_TYPE_ID)};
+static const protocol_handler_t s_handler[ROUTE_SLOT_COUNT] = {PROTO_SCHEMA_TYPES(ROUTE_HANDLER)};
+
+// [槽位][cmd] -> 请求长度 + 1（0: 未定义的命令，或 OUT 回绕为 0）
+static const uint16_t s_req_size[ROUTE_SLOT_COUNT][PROTO_SCHEMA_MAX_CMDS] = {
+    PROTO_SCHEMA_TYPES(ROUTE_CMDS)};
+
+protocol_handler_t protocol_route(uint8_t type, uint8_t cmd, uint16_t len, proto_status_t* status)
+{
+    uint8_t  slot = s_type_slot[type];
+    uint16_t size = 0U;
+    if (slot != 0U && s_handler[slot - 1U] != NULL && cmd < PROTO_SCHEMA_MAX_CMDS) {
+        size = s_req_size[slot - 1U][cmd];
+    }
+    if (size == 0U) {
+        *status = PROTO_STATUS_UNKNOWN_CMD;
+        return NULL;
+    }
+    size = (uint16_t)(size - 1U);
+    if (size != PROTO_SIZE_VAR && len != size) {
+        *status = PROTO_STATUS_BAD_PAYLOAD;
+        return NULL;
+    }
+    *status = PROTO_STATUS_OK;
+    return s_handler[slot - 1U];
+}
+
+// 所有有处理函数的类型共用：解析 [cmd][payload]，查表后在请求上下文中执行处理函数
+static TF_Result protocol_type_listener(TinyFrame* tf, TF_Msg* msg)
+{
+    (void)tf;
+    if (msg == NULL) {
+        return TF_NEXT;
+    }
+    if (msg->type == (uint8_t)PROTO_TYPE_SYS) {
+        // 波特率切换后收到的第一个有效 SYS 帧（通常是 PING）确认新波特率
+        tf_uart_port_baud_confirm();
+    }
+
+    proto_cmd_view_t cmd_view;
+    if (!proto_parse_cmd(msg->data, msg->len, &cmd_view)) {
+        return TF_NEXT;
+    }
+
+    request.active   = true;
+    request.replied  = false;
+    request.type     = msg->type;
+    request.cmd      = cmd_view.cmd;
+    request.frame_id = msg->frame_id;
+    request.reply    = NULL;
+
+    proto_status_t     status  = PROTO_STATUS_SKIPPED;
+    protocol_handler_t handler = NULL;
+    // 急停已在接收中断里执行：排在急停帧之前的请求不再执行
+    if (!protocol_estop_fenced(
+            msg->type, cmd_view.cmd, cmd_view.payload_len, (uint8_t)msg->frame_id)) {
+        handler = protocol_route(msg->type, cmd_view.cmd, cmd_view.payload_len, &status);
+    }
+    if (handler != NULL) {
+        status = handler(cmd_view.cmd, cmd_view.payload, cmd_view.payload_len);
+    }
+
+    // 没有应答帧或处理失败时补一个 ACK，每个请求都能按帧 ID 对上结果
+    if (!request.replied || status != PROTO_STATUS_OK) {
+        uint8_t* ack = tf_uart_port_frame_begin(3U, TF_UART_TX_CONTROL);
+        if (ack != NULL) {
+            ack[0] = request.type;
+            ack[1] = request.cmd;
+            ack[2] = (uint8_t)status;
+            (void)tf_uart_port_frame_respond(ack, PROTO_TYPE_ACK, 3U, request.frame_id);
+        }
+    }
+
+    request.active = false;
+    request.reply  = NULL;
+    return TF_STAY;
+}
+
+uint8_t* protocol_reply_begin(uint16_t max_len)
+{
+    // 每个请求只有一个应答帧：它还没提交时（BATCH 的结果帧正在收集子命令的应答）不再另开一帧，
+    // 否则子命令的应答会以不带请求帧 ID 的单独帧发出，结果帧里也没有它。
+    // 子命令拿到 NULL 后按 BUSY 失败，状态照常记在结果帧中
+    if (request.active && request.reply != NULL) {
+        return NULL;
+    }
+    uint8_t* payload = tf_uart_port_frame_begin(max_len, TF_UART_TX_CONTROL);
+    if (request.active) {
+        request.reply = payload;
+    }
+    return payload;
+}
+
+bool protocol_reply_commit(uint8_t* payload, uint8_t type, uint16_t len)
+{
+    if (payload == NULL) {
+        return false;
+    }
+    // 中断中提交的遥测帧不是本请求的应答，按普通帧发送
+    if (!request.active || payload != request.reply) {
+        return tf_uart_port_frame_commit(payload, type, len);
+    }
+
+    request.reply = NULL;
+    if (!tf_uart_port_frame_respond(payload, type, len, request.frame_id)) {
+        return false;
+    }
+    request.replied = true;
+    return true;
+}
+
+bool protocol_send_reply(uint8_t type, const uint8_t* data, uint16_t len)
+{
+    if (data == NULL || len == 0U) {
+        return false;
+    }
+    uint8_t* payload = protocol_reply_begin(len);
+    if (payload == NULL) {
+        return false;
+    }
+    memcpy(payload, data, len);
+    return protocol_reply_commit(payload, type, len);
+}
+
+void* protocol_scratch(uint16_t size)
+{
+    return (size <= PROTO_SCRATCH_SIZE) ? s_scratch.bytes : NULL;
+}
+
+void protocol_notify_flush(void)
+{
+    protocol_servo_notify_flush();
+    protocol_motion_notify_flush();
+    protocol_cycle_notify_flush();
+}
 
 bool protocol_init(void)
 {
@@ -19,12 +181,12 @@ bool protocol_init(void)
     }
 
     bool ok = true;
-    ok &= TF_AddTypeListener(tf, PROTO_TYPE_SYS, protocol_sys_listener);
-    ok &= TF_AddTypeListener(tf, PROTO_TYPE_SERVO, protocol_servo_listener);
-    ok &= TF_AddTypeListener(tf, PROTO_TYPE_MOTION, protocol_motion_listener);
-    ok &= TF_AddTypeListener(tf, PROTO_TYPE_CYCLE, protocol_cycle_listener);
-    ok &= TF_AddTypeListener(tf, PROTO_TYPE_ARM, protocol_arm_listener);
-    ok &= TF_AddTypeListener(tf, PROTO_TYPE_CONFIG, protocol_config_listener);
+    for (uint8_t slot = 0; slot < ROUTE_SLOT_COUNT; ++slot) {
+        if (s_handler[slot] != NULL) {
+            ok &= TF_AddTypeListener(tf, s_type_id[slot], protocol_type_listener);
+        }
+    }
+    protocol_estop_init();
 
     return ok;
 }
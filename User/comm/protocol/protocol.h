@@ -4,116 +4,245 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "../comm_config.h"
+#include "TinyFrame.h"
 #include "protocol_codec.h"
+#include "protocol_schema.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-// Limits
-#define PROTO_MAX_PAYLOAD 256
+// Limits: command payload after the [cmd] byte, so [cmd][payload] fills one large frame.
+// Frames longer than COMM_SMALL_MAX_PAYLOAD are only sent after SYS_CMD_SET_FRAME_MODE.
+#define PROTO_MAX_PAYLOAD (COMM_MAX_PAYLOAD - 1)
 
 // Protocol metadata
 #define PROTO_VERSION_MAJOR 1
 #define PROTO_VERSION_MINOR 0
 #define PROTO_DEVICE_NAME   "km1-one"
 
-// Protocol frame types (TinyFrame msg->type)
-typedef enum {
-    PROTO_TYPE_SYS    = 0x01,
-    PROTO_TYPE_SERVO  = 0x10,
-    PROTO_TYPE_MOTION = 0x11,
-    PROTO_TYPE_CYCLE  = 0x12,
-    PROTO_TYPE_ARM    = 0x13,
-    PROTO_TYPE_STATE  = 0xD0,
-    PROTO_TYPE_CONFIG = 0xE0,
-    PROTO_TYPE_DEBUG  = 0xF0,
-} proto_type_t;
+// Protocol frame types (TinyFrame msg->type) and commands, generated from protocol_schema.h
+#define PROTO_SCHEMA_TYPE_ENUM(name, id, handler) PROTO_TYPE_##name = id,
+#define PROTO_SCHEMA_CMD_ENUM(type, name, id, req) type##_CMD_##name = id,
+
+typedef enum { PROTO_SCHEMA_TYPES(PROTO_SCHEMA_TYPE_ENUM) } proto_type_t;
 
 // SYS commands
+typedef enum { PROTO_SCHEMA_SYS_CMDS(PROTO_SCHEMA_CMD_ENUM) } proto_sys_cmd_t;
+
+// SYS_CMD_SET_BAUD: fall back to the old rate if no SYS frame arrives at the new
+// rate within this time (unless the request carries its own timeout)
+#define PROTO_BAUD_CONFIRM_TIMEOUT_MS 1000U
+
+// SYS_CMD_BAUD status
 typedef enum {
-    SYS_CMD_PING      = 0x01,
-    SYS_CMD_PONG      = 0x02,
-    SYS_CMD_RESET     = 0x03,
-    SYS_CMD_GET_INFO  = 0x04,
-    SYS_CMD_INFO      = 0x05,
-    SYS_CMD_HEARTBEAT = 0x06,
-} proto_sys_cmd_t;
+    PROTO_BAUD_OK          = 0x00,  // switching after this reply (or query result)
+    PROTO_BAUD_UNSUPPORTED = 0x01,  // rate not reachable within tolerance, nothing changes
+} proto_baud_status_t;
 
-// SERVO commands
+// SYS_CMD_SET_FRAME_MODE modes
 typedef enum {
-    SERVO_CMD_ENABLE     = 0x01,
-    SERVO_CMD_DISABLE    = 0x02,
-    SERVO_CMD_SET_PWM    = 0x03,
-    SERVO_CMD_SET_POS    = 0x04,
-    SERVO_CMD_GET_STATUS = 0x05,
-    SERVO_CMD_STATUS     = 0x06,
-    SERVO_CMD_HOME       = 0x07,
-} proto_servo_cmd_t;
+    PROTO_FRAME_MODE_SMALL = 0x00,  // 1-byte LEN, payload <= COMM_SMALL_MAX_PAYLOAD
+    PROTO_FRAME_MODE_LARGE = 0x01,  // 2-byte LEN, payload <= COMM_MAX_PAYLOAD
+} proto_frame_mode_t;
 
-// MOTION commands
+// Command status, returned by every protocol_*_handle() and reported to the
+// host in PROTO_TYPE_ACK frames / BATCH_CMD_RESULT
+typedef enum {
+    PROTO_STATUS_OK          = 0x00,
+    PROTO_STATUS_UNKNOWN_CMD = 0x01,  // cmd not defined for this type
+    PROTO_STATUS_BAD_PAYLOAD = 0x02,  // payload length / format wrong
+    PROTO_STATUS_INVALID_ARG = 0x03,  // well-formed, but an id or value is out of range
+    PROTO_STATUS_FAILED      = 0x04,  // rejected by the subsystem (unknown group, cycle, ...)
+    PROTO_STATUS_BUSY        = 0x05,  // out of resources (TX slot, cycle slot), retry later
+    PROTO_STATUS_UNSUPPORTED = 0x06,  // defined but not implemented / not allowed here
+    PROTO_STATUS_SKIPPED     = 0x07,  // not run: earlier BATCH failure, or overtaken by a stop
+} proto_status_t;
+
+// BATCH commands
+typedef enum { PROTO_SCHEMA_BATCH_CMDS(PROTO_SCHEMA_CMD_ENUM) } proto_batch_cmd_t;
+
+// BATCH_CMD_EXEC flags
 typedef enum {
-    MOTION_CMD_START      = 0x01,
-    MOTION_CMD_STOP       = 0x02,
-    MOTION_CMD_PAUSE      = 0x03,
-    MOTION_CMD_RESUME     = 0x04,
-    MOTION_CMD_SET_PLAN   = 0x05,
-    MOTION_CMD_GET_STATUS = 0x06,
-    MOTION_CMD_STATUS     = 0x07,
-} proto_motion_cmd_t;
+    PROTO_BATCH_ATOMIC        = 0x01,  // no 1 ms motion tick between sub-commands
+    PROTO_BATCH_STOP_ON_ERROR = 0x02,  // skip the rest after the first failed sub-command
+} proto_batch_flag_t;
+
+// SERVO commands
+typedef enum { PROTO_SCHEMA_SERVO_CMDS(PROTO_SCHEMA_CMD_ENUM) } proto_servo_cmd_t;
+
+// MOTION commands
+typedef enum { PROTO_SCHEMA_MOTION_CMDS(PROTO_SCHEMA_CMD_ENUM) } proto_motion_cmd_t;
 
 // CYCLE commands
-typedef enum {
-    CYCLE_CMD_CREATE     = 0x00,
-    CYCLE_CMD_START      = 0x01,
-    CYCLE_CMD_RESTART    = 0x02,
-    CYCLE_CMD_PAUSE      = 0x03,
-    CYCLE_CMD_RELEASE    = 0x04,
-    CYCLE_CMD_GET_STATUS = 0x05,
-    CYCLE_CMD_STATUS     = 0x06,
-    CYCLE_CMD_LIST       = 0x07,
-} proto_cycle_cmd_t;
+typedef enum { PROTO_SCHEMA_CYCLE_CMDS(PROTO_SCHEMA_CMD_ENUM) } proto_cycle_cmd_t;
 
 // ARM commands
+typedef enum { PROTO_SCHEMA_ARM_CMDS(PROTO_SCHEMA_CMD_ENUM) } proto_arm_cmd_t;
+
+// TELEM commands
+typedef enum { PROTO_SCHEMA_TELEM_CMDS(PROTO_SCHEMA_CMD_ENUM) } proto_telem_cmd_t;
+
+// TELEM_CMD_SUBSCRIBE fields (one STATE_CMD_TELEMETRY frame carries all selected fields)
 typedef enum {
-    ARM_CMD_HOME       = 0x01,
-    ARM_CMD_STOP       = 0x02,
-    ARM_CMD_SET_POSE   = 0x03,
-    ARM_CMD_GET_STATUS = 0x04,
-    ARM_CMD_STATUS     = 0x05,
-} proto_arm_cmd_t;
+    PROTO_TELEM_PWM       = 0x01,  // per servo: current pwm (us)
+    PROTO_TELEM_TARGET    = 0x02,  // per servo: target angle
+    PROTO_TELEM_REMAINING = 0x04,  // per servo: remaining move time (ms)
+    PROTO_TELEM_MOVING    = 0x08,  // moving servo mask
+    PROTO_TELEM_CYCLE     = 0x10,  // active / running cycles, pose index and loop count
+} proto_telem_field_t;
+
+#define PROTO_TELEM_FIELDS_ALL  0x1FU
+#define PROTO_TELEM_MAX_RATE_HZ 200U  // sampled in the 1 ms tick, period = 1000 / rate
 
 // CONFIG commands
+typedef enum { PROTO_SCHEMA_CONFIG_CMDS(PROTO_SCHEMA_CMD_ENUM) } proto_config_cmd_t;
+
+// DEBUG commands
+typedef enum { PROTO_SCHEMA_DEBUG_CMDS(PROTO_SCHEMA_CMD_ENUM) } proto_debug_cmd_t;
+
+// DEBUG_CMD_GET_STATS sections
+typedef enum {
+    DEBUG_STATS_RX      = 0x01,
+    DEBUG_STATS_CRC     = 0x02,
+    DEBUG_STATS_TX      = 0x03,
+    DEBUG_STATS_LOG     = 0x04,
+    DEBUG_STATS_CAPTURE = 0x05,
+    DEBUG_STATS_LINK    = 0x06,
+    DEBUG_STATS_ESTOP   = 0x07,
+    DEBUG_STATS_TICK    = 0x08,
+} proto_debug_stats_t;
+
+// DEBUG_CMD_CAPTURE operations
 typedef enum {
-    CONFIG_CMD_GET   = 0x01,
-    CONFIG_CMD_SET   = 0x02,
-    CONFIG_CMD_SAVE  = 0x03,
-    CONFIG_CMD_LOAD  = 0x04,
-    CONFIG_CMD_RESET = 0x05,
-} proto_config_cmd_t;
+    DEBUG_CAPTURE_STOP  = 0x00,
+    DEBUG_CAPTURE_START = 0x01,
+    DEBUG_CAPTURE_READ  = 0x02,
+} proto_debug_capture_op_t;
 
 // STATE commands (device -> host)
-typedef enum {
-    STATE_CMD_SYS    = 0x01,
-    STATE_CMD_SERVO  = 0x02,
-    STATE_CMD_MOTION = 0x03,
-    STATE_CMD_CYCLE  = 0x04,
-    STATE_CMD_ARM    = 0x05,
-    STATE_CMD_CONFIG = 0x06,
-} proto_state_cmd_t;
-
-// Listener entry points
-bool protocol_sys_handle(uint8_t cmd, const uint8_t* payload, uint16_t len);
-bool protocol_servo_handle(uint8_t cmd, const uint8_t* payload, uint16_t len);
-bool protocol_motion_handle(uint8_t cmd, const uint8_t* payload, uint16_t len);
-bool protocol_cycle_handle(uint8_t cmd, const uint8_t* payload, uint16_t len);
-bool protocol_arm_handle(uint8_t cmd, const uint8_t* payload, uint16_t len);
-bool protocol_config_handle(uint8_t cmd, const uint8_t* payload, uint16_t len);
+typedef enum { PROTO_SCHEMA_STATE_CMDS(PROTO_SCHEMA_CMD_ENUM) } proto_state_cmd_t;
+
+// Per-type command handlers (listed in PROTO_SCHEMA_TYPES)
+typedef proto_status_t (*protocol_handler_t)(uint8_t cmd, const uint8_t* payload, uint16_t len);
+
+proto_status_t protocol_sys_handle(uint8_t cmd, const uint8_t* payload, uint16_t len);
+proto_status_t protocol_servo_handle(uint8_t cmd, const uint8_t* payload, uint16_t len);
+proto_status_t protocol_motion_handle(uint8_t cmd, const uint8_t* payload, uint16_t len);
+proto_status_t protocol_cycle_handle(uint8_t cmd, const uint8_t* payload, uint16_t len);
+proto_status_t protocol_arm_handle(uint8_t cmd, const uint8_t* payload, uint16_t len);
+proto_status_t protocol_config_handle(uint8_t cmd, const uint8_t* payload, uint16_t len);
+proto_status_t protocol_debug_handle(uint8_t cmd, const uint8_t* payload, uint16_t len);
+proto_status_t protocol_batch_handle(uint8_t cmd, const uint8_t* payload, uint16_t len);
+proto_status_t protocol_telem_handle(uint8_t cmd, const uint8_t* payload, uint16_t len);
+
+// O(1) [type][cmd] lookup in the routing table generated from protocol_schema.h.
+// Returns the type's handler if cmd is defined for it and len fits the schema's
+// request size; otherwise NULL, with *status set to UNKNOWN_CMD or BAD_PAYLOAD.
+// Requests arriving in their own frame are routed by the TinyFrame type listener
+// registered in protocol_init(), which also acknowledges them (see protocol_reply_*).
+protocol_handler_t protocol_route(uint8_t type, uint8_t cmd, uint16_t len, proto_status_t* status);
+
+// Request replies (main loop). While a request is being handled, the reply
+// begun here is sent as a response carrying the request's frame ID. If the
+// handler sends no reply, or fails, the type listener sends a
+// PROTO_TYPE_ACK frame [type][cmd][status] with that ID instead, so every
+// request gets exactly one frame back with its ID (two if a reply was sent
+// and the handler failed afterwards; the ACK is always last). Only one reply
+// may be open at a time: while it is, begin returns NULL, so a BATCH
+// sub-command cannot send its own frame and fails inside the result instead.
+uint8_t* protocol_reply_begin(uint16_t max_len);
+bool protocol_reply_commit(uint8_t* payload, uint8_t type, uint16_t len);
+bool protocol_send_reply(uint8_t type, const uint8_t* data, uint16_t len);
+
+// Status of a handler whose only work is sending its reply
+static inline proto_status_t protocol_reply_status(bool sent)
+{
+    return sent ? PROTO_STATUS_OK : PROTO_STATUS_BUSY;
+}
+
+// Shared scratch for command handlers (main loop only): room for a reply's
+// intermediate data (snapshot copy, cycle list, ...) that would otherwise sit on
+// the handler's stack. Returns NULL if size exceeds PROTO_SCRATCH_SIZE. One user
+// at a time: valid until the handler returns; never use it from interrupts.
+#ifndef PROTO_SCRATCH_SIZE
+#define PROTO_SCRATCH_SIZE 296U  // the snapshot copy in sys_listener.c, the largest user
+#endif
+
+void* protocol_scratch(uint16_t size);
 
 // State sender
 bool protocol_send_state(uint8_t cmd, const uint8_t* payload, uint16_t len);
 
-// Register type listeners with TinyFrame instance
+// Zero-copy state sender: encode the payload straight into the returned buffer
+// (max_len bytes), then commit it with the encoded length. Committing 0 (encode
+// failed) drops the frame and returns false. For command replies (main loop):
+// the frame carries the request's ID, see protocol_reply_begin().
+uint8_t* protocol_state_begin(uint8_t cmd, uint16_t max_len);
+bool protocol_state_commit(uint8_t* payload, uint16_t len);
+
+// Same as protocol_state_begin(), but for unsolicited telemetry (status pushes):
+// sent at bulk priority, behind pending command replies, and dropped (counted in
+// DEBUG_STATS_TX) instead of taking the TX slots reserved for replies. Safe from
+// interrupts; commit with protocol_state_commit().
+uint8_t* protocol_telemetry_begin(uint8_t cmd, uint16_t max_len);
+
+// Motion completion pushes (servo, sync group and cycle status frames). The
+// completion callbacks run inside servo_motion_update_1ms() (TIM1, highest
+// priority) and only latch the event; the frames are taken from the pool and sent
+// here. Call after servo_motion_update_1ms(), from PendSV like the sampler below.
+void protocol_notify_flush(void);
+void protocol_servo_notify_flush(void);
+void protocol_motion_notify_flush(void);
+void protocol_cycle_notify_flush(void);
+
+// Telemetry sampler: call once per 1 ms tick, after servo_motion_update_1ms(), so
+// every sample sees one consistent motion tick. The firmware runs it from PendSV
+// (lowest priority), right after the TIM1 tick, see irq_prio.h.
+void protocol_telemetry_tick_1ms(void);
+
+// Batch response capture (main loop only): between begin and end, replies made
+// with protocol_state_begin()/protocol_send_state() are appended to buf as
+// [index:u8][state_cmd:u8][len:u16][payload...] records instead of being sent.
+// Telemetry is never captured. end returns the number of bytes written.
+void protocol_state_capture_begin(uint8_t* buf, uint16_t size);
+void protocol_state_capture_index(uint8_t index);
+uint16_t protocol_state_capture_end(void);
+
+// Emergency stop fast path (estop.c). The stop-all frame (SERVO_CMD_DISABLE with no
+// payload) is recognised in the USART3 RX interrupt, straight from the received bytes,
+// and stops the stream and every servo before the main loop has parsed the frames
+// queued ahead of it. Those frames are then answered with PROTO_STATUS_SKIPPED until
+// the main loop reaches the stop frame itself, or PROTO_ESTOP_FENCE_TIMEOUT_MS passes
+// (stop frame lost to a parse error). Other SERVO_CMD_DISABLE requests always run.
+#ifndef PROTO_ESTOP_ENABLE
+#define PROTO_ESTOP_ENABLE 1
+#endif
+
+#ifndef PROTO_ESTOP_FENCE_TIMEOUT_MS
+#define PROTO_ESTOP_FENCE_TIMEOUT_MS 1000U
+#endif
+
+typedef struct {
+    uint32_t stops;             // stop frames seen by the RX interrupt
+    uint32_t skipped;           // requests answered with PROTO_STATUS_SKIPPED
+    uint32_t fence_timeouts;    // fences lifted by the timeout
+    uint32_t bytes;             // bytes scanned in the RX interrupt
+    uint32_t stop_cycles_max;   // protocol_estop_now() in the interrupt
+    uint32_t hook_cycles_max;   // one RX event: scan + stop
+    uint32_t fence_cycles_max;  // stop in the interrupt -> stop frame in the main loop
+} proto_estop_stats_t;
+
+void protocol_estop_init(void);  // called by protocol_init()
+void protocol_estop_now(void);   // stop the stream and every servo; safe from interrupts
+void protocol_estop_tick_1ms(void);
+// Main loop, before a request is routed: true if it must be skipped
+bool protocol_estop_fenced(uint8_t type, uint8_t cmd, uint16_t payload_len, uint8_t frame_id);
+void protocol_estop_get_stats(proto_estop_stats_t* stats);
+void protocol_estop_reset_stats(void);
+
+// Register the type listener for every schema type that has a handler
 bool protocol_init(void);
 
 #ifdef __cplusplus
@@ -0,0 +1,504 @@
+#ifndef PROTOCOL_SCHEMA_H
+#define PROTOCOL_SCHEMA_H
+
+/**
+ * @brief 协议描述（唯一来源，只含宏，C 固件和主机端 C++ 共用）
+ *
+ * 由这些列表展开生成：
+ *   - protocol.h 中的类型 / 命令枚举
+ *   - proto_msg.h/.c 中定长 / 变长消息的结构体和 proto_encode_* / proto_decode_*
+ *   - protocol.c 中按 [type][cmd] 查表的分发表（未定义的命令、定长请求的长度在这里拒绝）
+ *   - Tools/host/proto/km1_proto.hpp 中的主机端结构体
+ * 增加消息或命令只改这里（和 protocol_spec.md）。
+ * 仍然手写的只有字段表描述不了的负载：BATCH 的嵌套条目（batch_codec.c）、按位掩码取舍字段的
+ * 遥测帧（telemetry_codec.c）、PING 回显和 DEBUG_CMD_CAPTURE 读出时附带的抓包数据。
+ */
+
+// ==================== 字段类型 ====================
+// 所有多字节字段均为小端
+
+#define PROTO_WIRE_SIZE_u8  1U
+#define PROTO_WIRE_SIZE_u16 2U
+#define PROTO_WIRE_SIZE_u32 4U
+#define PROTO_WIRE_SIZE_f32 4U
+
+// 命令表中的请求长度：定长消息名（PROTO_SIZE_<消息>，长度必须相等）、NONE（无负载）、
+// VAR（变长 / 可选负载，由处理函数检查）或 OUT（只由设备发出，设备不接受）
+#define PROTO_SIZE_NONE 0U
+#define PROTO_SIZE_VAR  0x7FFFU  // 大于任何帧
+#define PROTO_SIZE_OUT  0xFFFFU
+
+// ==================== 帧类型 ====================
+// X(名称, type, 处理函数)；处理函数为 NULL 的类型只由设备发出
+
+#define PROTO_SCHEMA_TYPES(X)                                                                      \
+    X(SYS, 0x01, protocol_sys_handle)                                                              \
+    X(BATCH, 0x02, protocol_batch_handle)                                                          \
+    X(ACK, 0x03, NULL)                                                                             \
+    X(SERVO, 0x10, protocol_servo_handle)                                                          \
+    X(MOTION, 0x11, protocol_motion_handle)                                                        \
+    X(CYCLE, 0x12, protocol_cycle_handle)                                                          \
+    X(ARM, 0x13, protocol_arm_handle)                                                              \
+    X(TELEM, 0x14, protocol_telem_handle)                                                          \
+    X(STATE, 0xD0, NULL)                                                                           \
+    X(CONFIG, 0xE0, protocol_config_handle)                                                        \
+    X(DEBUG, 0xF0, protocol_debug_handle)
+
+// ==================== 命令 ====================
+// PROTO_SCHEMA_<类型>_CMDS(X): X(类型, 名称, cmd, 请求长度)，cmd 小于 PROTO_SCHEMA_MAX_CMDS
+
+#define PROTO_SCHEMA_MAX_CMDS 0x20U
+
+#define PROTO_SCHEMA_SYS_CMDS(X)                                                                   \
+    X(SYS, PING, 0x01, VAR)                                                                        \
+    X(SYS, PONG, 0x02, VAR)                                                                        \
+    X(SYS, RESET, 0x03, VAR)                                                                       \
+    X(SYS, GET_INFO, 0x04, VAR)                                                                    \
+    X(SYS, INFO, 0x05, VAR)                                                                        \
+    X(SYS, HEARTBEAT, 0x06, VAR)                                                                   \
+    X(SYS, SET_FRAME_MODE, 0x07, VAR)                                                              \
+    X(SYS, FRAME_MODE, 0x08, VAR)                                                                  \
+    X(SYS, SET_BAUD, 0x09, VAR)                                                                    \
+    X(SYS, BAUD, 0x0A, VAR)                                                                        \
+    X(SYS, GET_SNAPSHOT, 0x0B, VAR)                                                                \
+    X(SYS, SNAPSHOT, 0x0C, VAR)
+
+#define PROTO_SCHEMA_BATCH_CMDS(X)                                                                 \
+    X(BATCH, EXEC, 0x01, VAR)                                                                      \
+    X(BATCH, RESULT, 0x02, VAR)
+
+// ACK 帧没有 [cmd] 字节：[type][cmd][status]
+#define PROTO_SCHEMA_ACK_CMDS(X)
+
+#define PROTO_SCHEMA_SERVO_CMDS(X)                                                                 \
+    X(SERVO, ENABLE, 0x01, VAR)                                                                    \
+    X(SERVO, DISABLE, 0x02, VAR)                                                                   \
+    X(SERVO, SET_PWM, 0x03, SERVO_SET_PWM_REQ)                                                     \
+    X(SERVO, SET_POS, 0x04, SERVO_SET_POS_REQ)                                                     \
+    X(SERVO, GET_STATUS, 0x05, SERVO_ID_REQ)                                                       \
+    X(SERVO, STATUS, 0x06, VAR)                                                                    \
+    X(SERVO, HOME, 0x07, NONE)
+
+#define PROTO_SCHEMA_MOTION_CMDS(X)                                                                \
+    X(MOTION, START, 0x01, VAR)                                                                    \
+    X(MOTION, STOP, 0x02, MOTION_ID_REQ)                                                           \
+    X(MOTION, PAUSE, 0x03, MOTION_ID_REQ)                                                          \
+    X(MOTION, RESUME, 0x04, MOTION_ID_REQ)                                                         \
+    X(MOTION, SET_PLAN, 0x05, VAR)                                                                 \
+    X(MOTION, GET_STATUS, 0x06, MOTION_ID_REQ)                                                     \
+    X(MOTION, STATUS, 0x07, VAR)                                                                   \
+    X(MOTION, STREAM_START, 0x08, VAR)                                                             \
+    X(MOTION, STREAM_POINT, 0x09, VAR)                                                             \
+    X(MOTION, STREAM_STOP, 0x0A, VAR)                                                              \
+    X(MOTION, STREAM_GET_STATUS, 0x0B, VAR)
+
+#define PROTO_SCHEMA_CYCLE_CMDS(X)                                                                 \
+    X(CYCLE, CREATE, 0x00, VAR)                                                                    \
+    X(CYCLE, START, 0x01, CYCLE_ID_REQ)                                                            \
+    X(CYCLE, RESTART, 0x02, CYCLE_ID_REQ)                                                          \
+    X(CYCLE, PAUSE, 0x03, CYCLE_ID_REQ)                                                            \
+    X(CYCLE, RELEASE, 0x04, CYCLE_ID_REQ)                                                          \
+    X(CYCLE, GET_STATUS, 0x05, CYCLE_ID_REQ)                                                       \
+    X(CYCLE, STATUS, 0x06, CYCLE_ID_REQ)                                                           \
+    X(CYCLE, LIST, 0x07, VAR)
+
+#define PROTO_SCHEMA_ARM_CMDS(X)                                                                   \
+    X(ARM, HOME, 0x01, VAR)                                                                        \
+    X(ARM, STOP, 0x02, VAR)                                                                        \
+    X(ARM, SET_POSE, 0x03, VAR)                                                                    \
+    X(ARM, GET_STATUS, 0x04, VAR)                                                                  \
+    X(ARM, STATUS, 0x05, VAR)
+
+#define PROTO_SCHEMA_TELEM_CMDS(X)                                                                 \
+    X(TELEM, SUBSCRIBE, 0x01, VAR)                                                                 \
+    X(TELEM, SUBSCRIPTION, 0x02, VAR)
+
+#define PROTO_SCHEMA_STATE_CMDS(X)                                                                 \
+    X(STATE, SYS, 0x01, OUT)                                                                       \
+    X(STATE, SERVO, 0x02, OUT)                                                                     \
+    X(STATE, MOTION, 0x03, OUT)                                                                    \
+    X(STATE, CYCLE, 0x04, OUT)                                                                     \
+    X(STATE, ARM, 0x05, OUT)                                                                       \
+    X(STATE, CONFIG, 0x06, OUT)                                                                    \
+    X(STATE, DEBUG, 0x07, OUT)                                                                     \
+    X(STATE, TELEMETRY, 0x08, OUT)
+
+#define PROTO_SCHEMA_CONFIG_CMDS(X)                                                                \
+    X(CONFIG, GET, 0x01, VAR)                                                                      \
+    X(CONFIG, SET, 0x02, VAR)                                                                      \
+    X(CONFIG, SAVE, 0x03, VAR)                                                                     \
+    X(CONFIG, LOAD, 0x04, VAR)                                                                     \
+    X(CONFIG, RESET, 0x05, VAR)
+
+#define PROTO_SCHEMA_DEBUG_CMDS(X)                                                                 \
+    X(DEBUG, GET_STATS, 0x01, DEBUG_GET_STATS_REQ)                                                 \
+    X(DEBUG, RESET_STATS, 0x02, VAR)                                                               \
+    X(DEBUG, CAPTURE, 0x03, VAR)
+
+// ==================== 定长消息 ====================
+// M(名称, 大写名称)；字段表 PROTO_MSG_<大写名称>(F): F(字段类型, 字段名)，按线上顺序排列。
+// 生成 proto_<名称>_t、PROTO_SIZE_<大写名称>、proto_encode_<名称>、proto_decode_<名称>
+
+#define PROTO_SCHEMA_MESSAGES(M)                                                                   \
+    M(sys_frame_mode_req, SYS_FRAME_MODE_REQ)                                                      \
+    M(sys_frame_mode_resp, SYS_FRAME_MODE_RESP)                                                    \
+    M(sys_baud_resp, SYS_BAUD_RESP)                                                                \
+    M(servo_id_req, SERVO_ID_REQ)                                                                  \
+    M(servo_set_pwm_req, SERVO_SET_PWM_REQ)                                                        \
+    M(servo_set_pos_req, SERVO_SET_POS_REQ)                                                        \
+    M(servo_status_resp, SERVO_STATUS_RESP)                                                        \
+    M(motion_id_req, MOTION_ID_REQ)                                                                \
+    M(motion_start_resp, MOTION_START_RESP)                                                        \
+    M(motion_status_resp, MOTION_STATUS_RESP)                                                      \
+    M(motion_get_status_resp, MOTION_GET_STATUS_RESP)                                              \
+    M(motion_stream_status_resp, MOTION_STREAM_STATUS_RESP)                                        \
+    M(cycle_id_req, CYCLE_ID_REQ)                                                                  \
+    M(cycle_status, CYCLE_STATUS)                                                                  \
+    M(cycle_status_resp, CYCLE_STATUS_RESP)                                                        \
+    M(cycle_status_update_resp, CYCLE_STATUS_UPDATE_RESP)                                          \
+    M(arm_status_resp, ARM_STATUS_RESP)                                                            \
+    M(telem_subscribe_req, TELEM_SUBSCRIBE_REQ)                                                    \
+    M(telem_subscription_resp, TELEM_SUBSCRIPTION_RESP)                                            \
+    M(debug_get_stats_req, DEBUG_GET_STATS_REQ)                                                    \
+    M(debug_rx_stats_resp, DEBUG_RX_STATS_RESP)                                                    \
+    M(debug_crc_stats_resp, DEBUG_CRC_STATS_RESP)                                                  \
+    M(debug_tx_class_stats, DEBUG_TX_CLASS_STATS)                                                  \
+    M(debug_log_stats_resp, DEBUG_LOG_STATS_RESP)                                                  \
+    M(debug_capture_resp, DEBUG_CAPTURE_RESP)                                                      \
+    M(debug_link_stats_resp, DEBUG_LINK_STATS_RESP)                                                \
+    M(debug_estop_stats_resp, DEBUG_ESTOP_STATS_RESP)                                              \
+    M(debug_tick_stats_resp, DEBUG_TICK_STATS_RESP)                                                \
+    M(snapshot_servo, SNAPSHOT_SERVO)                                                              \
+    M(snapshot_group, SNAPSHOT_GROUP)                                                              \
+    M(snapshot_cycle, SNAPSHOT_CYCLE)
+
+// SYS_CMD_SET_FRAME_MODE（无负载时仅查询）
+#define PROTO_MSG_SYS_FRAME_MODE_REQ(F) F(u8, mode)
+
+// SYS_CMD_FRAME_MODE
+#define PROTO_MSG_SYS_FRAME_MODE_RESP(F)                                                           \
+    F(u8, mode)                                                                                    \
+    F(u16, max_payload)
+
+// SYS_CMD_BAUD
+#define PROTO_MSG_SYS_BAUD_RESP(F)                                                                 \
+    F(u8, status)                                                                                  \
+    F(u32, baud)
+
+// SERVO_CMD_GET_STATUS、SERVO_CMD_DISABLE（无负载时为全部急停）
+#define PROTO_MSG_SERVO_ID_REQ(F) F(u8, id)
+
+// SERVO_CMD_SET_PWM
+#define PROTO_MSG_SERVO_SET_PWM_REQ(F)                                                             \
+    F(u8, id)                                                                                      \
+    F(u32, pwm)                                                                                    \
+    F(u32, duration_ms)
+
+// SERVO_CMD_SET_POS
+#define PROTO_MSG_SERVO_SET_POS_REQ(F)                                                             \
+    F(u8, id)                                                                                      \
+    F(f32, angle)                                                                                  \
+    F(u32, duration_ms)
+
+// STATE_CMD_SERVO
+#define PROTO_MSG_SERVO_STATUS_RESP(F)                                                             \
+    F(u8, subcmd)                                                                                  \
+    F(u32, servo_id)                                                                               \
+    F(u8, moving)                                                                                  \
+    F(u32, current_pwm)                                                                            \
+    F(f32, target_angle)                                                                           \
+    F(u32, remaining_time)
+
+// MOTION_CMD_STOP / PAUSE / RESUME / GET_STATUS
+#define PROTO_MSG_MOTION_ID_REQ(F) F(u32, group_id)
+
+// STATE_CMD_MOTION: MOTION_CMD_START
+#define PROTO_MSG_MOTION_START_RESP(F)                                                             \
+    F(u8, subcmd)                                                                                  \
+    F(u32, group_id)
+
+// STATE_CMD_MOTION: MOTION_CMD_STATUS（完成推送）
+#define PROTO_MSG_MOTION_STATUS_RESP(F)                                                            \
+    F(u8, subcmd)                                                                                  \
+    F(u32, group_id)                                                                               \
+    F(u8, complete)
+
+// STATE_CMD_MOTION: MOTION_CMD_GET_STATUS
+#define PROTO_MSG_MOTION_GET_STATUS_RESP(F)                                                        \
+    F(u8, subcmd)                                                                                  \
+    F(u32, group_id)                                                                               \
+    F(u32, mask)                                                                                   \
+    F(u8, complete)
+
+// STATE_CMD_MOTION: MOTION_CMD_STREAM_GET_STATUS
+#define PROTO_MSG_MOTION_STREAM_STATUS_RESP(F)                                                     \
+    F(u8, subcmd)                                                                                  \
+    F(u8, active)                                                                                  \
+    F(u8, servo_mask)                                                                              \
+    F(u16, latency_ms)                                                                             \
+    F(u16, extrapolate_ms)                                                                         \
+    F(u8, buffered)                                                                                \
+    F(u32, points)                                                                                 \
+    F(u32, late)                                                                                   \
+    F(u32, overflows)                                                                              \
+    F(u32, underruns)                                                                              \
+    F(u32, extrapolated_ms)
+
+// CYCLE_CMD_START / RESTART / PAUSE / RELEASE / GET_STATUS
+#define PROTO_MSG_CYCLE_ID_REQ(F) F(u32, cycle_index)
+
+// CYCLE_CMD_LIST 中的一项
+#define PROTO_MSG_CYCLE_STATUS(F)                                                                  \
+    F(u8, index)                                                                                   \
+    F(u8, active)                                                                                  \
+    F(u8, running)                                                                                 \
+    F(u8, current_pose)                                                                            \
+    F(u8, pose_count)                                                                              \
+    F(u32, loop_count)                                                                             \
+    F(u32, max_loops)                                                                              \
+    F(u32, active_group_id)
+
+// STATE_CMD_CYCLE: CYCLE_CMD_GET_STATUS
+#define PROTO_MSG_CYCLE_STATUS_RESP(F)                                                             \
+    F(u8, subcmd)                                                                                  \
+    F(u32, cycle_index)                                                                            \
+    F(u8, active)                                                                                  \
+    F(u8, running)                                                                                 \
+    F(u8, current_pose)                                                                            \
+    F(u8, pose_count)                                                                              \
+    F(u32, loop_count)                                                                             \
+    F(u32, max_loops)                                                                              \
+    F(u32, active_group_id)
+
+// STATE_CMD_CYCLE: CYCLE_CMD_STATUS（每轮推送）
+#define PROTO_MSG_CYCLE_STATUS_UPDATE_RESP(F)                                                      \
+    F(u8, subcmd)                                                                                  \
+    F(u32, cycle_index)                                                                            \
+    F(u32, loop_count)                                                                             \
+    F(u32, remaining)                                                                              \
+    F(u8, finished)
+
+// STATE_CMD_ARM
+#define PROTO_MSG_ARM_STATUS_RESP(F) F(u32, moving_mask)
+
+// TELEM_CMD_SUBSCRIBE（无负载时仅查询）
+#define PROTO_MSG_TELEM_SUBSCRIBE_REQ(F)                                                           \
+    F(u8, fields)                                                                                  \
+    F(u8, servo_mask)                                                                              \
+    F(u16, rate_hz)
+
+// TELEM_CMD_SUBSCRIPTION
+#define PROTO_MSG_TELEM_SUBSCRIPTION_RESP(F)                                                       \
+    F(u8, fields)                                                                                  \
+    F(u8, servo_mask)                                                                              \
+    F(u16, period_ms)
+
+// DEBUG_CMD_GET_STATS
+#define PROTO_MSG_DEBUG_GET_STATS_REQ(F) F(u8, section)
+
+// STATE_CMD_DEBUG: DEBUG_STATS_RX
+#define PROTO_MSG_DEBUG_RX_STATS_RESP(F)                                                           \
+    F(u8, section)                                                                                 \
+    F(u32, cpu_hz)                                                                                 \
+    F(u32, rx_bytes)                                                                               \
+    F(u32, rx_cycles)                                                                              \
+    F(u32, rx_errors)
+
+// STATE_CMD_DEBUG: DEBUG_STATS_CRC
+#define PROTO_MSG_DEBUG_CRC_STATS_RESP(F)                                                          \
+    F(u8, section)                                                                                 \
+    F(u32, cpu_hz)                                                                                 \
+    F(u32, blocks)                                                                                 \
+    F(u32, bytes)                                                                                  \
+    F(u32, cycles)                                                                                 \
+    F(u8, hw)
+
+// STATE_CMD_DEBUG: DEBUG_STATS_TX 中每个发送类别一项
+#define PROTO_MSG_DEBUG_TX_CLASS_STATS(F)                                                          \
+    F(u8, queued)                                                                                  \
+    F(u8, high_water)                                                                              \
+    F(u32, sent)                                                                                   \
+    F(u32, drops)
+
+// STATE_CMD_DEBUG: DEBUG_STATS_LOG
+#define PROTO_MSG_DEBUG_LOG_STATS_RESP(F)                                                          \
+    F(u8, section)                                                                                 \
+    F(u32, cpu_hz)                                                                                 \
+    F(u32, writes)                                                                                 \
+    F(u32, bytes)                                                                                  \
+    F(u32, drops)                                                                                  \
+    F(u32, dropped_bytes)                                                                          \
+    F(u32, cycles)                                                                                 \
+    F(u32, sent)                                                                                   \
+    F(u16, pending)                                                                                \
+    F(u16, high_water)
+
+// STATE_CMD_DEBUG: DEBUG_STATS_CAPTURE（DEBUG_CMD_CAPTURE 读出时后跟抓包数据）
+#define PROTO_MSG_DEBUG_CAPTURE_RESP(F)                                                            \
+    F(u8, section)                                                                                 \
+    F(u8, state)                                                                                   \
+    F(u16, records)                                                                                \
+    F(u32, overwritten)                                                                            \
+    F(u32, dropped)                                                                                \
+    F(u16, size)                                                                                   \
+    F(u16, offset)
+
+// STATE_CMD_DEBUG: DEBUG_STATS_LINK
+#define PROTO_MSG_DEBUG_LINK_STATS_RESP(F)                                                         \
+    F(u8, section)                                                                                 \
+    F(u32, rx_errors)                                                                              \
+    F(u32, rx_overflows)                                                                           \
+    F(u32, tx_send_fails)                                                                          \
+    F(u32, tx_lock_fails)                                                                          \
+    F(u32, baud_fallbacks)
+
+// STATE_CMD_DEBUG: DEBUG_STATS_ESTOP
+#define PROTO_MSG_DEBUG_ESTOP_STATS_RESP(F)                                                        \
+    F(u8, section)                                                                                 \
+    F(u32, cpu_hz)                                                                                 \
+    F(u32, stops)                                                                                  \
+    F(u32, skipped)                                                                                \
+    F(u32, fence_timeouts)                                                                         \
+    F(u32, bytes)                                                                                  \
+    F(u32, stop_cycles_max)                                                                        \
+    F(u32, hook_cycles_max)                                                                        \
+    F(u32, fence_cycles_max)
+
+// STATE_CMD_DEBUG: DEBUG_STATS_TICK
+#define PROTO_MSG_DEBUG_TICK_STATS_RESP(F)                                                         \
+    F(u8, section)                                                                                 \
+    F(u32, cpu_hz)                                                                                 \
+    F(u32, ticks)                                                                                  \
+    F(u32, period_min)                                                                             \
+    F(u32, period_max)                                                                             \
+    F(u32, run_max)
+
+// SYS_CMD_SNAPSHOT 中每个舵机一项
+#define PROTO_MSG_SNAPSHOT_SERVO(F)                                                                \
+    F(u8, moving)                                                                                  \
+    F(u16, current_pwm)                                                                            \
+    F(f32, target_angle)                                                                           \
+    F(u32, remaining_ms)
+
+// SYS_CMD_SNAPSHOT 中每个同步组一项
+#define PROTO_MSG_SNAPSHOT_GROUP(F)                                                                \
+    F(u32, group_id)                                                                               \
+    F(u8, mask)                                                                                    \
+    F(u8, done_mask)
+
+// SYS_CMD_SNAPSHOT 中每个 cycle 一项
+#define PROTO_MSG_SNAPSHOT_CYCLE(F)                                                                \
+    F(u8, index)                                                                                   \
+    F(u8, running)                                                                                 \
+    F(u8, current_pose)                                                                            \
+    F(u8, pose_count)                                                                              \
+    F(u32, loop_count)                                                                             \
+    F(u32, max_loops)                                                                              \
+    F(u32, active_group_id)
+
+// ==================== 变长消息 ====================
+// M(名称, 大写名称)；字段表 PROTO_MSG_<大写名称>(F, A, S, R, O)，按线上顺序排列：
+//   F(字段类型, 字段名)                     定长字段
+//   A(字段类型, 字段名, 个数)               数组，个数是前面字段的表达式（m->字段名）
+//   S(消息名, 大写消息名, 字段名, 个数)     定长消息的数组
+//   R(字段类型, 字段名)                     数组，占满剩余负载，生成 <字段名>_count
+//   O(字段类型, 字段名)                     可选字段，只能放在末尾，生成 has_<字段名>；
+//                                           负载可以在任一可选字段之前结束
+// 负载长度必须与字段表完全一致（多余的字节也拒绝）。
+
+// 设备解码的请求：生成 proto_<名称>_t 和 proto_decode_<名称>。数组不拷贝，指向负载中的原始字节，
+// 元素用 proto_wire_<字段类型>() 读取（S 用 proto_decode_<消息名>）
+#define PROTO_SCHEMA_VAR_REQUESTS(M)                                                               \
+    M(motion_start_req, MOTION_START_REQ)                                                          \
+    M(motion_stream_start_req, MOTION_STREAM_START_REQ)                                            \
+    M(motion_stream_point_req, MOTION_STREAM_POINT_REQ)                                            \
+    M(cycle_create_req, CYCLE_CREATE_REQ)                                                          \
+    M(arm_home_req, ARM_HOME_REQ)                                                                  \
+    M(arm_set_pose_req, ARM_SET_POSE_REQ)                                                          \
+    M(sys_set_baud_req, SYS_SET_BAUD_REQ)                                                          \
+    M(debug_capture_req, DEBUG_CAPTURE_REQ)
+
+// 设备编码的应答：生成 proto_<名称>_t、proto_size_<名称> 和 proto_encode_<名称>。
+// 数组字段指向调用方的元素数组
+#define PROTO_SCHEMA_VAR_REPLIES(M)                                                                \
+    M(sys_info_resp, SYS_INFO_RESP)                                                                \
+    M(snapshot_resp, SNAPSHOT_RESP)                                                                \
+    M(cycle_list_resp, CYCLE_LIST_RESP)                                                            \
+    M(debug_tx_stats_resp, DEBUG_TX_STATS_RESP)
+
+// MOTION_CMD_START：mode 0 时 values 为 PWM，mode 1 时为角度（f32，按位传输）
+#define PROTO_MSG_MOTION_START_REQ(F, A, S, R, O)                                                  \
+    F(u8, mode)                                                                                    \
+    F(u8, count)                                                                                   \
+    F(u32, duration_ms)                                                                            \
+    A(u8, servo_ids, m->count)                                                                     \
+    A(u32, values, m->count)
+
+// MOTION_CMD_STREAM_START：extrapolate_ms 省略时取 MOTION_STREAM_DEFAULT_EXTRAPOLATE_MS
+#define PROTO_MSG_MOTION_STREAM_START_REQ(F, A, S, R, O)                                           \
+    F(u8, servo_mask)                                                                              \
+    F(u16, latency_ms)                                                                             \
+    O(u16, extrapolate_ms)
+
+// MOTION_CMD_STREAM_POINT：servo_mask 中每个舵机一个 PWM，按 ID 升序
+#define PROTO_MSG_MOTION_STREAM_POINT_REQ(F, A, S, R, O)                                           \
+    F(u32, t_ms)                                                                                   \
+    R(u16, pwms)
+
+// CYCLE_CMD_CREATE：values 按姿态排列（pose_count * servo_count），mode 含义同 MOTION_CMD_START
+#define PROTO_MSG_CYCLE_CREATE_REQ(F, A, S, R, O)                                                  \
+    F(u8, mode)                                                                                    \
+    F(u8, servo_count)                                                                             \
+    F(u8, pose_count)                                                                              \
+    F(u32, max_loops)                                                                              \
+    A(u32, durations_ms, m->pose_count)                                                            \
+    A(u8, servo_ids, m->servo_count)                                                               \
+    A(u32, values, m->pose_count * m->servo_count)
+
+// ARM_CMD_HOME：duration_ms 省略时为 1000
+#define PROTO_MSG_ARM_HOME_REQ(F, A, S, R, O) O(u32, duration_ms)
+
+// ARM_CMD_SET_POSE：每个关节一个角度
+#define PROTO_MSG_ARM_SET_POSE_REQ(F, A, S, R, O)                                                  \
+    F(u32, duration_ms)                                                                            \
+    R(f32, angles)
+
+// SYS_CMD_SET_BAUD：无负载时仅查询，timeout_ms 省略或为 0 时取 PROTO_BAUD_CONFIRM_TIMEOUT_MS
+#define PROTO_MSG_SYS_SET_BAUD_REQ(F, A, S, R, O)                                                  \
+    O(u32, baud)                                                                                   \
+    O(u16, timeout_ms)
+
+// DEBUG_CMD_CAPTURE：offset 只用于 DEBUG_CAPTURE_READ
+#define PROTO_MSG_DEBUG_CAPTURE_REQ(F, A, S, R, O)                                                 \
+    F(u8, op)                                                                                      \
+    O(u16, offset)
+
+// SYS_CMD_INFO
+#define PROTO_MSG_SYS_INFO_RESP(F, A, S, R, O)                                                     \
+    F(u8, major)                                                                                   \
+    F(u8, minor)                                                                                   \
+    F(u8, name_len)                                                                                \
+    A(u8, name, m->name_len)
+
+// SYS_CMD_SNAPSHOT：每个舵机（按 ID）、每个活动的同步组、每个活动的 cycle
+#define PROTO_MSG_SNAPSHOT_RESP(F, A, S, R, O)                                                     \
+    F(u8, servo_count)                                                                             \
+    S(snapshot_servo, SNAPSHOT_SERVO, servos, m->servo_count)                                      \
+    F(u8, group_count)                                                                             \
+    S(snapshot_group, SNAPSHOT_GROUP, groups, m->group_count)                                      \
+    F(u8, cycle_count)                                                                             \
+    S(snapshot_cycle, SNAPSHOT_CYCLE, cycles, m->cycle_count)
+
+// STATE_CMD_CYCLE: CYCLE_CMD_LIST
+#define PROTO_MSG_CYCLE_LIST_RESP(F, A, S, R, O)                                                   \
+    F(u8, subcmd)                                                                                  \
+    F(u8, cycle_count)                                                                             \
+    S(cycle_status, CYCLE_STATUS, cycles, m->cycle_count)
+
+// STATE_CMD_DEBUG: DEBUG_STATS_TX，每个发送类别一项
+#define PROTO_MSG_DEBUG_TX_STATS_RESP(F, A, S, R, O)                                               \
+    F(u8, section)                                                                                 \
+    F(u8, class_count)                                                                             \
+    S(debug_tx_class_stats, DEBUG_TX_CLASS_STATS, classes, m->class_count)
+
+#endif  // PROTOCOL_SCHEMA_H
@@ -1,13 +1,120 @@
+#include <string.h>
+
 #include "protocol.h"
 #include "tf_uart_port.h"
 
+// BATCH 执行期间的应答收集
+static struct {
+    uint8_t* buf;
+    uint16_t size;
+    uint16_t len;
+    uint8_t  index;
+} capture;
+
+#define CAPTURE_HEAD 4U  // [index][state_cmd][len:u16]
+
+static bool capture_owns(const uint8_t* payload)
+{
+    return capture.buf != NULL && payload >= capture.buf && payload <= capture.buf + capture.size;
+}
+
+static uint8_t* capture_begin(uint8_t cmd, uint16_t max_len)
+{
+    if ((uint32_t)capture.len + CAPTURE_HEAD + max_len > capture.size) {
+        return NULL;  // 结果帧放不下，该子命令按失败处理
+    }
+    uint8_t* rec = &capture.buf[capture.len];
+    rec[0]       = capture.index;
+    rec[1]       = cmd;
+    return &rec[CAPTURE_HEAD];
+}
+
+static bool capture_commit(uint8_t* payload, uint16_t len)
+{
+    uint8_t* rec = payload - CAPTURE_HEAD;
+    rec[2]       = (uint8_t)(len & 0xFFU);
+    rec[3]       = (uint8_t)(len >> 8);
+    capture.len  = (uint16_t)(capture.len + CAPTURE_HEAD + len);
+    return true;
+}
+
+void protocol_state_capture_begin(uint8_t* buf, uint16_t size)
+{
+    capture.buf   = buf;
+    capture.size  = size;
+    capture.len   = 0;
+    capture.index = 0;
+}
+
+void protocol_state_capture_index(uint8_t index)
+{
+    capture.index = index;
+}
+
+uint16_t protocol_state_capture_end(void)
+{
+    uint16_t len = capture.len;
+    capture.buf  = NULL;
+    capture.size = 0;
+    capture.len  = 0;
+    return len;
+}
+
+static uint8_t* state_frame(uint8_t* frame, uint8_t cmd)
+{
+    // Payload format: [cmd][payload...], written straight into a UART TX slot
+    if (frame == NULL) {
+        return NULL;
+    }
+    frame[0] = cmd;
+    return &frame[1];
+}
+
+uint8_t* protocol_state_begin(uint8_t cmd, uint16_t max_len)
+{
+    if (capture.buf != NULL) {
+        return capture_begin(cmd, max_len);
+    }
+    return state_frame(protocol_reply_begin((uint16_t)(max_len + 1U)), cmd);
+}
+
+uint8_t* protocol_telemetry_begin(uint8_t cmd, uint16_t max_len)
+{
+    return state_frame(tf_uart_port_frame_begin((uint16_t)(max_len + 1U), TF_UART_TX_BULK), cmd);
+}
+
+bool protocol_state_commit(uint8_t* payload, uint16_t len)
+{
+    if (payload == NULL) {
+        return false;
+    }
+    if (capture_owns(payload)) {
+        return len != 0U && capture_commit(payload, len);
+    }
+    uint8_t* frame = payload - 1;  // [cmd] 在负载前面
+    if (len == 0U) {
+        // encode failed, drop the frame
+        (void)protocol_reply_commit(frame, PROTO_TYPE_STATE, 0U);
+        return false;
+    }
+    return protocol_reply_commit(frame, PROTO_TYPE_STATE, (uint16_t)(len + 1U));
+}
+
 bool protocol_send_state(uint8_t cmd, const uint8_t* payload, uint16_t len)
 {
-    uint8_t  frame[1U + PROTO_MAX_PAYLOAD];
-    uint16_t frame_len = 0U;
+    if (len > 0U && payload == NULL) {
+        return false;
+    }
 
-    if (!proto_encode_cmd_frame(cmd, payload, len, frame, (uint16_t)sizeof(frame), &frame_len)) {
+    uint8_t* buf = protocol_state_begin(cmd, len);
+    if (buf == NULL) {
         return false;
     }
-    return tf_uart_port_send_frame(PROTO_TYPE_STATE, frame, frame_len);
+    if (len > 0U) {
+        memcpy(buf, payload, len);
+    }
+    if (capture_owns(buf)) {
+        return capture_commit(buf, len);
+    }
+    return protocol_reply_commit(buf - 1, PROTO_TYPE_STATE, (uint16_t)(len + 1U));
 }
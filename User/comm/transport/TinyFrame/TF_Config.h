@@ -4,21 +4,40 @@
 #include <stdint.h>
 #include <stdio.h>
 
+#include "../../comm_config.h"
+
 #define TF_ID_BYTES     1
-#define TF_LEN_BYTES    1
+// LEN 字段最多 2 字节；上电为 1 字节（兼容模式），协商后切换为 2 字节（大帧模式）
+#define TF_LEN_BYTES    2
+#define TF_LEN_DYNAMIC  1
 #define TF_TYPE_BYTES   1
-#define TF_CKSUM_TYPE TF_CKSUM_NONE
+// CRC-32/MPEG-2，由 tf_crc32.c 实现（目标板使用 CRC 外设，主机使用 slicing-by-4 查表）
+#define TF_CKSUM_TYPE TF_CKSUM_CUSTOM32
+#define TF_CKSUM_HAS_BLOCK 1
 #define TF_USE_SOF_BYTE 1
 #define TF_SOF_BYTE     0x01
 typedef uint16_t TF_TICKS;
 typedef uint8_t TF_COUNT;
-#define TF_MAX_PAYLOAD_RX 1024
-#define TF_SENDBUF_LEN 1024
+#define TF_MAX_PAYLOAD_RX COMM_MAX_PAYLOAD
+#define TF_SENDBUF_LEN COMM_MAX_FRAME  // 仅 TF_TX_ZERO_COPY=0 时使用
 #define TF_MAX_ID_LST   10
 #define TF_MAX_TYPE_LST 10
 #define TF_MAX_GEN_LST  5
 #define TF_PARSER_TIMEOUT_TICKS 10
 
+// 直接在 DMA 接收缓冲区中解析帧（零拷贝），不再需要 tf->data 缓冲区
+#ifndef TF_RX_IN_PLACE
+#define TF_RX_IN_PLACE 1
+#endif
+
+// 直接在 UART 发送队列中组帧（零拷贝），不再需要 tf->sendbuf 缓冲区
+#ifndef TF_TX_ZERO_COPY
+#define TF_TX_ZERO_COPY 1
+#endif
+
+// 每个接收帧在分发前交给 TF_RxHookImpl()（tf_uart_port.c），用于抓包
+#define TF_RX_HOOK TF_CAPTURE_ENABLE
+
 #define TF_Error(format, ...) printf("[TF] " format "\n", ##__VA_ARGS__)
 
 #endif //TF_CONFIG_H
@@ -29,6 +29,7 @@
     /** Claim the TX interface before composing and sending a frame */
     static bool TF_ClaimTx(TinyFrame *tf) {
         if (tf->soft_lock) {
+            tf->tx_lock_fails++;
             TF_Error("TF already locked for tx!");
             return false;
         }
@@ -205,6 +206,16 @@
 #define CKSUM_ADD(cksum, byte) do { (cksum) = TF_CksumAdd((cksum), (byte)); } while (0)
 #define CKSUM_FINALIZE(cksum)  do { (cksum) = TF_CksumEnd((cksum)); } while (0)
 
+#if TF_CKSUM_HAS_BLOCK
+    #define CKSUM_ADD_BLOCK(cksum, data, n) do { (cksum) = TF_CksumBlock((cksum), (data), (n)); } while (0)
+#else
+    #define CKSUM_ADD_BLOCK(cksum, data, n) do { \
+            const uint8_t *_cp = (data); \
+            uint32_t _cn = (n); \
+            while (_cn-- > 0) { CKSUM_ADD((cksum), *_cp++); } \
+        } while (0)
+#endif
+
 //endregion
 
 
@@ -228,6 +239,9 @@ bool _TF_FN TF_InitStatic(TinyFrame *tf, TF_Peer peer_bit)
     tf->userdata = userdata;
 
     tf->peer_bit = peer_bit;
+#if TF_LEN_DYNAMIC
+    tf->len_bytes = 1;
+#endif
     return true;
 }
 
@@ -426,7 +440,8 @@ bool _TF_FN TF_RemoveGenericListener(TinyFrame *tf, TF_Listener cb)
 }
 
 /** Handle a message that was just collected & verified by the parser */
-static void _TF_FN TF_HandleReceivedMessage(TinyFrame *tf)
+static void _TF_FN TF_HandleReceivedMessage(TinyFrame *tf, TF_ID id, TF_TYPE type,
+                                            const uint8_t *data, TF_LEN len)
 {
     TF_COUNT i;
     struct TF_IdListener_ *ilst;
@@ -437,11 +452,15 @@ static void _TF_FN TF_HandleReceivedMessage(TinyFrame *tf)
     // Prepare message object
     TF_Msg msg;
     TF_ClearMsg(&msg);
-    msg.frame_id = tf->id;
+    msg.frame_id = id;
     msg.is_response = false;
-    msg.type = tf->type;
-    msg.data = tf->data;
-    msg.len = tf->len;
+    msg.type = type;
+    msg.data = data;
+    msg.len = len;
+
+#if TF_RX_HOOK
+    TF_RxHookImpl(tf, &msg);
+#endif
 
     // Any listener can consume the message, or let someone else handle it.
 
@@ -547,6 +566,50 @@ bool _TF_FN TF_RenewIdListener(TinyFrame *tf, TF_ID id)
 
 //region Parser
 
+// Width of the LEN field on the wire
+#if TF_LEN_DYNAMIC
+    #define TF_LEN_WIDTH(tf) ((uint32_t) (tf)->len_bytes)
+#else
+    #define TF_LEN_WIDTH(tf) ((uint32_t) TF_LEN_BYTES)
+#endif
+
+/** Largest payload length the LEN field can currently describe */
+uint32_t _TF_FN TF_GetMaxPayload(TinyFrame *tf)
+{
+    uint32_t width = TF_LEN_WIDTH(tf);
+    uint32_t max = (width >= 4) ? 0xFFFFFFFFUL : ((1UL << (8 * width)) - 1);
+    return TF_MIN(max, (uint32_t) TF_MAX_PAYLOAD_RX);
+}
+
+uint32_t _TF_FN TF_GetTxLockFails(TinyFrame *tf)
+{
+#if TF_USE_MUTEX
+    (void) tf;
+    return 0;
+#else
+    return tf->tx_lock_fails;
+#endif
+}
+
+#if TF_LEN_DYNAMIC
+bool _TF_FN TF_SetLenBytes(TinyFrame *tf, uint8_t len_bytes)
+{
+    if (len_bytes < 1 || len_bytes > TF_LEN_BYTES) {
+        TF_Error("Bad LEN width %d", (int) len_bytes);
+        return false;
+    }
+    tf->len_bytes = len_bytes;
+    return true;
+}
+
+uint8_t _TF_FN TF_GetLenBytes(TinyFrame *tf)
+{
+    return tf->len_bytes;
+}
+#endif
+
+#if !TF_RX_IN_PLACE
+
 /** Handle a received byte buffer */
 void _TF_FN TF_Accept(TinyFrame *tf, const uint8_t *buffer, uint32_t count)
 {
@@ -572,6 +635,7 @@ static void _TF_FN pars_begin_frame(TinyFrame *tf) {
 #endif
 
     tf->discard_data = false;
+    tf->len = 0; // the LEN field may be narrower than TF_LEN
 
     // Enter ID state
     tf->state = TFState_ID;
@@ -622,7 +686,8 @@ void _TF_FN TF_AcceptChar(TinyFrame *tf, unsigned char c)
 
         case TFState_LEN:
             CKSUM_ADD(tf->cksum, c);
-            COLLECT_NUMBER(tf->len, TF_LEN) {
+            tf->len = (TF_LEN) ((tf->len << 8) | c);
+            if (++tf->rxi == TF_LEN_WIDTH(tf)) {
                 // Enter TYPE state
                 tf->state = TFState_TYPE;
                 tf->rxi = 0;
@@ -657,7 +722,7 @@ void _TF_FN TF_AcceptChar(TinyFrame *tf, unsigned char c)
 
                 if (tf->len == 0) {
                     // if the message has no body, we're done.
-                    TF_HandleReceivedMessage(tf);
+                    TF_HandleReceivedMessage(tf, tf->id, tf->type, tf->data, tf->len);
                     TF_ResetParser(tf);
                     break;
                 }
@@ -687,7 +752,7 @@ void _TF_FN TF_AcceptChar(TinyFrame *tf, unsigned char c)
             if (tf->rxi == tf->len) {
                 #if TF_CKSUM_TYPE == TF_CKSUM_NONE
                     // All done
-                    TF_HandleReceivedMessage(tf);
+                    TF_HandleReceivedMessage(tf, tf->id, tf->type, tf->data, tf->len);
                     TF_ResetParser(tf);
                 #else
                     // Enter DATA_CKSUM state
@@ -704,7 +769,7 @@ void _TF_FN TF_AcceptChar(TinyFrame *tf, unsigned char c)
                 CKSUM_FINALIZE(tf->cksum);
                 if (!tf->discard_data) {
                     if (tf->cksum == tf->ref_cksum) {
-                        TF_HandleReceivedMessage(tf);
+                        TF_HandleReceivedMessage(tf, tf->id, tf->type, tf->data, tf->len);
                     } else {
                         TF_Error("Body cksum mismatch");
                     }
@@ -717,6 +782,181 @@ void _TF_FN TF_AcceptChar(TinyFrame *tf, unsigned char c)
     //@formatter:on
 }
 
+#else
+
+/** Reset the parser's internal state. */
+void _TF_FN TF_ResetParser(TinyFrame *tf)
+{
+    tf->state = TFState_SOF;
+    tf->rx_wait = 0;
+}
+
+#endif // !TF_RX_IN_PLACE
+
+// Frame layout sizes used by the in-place parser
+#define TF_HEAD_LEN(tf) (TF_USE_SOF_BYTE + TF_ID_BYTES + TF_LEN_WIDTH(tf) + TF_TYPE_BYTES)
+#if TF_CKSUM_TYPE == TF_CKSUM_NONE
+    #define TF_CKSUM_LEN 0
+#else
+    #define TF_CKSUM_LEN sizeof(TF_CKSUM)
+#endif
+
+/** Read a big-endian number of 'n' bytes */
+static inline uint32_t _TF_FN pars_read_num(const uint8_t *p, uint32_t n)
+{
+    uint32_t num = 0;
+    while (n-- > 0) {
+        num = (num << 8) | *p++;
+    }
+    return num;
+}
+
+#if TF_CKSUM_TYPE != TF_CKSUM_NONE
+/** Compute a finalized checksum of a contiguous block */
+static TF_CKSUM _TF_FN pars_cksum_block(const uint8_t *p, uint32_t n)
+{
+    TF_CKSUM cksum;
+    CKSUM_RESET(cksum);
+    CKSUM_ADD_BLOCK(cksum, p, n);
+    CKSUM_FINALIZE(cksum);
+    return cksum;
+}
+#endif
+
+#if TF_USE_SOF_BYTE
+/** Find the next SOF byte at or after 'pos', testing a whole word per step. Returns count if none. */
+static uint32_t _TF_FN pars_find_sof(const uint8_t *buffer, uint32_t pos, uint32_t count)
+{
+    const uint32_t pattern = 0x01010101UL * TF_SOF_BYTE;
+    uint32_t w;
+
+    while (pos < count && ((uintptr_t) (buffer + pos) & 3U) != 0) {
+        if (buffer[pos] == TF_SOF_BYTE) return pos;
+        pos++;
+    }
+
+    while (count - pos >= 4) {
+        memcpy(&w, buffer + pos, 4);
+        w ^= pattern; // the SOF byte becomes zero
+        if (((w - 0x01010101UL) & ~w & 0x80808080UL) != 0) break;
+        pos += 4;
+    }
+
+    while (pos < count && buffer[pos] != TF_SOF_BYTE) {
+        pos++;
+    }
+    return pos;
+}
+#endif
+
+/**
+ * Parse and dispatch all complete frames in the buffer.
+ *
+ * @return nr of bytes consumed; parsing stops at the start of an incomplete frame
+ */
+static uint32_t _TF_FN pars_frames(TinyFrame *tf, const uint8_t *buffer, uint32_t count)
+{
+    uint32_t pos = 0;
+    uint32_t avail;
+    uint32_t frame_len;
+    uint32_t head_len;
+    const uint8_t *p;
+    TF_ID id;
+    TF_LEN len;
+    TF_TYPE type;
+
+    while (pos < count) {
+#if TF_USE_SOF_BYTE
+        pos = pars_find_sof(buffer, pos, count);
+        if (pos == count) break;
+#endif
+        avail = count - pos;
+        head_len = TF_HEAD_LEN(tf);
+        if (avail < head_len + TF_CKSUM_LEN) {
+            break; // header not complete yet
+        }
+
+        p = buffer + pos + TF_USE_SOF_BYTE;
+        id = (TF_ID) pars_read_num(p, TF_ID_BYTES);
+        p += TF_ID_BYTES;
+        len = (TF_LEN) pars_read_num(p, TF_LEN_WIDTH(tf));
+        p += TF_LEN_WIDTH(tf);
+        type = (TF_TYPE) pars_read_num(p, TF_TYPE_BYTES);
+        p += TF_TYPE_BYTES;
+
+#if TF_CKSUM_TYPE != TF_CKSUM_NONE
+        if (pars_cksum_block(buffer + pos, head_len) != (TF_CKSUM) pars_read_num(p, TF_CKSUM_LEN)) {
+            TF_Error("Rx head cksum mismatch");
+            pos++; // not a real frame start, keep hunting
+            continue;
+        }
+        p += TF_CKSUM_LEN;
+#endif
+
+        if (len > TF_MAX_PAYLOAD_RX) {
+            TF_Error("Rx payload too long: %d", (int)len);
+            pos++;
+            continue;
+        }
+
+        frame_len = head_len + TF_CKSUM_LEN + len + (len > 0 ? TF_CKSUM_LEN : 0);
+        if (avail < frame_len) {
+            break; // body not complete yet
+        }
+
+#if TF_CKSUM_TYPE != TF_CKSUM_NONE
+        if (len > 0 && pars_cksum_block(p, len) != (TF_CKSUM) pars_read_num(p + len, TF_CKSUM_LEN)) {
+            TF_Error("Body cksum mismatch");
+            pos += frame_len;
+            continue;
+        }
+#endif
+
+        TF_HandleReceivedMessage(tf, id, type, p, len);
+        pos += frame_len;
+    }
+
+    return pos;
+}
+
+/** Parse complete frames in place, return nr of consumed bytes */
+uint32_t _TF_FN TF_AcceptInPlace(TinyFrame *tf, const uint8_t *buffer, uint32_t count)
+{
+    uint32_t pos = 0;
+    bool waiting = (tf->rx_wait != 0);
+
+    // A partial frame was left at the start of the buffer last time. rx_wait is the most of it
+    // ever seen; a shorter view (the tail before a ring buffer wraps, followed by a second call
+    // with the wrapped part) neither keeps it alive nor times it out.
+    if (waiting) {
+        if (count > tf->rx_wait) {
+            tf->parser_timeout_ticks = 0; // it grew, still alive
+            tf->rx_wait = count;
+        }
+        else if (count == tf->rx_wait && tf->parser_timeout_ticks >= TF_PARSER_TIMEOUT_TICKS) {
+            TF_Error("Parser timeout");
+            pos = 1; // drop its SOF and re-synchronize behind it
+            waiting = false;
+        }
+    }
+
+    pos += pars_frames(tf, buffer + pos, count - pos);
+
+    if (pos < count) {
+        // Remember the partial frame, it is timed out by TF_Tick()
+        if (pos != 0 || !waiting) {
+            tf->parser_timeout_ticks = 0; // a new partial frame
+            tf->rx_wait = count - pos;
+        }
+        tf->state = TFState_DATA;
+    }
+    else {
+        tf->rx_wait = 0;
+        tf->state = TFState_SOF;
+    }
+    return pos;
+}
+
 //endregion Parser
 
 
@@ -769,6 +1009,19 @@ void _TF_FN TF_AcceptChar(TinyFrame *tf, unsigned char c)
  * @param msg - message written to the buffer
  * @return nr of bytes in outbuff used by the frame, 0 on failure
  */
+/**
+ * Allocate a new frame ID. Atomic, because TF_ComposeInPlace() may run in
+ * several contexts (main loop, interrupts) at once.
+ */
+static inline TF_ID _TF_FN TF_NextId(TinyFrame *tf)
+{
+#if defined(__GNUC__)
+    return __atomic_fetch_add(&tf->next_id, 1, __ATOMIC_RELAXED);
+#else
+    return tf->next_id++;
+#endif
+}
+
 static inline uint32_t _TF_FN TF_ComposeHead(TinyFrame *tf, uint8_t *outbuff, TF_Msg *msg)
 {
     int8_t si = 0; // signed small int
@@ -786,7 +1039,7 @@ static inline uint32_t _TF_FN TF_ComposeHead(TinyFrame *tf, uint8_t *outbuff, TF
         id = msg->frame_id;
     }
     else {
-        id = (TF_ID) (tf->next_id++ & TF_ID_MASK);
+        id = (TF_ID) (TF_NextId(tf) & TF_ID_MASK);
         if (tf->peer_bit) {
             id |= TF_ID_PEERBIT;
         }
@@ -803,7 +1056,15 @@ static inline uint32_t _TF_FN TF_ComposeHead(TinyFrame *tf, uint8_t *outbuff, TF
 #endif
 
     WRITENUM_CKSUM(TF_ID, id);
+#if TF_LEN_DYNAMIC
+    if (tf->len_bytes == 1) {
+        WRITENUM_CKSUM(uint8_t, msg->len);
+    } else {
+        WRITENUM_CKSUM(TF_LEN, msg->len);
+    }
+#else
     WRITENUM_CKSUM(TF_LEN, msg->len);
+#endif
     WRITENUM_CKSUM(TF_TYPE, msg->type);
 
 #if TF_CKSUM_TYPE != TF_CKSUM_NONE
@@ -828,17 +1089,14 @@ static inline uint32_t _TF_FN TF_ComposeBody(uint8_t *outbuff,
                                     const uint8_t *data, TF_LEN data_len,
                                     TF_CKSUM *cksum)
 {
-    TF_LEN i = 0;
-    uint8_t b = 0;
-    uint32_t pos = 0;
-
-    for (i = 0; i < data_len; i++) {
-        b = data[i];
-        outbuff[pos++] = b;
-        CKSUM_ADD(*cksum, b);
-    }
+    memcpy(outbuff, data, data_len);
+#if TF_CKSUM_TYPE != TF_CKSUM_NONE
+    CKSUM_ADD_BLOCK(*cksum, outbuff, data_len);
+#else
+    (void)cksum;
+#endif
 
-    return pos;
+    return data_len;
 }
 
 /**
@@ -873,13 +1131,33 @@ static inline uint32_t _TF_FN TF_ComposeTail(uint8_t *outbuff, TF_CKSUM *cksum)
  */
 static bool _TF_FN TF_SendFrame_Begin(TinyFrame *tf, TF_Msg *msg, TF_Listener listener, TF_Listener_Timeout ftimeout, TF_TICKS timeout)
 {
+    if (msg->len > TF_GetMaxPayload(tf)) {
+        TF_Error("Tx payload too long: %d", (int) msg->len);
+        return false;
+    }
+
     TF_TRY(TF_ClaimTx(tf));
 
+#if TF_TX_ZERO_COPY
+    // The whole frame is composed in place, reserve it at once
+    tf->tx_cap = TF_HEAD_LEN(tf) + TF_CKSUM_LEN + msg->len + (msg->len > 0 ? TF_CKSUM_LEN : 0);
+    tf->txbuf = TF_ReserveImpl(tf, tf->tx_cap);
+    if (tf->txbuf == NULL) {
+        TF_Error("No room for Tx frame");
+        TF_ReleaseTx(tf);
+        return false;
+    }
+    tf->tx_pos = (uint32_t) TF_ComposeHead(tf, tf->txbuf, msg);
+#else
     tf->tx_pos = (uint32_t) TF_ComposeHead(tf, tf->sendbuf, msg); // frame ID is incremented here if it's not a response
+#endif
     tf->tx_len = msg->len;
 
     if (listener) {
         if(!TF_AddIdListener(tf, msg, listener, ftimeout, timeout)) {
+#if TF_TX_ZERO_COPY
+            TF_CommitImpl(tf, 0);
+#endif
             TF_ReleaseTx(tf);
             return false;
         }
@@ -899,6 +1177,15 @@ static bool _TF_FN TF_SendFrame_Begin(TinyFrame *tf, TF_Msg *msg, TF_Listener li
  */
 static void _TF_FN TF_SendFrame_Chunk(TinyFrame *tf, const uint8_t *buff, uint32_t length)
 {
+#if TF_TX_ZERO_COPY
+    // Never write past the reserved block (room for the checksum is kept)
+    uint32_t room = tf->tx_cap - tf->tx_pos - (tf->tx_len > 0 ? TF_CKSUM_LEN : 0);
+    if (length > room) {
+        TF_Error("Tx chunk exceeds frame length");
+        length = room;
+    }
+    tf->tx_pos += TF_ComposeBody(tf->txbuf + tf->tx_pos, buff, (TF_LEN) length, &tf->tx_cksum);
+#else
     uint32_t remain;
     uint32_t chunk;
     uint32_t sent = 0;
@@ -917,6 +1204,7 @@ static void _TF_FN TF_SendFrame_Chunk(TinyFrame *tf, const uint8_t *buff, uint32
             tf->tx_pos = 0;
         }
     }
+#endif
 }
 
 /**
@@ -926,6 +1214,15 @@ static void _TF_FN TF_SendFrame_Chunk(TinyFrame *tf, const uint8_t *buff, uint32
  */
 static void _TF_FN TF_SendFrame_End(TinyFrame *tf)
 {
+#if TF_TX_ZERO_COPY
+    if (tf->tx_len > 0) {
+        tf->tx_pos += TF_ComposeTail(tf->txbuf + tf->tx_pos, &tf->tx_cksum);
+    }
+
+    TF_CommitImpl(tf, tf->tx_pos);
+    tf->txbuf = NULL;
+    TF_ReleaseTx(tf);
+#else
     // Checksum only if message had a body
     if (tf->tx_len > 0) {
         // Flush if checksum wouldn't fit in the buffer
@@ -940,6 +1237,7 @@ static void _TF_FN TF_SendFrame_End(TinyFrame *tf)
 
     TF_WriteImpl(tf, (const uint8_t *) tf->sendbuf, tf->tx_pos);
     TF_ReleaseTx(tf);
+#endif
 }
 
 /**
@@ -1014,6 +1312,117 @@ bool _TF_FN TF_Respond(TinyFrame *tf, TF_Msg *msg)
 //endregion Sending API funcs
 
 
+//region Sending API funcs - in place
+
+uint8_t * _TF_FN TF_SendReserve(TinyFrame *tf, TF_LEN max_len)
+{
+    uint32_t head = TF_HEAD_LEN(tf) + TF_CKSUM_LEN;
+    uint32_t cap = head + max_len + (max_len > 0 ? TF_CKSUM_LEN : 0);
+    uint8_t *buf;
+
+    if (max_len > TF_GetMaxPayload(tf)) {
+        TF_Error("Tx payload too long: %d", (int) max_len);
+        return NULL;
+    }
+
+    if (!TF_ClaimTx(tf)) return NULL;
+
+#if TF_TX_ZERO_COPY
+    buf = TF_ReserveImpl(tf, cap);
+    tf->txbuf = buf;
+    tf->tx_cap = cap;
+#else
+    buf = (cap <= TF_SENDBUF_LEN) ? tf->sendbuf : NULL;
+#endif
+    if (buf == NULL) {
+        TF_Error("No room for Tx frame");
+        TF_ReleaseTx(tf);
+        return NULL;
+    }
+
+    tf->tx_len = max_len;
+    return buf + head;
+}
+
+bool _TF_FN TF_SendCommit(TinyFrame *tf, TF_Msg *msg)
+{
+#if TF_TX_ZERO_COPY
+    uint8_t *buf = tf->txbuf;
+#else
+    uint8_t *buf = tf->sendbuf;
+#endif
+    uint32_t pos;
+
+    if (msg->len > tf->tx_len) {
+        TF_Error("Tx payload exceeds reservation");
+        TF_SendAbort(tf);
+        return false;
+    }
+
+    // The head has a fixed size, compose it in front of the already written payload
+    pos = TF_ComposeHead(tf, buf, msg);
+    if (msg->len > 0) {
+        CKSUM_RESET(tf->tx_cksum);
+        CKSUM_ADD_BLOCK(tf->tx_cksum, buf + pos, msg->len);
+        pos += msg->len;
+        pos += TF_ComposeTail(buf + pos, &tf->tx_cksum);
+    }
+
+#if TF_TX_ZERO_COPY
+    TF_CommitImpl(tf, pos);
+    tf->txbuf = NULL;
+#else
+    TF_WriteImpl(tf, (const uint8_t *) buf, pos);
+#endif
+    TF_ReleaseTx(tf);
+    return true;
+}
+
+void _TF_FN TF_SendAbort(TinyFrame *tf)
+{
+#if TF_TX_ZERO_COPY
+    TF_CommitImpl(tf, 0);
+    tf->txbuf = NULL;
+#endif
+    TF_ReleaseTx(tf);
+}
+
+uint32_t _TF_FN TF_FrameHeadLen(TinyFrame *tf)
+{
+    return TF_HEAD_LEN(tf) + TF_CKSUM_LEN;
+}
+
+uint32_t _TF_FN TF_FrameLen(TinyFrame *tf, TF_LEN len)
+{
+    return TF_HEAD_LEN(tf) + TF_CKSUM_LEN + len + (len > 0 ? TF_CKSUM_LEN : 0);
+}
+
+uint32_t _TF_FN TF_ComposeInPlace(TinyFrame *tf, uint8_t *buf, TF_Msg *msg)
+{
+    TF_CKSUM cksum = 0;
+    uint32_t pos;
+
+    (void)cksum;
+
+    if (msg->len > TF_GetMaxPayload(tf)) {
+        TF_Error("Tx payload too long: %d", (int) msg->len);
+        return 0;
+    }
+
+    // Same as TF_SendCommit(), but with a local checksum and without the Tx lock
+    pos = TF_ComposeHead(tf, buf, msg);
+    if (msg->len > 0) {
+        CKSUM_RESET(cksum);
+        CKSUM_ADD_BLOCK(cksum, buf + pos, msg->len);
+        pos += msg->len;
+        pos += TF_ComposeTail(buf + pos, &cksum);
+    }
+    return pos;
+}
+
+//endregion Sending API funcs - in place
+
+
 //region Sending API funcs - multipart
 
 bool _TF_FN TF_Send_Multipart(TinyFrame *tf, TF_Msg *msg)
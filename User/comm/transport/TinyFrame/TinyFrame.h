@@ -31,6 +31,29 @@
 
 #include "TF_Config.h"
 
+// Parse frames in the receive buffer (TF_AcceptInPlace) instead of copying them into tf->data.
+// The byte-wise TF_Accept() / TF_AcceptChar() are not available in this mode.
+#ifndef TF_RX_IN_PLACE
+    #define TF_RX_IN_PLACE 0
+#endif
+
+// Compose outgoing frames directly in memory provided by TF_ReserveImpl() / TF_CommitImpl()
+// (e.g. the UART DMA queue) instead of tf->sendbuf + TF_WriteImpl().
+#ifndef TF_TX_ZERO_COPY
+    #define TF_TX_ZERO_COPY 0
+#endif
+
+// Pass every received frame to TF_RxHookImpl() before the listeners see it (e.g. for tracing).
+#ifndef TF_RX_HOOK
+    #define TF_RX_HOOK 0
+#endif
+
+// Width of the LEN field is chosen at run time (1 .. TF_LEN_BYTES, see TF_SetLenBytes()).
+// The instance starts with 1-byte lengths; both peers must switch at the same frame boundary.
+#ifndef TF_LEN_DYNAMIC
+    #define TF_LEN_DYNAMIC 0
+#endif
+
 //region Resolve data types
 
 #if TF_LEN_BYTES == 1
@@ -198,6 +221,7 @@ void TF_DeInit(TinyFrame *tf);
 
 // ---------------------------------- API CALLS --------------------------------------
 
+#if !TF_RX_IN_PLACE
 /**
  * Accept incoming bytes & parse frames
  *
@@ -214,6 +238,65 @@ void TF_Accept(TinyFrame *tf, const uint8_t *buffer, uint32_t count);
  * @param c - a received char
  */
 void TF_AcceptChar(TinyFrame *tf, uint8_t c);
+#endif
+
+/**
+ * Parse complete frames directly in the caller's buffer, without copying.
+ *
+ * Frames are located and validated in place; listeners receive msg->data
+ * pointing into the buffer, valid only for the duration of the callback.
+ *
+ * Parsing stops at the first incomplete frame. Its bytes are NOT consumed -
+ * the caller keeps them and calls again with the same start once more bytes
+ * arrived. A partial frame that does not grow for TF_PARSER_TIMEOUT_TICKS
+ * is dropped (its SOF byte is skipped and the parser re-synchronizes).
+ * A call that sees less of it than before (the tail of a ring buffer, before
+ * a second call with the wrapped part appended) leaves its timeout alone.
+ *
+ * @param tf - instance
+ * @param buffer - received bytes, starting at the first unconsumed byte
+ * @param count - nr of bytes in the buffer
+ * @return nr of bytes consumed (complete frames and skipped garbage)
+ */
+uint32_t TF_AcceptInPlace(TinyFrame *tf, const uint8_t *buffer, uint32_t count);
+
+/**
+ * Get the largest payload the LEN field can currently describe
+ * (also capped by TF_MAX_PAYLOAD_RX).
+ *
+ * @param tf - instance
+ * @return max payload length in bytes
+ */
+uint32_t TF_GetMaxPayload(TinyFrame *tf);
+
+/**
+ * Number of frames that could not be sent because the Tx interface was already
+ * claimed ("TF already locked for tx!"). Always 0 with TF_USE_MUTEX.
+ *
+ * @param tf - instance
+ * @return failure count since TF_Init
+ */
+uint32_t TF_GetTxLockFails(TinyFrame *tf);
+
+#if TF_LEN_DYNAMIC
+/**
+ * Change the width of the LEN field for both received and sent frames.
+ * Takes effect from the next frame; a frame being composed or parsed is not affected.
+ *
+ * @param tf - instance
+ * @param len_bytes - 1 .. TF_LEN_BYTES
+ * @return success
+ */
+bool TF_SetLenBytes(TinyFrame *tf, uint8_t len_bytes);
+
+/**
+ * Get the current width of the LEN field
+ *
+ * @param tf - instance
+ * @return 1 .. TF_LEN_BYTES
+ */
+uint8_t TF_GetLenBytes(TinyFrame *tf);
+#endif
 
 /**
  * This function should be called periodically.
@@ -349,6 +432,76 @@ bool TF_QuerySimple(TinyFrame *tf, TF_TYPE type,
 bool TF_Respond(TinyFrame *tf, TF_Msg *msg);
 
 
+// ------------------------ IN-PLACE FRAME TX FUNCTIONS -----------------------------
+// Serialize the payload straight into the frame buffer (see TF_TX_ZERO_COPY)
+
+/**
+ * Reserve room for a frame and get a pointer to its payload area, so the payload
+ * can be serialized in place (no intermediate buffer, no copy).
+ * The Tx interface stays claimed until TF_SendCommit() or TF_SendAbort().
+ *
+ * @param tf - instance
+ * @param max_len - max payload length that will be written
+ * @return payload pointer (max_len bytes writable), NULL on failure
+ */
+uint8_t *TF_SendReserve(TinyFrame *tf, TF_LEN max_len);
+
+/**
+ * Finish and send a frame started with TF_SendReserve().
+ * The header is composed now, so msg->len may be smaller than the reserved max_len.
+ * msg->data is ignored; type, is_response and frame_id are used as in TF_Send().
+ *
+ * @param tf - instance
+ * @param msg - message (len = payload bytes written)
+ * @return success
+ */
+bool TF_SendCommit(TinyFrame *tf, TF_Msg *msg);
+
+/**
+ * Drop a frame started with TF_SendReserve()
+ *
+ * @param tf - instance
+ */
+void TF_SendAbort(TinyFrame *tf);
+
+
+// ------------------------ CONCURRENT IN-PLACE COMPOSE -----------------------------
+// The caller owns the frame buffer (e.g. a slot from a frame pool), so several contexts
+// (main loop, interrupts) can compose frames at the same time. The Tx lock is not
+// used and nothing is sent; handing the finished frame to the UART is up to the caller.
+
+/**
+ * Offset of the payload in a frame (head + head checksum)
+ *
+ * @param tf - instance
+ * @return bytes in front of the payload
+ */
+uint32_t TF_FrameHeadLen(TinyFrame *tf);
+
+/**
+ * Total frame size for a given payload length
+ *
+ * @param tf - instance
+ * @param len - payload length
+ * @return frame size in bytes
+ */
+uint32_t TF_FrameLen(TinyFrame *tf, TF_LEN len);
+
+/**
+ * Compose the head and checksums around a payload already written at
+ * buf + TF_FrameHeadLen(tf). Reentrant: the frame ID is allocated atomically and
+ * no shared Tx state is touched. The LEN width must not change between sizing
+ * the buffer and composing.
+ * msg->data is ignored; type, is_response and frame_id are used as in TF_Send().
+ *
+ * @param tf - instance
+ * @param buf - frame buffer, at least TF_FrameLen(tf, msg->len) bytes
+ * @param msg - message (len = payload bytes written)
+ * @return frame length, 0 if the payload is too long
+ */
+uint32_t TF_ComposeInPlace(TinyFrame *tf, uint8_t *buf, TF_Msg *msg);
+
+
 // ------------------------ MULTIPART FRAME TX FUNCTIONS -----------------------------
 // Those routines are used to send long frames without having all the data available
 // at once (e.g. capturing it from a peripheral or reading from a large memory buffer)
@@ -450,7 +603,13 @@ struct TinyFrame_ {
     TF_TICKS parser_timeout_ticks;
     TF_ID id;               //!< Incoming packet ID
     TF_LEN len;             //!< Payload length
+#if TF_LEN_DYNAMIC
+    uint8_t len_bytes;      //!< Current width of the LEN field (rx and tx)
+#endif
+#if !TF_RX_IN_PLACE
     uint8_t data[TF_MAX_PAYLOAD_RX]; //!< Data byte buffer
+#endif
+    uint32_t rx_wait;       //!< In-place parser: most bytes of the partial frame seen (0 = none)
     TF_LEN rxi;             //!< Field size byte counter
     TF_CKSUM cksum;         //!< Checksum calculated of the data stream
     TF_CKSUM ref_cksum;     //!< Reference checksum read from the message
@@ -458,8 +617,13 @@ struct TinyFrame_ {
     bool discard_data;      //!< Set if (len > TF_MAX_PAYLOAD) to read the frame, but ignore the data.
 
     /* Tx state */
+#if TF_TX_ZERO_COPY
+    uint8_t *txbuf;         //!< Frame being composed, reserved with TF_ReserveImpl()
+    uint32_t tx_cap;        //!< Size of the reserved block
+#else
     // Buffer for building frames
     uint8_t sendbuf[TF_SENDBUF_LEN]; //!< Transmit temporary buffer
+#endif
 
     uint32_t tx_pos;        //!< Next write position in the Tx buffer (used for multipart)
     uint32_t tx_len;        //!< Total expected Tx length
@@ -467,6 +631,7 @@ struct TinyFrame_ {
 
 #if !TF_USE_MUTEX
     bool soft_lock;         //!< Tx lock flag used if the mutex feature is not enabled.
+    uint32_t tx_lock_fails; //!< Frames not sent because the Tx lock was taken
 #endif
 
     /* --- Callbacks --- */
@@ -487,12 +652,39 @@ struct TinyFrame_ {
 
 // ------------------------ TO BE IMPLEMENTED BY USER ------------------------
 
+#if TF_TX_ZERO_COPY
+/**
+ * Reserve a contiguous block of 'len' bytes in the output queue; the frame is composed in it.
+ *
+ * ! Implement this in your application code !
+ *
+ * @return pointer to the block, or NULL if there is no room
+ */
+extern uint8_t *TF_ReserveImpl(TinyFrame *tf, uint32_t len);
+
+/**
+ * Hand the first 'len' bytes of the reserved block over for sending (0 = drop the reservation).
+ *
+ * ! Implement this in your application code !
+ */
+extern void TF_CommitImpl(TinyFrame *tf, uint32_t len);
+#else
 /**
  * 'Write bytes' function that sends data to UART
  *
  * ! Implement this in your application code !
  */
 extern void TF_WriteImpl(TinyFrame *tf, const uint8_t *buff, uint32_t len);
+#endif
+
+#if TF_RX_HOOK
+/**
+ * Called with every verified frame before it is dispatched to the listeners.
+ *
+ * ! Implement this in your application code !
+ */
+extern void TF_RxHookImpl(TinyFrame *tf, const TF_Msg *msg);
+#endif
 
 // Mutex functions
 #if TF_USE_MUTEX
@@ -532,6 +724,20 @@ extern void TF_WriteImpl(TinyFrame *tf, const uint8_t *buff, uint32_t len);
      */
     extern TF_CKSUM TF_CksumEnd(TF_CKSUM cksum);
 
+#if TF_CKSUM_HAS_BLOCK
+    /**
+     * Update a checksum with a block of bytes (optional, set TF_CKSUM_HAS_BLOCK).
+     * Used instead of TF_CksumAdd() wherever the data is contiguous, so the
+     * implementation can work a word at a time or use a hardware unit.
+     *
+     * @param cksum - previous checksum value
+     * @param data - bytes to add
+     * @param len - nr of bytes
+     * @return updated checksum value
+     */
+    extern TF_CKSUM TF_CksumBlock(TF_CKSUM cksum, const uint8_t *data, uint32_t len);
+#endif
+
 #endif
 
 #endif
@@ -0,0 +1,189 @@
+#include "tf_capture.h"
+
+#include <string.h>
+
+#if TF_CAPTURE_ENABLE
+
+#define CAPTURE_MASK (TF_CAPTURE_BUFFER_SIZE - 1U)
+
+_Static_assert(TF_CAPTURE_BUFFER_SIZE <= 0xFFFFU, "capture size is reported as u16");
+_Static_assert(TF_CAPTURE_RECORD_HEAD + TF_CAPTURE_MAX_DATA <= TF_CAPTURE_BUFFER_SIZE,
+               "TF_CAPTURE_MAX_DATA does not fit into the capture buffer");
+
+static uint8_t s_buf[TF_CAPTURE_BUFFER_SIZE];
+
+// head / tail 为自由计数的字节位置，取低位得到缓冲区下标；tail - head 为已用字节数
+static uint32_t          s_head    = 0;  // 最早一条记录的起始位置
+static uint32_t          s_tail    = 0;  // 下一条记录的写入位置
+static uint16_t          s_records = 0;
+static volatile int      s_writer  = 0;  // 写入权
+static volatile bool     s_running = false;
+static volatile uint32_t s_time_ms = 0;
+
+static uint32_t s_overwritten = 0;
+static uint32_t s_dropped     = 0;
+
+static void ring_write(uint32_t pos, const uint8_t* data, uint32_t len)
+{
+    uint32_t idx   = pos & CAPTURE_MASK;
+    uint32_t first = TF_CAPTURE_BUFFER_SIZE - idx;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(&s_buf[idx], data, first);
+    memcpy(s_buf, data + first, len - first);
+}
+
+static void ring_read(uint32_t pos, uint8_t* data, uint32_t len)
+{
+    uint32_t idx   = pos & CAPTURE_MASK;
+    uint32_t first = TF_CAPTURE_BUFFER_SIZE - idx;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(data, &s_buf[idx], first);
+    memcpy(data + first, s_buf, len - first);
+}
+
+static void ring_clear(void)
+{
+    s_head        = 0;
+    s_tail        = 0;
+    s_records     = 0;
+    s_overwritten = 0;
+    s_dropped     = 0;
+}
+
+void tf_capture_init(void)
+{
+    ring_clear();
+    s_running = true;
+}
+
+void tf_capture_frame(uint8_t flags, uint8_t id, uint8_t type, const uint8_t* data, uint16_t len)
+{
+    if (!s_running) {
+        return;
+    }
+    if (__atomic_exchange_n(&s_writer, 1, __ATOMIC_ACQUIRE)) {
+        s_dropped++;  // 被中断打断的写入仍持有写入权，这条记录放弃
+        return;
+    }
+
+    uint16_t stored = (len > TF_CAPTURE_MAX_DATA) ? TF_CAPTURE_MAX_DATA : len;
+    if (stored < len) {
+        flags |= TF_CAPTURE_TRUNCATED;
+    }
+    uint32_t rec_len = TF_CAPTURE_RECORD_HEAD + stored;
+
+    // 腾出空间：从最早的记录开始覆盖
+    while (TF_CAPTURE_BUFFER_SIZE - (s_tail - s_head) < rec_len) {
+        uint8_t head[TF_CAPTURE_RECORD_HEAD];
+        ring_read(s_head, head, sizeof(head));
+        s_head += TF_CAPTURE_RECORD_HEAD + (uint32_t)(head[9] | (head[10] << 8));
+        s_records--;
+        s_overwritten++;
+    }
+
+    uint32_t t = s_time_ms;
+    uint8_t  head[TF_CAPTURE_RECORD_HEAD];
+    head[0]  = (uint8_t)t;
+    head[1]  = (uint8_t)(t >> 8);
+    head[2]  = (uint8_t)(t >> 16);
+    head[3]  = (uint8_t)(t >> 24);
+    head[4]  = flags;
+    head[5]  = id;
+    head[6]  = type;
+    head[7]  = (uint8_t)len;
+    head[8]  = (uint8_t)(len >> 8);
+    head[9]  = (uint8_t)stored;
+    head[10] = (uint8_t)(stored >> 8);
+    ring_write(s_tail, head, sizeof(head));
+    if (stored > 0U) {
+        ring_write(s_tail + TF_CAPTURE_RECORD_HEAD, data, stored);
+    }
+    s_tail += rec_len;
+    s_records++;
+
+    __atomic_store_n(&s_writer, 0, __ATOMIC_RELEASE);
+}
+
+void tf_capture_tick_1ms(void)
+{
+    s_time_ms++;
+}
+
+void tf_capture_start(void)
+{
+    // 主循环中调用：中断里的写入者总是在返回前完成，停止后不会再有新的写入
+    s_running = false;
+    ring_clear();
+    s_running = true;
+}
+
+void tf_capture_stop(void)
+{
+    s_running = false;
+}
+
+void tf_capture_get_info(tf_capture_info_t* info)
+{
+    if (info == NULL) {
+        return;
+    }
+    info->running     = s_running;
+    info->records     = s_records;
+    info->size        = (uint16_t)(s_tail - s_head);
+    info->overwritten = s_overwritten;
+    info->dropped     = s_dropped;
+}
+
+uint16_t tf_capture_read(uint16_t offset, uint8_t* buf, uint16_t max_len)
+{
+    uint32_t size = s_tail - s_head;
+    if (s_running || buf == NULL || offset >= size) {
+        return 0;
+    }
+    uint32_t n = size - offset;
+    if (n > max_len) {
+        n = max_len;
+    }
+    ring_read(s_head + offset, buf, n);
+    return (uint16_t)n;
+}
+
+#else
+
+void tf_capture_init(void) {}
+
+void tf_capture_frame(uint8_t flags, uint8_t id, uint8_t type, const uint8_t* data, uint16_t len)
+{
+    (void)flags;
+    (void)id;
+    (void)type;
+    (void)data;
+    (void)len;
+}
+
+void tf_capture_tick_1ms(void) {}
+
+void tf_capture_start(void) {}
+
+void tf_capture_stop(void) {}
+
+void tf_capture_get_info(tf_capture_info_t* info)
+{
+    if (info != NULL) {
+        memset(info, 0, sizeof(*info));
+    }
+}
+
+uint16_t tf_capture_read(uint16_t offset, uint8_t* buf, uint16_t max_len)
+{
+    (void)offset;
+    (void)buf;
+    (void)max_len;
+    return 0;
+}
+
+#endif
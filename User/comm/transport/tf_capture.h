@@ -0,0 +1,83 @@
+#ifndef TF_CAPTURE_H
+#define TF_CAPTURE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../comm_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * 收发帧抓包（TF_CAPTURE_ENABLE，见 comm_config.h）
+ *
+ * 校验通过的接收帧和发出的每一帧按时间顺序记录到 RAM 环形缓冲区，满了覆盖最早的记录，
+ * 现场出问题后停止记录、用 DEBUG_CMD_CAPTURE 读出（Tools/host/capture/km1_cap dump），
+ * 再在主机端仿真设备上回放。记录格式（小端）：
+ *   [time_ms:u32][flags:u8][id:u8][type:u8][len:u16][stored:u16][data * stored]
+ *   - flags: TF_CAPTURE_TX（设备发出，否则为接收）、TF_CAPTURE_TRUNCATED（只保存了前 stored 字节）
+ *   - data 为帧的数据区 [cmd][payload...]，最多 TF_CAPTURE_MAX_DATA 字节
+ * 主机端 km1::TapTransport 写出的抓包文件使用相同的记录格式。
+ *
+ * 主循环和中断都可能发帧：写入时获取写入权，抢不到（被中断打断的那次写入）的记录直接丢弃
+ * 并计数，不关中断。未打开时所有函数为空操作，不占用 RAM。
+ */
+
+#define TF_CAPTURE_RECORD_HEAD 11U  // 记录头长度
+
+#define TF_CAPTURE_TX        0x01U  // 设备发出的帧
+#define TF_CAPTURE_TRUNCATED 0x02U  // 数据被截断
+
+/**
+ * @brief 抓包状态
+ */
+typedef struct {
+    bool     running;      // 正在记录（停止后才能读出）
+    uint16_t records;      // 缓冲区中的记录数
+    uint16_t size;         // 缓冲区中的字节数（读出的总长度）
+    uint32_t overwritten;  // 被新记录覆盖的记录数
+    uint32_t dropped;      // 写入冲突丢弃的记录数
+} tf_capture_info_t;
+
+/**
+ * @brief 初始化，上电即开始记录
+ */
+void tf_capture_init(void);
+
+/**
+ * @brief 记录一帧（任意上下文）
+ * @param flags TF_CAPTURE_TX 或 0
+ */
+void tf_capture_frame(uint8_t flags, uint8_t id, uint8_t type, const uint8_t* data, uint16_t len);
+
+/**
+ * @brief 时间戳计数（每 1ms 调用一次，目标板上在 PendSV 中）
+ */
+void tf_capture_tick_1ms(void);
+
+/**
+ * @brief 清空缓冲区并开始记录
+ */
+void tf_capture_start(void);
+
+/**
+ * @brief 停止记录，缓冲区内容保持不变直到下次 tf_capture_start()
+ */
+void tf_capture_stop(void);
+
+void tf_capture_get_info(tf_capture_info_t* info);
+
+/**
+ * @brief 按从旧到新的顺序读出缓冲区内容（停止后调用）
+ * @param offset 起始字节（0..info.size）
+ * @return 复制的字节数，正在记录时为 0
+ */
+uint16_t tf_capture_read(uint16_t offset, uint8_t* buf, uint16_t max_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TF_CAPTURE_H
@@ -0,0 +1,64 @@
+#ifndef TF_CRC32_H
+#define TF_CRC32_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * TinyFrame 自定义校验（TF_CKSUM_CUSTOM32）：CRC-32/MPEG-2
+ *   多项式 0x04C11DB7，初值 0xFFFFFFFF，不反射，无结果异或
+ *   "123456789" 的校验值为 0x0376E6E7
+ *
+ * 这正是 STM32F1 CRC 外设的算法（按大端字输入）。目标板上整块数据按字送入硬件，
+ * 不足 4 字节的尾部查表补算；主机构建使用 slicing-by-4 查表实现，结果一致。
+ */
+
+#ifndef TF_CRC32_USE_HW
+#if defined(__arm__)
+#define TF_CRC32_USE_HW 1  // 使用 CRC 外设
+#else
+#define TF_CRC32_USE_HW 0  // 主机构建：纯软件
+#endif
+#endif
+
+/**
+ * @brief 校验开销统计
+ */
+typedef struct {
+    uint32_t blocks;  // 计算的数据块数（每帧：头一块，有数据时再加一块）
+    uint32_t bytes;   // 参与计算的字节数
+    uint32_t cycles;  // 耗时（周期计数）
+} tf_crc32_stats_t;
+
+/**
+ * @brief 初始化（使能 CRC 外设时钟）
+ */
+void tf_crc32_init(void);
+
+/**
+ * @brief 一次性计算一块数据的 CRC（含初值，不含结束处理）
+ * @param data 数据
+ * @param len  长度
+ * @return CRC 值
+ */
+uint32_t tf_crc32_compute(const uint8_t* data, uint32_t len);
+
+/**
+ * @brief 获取统计
+ */
+void tf_crc32_get_stats(tf_crc32_stats_t* stats);
+
+/**
+ * @brief 清零统计
+ */
+void tf_crc32_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TF_CRC32_H
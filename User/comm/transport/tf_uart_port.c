@@ -4,6 +4,10 @@
 #include <string.h>
 
 #include "../drivers/uart_driver.h"
+#include "cycle_counter.h"
+#include "debug_output.h"
+#include "tf_capture.h"
+#include "tf_crc32.h"
 #include "tinyframe/TinyFrame.h"
 #include "tinyframe/utils.h"
 
@@ -13,18 +17,78 @@ static TinyFrame tf_instance;  // TinyFrame instance
 static tf_uart_frame_callback_t user_callback  = NULL;  // User callback
 static bool                     tf_uart_inited = false;
 
+// 接收路径统计（解析 + 监听器执行）
+static tf_uart_port_stats_t rx_stats;
+
+#if TF_RX_IN_PLACE
+// 最大帧长度（头 + 头校验 + 数据 + 数据校验），跨越 DMA 缓冲区末尾的帧除第一个字节外都要放入镜像区
+#define TF_UART_MAX_PAYLOAD                                                                        \
+    ((TF_MAX_PAYLOAD_RX < (1UL << (8 * TF_LEN_BYTES)) - 1) ? TF_MAX_PAYLOAD_RX                     \
+                                                           : (1UL << (8 * TF_LEN_BYTES)) - 1)
+#define TF_UART_MAX_FRAME                                                                          \
+    (1 + TF_ID_BYTES + TF_LEN_BYTES + TF_TYPE_BYTES + 2 * sizeof(TF_CKSUM) + TF_UART_MAX_PAYLOAD)
+
+_Static_assert(UART_RX_WRAP_GUARD >= TF_UART_MAX_FRAME - 1,
+               "UART_RX_WRAP_GUARD smaller than a frame");
+// 解析一帧期间 DMA 还能再收一整帧而不覆盖它
+_Static_assert(UART_DMA_RX_BUFFER_SIZE >= 2 * TF_UART_MAX_FRAME,
+               "UART_DMA_RX_BUFFER_SIZE must hold two maximum-size frames");
+
+static bool rx_partial = false;  // 上次解析停在不完整帧上，需要继续检查超时
+#endif
+
+// 波特率协商：请求 -> 应答发完后切换 -> 等待确认，超时恢复原波特率
+typedef enum {
+    BAUD_IDLE = 0,
+    BAUD_PENDING,    // 等待已排队的帧以旧波特率发完
+    BAUD_PROBATION,  // 已切换，等待新波特率下的有效帧
+} baud_state_t;
+
+static baud_state_t      baud_state     = BAUD_IDLE;
+static uint32_t          baud_target    = 0;
+static uint32_t          baud_fallback  = 0;  // 切换前的波特率
+static uint16_t          baud_timeout   = 0;
+static volatile uint16_t baud_remaining = 0;  // 确认剩余时间（ms），由 1ms tick 递减
+static uint32_t          baud_fallbacks = 0;
+
 #ifndef TF_UART_PORT_LOG_ENABLE
 #define TF_UART_PORT_LOG_ENABLE 1
 #endif
 
 #if TF_UART_PORT_LOG_ENABLE
-#define TF_UART_LOG(fmt, ...) printf("[tf_uart] " fmt "\n", ##__VA_ARGS__)
+#define TF_UART_LOG(fmt, ...) DEBUG_LOG("[tf_uart] " fmt "\n", ##__VA_ARGS__)
 #else
 #define TF_UART_LOG(fmt, ...) ((void)0)
 #endif
 
 // ==================== TinyFrame callbacks ====================
 
+#if TF_TX_ZERO_COPY
+#if !UART_DRIVER_USE_TX_QUEUE
+#error "TF_TX_ZERO_COPY composes frames in the UART TX queue, enable UART_DRIVER_USE_TX_QUEUE"
+#endif
+
+/**
+ * @brief TinyFrame reserve implementation (frame is composed in a UART TX slot)
+ */
+uint8_t* TF_ReserveImpl(TinyFrame* tf, uint32_t len)
+{
+    (void)tf;
+    uint8_t* p = uart_driver_tx_reserve(len, UART_TX_CLASS_CONTROL);
+    if (p == NULL) {
+        TF_UART_LOG("no free UART TX slot (%lu bytes)", (unsigned long)len);
+    }
+    return p;
+}
+
+/**
+ * @brief TinyFrame commit implementation (start DMA on the composed frame)
+ */
+void TF_CommitImpl(TinyFrame* tf, uint32_t len)
+{
+    (void)uart_driver_tx_commit(tf->txbuf, len);
+}
+#else
 /**
  * @brief TinyFrame write implementation (send data to UART)
  */
@@ -46,12 +110,25 @@ void TF_WriteImpl(TinyFrame* tf, const uint8_t* buff, uint32_t len)
     //     TF_UART_LOG("UART send failed");
     // }
 }
+#endif
+
+#if TF_RX_HOOK
+/**
+ * @brief 每个校验通过的接收帧（分发给监听器之前）
+ */
+void TF_RxHookImpl(TinyFrame* tf, const TF_Msg* msg)
+{
+    (void)tf;
+    tf_capture_frame(0U, (uint8_t)msg->frame_id, msg->type, msg->data, msg->len);
+}
+#endif
 
 /**
  * @brief TinyFrame generic listener
  */
 static TF_Result tf_frame_listener(TinyFrame* tf, TF_Msg* msg)
 {
+    (void)tf;
     TF_UART_LOG("UART received:");
     dumpFrameInfo(msg);
     // Call user callback (frame type and payload)
@@ -62,8 +139,45 @@ static TF_Result tf_frame_listener(TinyFrame* tf, TF_Msg* msg)
     return TF_STAY;
 }
 
-// ==================== UART RX callback ====================
+// ==================== UART RX ====================
 
+#if TF_RX_IN_PLACE
+/**
+ * @brief 直接在 DMA 缓冲区中解析所有完整帧
+ */
+static void rx_process_in_place(void)
+{
+    const uint8_t* data;
+    uint32_t       avail;
+    uint32_t       used;
+    uint32_t       start = cycle_counter_now();
+
+    // DMA 套圈：半帧的后续数据已被覆盖，从 DMA 当前位置重新同步
+    if (uart_driver_rx_take_overrun()) {
+        TF_ResetParser(&tf_instance);
+        TF_UART_LOG("RX overrun, parser reset");
+    }
+
+    rx_partial = false;
+    while ((avail = uart_driver_rx_peek(&data)) > 0) {
+        used = TF_AcceptInPlace(&tf_instance, data, avail);
+        if (used == 0) {
+            // 剩下的是不完整帧；若它被缓冲区末尾截断，拼上回绕部分再试一次
+            uint32_t wrapped = uart_driver_rx_peek_wrap(&data);
+            if (wrapped > avail) {
+                used = TF_AcceptInPlace(&tf_instance, data, wrapped);
+            }
+        }
+        if (used == 0) {
+            rx_partial = true;
+            break;
+        }
+        uart_driver_rx_consume(used);
+        rx_stats.rx_bytes += used;
+    }
+    rx_stats.rx_cycles += cycle_counter_now() - start;
+}
+#else
 /**
  * @brief UART receive callback
  */
@@ -73,9 +187,67 @@ static void uart_rx_callback(const uint8_t* data, uint32_t len)
         return;
     }
     // Pass raw bytes to TinyFrame
+    uint32_t start = cycle_counter_now();
     TF_Accept(&tf_instance, data, len);
+    rx_stats.rx_cycles += cycle_counter_now() - start;
+    rx_stats.rx_bytes += len;
     // printf("[tf_uart] uart received: %.*s\n", len, data);
 }
+#endif
+
+// ==================== Baud negotiation ====================
+
+/**
+ * @brief 波特率切换后丢弃旧波特率下的半帧
+ */
+static void baud_reset_parser(void)
+{
+    TF_ResetParser(&tf_instance);
+#if TF_RX_IN_PLACE
+    rx_partial = false;
+#endif
+}
+
+/**
+ * @brief 推进波特率协商（主循环）
+ */
+static void baud_process(void)
+{
+    switch (baud_state) {
+        case BAUD_PENDING:
+            // 应答必须以旧波特率完整发出，主机收到后才切换
+            if (!uart_driver_is_tx_done()) {
+                return;
+            }
+            baud_fallback = uart_driver_get_baudrate();
+            if (uart_driver_set_baudrate(baud_target) != 0) {
+                return;  // 期间又开始了发送，下次再试
+            }
+            baud_reset_parser();
+            baud_remaining = baud_timeout;
+            baud_state     = BAUD_PROBATION;
+            TF_UART_LOG("baud %lu -> %lu, waiting for confirm",
+                        (unsigned long)baud_fallback,
+                        (unsigned long)baud_target);
+            break;
+        case BAUD_PROBATION:
+            if (baud_remaining != 0) {
+                return;
+            }
+            if (uart_driver_set_baudrate(baud_fallback) != 0) {
+                return;
+            }
+            baud_reset_parser();
+            baud_state = BAUD_IDLE;
+            baud_fallbacks++;
+            TF_UART_LOG("baud %lu not confirmed, back to %lu",
+                        (unsigned long)baud_target,
+                        (unsigned long)baud_fallback);
+            break;
+        default:
+            break;
+    }
+}
 
 // ==================== Public API ====================
 
@@ -92,12 +264,18 @@ bool tf_uart_port_init(tf_uart_frame_callback_t callback)
     user_callback = callback;
 
     // 1. Init UART driver
+#if TF_RX_IN_PLACE
+    if (uart_driver_init(NULL) != 0) {
+#else
     if (uart_driver_init(uart_rx_callback) != 0) {
+#endif
         TF_UART_LOG("UART driver init failed");
         return false;
     }
 
     // 2. Init TinyFrame (slave)
+    tf_crc32_init();
+    tf_capture_init();
     TF_InitStatic(&tf_instance, TF_SLAVE);
 
     // 3. Register TinyFrame generic listener
@@ -113,25 +291,19 @@ bool tf_uart_port_init(tf_uart_frame_callback_t callback)
 
 bool tf_uart_port_send_frame(uint8_t frame_type, const uint8_t* data, uint16_t len)
 {
-    // Check init
-    if (!tf_uart_inited) {
-        TF_UART_LOG("error: have not init port");
-        return false;
-    }
     if (data == NULL || len == 0) {
         TF_UART_LOG("error: empty frame");
         return false;
     }
 
-    // Build TinyFrame message
-    TF_Msg msg;
-    msg.type = frame_type;  // Frame type set by caller
-    msg.data = data;        // Payload
-    msg.len  = len;         // Length
-
-    // Send frame
-    bool success = TF_Send(&tf_instance, &msg);
+    // 与零拷贝发送走同一路径，任意上下文都可以调用
+    uint8_t* payload = tf_uart_port_frame_begin(len, TF_UART_TX_CONTROL);
+    if (payload == NULL) {
+        return false;
+    }
+    memcpy(payload, data, len);
 
+    bool success = tf_uart_port_frame_commit(payload, frame_type, len);
     if (success) {
         TF_UART_LOG("send frame: type=0x%02X, len=%u", frame_type, len);
     } else {
@@ -141,16 +313,194 @@ bool tf_uart_port_send_frame(uint8_t frame_type, const uint8_t* data, uint16_t l
     return success;
 }
 
+bool tf_uart_port_set_large_frames(bool large)
+{
+    if (!TF_SetLenBytes(&tf_instance, large ? TF_LEN_BYTES : 1)) {
+        return false;
+    }
+    TF_UART_LOG("frame mode: %s, max payload %lu",
+                large ? "large" : "small",
+                (unsigned long)TF_GetMaxPayload(&tf_instance));
+    return true;
+}
+
+bool tf_uart_port_is_large_frames(void)
+{
+    return TF_GetLenBytes(&tf_instance) > 1;
+}
+
+uint16_t tf_uart_port_max_payload(void)
+{
+    return (uint16_t)TF_GetMaxPayload(&tf_instance);
+}
+
+void tf_uart_port_set_rx_isr_hook(tf_uart_rx_isr_hook_t hook)
+{
+    uart_driver_set_rx_isr_hook(hook);
+}
+
+bool tf_uart_port_request_baud(uint32_t baud, uint16_t timeout_ms)
+{
+    if (!uart_driver_baudrate_supported(baud) || timeout_ms == 0) {
+        return false;
+    }
+    baud_target  = baud;
+    baud_timeout = timeout_ms;
+    baud_state   = BAUD_PENDING;
+    return true;
+}
+
+void tf_uart_port_baud_confirm(void)
+{
+    if (baud_state == BAUD_PROBATION) {
+        baud_state = BAUD_IDLE;
+        TF_UART_LOG("baud %lu confirmed", (unsigned long)baud_target);
+    }
+}
+
+uint32_t tf_uart_port_get_baud(void)
+{
+    return uart_driver_get_baudrate();
+}
+
+uint32_t tf_uart_port_get_baud_fallbacks(void)
+{
+    return baud_fallbacks;
+}
+
+#if UART_DRIVER_USE_TX_QUEUE
+_Static_assert((int)TF_UART_TX_CONTROL == (int)UART_TX_CLASS_CONTROL
+                   && (int)TF_UART_TX_BULK == (int)UART_TX_CLASS_BULK
+                   && (int)TF_UART_TX_CLASS_COUNT == (int)UART_TX_CLASS_COUNT,
+               "tf_uart_tx_class_t must match uart_tx_class_t");
+
+uint8_t* tf_uart_port_frame_begin(uint16_t max_len, tf_uart_tx_class_t cls)
+{
+    if (!tf_uart_inited) {
+        TF_UART_LOG("error: have not init port");
+        return NULL;
+    }
+    if (max_len > TF_GetMaxPayload(&tf_instance)) {
+        TF_UART_LOG("error: payload too long (%u)", max_len);
+        return NULL;
+    }
+
+    // 每帧占用自己的发送帧槽，主循环和中断可以同时组帧
+    uint32_t frame_len = TF_FrameLen(&tf_instance, max_len);
+    uint8_t* frame     = uart_driver_tx_reserve(frame_len, (uart_tx_class_t)cls);
+    if (frame == NULL) {
+        // 批量帧丢弃只计数（见 tf_uart_port_get_tx_stats()），突发时不刷日志
+        if (cls == TF_UART_TX_CONTROL) {
+            TF_UART_LOG("no free TX slot (%u bytes)", max_len);
+        }
+        return NULL;
+    }
+    return frame + TF_FrameHeadLen(&tf_instance);
+}
+
+/**
+ * @brief 在帧槽中补上帧头和校验并提交（msg->len 为 0 时放弃该帧）
+ */
+static bool frame_finish(uint8_t* payload, TF_Msg* msg)
+{
+    if (payload == NULL) {
+        return false;
+    }
+
+    uint8_t* frame = payload - TF_FrameHeadLen(&tf_instance);
+    if (msg->len == 0) {
+        (void)uart_driver_tx_commit(frame, 0);  // 放弃该帧，释放帧槽
+        return false;
+    }
+    uint32_t frame_len = TF_ComposeInPlace(&tf_instance, frame, msg);
+    if (frame_len != 0U) {
+        // 提交后帧槽可能随时被 DMA 完成中断释放，在此之前记录（帧 ID 已由组帧确定）
+        tf_capture_frame(TF_CAPTURE_TX, (uint8_t)msg->frame_id, msg->type, payload, msg->len);
+    }
+    return uart_driver_tx_commit(frame, frame_len) == 0;
+}
+#else
+uint8_t* tf_uart_port_frame_begin(uint16_t max_len, tf_uart_tx_class_t cls)
+{
+    (void)cls;
+    if (!tf_uart_inited) {
+        TF_UART_LOG("error: have not init port");
+        return NULL;
+    }
+    // 没有发送队列时只有一个发送缓冲区，不能在中断中发送
+    return TF_SendReserve(&tf_instance, (TF_LEN)max_len);
+}
+
+static bool frame_finish(uint8_t* payload, TF_Msg* msg)
+{
+    if (msg->len == 0) {
+        TF_SendAbort(&tf_instance);
+        return false;
+    }
+    if (!TF_SendCommit(&tf_instance, msg)) {
+        return false;
+    }
+    // 唯一的发送缓冲区只在主循环中重新分配，发出后负载仍然有效
+    tf_capture_frame(TF_CAPTURE_TX, (uint8_t)msg->frame_id, msg->type, payload, msg->len);
+    return true;
+}
+#endif
+
+bool tf_uart_port_frame_commit(uint8_t* payload, uint8_t frame_type, uint16_t len)
+{
+    TF_Msg msg;
+    TF_ClearMsg(&msg);
+    msg.type = frame_type;
+    msg.len  = len;
+    return frame_finish(payload, &msg);
+}
+
+bool tf_uart_port_frame_respond(uint8_t* payload,
+                                uint8_t  frame_type,
+                                uint16_t len,
+                                uint32_t frame_id)
+{
+    // 与 TF_Respond() 相同：沿用请求的帧 ID，主机据此匹配应答
+    TF_Msg msg;
+    TF_ClearMsg(&msg);
+    msg.type        = frame_type;
+    msg.len         = len;
+    msg.frame_id    = (TF_ID)frame_id;
+    msg.is_response = true;
+    return frame_finish(payload, &msg);
+}
+
 void tf_uart_port_poll(void)
 {
+#if TF_RX_IN_PLACE
+    // 有接收事件，或有不完整帧等待超时判定时才解析
+    if (uart_driver_rx_take_event() || rx_partial) {
+        rx_process_in_place();
+    }
+#else
     // Poll UART driver (process RX data)
     uart_driver_poll();
+#endif
+
+    if (baud_state != BAUD_IDLE) {
+        baud_process();
+    }
+}
+
+bool tf_uart_port_rx_pending(void)
+{
+    return uart_driver_rx_pending() != 0;
 }
 
 void tf_uart_port_tick_1ms(void)
 {
     // Handle TinyFrame timeouts
     TF_Tick(&tf_instance);
+    tf_capture_tick_1ms();
+
+    if (baud_remaining != 0) {
+        baud_remaining--;
+    }
 }
 
 bool tf_uart_port_is_tx_done(void)
@@ -158,6 +508,54 @@ bool tf_uart_port_is_tx_done(void)
     return uart_driver_is_tx_done();
 }
 
+void tf_uart_port_get_stats(tf_uart_port_stats_t* stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    *stats           = rx_stats;
+    stats->rx_errors = uart_driver_get_rx_error_count();
+    stats->cpu_hz    = cycle_counter_hz();
+}
+
+bool tf_uart_port_get_tx_stats(tf_uart_tx_class_t cls, tf_uart_tx_stats_t* stats)
+{
+    if (stats == NULL || cls >= TF_UART_TX_CLASS_COUNT) {
+        return false;
+    }
+#if UART_DRIVER_USE_TX_QUEUE
+    uart_tx_class_stats_t s;
+    uart_driver_get_tx_stats((uart_tx_class_t)cls, &s);
+    stats->sent       = s.sent;
+    stats->drops      = s.drops;
+    stats->queued     = s.queued;
+    stats->high_water = s.high_water;
+#else
+    memset(stats, 0, sizeof(*stats));
+#endif
+    return true;
+}
+
+void tf_uart_port_get_link_stats(tf_uart_link_stats_t* stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    stats->rx_errors      = uart_driver_get_rx_error_count();
+    stats->rx_overflows   = uart_driver_get_rx_overflow_count();
+    stats->tx_send_fails  = uart_driver_get_tx_fail_count();
+    stats->tx_lock_fails  = TF_GetTxLockFails(&tf_instance);
+    stats->baud_fallbacks = baud_fallbacks;
+}
+
+void tf_uart_port_reset_stats(void)
+{
+    memset(&rx_stats, 0, sizeof(rx_stats));
+#if UART_DRIVER_USE_TX_QUEUE
+    uart_driver_reset_tx_stats();
+#endif
+}
+
 void* tf_uart_port_get_instance(void)
 {
     return (void*)&tf_instance;
@@ -16,6 +16,53 @@ extern "C" {
  */
 typedef void (*tf_uart_frame_callback_t)(uint8_t frame_type, const uint8_t* data, uint16_t len);
 
+/**
+ * @brief 接收中断钩子类型（与 uart_driver 的 uart_rx_callback_t 相同）
+ * @param data 新收到的原始字节（未经解析）
+ * @param len 字节数
+ */
+typedef void (*tf_uart_rx_isr_hook_t)(const uint8_t* data, uint32_t len);
+
+/**
+ * @brief 发送优先级（与 uart_driver 的 uart_tx_class_t 一一对应）
+ */
+typedef enum {
+    TF_UART_TX_CONTROL = 0,  // 命令应答、确认：插在已排队的批量帧之前发送
+    TF_UART_TX_BULK,         // 批量遥测：不能占满发送帧槽
+    TF_UART_TX_CLASS_COUNT,
+} tf_uart_tx_class_t;
+
+/**
+ * @brief 单个发送优先级的统计
+ */
+typedef struct {
+    uint32_t sent;        // 已发送帧数
+    uint32_t drops;       // 丢弃的帧数（配额用完或没有空闲帧槽）
+    uint16_t queued;      // 当前排队（含正在发送）的帧数
+    uint16_t high_water;  // queued 的历史最大值
+} tf_uart_tx_stats_t;
+
+/**
+ * @brief 接收路径统计
+ */
+typedef struct {
+    uint32_t rx_bytes;   // 已解析的字节数
+    uint32_t rx_cycles;  // 解析耗时（周期计数，含监听器执行）
+    uint32_t rx_errors;  // UART 接收错误次数
+    uint32_t cpu_hz;     // 周期计数频率，rx_bytes * cpu_hz / rx_cycles 即解析速率（字节/秒）
+} tf_uart_port_stats_t;
+
+/**
+ * @brief 链路丢帧 / 丢数据计数（上电后累计，不随 tf_uart_port_reset_stats() 清零）
+ */
+typedef struct {
+    uint32_t rx_errors;       // UART 接收错误次数（溢出 / 噪声 / 帧错误）
+    uint32_t rx_overflows;    // 接收溢出次数：收到的数据有丢失
+    uint32_t tx_send_fails;   // uart_driver_send_async() 失败次数
+    uint32_t tx_lock_fails;   // TinyFrame 发送锁已被占用而没能发出的帧数
+    uint32_t baud_fallbacks;  // 波特率切换未确认而恢复的次数
+} tf_uart_link_stats_t;
+
 /**
  * @brief 初始化通信端口
  * @param callback 帧接收回调函数
@@ -29,14 +76,101 @@ bool tf_uart_port_init(tf_uart_frame_callback_t callback);
  * @param data 数据指针
  * @param len 数据长度
  * @return true:成功, false:失败
+ * @note  以控制优先级发送；可以在主循环和中断中调用（见 tf_uart_port_frame_begin()）
  */
 bool tf_uart_port_send_frame(uint8_t frame_type, const uint8_t* data, uint16_t len);
 
+/**
+ * @brief 开始一帧零拷贝发送：分配一个发送帧槽并返回其负载区指针，调用者直接在其中编码
+ * @param max_len 最多写入的负载字节数
+ * @param cls 发送优先级
+ * @return 负载区指针，NULL 表示失败（配额用完、没有空闲帧槽或长度超出当前帧模式）
+ * @note  成功后必须用同一指针调用 tf_uart_port_frame_commit()。
+ *        每帧有自己的帧槽，主循环和中断可以同时组帧，互不等待；
+ *        同一优先级的帧按提交顺序发出
+ */
+uint8_t* tf_uart_port_frame_begin(uint16_t max_len, tf_uart_tx_class_t cls);
+
+/**
+ * @brief 完成并发送 tf_uart_port_frame_begin() 开始的帧
+ * @param payload tf_uart_port_frame_begin() 返回的指针
+ * @param frame_type 帧类型
+ * @param len 实际写入的负载字节数（不超过 max_len；0 表示放弃该帧）
+ * @return true:成功, false:失败或已放弃
+ */
+bool tf_uart_port_frame_commit(uint8_t* payload, uint8_t frame_type, uint16_t len);
+
+/**
+ * @brief 同 tf_uart_port_frame_commit()，但作为应答发送（同 TF_Respond()）
+ * @param frame_id 请求帧的 ID，应答帧沿用它
+ */
+bool tf_uart_port_frame_respond(uint8_t* payload,
+                                uint8_t  frame_type,
+                                uint16_t len,
+                                uint32_t frame_id);
+
+/**
+ * @brief 切换帧长度模式
+ * @param large true:2 字节 LEN（大帧）, false:1 字节 LEN（兼容，上电默认）
+ * @return true:成功, false:失败
+ * @note  从下一帧开始生效（收发同时切换）
+ */
+bool tf_uart_port_set_large_frames(bool large);
+
+/**
+ * @brief 当前是否处于大帧模式
+ */
+bool tf_uart_port_is_large_frames(void);
+
+/**
+ * @brief 当前模式下单帧最大负载
+ * @return 字节数
+ */
+uint16_t tf_uart_port_max_payload(void);
+
+/**
+ * @brief 请求切换波特率
+ * @param baud 新波特率
+ * @param timeout_ms 确认超时：切换后这段时间内没有调用 tf_uart_port_baud_confirm()，
+ *                   恢复切换前的波特率
+ * @return true:已接受, false:不支持该波特率
+ * @note  已排队的帧（包括本次请求的应答）以旧波特率发完后，由 tf_uart_port_poll() 切换
+ */
+bool tf_uart_port_request_baud(uint32_t baud, uint16_t timeout_ms);
+
+/**
+ * @brief 确认当前波特率（切换后收到有效帧时调用），确认等待期外调用无效果
+ */
+void tf_uart_port_baud_confirm(void);
+
+/**
+ * @brief 当前波特率（切换等待中时仍为旧值）
+ */
+uint32_t tf_uart_port_get_baud(void);
+
+/**
+ * @brief 切换后因超时未确认而恢复原波特率的次数
+ */
+uint32_t tf_uart_port_get_baud_fallbacks(void);
+
+/**
+ * @brief 设置接收中断钩子（直接转给 uart_driver_set_rx_isr_hook）
+ * @param hook 钩子，NULL 取消
+ * @note  钩子在接收事件中断中看到原始字节流，早于主循环的帧解析；只用于必须立即响应的少数模式
+ */
+void tf_uart_port_set_rx_isr_hook(tf_uart_rx_isr_hook_t hook);
+
 /**
  * @brief 轮询处理（在主循环中调用）
  */
 void tf_uart_port_poll(void);
 
+/**
+ * @brief 是否有尚未处理的接收事件
+ * @return true:有, false:无（主循环可以休眠）
+ */
+bool tf_uart_port_rx_pending(void);
+
 /**
  * @brief tick(每1ms调用一次)
  */
@@ -48,6 +182,31 @@ void tf_uart_port_tick_1ms(void);
  */
 bool tf_uart_port_is_tx_done(void);
 
+/**
+ * @brief 获取接收路径统计
+ * @param stats 输出
+ */
+void tf_uart_port_get_stats(tf_uart_port_stats_t* stats);
+
+/**
+ * @brief 获取发送优先级统计
+ * @param cls 发送优先级
+ * @param stats 输出
+ * @return true:成功, false:参数无效
+ */
+bool tf_uart_port_get_tx_stats(tf_uart_tx_class_t cls, tf_uart_tx_stats_t* stats);
+
+/**
+ * @brief 获取链路丢帧 / 丢数据计数
+ * @param stats 输出
+ */
+void tf_uart_port_get_link_stats(tf_uart_link_stats_t* stats);
+
+/**
+ * @brief 清零统计（接收与发送）
+ */
+void tf_uart_port_reset_stats(void);
+
 /**
  * @brief 获取TinyFrame实例指针
  *
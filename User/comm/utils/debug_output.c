@@ -0,0 +1,268 @@
+#include "debug_output.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "cycle_counter.h"
+#include "ringbuffer.h"
+#include "usart.h"
+
+_Static_assert((DEBUG_OUTPUT_BUFFER_SIZE & (DEBUG_OUTPUT_BUFFER_SIZE - 1)) == 0,
+               "DEBUG_OUTPUT_BUFFER_SIZE must be a power of two");
+_Static_assert(DEBUG_OUTPUT_BUFFER_SIZE <= 0xFFFF, "DMA transfers are at most 65535 bytes");
+_Static_assert(DEBUG_OUTPUT_LINE_MAX > 1 && DEBUG_OUTPUT_LINE_MAX <= DEBUG_OUTPUT_BUFFER_SIZE,
+               "DEBUG_OUTPUT_LINE_MAX out of range");
+
+// 写入方（主循环、各级中断）任意时刻只有一个：用原子交换抢占写入权，抢不到就丢弃；
+// 读取方是 DMA：发送权同样用原子交换抢占，由主循环的写入和发送完成中断接力启动
+static uint8_t      s_buffer[DEBUG_OUTPUT_BUFFER_SIZE];
+static ringbuffer_t s_ring;
+static volatile int s_ready   = 0;
+static volatile int s_writer  = 0;  // 写入权
+static volatile int s_tx_busy = 0;  // 发送权（DMA 正在发送 s_tx_len 字节）
+static uint32_t     s_tx_len  = 0;
+static uint32_t     s_sent    = 0;  // 只在持有发送权时修改
+
+// 只在持有写入权时修改
+static debug_output_stats_t s_stats;
+
+// 抢不到写入权而丢弃的次数 / 字节数（原子累加，读取统计时并入 drops）
+static volatile uint32_t s_contended       = 0;
+static volatile uint32_t s_contended_bytes = 0;
+
+// ==================== 内部函数 ====================
+
+/**
+ * @brief 空闲时把缓冲区中的下一段连续数据交给 DMA
+ */
+static void tx_kick(void)
+{
+    for (;;) {
+        if (__atomic_exchange_n(&s_tx_busy, 1, __ATOMIC_ACQUIRE)) {
+            return;  // 已在发送，完成中断会继续
+        }
+
+        const uint8_t* p;
+        uint32_t       n = ringbuffer_read_span(&s_ring, &p);
+        if (n > 0) {
+            s_tx_len = n;
+            if (HAL_UART_Transmit_DMA(&huart1, (uint8_t*)p, (uint16_t)n) != HAL_OK) {
+                // 启动失败：数据留在缓冲区中，下次写入时重试
+                __atomic_store_n(&s_tx_busy, 0, __ATOMIC_RELEASE);
+            }
+            return;
+        }
+
+        __atomic_store_n(&s_tx_busy, 0, __ATOMIC_RELEASE);
+        // 释放发送权之后再检查一次，避免错过同时写入的数据
+        if (ringbuffer_is_empty(&s_ring)) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief 持有写入权时整段写入；放不下则整段丢弃
+ */
+static uint32_t ring_put(const void* data, uint32_t len)
+{
+    if (ringbuffer_free_space(&s_ring) < len) {
+        s_stats.drops++;
+        s_stats.dropped_bytes += len;
+        return 0;
+    }
+
+    (void)ringbuffer_write(&s_ring, (const uint8_t*)data, len);
+    s_stats.writes++;
+    s_stats.bytes += len;
+
+    uint32_t pending = ringbuffer_available(&s_ring);
+    if (pending > s_stats.high_water) {
+        s_stats.high_water = (uint16_t)pending;
+    }
+    return len;
+}
+
+static bool writer_acquire(uint32_t len)
+{
+    if (!s_ready) {
+        return false;
+    }
+    if (__atomic_exchange_n(&s_writer, 1, __ATOMIC_ACQUIRE)) {
+        // 打断了另一个写入者：不等待，这一段直接丢弃
+        __atomic_fetch_add(&s_contended, 1U, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&s_contended_bytes, len, __ATOMIC_RELAXED);
+        return false;
+    }
+    return true;
+}
+
+static void writer_release(uint32_t start)
+{
+    s_stats.cycles += cycle_counter_now() - start;
+    __atomic_store_n(&s_writer, 0, __ATOMIC_RELEASE);
+    tx_kick();
+}
+
+// ==================== 公共函数 ====================
+
+void debug_output_init(void)
+{
+    s_ready = 0;
+    (void)ringbuffer_init(&s_ring, s_buffer, DEBUG_OUTPUT_BUFFER_SIZE);
+    s_writer  = 0;
+    s_tx_busy = 0;
+    s_tx_len  = 0;
+    s_sent    = 0;
+    debug_output_reset_stats();
+    s_ready = 1;
+}
+
+int debug_output_printf(const char* fmt, ...)
+{
+    uint32_t start = cycle_counter_now();
+    if (!writer_acquire(0U)) {
+        return 0;
+    }
+
+    char    line[DEBUG_OUTPUT_LINE_MAX];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(line, sizeof(line), fmt, ap);
+    va_end(ap);
+
+    uint32_t len = 0;
+    if (n > 0) {
+        len = ring_put(line, ((uint32_t)n < sizeof(line)) ? (uint32_t)n : sizeof(line) - 1U);
+    }
+    writer_release(start);
+    return (int)len;
+}
+
+uint32_t debug_output_write(const void* data, uint32_t len)
+{
+    if (data == NULL || len == 0) {
+        return 0;
+    }
+
+    uint32_t start = cycle_counter_now();
+    if (!writer_acquire(len)) {
+        return 0;
+    }
+    uint32_t written = ring_put(data, len);
+    writer_release(start);
+    return written;
+}
+
+void debug_output_dump(const char* prefix, const char* label, const uint8_t* data, uint32_t len)
+{
+    (void)debug_output_printf("%s%s (len=%u):", prefix, label, (unsigned)len);
+    for (uint32_t i = 0; i < len; ++i) {
+        (void)debug_output_printf(" %02X", (unsigned)data[i]);
+    }
+    (void)debug_output_printf("\n");
+}
+
+uint32_t debug_output_token(uint16_t token, const debug_token_arg_t* args, uint32_t argc)
+{
+    uint32_t start = cycle_counter_now();
+    if (!writer_acquire(0U)) {
+        return 0;
+    }
+
+    // [0xA5][token:u16][len:u8][参数]
+    uint8_t  rec[DEBUG_OUTPUT_LINE_MAX];
+    uint32_t off = 4U;
+    for (uint32_t i = 0; i < argc && off != 0U; ++i) {
+        const debug_token_arg_t* a = &args[i];
+        uint32_t need = (a->kind == DEBUG_TOKEN_ARG_STR || a->kind == DEBUG_TOKEN_ARG_HEX)
+                          ? 1U + a->len
+                          : 4U;
+        if (off + need > sizeof(rec) || off + need - 4U > 0xFFU) {
+            off = 0U;  // 放不下：整条丢弃
+            break;
+        }
+        switch (a->kind) {
+            case DEBUG_TOKEN_ARG_STR:
+            case DEBUG_TOKEN_ARG_HEX:
+                rec[off] = a->len;
+                memcpy(&rec[off + 1U], a->v.p, a->len);
+                break;
+            default:
+                memcpy(&rec[off], &a->v.u, 4U);  // f32 与 u32 同样按小端位模式发送
+                break;
+        }
+        off += need;
+    }
+
+    uint32_t len = 0;
+    if (off != 0U) {
+        rec[0] = DEBUG_TOKEN_SYNC;
+        rec[1] = (uint8_t)(token & 0xFFU);
+        rec[2] = (uint8_t)(token >> 8);
+        rec[3] = (uint8_t)(off - 4U);
+        len    = ring_put(rec, off);
+    } else {
+        s_stats.drops++;
+    }
+    writer_release(start);
+    return len;
+}
+
+void debug_output_tx_complete_callback(void)
+{
+    (void)ringbuffer_skip(&s_ring, s_tx_len);
+    s_sent += s_tx_len;
+    s_tx_len = 0;
+    __atomic_store_n(&s_tx_busy, 0, __ATOMIC_RELEASE);
+    tx_kick();
+}
+
+void debug_output_error_callback(void)
+{
+    // 接收侧错误不会中断 DMA 发送；只有发送已停止时才重发当前段
+    if (s_tx_busy && huart1.gState == HAL_UART_STATE_READY) {
+        __atomic_store_n(&s_tx_busy, 0, __ATOMIC_RELEASE);
+        tx_kick();
+    }
+}
+
+void debug_output_get_stats(debug_output_stats_t* stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    *stats = s_stats;
+    stats->drops += s_contended;
+    stats->dropped_bytes += s_contended_bytes;
+    stats->sent    = s_sent;
+    stats->pending = (uint16_t)ringbuffer_available(&s_ring);
+}
+
+void debug_output_reset_stats(void)
+{
+    if (__atomic_exchange_n(&s_writer, 1, __ATOMIC_ACQUIRE)) {
+        return;  // 打断了写入者（只可能在中断中调用），不清零
+    }
+    s_stats            = (debug_output_stats_t){0};
+    s_stats.high_water = (uint16_t)ringbuffer_available(&s_ring);
+    s_sent             = 0;
+    s_contended        = 0;
+    s_contended_bytes  = 0;
+    __atomic_store_n(&s_writer, 0, __ATOMIC_RELEASE);
+}
+
+// ==================== 标准输出重定向 ====================
+
+/**
+ * @brief 覆盖 syscalls.c 中的弱定义：stdout / stderr 写入日志缓冲区而不是逐字符发送
+ * @note  总是报告全部写入，丢弃的部分只反映在统计中，避免 newlib 重试
+ */
+int _write(int file, char* ptr, int len)
+{
+    if ((file == 1 || file == 2) && len > 0) {
+        (void)debug_output_write(ptr, (uint32_t)len);
+    }
+    return len;
+}
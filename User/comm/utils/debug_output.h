@@ -0,0 +1,107 @@
+#ifndef __DEBUG_OUTPUT_H__
+#define __DEBUG_OUTPUT_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "debug_token.h"
+
+/**
+ * @brief 调试日志输出（USART1，DMA 后台发送）
+ *
+ * - 日志先格式化进 RAM 环形缓冲区，由 USART1 的 DMA 在后台逐段发出，
+ *   调用者只付出格式化和一次拷贝的开销，从不等待串口
+ * - 缓冲区放不下整行时丢弃这一行（不写半行），计入丢弃数
+ * - printf 经 _write 也写入同一缓冲区；主循环和中断都可以调用，
+ *   中断打断了正在写入的主循环时，中断的这一行被丢弃而不是等待
+ * - 各模块的 *_LOG / *_DUMP 宏经 DEBUG_LOG / DEBUG_DUMP 输出：DEBUG_OUTPUT_TOKENIZED 为 1 时
+ *   发送令牌化的二进制记录（见 debug_token.h），与 printf 文本混在同一串口上，
+ *   由主机端解码器还原；为 0 时在设备上格式化成文本
+ */
+
+// ==================== 配置选项 ====================
+
+#ifndef DEBUG_OUTPUT_BUFFER_SIZE
+#define DEBUG_OUTPUT_BUFFER_SIZE 1024  // 日志环形缓冲区大小（2 的幂）
+#endif
+
+#ifndef DEBUG_OUTPUT_LINE_MAX
+#define DEBUG_OUTPUT_LINE_MAX 128  // 单行文本 / 单条令牌记录的最大长度（栈上）
+#endif
+
+#ifndef DEBUG_OUTPUT_TOKENIZED
+#define DEBUG_OUTPUT_TOKENIZED 1  // DEBUG_LOG / DEBUG_DUMP 使用令牌化记录（需要主机端解码）
+#endif
+
+// ================================================
+
+typedef struct {
+    uint32_t writes;         // 写入缓冲区的次数（行 / _write 调用）
+    uint32_t bytes;          // 写入缓冲区的字节数
+    uint32_t drops;          // 丢弃的次数（缓冲区满或与另一写入者冲突）
+    uint32_t dropped_bytes;  // 丢弃的字节数
+    uint32_t cycles;         // 写入方花费的周期数（含 debug_output_printf 的格式化）
+    uint32_t sent;           // 已由 DMA 发出的字节数
+    uint16_t pending;        // 当前缓冲区中未发出的字节数
+    uint16_t high_water;     // pending 的历史最大值
+} debug_output_stats_t;
+
+/**
+ * @brief 初始化（MX_USART1_UART_Init 之后调用；之前的输出全部丢弃）
+ */
+void debug_output_init(void);
+
+/**
+ * @brief 格式化一行写入缓冲区（不阻塞）
+ * @return 写入的字节数，0 表示丢弃；超过 DEBUG_OUTPUT_LINE_MAX - 1 的部分被截断
+ */
+int debug_output_printf(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+
+/**
+ * @brief 原样写入缓冲区（不阻塞，整段写入或整段丢弃）
+ * @return 写入的字节数，0 表示丢弃
+ */
+uint32_t debug_output_write(const void* data, uint32_t len);
+
+/**
+ * @brief USART1 发送完成回调（在 HAL_UART_TxCpltCallback 中调用）
+ */
+void debug_output_tx_complete_callback(void);
+
+/**
+ * @brief USART1 错误回调（在 HAL_UART_ErrorCallback 中调用），重发当前段
+ */
+void debug_output_error_callback(void);
+
+void debug_output_get_stats(debug_output_stats_t* stats);
+
+/**
+ * @brief 以文本逐字节输出 prefix label (len=N): XX XX ...
+ */
+void debug_output_dump(const char* prefix, const char* label, const uint8_t* data, uint32_t len);
+
+/**
+ * @brief 清零计数，高水位从当前占用量重新开始
+ */
+void debug_output_reset_stats(void);
+
+// ==================== 日志宏 ====================
+// fmt / prefix 必须是字符串字面量
+
+#if DEBUG_OUTPUT_TOKENIZED
+#define DEBUG_LOG(fmt, ...)                  DEBUG_TOKEN_LOG(fmt, ##__VA_ARGS__)
+#define DEBUG_DUMP(prefix, label, data, len) DEBUG_TOKEN_DUMP(prefix, label, data, len)
+#else
+#define DEBUG_LOG(fmt, ...)                  debug_output_printf(fmt, ##__VA_ARGS__)
+#define DEBUG_DUMP(prefix, label, data, len) debug_output_dump(prefix, label, data, len)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DEBUG_OUTPUT_H__ */
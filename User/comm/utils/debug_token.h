@@ -0,0 +1,155 @@
+#ifndef __DEBUG_TOKEN_H__
+#define __DEBUG_TOKEN_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief 令牌化日志（格式字符串只保存在主机端）
+ *
+ * - 格式字符串放进链接脚本中的 .km1_log 段（INFO 类型，不占 flash），
+ *   令牌就是它在段内的偏移；构建后该段导出为 <工程名>.logdict 字典文件
+ * - 固件只发送记录 [0xA5][token:u16][len:u8][参数 len 字节]，
+ *   由主机端 Tools/host/log/log_decode 按字典还原为文本
+ * - 参数编码：整数 / 指针 u32，float / double 按 f32，字符串 [n:u8][字节]，
+ *   十六进制块（%H，只用于 DEBUG_TOKEN_DUMP）[n:u8][字节]；多字节均为小端
+ * - 仍由编译器按 printf 规则检查格式字符串和参数（不生成代码）
+ */
+
+#define DEBUG_TOKEN_SYNC     0xA5U  // 记录起始字节（不会出现在 ASCII 文本中）
+#define DEBUG_TOKEN_MAX_ARGS 12     // 单条记录的最大参数个数（DEBUG_TOKEN_MAP_12）
+#define DEBUG_TOKEN_MAX_STR  32     // 字符串参数的最大长度（超出截断）
+
+#ifndef DEBUG_TOKEN_MAX_HEX
+#define DEBUG_TOKEN_MAX_HEX 32  // DEBUG_TOKEN_DUMP 最多发送的字节数（len 仍为实际长度）
+#endif
+
+typedef enum {
+    DEBUG_TOKEN_ARG_U32 = 0,
+    DEBUG_TOKEN_ARG_F32,
+    DEBUG_TOKEN_ARG_STR,
+    DEBUG_TOKEN_ARG_HEX,
+} debug_token_arg_kind_t;
+
+typedef struct {
+    uint8_t kind;
+    uint8_t len;  // STR / HEX
+    union {
+        uint32_t    u;
+        float       f;
+        const void* p;
+    } v;
+} debug_token_arg_t;
+
+static inline debug_token_arg_t debug_token_u32(uint32_t v)
+{
+    return (debug_token_arg_t){.kind = DEBUG_TOKEN_ARG_U32, .v.u = v};
+}
+
+static inline debug_token_arg_t debug_token_f32(double v)
+{
+    return (debug_token_arg_t){.kind = DEBUG_TOKEN_ARG_F32, .v.f = (float)v};
+}
+
+static inline debug_token_arg_t debug_token_ptr(const void* v)
+{
+    return (debug_token_arg_t){.kind = DEBUG_TOKEN_ARG_U32, .v.u = (uint32_t)(uintptr_t)v};
+}
+
+static inline debug_token_arg_t debug_token_str(const char* v)
+{
+    uint8_t n = 0;
+    while (v != NULL && v[n] != '\0' && n < DEBUG_TOKEN_MAX_STR) {
+        n++;
+    }
+    return (debug_token_arg_t){.kind = DEBUG_TOKEN_ARG_STR, .len = n, .v.p = v};
+}
+
+static inline debug_token_arg_t debug_token_hex(const void* data, uint32_t len)
+{
+    uint8_t n = (uint8_t)((len < DEBUG_TOKEN_MAX_HEX) ? len : DEBUG_TOKEN_MAX_HEX);
+    return (debug_token_arg_t){.kind = DEBUG_TOKEN_ARG_HEX, .len = n, .v.p = data};
+}
+
+// 按参数类型选择编码函数（只调用被选中的那一个）
+#define DEBUG_TOKEN_ARG(x)                                                                         \
+    _Generic((x),                                                                                  \
+        float: debug_token_f32,                                                                    \
+        double: debug_token_f32,                                                                   \
+        char*: debug_token_str,                                                                    \
+        const char*: debug_token_str,                                                              \
+        void*: debug_token_ptr,                                                                    \
+        const void*: debug_token_ptr,                                                              \
+        default: debug_token_u32)(x)
+
+// 对 0..DEBUG_TOKEN_MAX_ARGS 个参数逐个套用 DEBUG_TOKEN_ARG，以逗号分隔
+#define DEBUG_TOKEN_NARG(...)                                                                      \
+    DEBUG_TOKEN_NARG_(0, ##__VA_ARGS__, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define DEBUG_TOKEN_NARG_(_0, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, n, ...) n
+#define DEBUG_TOKEN_CAT(a, b)  DEBUG_TOKEN_CAT_(a, b)
+#define DEBUG_TOKEN_CAT_(a, b) a##b
+#define DEBUG_TOKEN_MAP(...)                                                                       \
+    DEBUG_TOKEN_CAT(DEBUG_TOKEN_MAP_, DEBUG_TOKEN_NARG(__VA_ARGS__))(__VA_ARGS__)
+#define DEBUG_TOKEN_MAP_0()
+#define DEBUG_TOKEN_MAP_1(a)       DEBUG_TOKEN_ARG(a)
+#define DEBUG_TOKEN_MAP_2(a, ...)  DEBUG_TOKEN_ARG(a), DEBUG_TOKEN_MAP_1(__VA_ARGS__)
+#define DEBUG_TOKEN_MAP_3(a, ...)  DEBUG_TOKEN_ARG(a), DEBUG_TOKEN_MAP_2(__VA_ARGS__)
+#define DEBUG_TOKEN_MAP_4(a, ...)  DEBUG_TOKEN_ARG(a), DEBUG_TOKEN_MAP_3(__VA_ARGS__)
+#define DEBUG_TOKEN_MAP_5(a, ...)  DEBUG_TOKEN_ARG(a), DEBUG_TOKEN_MAP_4(__VA_ARGS__)
+#define DEBUG_TOKEN_MAP_6(a, ...)  DEBUG_TOKEN_ARG(a), DEBUG_TOKEN_MAP_5(__VA_ARGS__)
+#define DEBUG_TOKEN_MAP_7(a, ...)  DEBUG_TOKEN_ARG(a), DEBUG_TOKEN_MAP_6(__VA_ARGS__)
+#define DEBUG_TOKEN_MAP_8(a, ...)  DEBUG_TOKEN_ARG(a), DEBUG_TOKEN_MAP_7(__VA_ARGS__)
+#define DEBUG_TOKEN_MAP_9(a, ...)  DEBUG_TOKEN_ARG(a), DEBUG_TOKEN_MAP_8(__VA_ARGS__)
+#define DEBUG_TOKEN_MAP_10(a, ...) DEBUG_TOKEN_ARG(a), DEBUG_TOKEN_MAP_9(__VA_ARGS__)
+#define DEBUG_TOKEN_MAP_11(a, ...) DEBUG_TOKEN_ARG(a), DEBUG_TOKEN_MAP_10(__VA_ARGS__)
+#define DEBUG_TOKEN_MAP_12(a, ...) DEBUG_TOKEN_ARG(a), DEBUG_TOKEN_MAP_11(__VA_ARGS__)
+
+// 格式字符串只进入 .km1_log 段，令牌取其段内偏移
+#define DEBUG_TOKEN_DEFINE(name, fmt)                                                              \
+    static const char name[] __attribute__((section(".km1_log"), used)) = fmt
+
+/**
+ * @brief 发送一条令牌化记录（整条写入或整条丢弃，见 debug_output.h）
+ * @param token 格式字符串在 .km1_log 段内的偏移
+ * @param args 参数
+ * @param argc 参数个数
+ * @return 写入的字节数，0 表示丢弃
+ */
+uint32_t debug_output_token(uint16_t token, const debug_token_arg_t* args, uint32_t argc);
+
+// 只用于编译期检查格式字符串，从不调用
+static inline __attribute__((format(printf, 1, 2))) void debug_token_check(const char* fmt, ...)
+{
+    (void)fmt;
+}
+
+#define DEBUG_TOKEN_LOG(fmt, ...)                                                                  \
+    do {                                                                                           \
+        DEBUG_TOKEN_DEFINE(_dt_fmt, fmt);                                                          \
+        const debug_token_arg_t _dt_args[] = {{0}, DEBUG_TOKEN_MAP(__VA_ARGS__)};                  \
+        if (0) debug_token_check(fmt, ##__VA_ARGS__);                                              \
+        (void)debug_output_token((uint16_t)(uintptr_t)_dt_fmt, &_dt_args[1],                       \
+                                 sizeof(_dt_args) / sizeof(_dt_args[0]) - 1U);                     \
+    } while (0)
+
+// 一条记录：prefix label (len=N): XX XX ...（最多 DEBUG_TOKEN_MAX_HEX 字节）
+#define DEBUG_TOKEN_DUMP(prefix, label, data, len)                                                 \
+    do {                                                                                           \
+        DEBUG_TOKEN_DEFINE(_dt_fmt, prefix "%s (len=%u):%H\n");                                    \
+        const debug_token_arg_t _dt_args[] = {                                                     \
+            debug_token_str(label),                                                                \
+            debug_token_u32((uint32_t)(len)),                                                      \
+            debug_token_hex((data), (uint32_t)(len)),                                              \
+        };                                                                                         \
+        (void)debug_output_token((uint16_t)(uintptr_t)_dt_fmt, _dt_args, 3U);                      \
+    } while (0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DEBUG_TOKEN_H__ */
@@ -3,6 +3,7 @@
 #include <string.h>
 
 #include "../drivers/servo_hal.h"  // 硬件层
+#include "cycle_counter.h"
 
 // 全局舵机运动数组
 static servo_motion_t servo_motions[MAX_SERVOS];
@@ -10,9 +11,22 @@ static servo_motion_t servo_motions[MAX_SERVOS];
 // 全局运动状态掩码
 static uint32_t global_moving_mask = 0;
 
+// 主循环 hold 期间推迟的 1ms 更新次数
+static volatile uint8_t  motion_hold_depth = 0;
+static volatile uint32_t motion_held_ticks = 0;
+
 // 全局完成回调（用于同步管理器）
 static servo_motion_complete_cb_t global_complete_callback = NULL;
 
+// 步进钩子（用于流式设定点）
+static servo_motion_tick_hook_t tick_hook = NULL;
+
+// 1ms 更新的时序统计（只在 servo_motion_update_1ms() 中写）
+static servo_tick_stats_t tick_stats       = {0, UINT32_MAX, 0, 0};
+static uint32_t           tick_last        = 0;
+static bool               tick_started     = false;
+static volatile bool      tick_stats_reset = false;
+
 // 处理单个舵机运动完成
 static void on_servo_complete(uint8_t servo_id)
 {
@@ -125,6 +139,12 @@ void servo_motion_set_global_complete_callback(servo_motion_complete_cb_t callba
     global_complete_callback = callback;
 }
 
+// 设置步进钩子
+void servo_motion_set_tick_hook(servo_motion_tick_hook_t hook)
+{
+    tick_hook = hook;
+}
+
 // ==================== 角度-PWM转换 ====================
 
 uint32_t angle_to_pwm(uint8_t id, float angle_deg)
@@ -251,6 +271,30 @@ void servo_move_home(uint8_t id, uint32_t duration_ms, servo_motion_complete_cb_
     servo_move_pwm(id, sm->servo.mid_pwm_us, duration_ms, cb);
 }
 
+void servo_set_pwm_direct(uint8_t id, uint32_t pwm_us)
+{
+    if (id >= MAX_SERVOS) return;
+
+    servo_motion_t* sm = &servo_motions[id];
+    const servo_t*  s  = &sm->servo;
+
+    if (pwm_us < s->min_pwm_us) pwm_us = s->min_pwm_us;
+    if (pwm_us > s->max_pwm_us) pwm_us = s->max_pwm_us;
+
+    // 被直接设定打断的运动按停止处理
+    if (sm->is_moving) {
+        sm->is_moving  = false;
+        sm->steps_left = 0;
+        on_servo_complete(id);
+    }
+
+    sm->target_pwm = pwm_us;
+    if (pwm_us != sm->current_pwm) {
+        sm->current_pwm = pwm_us;
+        servo_hal_set_pwm(id, pwm_us);
+    }
+}
+
 // 输出 current_pwm 到 PWM 硬件
 void servo_sync_to_hardware(void)
 {
@@ -410,8 +454,12 @@ static float ease_in_out_cubic(float t)
     return (t * t * (3.0f - 2.0f * t));
 }
 
-void servo_motion_update_1ms(void)
+static void servo_motion_step(void)
 {
+    if (tick_hook != NULL) {
+        tick_hook();
+    }
+
     for (uint8_t i = 0; i < MAX_SERVOS; i++) {
         servo_motion_t* sm = &servo_motions[i];
 
@@ -451,3 +499,62 @@ void servo_motion_update_1ms(void)
         }
     }
 }
+
+static void tick_stats_record(uint32_t start, uint32_t run)
+{
+    if (tick_stats_reset) {
+        tick_stats       = (servo_tick_stats_t){0, UINT32_MAX, 0, 0};
+        tick_stats_reset = false;
+    }
+    if (tick_started) {
+        uint32_t period = start - tick_last;
+        if (period < tick_stats.period_min) tick_stats.period_min = period;
+        if (period > tick_stats.period_max) tick_stats.period_max = period;
+        tick_stats.ticks++;
+    }
+    if (run > tick_stats.run_max) tick_stats.run_max = run;
+    tick_last    = start;
+    tick_started = true;
+}
+
+void servo_motion_update_1ms(void)
+{
+    uint32_t start = cycle_counter_now();
+
+    if (motion_hold_depth != 0) {
+        motion_held_ticks++;
+    } else {
+        // 补上 hold 期间推迟的更新
+        uint32_t ticks    = motion_held_ticks + 1U;
+        motion_held_ticks = 0;
+        while (ticks-- > 0) {
+            servo_motion_step();
+        }
+    }
+
+    tick_stats_record(start, cycle_counter_now() - start);
+}
+
+void servo_motion_get_tick_stats(servo_tick_stats_t* stats)
+{
+    if (stats == NULL) return;
+    *stats = tick_stats;
+    if (stats->ticks == 0) stats->period_min = 0;
+}
+
+void servo_motion_reset_tick_stats(void)
+{
+    tick_stats_reset = true;
+}
+
+void servo_motion_hold(void)
+{
+    motion_hold_depth++;
+}
+
+void servo_motion_release(void)
+{
+    if (motion_hold_depth > 0) {
+        motion_hold_depth--;
+    }
+}
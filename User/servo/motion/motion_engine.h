@@ -10,6 +10,18 @@
 // 运动完成回调函数类型
 typedef void (*servo_motion_complete_cb_t)(uint8_t id);
 
+// 每个 1ms 步进开始时调用的钩子（中断上下文，hold 期间同样推迟）
+typedef void (*servo_motion_tick_hook_t)(void);
+
+// 1ms 更新的时序统计（周期计数，见 cycle_counter.h）：
+// 相邻两次更新入口的间隔，抖动 = period_max - period_min；run_max 为单次更新的耗时
+typedef struct {
+    uint32_t ticks;       // 统计的间隔数
+    uint32_t period_min;  // 没有间隔时为 0
+    uint32_t period_max;
+    uint32_t run_max;
+} servo_tick_stats_t;
+
 // 舵机参数
 typedef struct {
     uint32_t min_pwm_us;     // 最小pwm（单位：微秒）
@@ -38,6 +50,7 @@ void    servo_motion_init(void);
 void    servo_motion_set_params(uint8_t id, const servo_t* params);
 servo_t servo_motion_get_params(uint8_t id);
 void    servo_motion_set_global_complete_callback(servo_motion_complete_cb_t callback);
+void    servo_motion_set_tick_hook(servo_motion_tick_hook_t hook);
 
 // ==================== 角度-PWM转换 ====================
 uint32_t angle_to_pwm(uint8_t id, float angle_deg);
@@ -49,6 +62,7 @@ void servo_move_pwm(uint8_t id, uint32_t pwm_us, uint32_t duration_ms, servo_mot
 void servo_move_relative(uint8_t id, float delta_deg, uint32_t duration_ms, servo_motion_complete_cb_t cb);
 void servo_move_home(uint8_t id, uint32_t duration_ms, servo_motion_complete_cb_t cb);
 void servo_sync_to_hardware(void);
+void servo_set_pwm_direct(uint8_t id, uint32_t pwm_us);  // 立即输出（流式设定点），取消正在进行的运动
 
 // ==================== 多舵机控制 ====================
 void servo_move_angle_multiple(const uint8_t ids[],
@@ -82,5 +96,13 @@ uint32_t servo_mask_from_ids(const uint8_t ids[], uint8_t count);
 
 // ==================== 核心更新函数 ====================
 void servo_motion_update_1ms(void);  // 在1ms定时器中断中调用
+void servo_motion_get_tick_stats(servo_tick_stats_t* stats);
+void servo_motion_reset_tick_stats(void);  // 下一次更新时清零（统计只在中断中写）
+
+// ==================== 原子批量修改 ====================
+// hold 期间 1ms 更新只计数不执行，release 后的下一个 tick 一次补齐，
+// 同一批修改在同一个 tick 生效且不丢失时间（仅主循环调用，可嵌套）
+void servo_motion_hold(void);
+void servo_motion_release(void);
 
 #endif /*__MOTION_ENGINE_H__*/
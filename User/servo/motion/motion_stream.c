@@ -0,0 +1,247 @@
+#include "motion_stream.h"
+
+#include <string.h>
+
+#include "motion_engine.h"
+
+#define STREAM_MASK (MOTION_STREAM_DEPTH - 1U)
+
+_Static_assert((MOTION_STREAM_DEPTH & (MOTION_STREAM_DEPTH - 1)) == 0,
+               "MOTION_STREAM_DEPTH must be a power of 2");
+
+#define ST_LOAD(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define ST_STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+/* ================= 内部数据结构 ================= */
+
+typedef struct {
+    uint32_t t_ms;  // 主机时间
+    uint16_t pwm[MAX_SERVOS];
+} stream_point_t;
+
+static struct {
+    bool     active;
+    uint32_t mask;
+    uint16_t latency_ms;
+    uint16_t extrapolate_ms;
+
+    // 抖动缓冲区：主循环写 head，1ms 中断写 tail
+    stream_point_t buf[MOTION_STREAM_DEPTH];
+    uint32_t       head;
+    uint32_t       tail;
+
+    // 主循环
+    uint32_t last_t;  // 最后接收的时间戳
+    bool     has_last;
+    int32_t  lead_sum;  // 设定点到达时领先播放位置的时间之和
+    uint8_t  lead_count;
+    int8_t   slew;  // 播放时钟校正（主循环给出，中断取走）
+
+    // 1ms 中断
+    bool           synced;  // 已按第一个点对齐播放时钟
+    uint32_t       play_t;  // 当前播放位置（主机时间）
+    stream_point_t prev;    // 当前段起点
+    stream_point_t prev2;   // 上一段起点，用于外推
+    bool           has_prev2;
+    bool           underrun;
+    uint16_t       out[MAX_SERVOS];
+
+    motion_stream_stats_t stats;
+} stream;
+
+/* ================= 私有函数 ================= */
+
+// 以当前输出作为段起点（开始播放、断流后恢复时）
+static void stream_rebase(void)
+{
+    stream.prev.t_ms = stream.play_t;
+    for (uint8_t i = 0; i < MAX_SERVOS; i++) {
+        stream.out[i]      = (uint16_t)servo_get_current_pwm(i);
+        stream.prev.pwm[i] = stream.out[i];
+    }
+    stream.has_prev2 = false;
+}
+
+static uint16_t stream_clamp(int32_t pwm)
+{
+    if (pwm < 0) return 0;
+    if (pwm > 0xFFFF) return 0xFFFF;
+    return (uint16_t)pwm;
+}
+
+// a + (b - a) * num / den
+static uint16_t stream_lerp(uint16_t a, uint16_t b, int32_t num, int32_t den)
+{
+    return stream_clamp((int32_t)a + ((int32_t)b - (int32_t)a) * num / den);
+}
+
+// 1ms 步进钩子（中断上下文）
+static void stream_tick(void)
+{
+    if (!ST_LOAD(&stream.active)) return;
+
+    uint32_t head = ST_LOAD(&stream.head);
+    uint32_t tail = stream.tail;
+
+    if (!stream.synced) {
+        if (head == tail) return;  // 等第一个点
+        stream.synced   = true;
+        stream.underrun = true;  // 与断流后恢复相同的对齐方式
+    } else {
+        int8_t slew = __atomic_exchange_n(&stream.slew, 0, __ATOMIC_ACQ_REL);
+        stream.play_t += (uint32_t)(1 + slew);
+    }
+
+    if (stream.underrun && head != tail) {
+        // 开始播放 / 断流后恢复：重新留出 latency_ms 的缓冲，从当前位置接到下一个点
+        stream.play_t   = stream.buf[tail & STREAM_MASK].t_ms - stream.latency_ms;
+        stream.underrun = false;
+        stream_rebase();
+    }
+
+    // 取出已到播放时间的点
+    while (head != tail && (int32_t)(stream.buf[tail & STREAM_MASK].t_ms - stream.play_t) <= 0) {
+        stream.prev2     = stream.prev;
+        stream.prev      = stream.buf[tail & STREAM_MASK];
+        stream.has_prev2 = true;
+        tail++;
+    }
+    ST_STORE(&stream.tail, tail);
+
+    if (head != tail) {
+        const stream_point_t* next = &stream.buf[tail & STREAM_MASK];
+        int32_t               num  = (int32_t)(stream.play_t - stream.prev.t_ms);
+        int32_t               den  = (int32_t)(next->t_ms - stream.prev.t_ms);
+        for (uint8_t i = 0; i < MAX_SERVOS; i++) {
+            stream.out[i] = stream_lerp(stream.prev.pwm[i], next->pwm[i], num, den);
+        }
+    } else {
+        // 缓冲区读空：沿最后一段的速度外推 extrapolate_ms，之后保持
+        int32_t dt = (int32_t)(stream.play_t - stream.prev.t_ms);
+        if (dt > 0 && !stream.underrun) {
+            stream.underrun = true;
+            stream.stats.underruns++;
+        }
+        if (dt > (int32_t)stream.extrapolate_ms) {
+            dt = (int32_t)stream.extrapolate_ms;
+        } else if (dt > 0) {
+            stream.stats.extrapolated_ms++;
+        }
+        bool    extrapolate = dt > 0 && stream.has_prev2;
+        int32_t den         = (int32_t)(stream.prev.t_ms - stream.prev2.t_ms);
+        for (uint8_t i = 0; i < MAX_SERVOS; i++) {
+            // prev + (prev - prev2) * dt / den
+            stream.out[i] = extrapolate
+                                ? stream_lerp(stream.prev2.pwm[i], stream.prev.pwm[i], den + dt, den)
+                                : stream.prev.pwm[i];
+        }
+    }
+
+    for (uint8_t i = 0; i < MAX_SERVOS; i++) {
+        if (stream.mask & (1U << i)) {
+            servo_set_pwm_direct(i, stream.out[i]);
+        }
+    }
+}
+
+/* ================= API ================= */
+
+void motion_stream_init(void)
+{
+    memset(&stream, 0, sizeof(stream));
+    servo_motion_set_tick_hook(stream_tick);
+}
+
+bool motion_stream_start(uint32_t servo_mask, uint16_t latency_ms, uint16_t extrapolate_ms)
+{
+    if (servo_mask == 0 || (servo_mask >> MAX_SERVOS) != 0) return false;
+    if (latency_ms == 0 || latency_ms > MOTION_STREAM_MAX_LATENCY_MS) return false;
+
+    // 先停止，中断不再访问，再重置
+    ST_STORE(&stream.active, false);
+    stream.mask           = servo_mask;
+    stream.latency_ms     = latency_ms;
+    stream.extrapolate_ms = extrapolate_ms;
+    stream.head           = 0;
+    stream.tail           = 0;
+    stream.has_last       = false;
+    stream.lead_sum       = 0;
+    stream.lead_count     = 0;
+    stream.slew           = 0;
+    stream.synced         = false;
+    stream.underrun       = false;
+    stream.has_prev2      = false;
+    ST_STORE(&stream.active, true);
+    return true;
+}
+
+void motion_stream_stop(void)
+{
+    ST_STORE(&stream.active, false);
+}
+
+motion_stream_result_t motion_stream_push(uint32_t t_ms, const uint16_t pwm[])
+{
+    if (!ST_LOAD(&stream.active)) return MOTION_STREAM_INACTIVE;
+
+    // 乱序，或到达时已经播放过
+    bool synced = ST_LOAD(&stream.synced);
+    if ((stream.has_last && (int32_t)(t_ms - stream.last_t) <= 0)
+        || (synced && (int32_t)(t_ms - ST_LOAD(&stream.play_t)) <= 0)) {
+        stream.stats.late++;
+        return MOTION_STREAM_LATE;
+    }
+
+    uint32_t head = stream.head;
+    if (head - ST_LOAD(&stream.tail) >= MOTION_STREAM_DEPTH) {
+        stream.stats.overflows++;
+        return MOTION_STREAM_FULL;
+    }
+
+    stream_point_t* p = &stream.buf[head & STREAM_MASK];
+    p->t_ms           = t_ms;
+    for (uint8_t i = 0; i < MAX_SERVOS; i++) {
+        p->pwm[i] = (stream.mask & (1U << i)) ? pwm[i] : 0U;
+    }
+    ST_STORE(&stream.head, head + 1U);
+
+    stream.last_t   = t_ms;
+    stream.has_last = true;
+    stream.stats.points++;
+
+    // 播放时钟校正：到达时的平均领先量应等于 latency_ms，
+    // 两端晶振的漂移由此每 MOTION_STREAM_SLEW_POINTS 个点最多校正 1ms
+    if (synced) {
+        stream.lead_sum += (int32_t)(t_ms - ST_LOAD(&stream.play_t));
+        if (++stream.lead_count >= MOTION_STREAM_SLEW_POINTS) {
+            int32_t avg = stream.lead_sum / (int32_t)stream.lead_count;
+            int8_t  slew = 0;
+            if (avg > (int32_t)stream.latency_ms + 1) {
+                slew = 1;  // 播放落后，追一拍
+            } else if (avg < (int32_t)stream.latency_ms - 1) {
+                slew = -1;  // 播放超前，停一拍
+            }
+            __atomic_store_n(&stream.slew, slew, __ATOMIC_RELEASE);
+            stream.lead_sum   = 0;
+            stream.lead_count = 0;
+        }
+    }
+    return MOTION_STREAM_OK;
+}
+
+void motion_stream_get_status(motion_stream_status_t* out)
+{
+    if (out == NULL) return;
+
+    out->active         = ST_LOAD(&stream.active);
+    out->servo_mask     = stream.mask;
+    out->latency_ms     = stream.latency_ms;
+    out->extrapolate_ms = stream.extrapolate_ms;
+    out->buffered       = (uint8_t)(ST_LOAD(&stream.head) - ST_LOAD(&stream.tail));
+    out->stats          = stream.stats;
+}
+
+void motion_stream_reset_stats(void)
+{
+    memset(&stream.stats, 0, sizeof(stream.stats));
+}
@@ -0,0 +1,94 @@
+#ifndef __MOTION_STREAM_H__
+#define __MOTION_STREAM_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ================= 配置 ================= */
+#ifndef MOTION_STREAM_DEPTH
+#define MOTION_STREAM_DEPTH 8  // 抖动缓冲区设定点数（2 的幂）
+#endif
+
+#ifndef MOTION_STREAM_MAX_LATENCY_MS
+#define MOTION_STREAM_MAX_LATENCY_MS 500  // 播放延迟上限
+#endif
+
+#ifndef MOTION_STREAM_DEFAULT_EXTRAPOLATE_MS
+#define MOTION_STREAM_DEFAULT_EXTRAPOLATE_MS 50  // 断流时沿最后速度外推的时长，之后保持
+#endif
+
+#ifndef MOTION_STREAM_SLEW_POINTS
+#define MOTION_STREAM_SLEW_POINTS 16  // 每收到多少个设定点校正一次播放时钟（±1ms）
+#endif
+
+/* ================= 类型定义 ================= */
+
+typedef enum {
+    MOTION_STREAM_OK = 0,
+    MOTION_STREAM_INACTIVE,  // 流模式未开启
+    MOTION_STREAM_LATE,      // 时间戳不晚于上一个点，或已经播放过（丢弃）
+    MOTION_STREAM_FULL,      // 抖动缓冲区满（丢弃）
+} motion_stream_result_t;
+
+typedef struct {
+    uint32_t points;           // 接收的设定点
+    uint32_t late;             // 迟到 / 乱序丢弃的设定点
+    uint32_t overflows;        // 缓冲区满丢弃的设定点
+    uint32_t underruns;        // 缓冲区读空的次数
+    uint32_t extrapolated_ms;  // 读空后外推的总时间
+} motion_stream_stats_t;
+
+typedef struct {
+    bool                  active;
+    uint32_t              servo_mask;
+    uint16_t              latency_ms;
+    uint16_t              extrapolate_ms;
+    uint8_t               buffered;  // 缓冲区中尚未播放的设定点
+    motion_stream_stats_t stats;
+} motion_stream_status_t;
+
+/* ================= API ================= */
+
+/**
+ * @brief 初始化（注册到运动引擎的 1ms 步进）
+ */
+void motion_stream_init(void);
+
+/**
+ * @brief 开启流模式（已开启时重新开始，清空缓冲区）
+ *
+ * 主机发送带时间戳的设定点，设备比收到的第一个点晚 latency_ms 开始播放，
+ * 每个 tick 在相邻两点之间线性插值；缓冲区读空时沿最后速度外推 extrapolate_ms，
+ * 之后保持不动，新的点到达后从当前位置平滑接上
+ *
+ * @param servo_mask 参与的舵机
+ * @param latency_ms 播放延迟（1..MOTION_STREAM_MAX_LATENCY_MS），应大于设定点间隔加抖动
+ * @param extrapolate_ms 外推时长
+ * @return true:成功, false:参数无效
+ */
+bool motion_stream_start(uint32_t servo_mask, uint16_t latency_ms, uint16_t extrapolate_ms);
+
+/**
+ * @brief 关闭流模式，舵机停在当前位置
+ */
+void motion_stream_stop(void);
+
+/**
+ * @brief 追加一个设定点（主循环）
+ * @param t_ms 主机时间戳，必须严格递增
+ * @param pwm 按舵机 ID 索引的 PWM，只使用 servo_mask 中的舵机
+ */
+motion_stream_result_t motion_stream_push(uint32_t t_ms, const uint16_t pwm[]);
+
+void motion_stream_get_status(motion_stream_status_t* out);
+void motion_stream_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MOTION_STREAM_H__ */
@@ -4,7 +4,6 @@
 
 #include "motion_engine.h"
 
-#define MAX_SYNC_GROUPS  8
 #define INVALID_GROUP_ID 0
 
 /* ================= 内部数据结构 ================= */
@@ -210,6 +209,19 @@ uint32_t motion_sync_get_group_mask(uint32_t group_id)
     return g ? g->mask : 0;
 }
 
+bool motion_sync_get_group_status(uint8_t slot, sync_group_status_t* out)
+{
+    if (slot >= MAX_SYNC_GROUPS || out == NULL) return false;
+
+    const sync_group_t* g = &sync_groups[slot];
+    if (!g->active) return false;
+
+    out->id        = g->id;
+    out->mask      = g->mask;
+    out->done_mask = g->done_mask;
+    return true;
+}
+
 /* ================= 高级接口 ================= */
 
 uint32_t motion_sync_move_angle(const uint8_t            servo_ids[],
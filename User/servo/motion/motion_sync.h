@@ -3,8 +3,16 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#define MAX_SYNC_GROUPS 8  // 同步组槽数，暴露给外部使用
+
 typedef void (*sync_group_complete_cb_t)(uint32_t group_id);
 
+typedef struct {
+    uint32_t id;
+    uint32_t mask;       // 本组舵机
+    uint32_t done_mask;  // 已完成舵机
+} sync_group_status_t;
+
 /* 初始化 / 反初始化 */
 void motion_sync_init(void);
 void motion_sync_deinit(void);
@@ -25,6 +33,9 @@ bool     motion_sync_release_group(uint32_t group_id);
 bool     motion_sync_is_group_complete(uint32_t group_id);
 uint32_t motion_sync_get_group_mask(uint32_t group_id);
 
+/* 按槽位读取组状态（slot < MAX_SYNC_GROUPS），槽位空闲时返回 false */
+bool motion_sync_get_group_status(uint8_t slot, sync_group_status_t* out);
+
 /* ================= 高级接口（直接运动） ================= */
 
 uint32_t motion_sync_move_angle(const uint8_t            servo_ids[],
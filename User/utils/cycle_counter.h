@@ -0,0 +1,68 @@
+#ifndef __CYCLE_COUNTER_H__
+#define __CYCLE_COUNTER_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/**
+ * @brief CPU 周期计数器，用于性能统计
+ *
+ * 目标板上使用 Cortex-M3 DWT->CYCCNT；主机构建（仿真/基准测试）使用单调时钟，
+ * 单位为纳秒。两者都是 32 位自由计数，只应用于计算差值。
+ */
+
+#if defined(__arm__)
+
+#include "main.h"
+
+/**
+ * @brief 启用 DWT 周期计数器（上电后调用一次）
+ */
+static inline void cycle_counter_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static inline uint32_t cycle_counter_now(void)
+{
+    return DWT->CYCCNT;
+}
+
+/**
+ * @brief 计数频率（Hz）
+ */
+static inline uint32_t cycle_counter_hz(void)
+{
+    return SystemCoreClock;
+}
+
+#else
+
+#include <time.h>
+
+static inline void cycle_counter_init(void) {}
+
+static inline uint32_t cycle_counter_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+}
+
+static inline uint32_t cycle_counter_hz(void)
+{
+    return 1000000000UL;
+}
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CYCLE_COUNTER_H__ */
@@ -0,0 +1,142 @@
+#include "frame_pool.h"
+
+// Cortex-M3 上 CAS 编译为 LDREX/STREX 循环，被中断打断时重试，不需要关中断
+#define FP_LOAD(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define FP_STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define FP_CAS(p, expected, desired)                                                               \
+    __atomic_compare_exchange_n(                                                                   \
+        (p), (expected), (desired), false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+
+// ==================== 帧槽池 ====================
+
+bool frame_pool_init(frame_pool_t* pool, uint8_t* buffer, uint16_t size, uint8_t count)
+{
+    if (buffer == NULL || size == 0 || count == 0 || count > 32U) {
+        return false;
+    }
+
+    pool->buffer     = buffer;
+    pool->size       = size;
+    pool->count      = count;
+    pool->free_mask  = (count == 32U) ? 0xFFFFFFFFUL : ((1UL << count) - 1U);
+    pool->fail_count = 0;
+    return true;
+}
+
+uint8_t* frame_pool_alloc(frame_pool_t* pool)
+{
+    uint32_t mask = FP_LOAD(&pool->free_mask);
+
+    while (mask != 0) {
+        uint32_t bit = mask & (0U - mask);  // 最低位的空闲槽
+        if (FP_CAS(&pool->free_mask, &mask, mask & ~bit)) {
+            return &pool->buffer[(uint32_t)__builtin_ctz(bit) * pool->size];
+        }
+        // CAS 失败时 mask 已更新为最新值，重试
+    }
+
+    pool->fail_count++;
+    return NULL;
+}
+
+bool frame_pool_owns(const frame_pool_t* pool, const uint8_t* p)
+{
+    return p >= pool->buffer && p < pool->buffer + (uint32_t)pool->size * pool->count;
+}
+
+int32_t frame_pool_index(const frame_pool_t* pool, const uint8_t* p)
+{
+    if (!frame_pool_owns(pool, p)) {
+        return -1;
+    }
+    return (int32_t)((uint32_t)(p - pool->buffer) / pool->size);
+}
+
+bool frame_pool_free(frame_pool_t* pool, const uint8_t* slot)
+{
+    int32_t index = frame_pool_index(pool, slot);
+    if (index < 0) {
+        return false;
+    }
+    __atomic_fetch_or(&pool->free_mask, 1UL << (uint32_t)index, __ATOMIC_RELEASE);
+    return true;
+}
+
+uint32_t frame_pool_free_count(const frame_pool_t* pool)
+{
+    return (uint32_t)__builtin_popcount(FP_LOAD(&pool->free_mask));
+}
+
+// ==================== 有序帧队列 ====================
+// 每个单元的 seq：等于 pos 表示序号 pos 可以写入，等于 pos + 1 表示序号 pos 已发布
+
+bool frame_queue_init(frame_queue_t* queue, frame_queue_cell_t* cells, uint32_t count)
+{
+    if (cells == NULL || count == 0 || (count & (count - 1U)) != 0) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        cells[i].data = NULL;
+        cells[i].len  = 0;
+        cells[i].seq  = i;
+    }
+    queue->cells = cells;
+    queue->mask  = count - 1U;
+    queue->head  = 0;
+    queue->tail  = 0;
+    return true;
+}
+
+bool frame_queue_push(frame_queue_t* queue, const uint8_t* data, uint16_t len)
+{
+    uint32_t            pos = FP_LOAD(&queue->head);
+    frame_queue_cell_t* cell;
+
+    for (;;) {
+        cell         = &queue->cells[pos & queue->mask];
+        int32_t diff = (int32_t)(FP_LOAD(&cell->seq) - pos);
+        if (diff == 0) {
+            if (FP_CAS(&queue->head, &pos, pos + 1U)) {
+                break;  // 领取到序号 pos
+            }
+        } else if (diff < 0) {
+            return false;  // 单元还没被消费者释放：队列满
+        } else {
+            pos = FP_LOAD(&queue->head);  // 被其他生产者抢先，重新读取
+        }
+    }
+
+    cell->data = data;
+    cell->len  = len;
+    FP_STORE(&cell->seq, pos + 1U);  // 发布
+    return true;
+}
+
+bool frame_queue_peek(const frame_queue_t* queue, const uint8_t** data, uint16_t* len)
+{
+    uint32_t                  pos  = queue->tail;
+    const frame_queue_cell_t* cell = &queue->cells[pos & queue->mask];
+
+    if (FP_LOAD(&cell->seq) != pos + 1U) {
+        return false;
+    }
+    *data = cell->data;
+    *len  = cell->len;
+    return true;
+}
+
+void frame_queue_pop(frame_queue_t* queue)
+{
+    uint32_t            pos  = queue->tail;
+    frame_queue_cell_t* cell = &queue->cells[pos & queue->mask];
+
+    // 单元留给下一圈的同一位置
+    FP_STORE(&cell->seq, pos + queue->mask + 1U);
+    FP_STORE(&queue->tail, pos + 1U);
+}
+
+bool frame_queue_is_empty(const frame_queue_t* queue)
+{
+    return FP_LOAD(&queue->head) == FP_LOAD(&queue->tail);
+}
@@ -0,0 +1,128 @@
+#ifndef __FRAME_POOL_H__
+#define __FRAME_POOL_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief 定长帧槽池（多生产者，无锁）
+ *
+ * - 空闲槽用位图表示，分配 / 释放都是一次 CAS，主循环和各级中断可以同时调用
+ * - 每个生产者拿到自己的槽后独立组帧，互相不等待
+ */
+typedef struct {
+    uint8_t*          buffer;      // count * size 字节
+    uint16_t          size;        // 每个槽的字节数
+    uint8_t           count;       // 槽数（1..32）
+    volatile uint32_t free_mask;   // 位为 1 表示该槽空闲
+    volatile uint32_t fail_count;  // 分配失败次数
+} frame_pool_t;
+
+/**
+ * @brief 有序帧队列的单元
+ */
+typedef struct {
+    const uint8_t*    data;
+    uint16_t          len;
+    volatile uint32_t seq;  // 单元序号，表示该单元当前可写 / 可读
+} frame_queue_cell_t;
+
+/**
+ * @brief 有序帧队列（多生产者 / 单消费者，无锁）
+ *
+ * - 生产者用 CAS 领取一个序号，写入单元后再发布；发布顺序可以与领取顺序不同，
+ *   消费者始终按领取顺序取出
+ * - 某个生产者领取后被中断抢占时，后面的帧暂不发出，等它发布后一起继续，
+ *   任何一方都不需要自旋等待
+ */
+typedef struct {
+    frame_queue_cell_t* cells;
+    uint32_t            mask;  // 单元数 - 1（单元数为 2 的幂）
+    volatile uint32_t   head;  // 下一个要领取的序号（生产者）
+    volatile uint32_t   tail;  // 下一个要取出的序号（消费者）
+} frame_queue_t;
+
+/**
+ * @brief 初始化帧槽池
+ * @param pool 槽池结构体指针
+ * @param buffer 底层缓冲区（至少 size * count 字节）
+ * @param size 每个槽的字节数
+ * @param count 槽数（1..32）
+ * @return true:成功, false:参数无效
+ */
+bool frame_pool_init(frame_pool_t* pool, uint8_t* buffer, uint16_t size, uint8_t count);
+
+/**
+ * @brief 分配一个槽（任意上下文）
+ * @return 槽指针，没有空闲槽时返回 NULL（并计入失败次数）
+ */
+uint8_t* frame_pool_alloc(frame_pool_t* pool);
+
+/**
+ * @brief 释放槽（任意上下文）
+ * @param slot frame_pool_alloc() 返回的指针
+ * @return true:成功, false:不属于该槽池
+ */
+bool frame_pool_free(frame_pool_t* pool, const uint8_t* slot);
+
+/**
+ * @brief 指针是否指向该槽池中的某个槽
+ */
+bool frame_pool_owns(const frame_pool_t* pool, const uint8_t* p);
+
+/**
+ * @brief 槽序号
+ * @return 0..count-1，不属于该槽池时返回 -1
+ */
+int32_t frame_pool_index(const frame_pool_t* pool, const uint8_t* p);
+
+/**
+ * @brief 当前空闲槽数
+ */
+uint32_t frame_pool_free_count(const frame_pool_t* pool);
+
+/**
+ * @brief 初始化帧队列
+ * @param queue 队列结构体指针
+ * @param cells 单元数组
+ * @param count 单元数，必须是 2 的幂
+ * @return true:成功, false:count 不是 2 的幂
+ */
+bool frame_queue_init(frame_queue_t* queue, frame_queue_cell_t* cells, uint32_t count);
+
+/**
+ * @brief 追加一帧（生产者，任意上下文）
+ * @param data 帧数据（取出并处理完之前保持有效）
+ * @param len 帧长度
+ * @return true:成功, false:队列满
+ */
+bool frame_queue_push(frame_queue_t* queue, const uint8_t* data, uint16_t len);
+
+/**
+ * @brief 查看队首帧（消费者）
+ * @param data 输出参数，帧数据
+ * @param len 输出参数，帧长度
+ * @return true:队首帧已发布, false:队列空或队首帧尚未发布
+ */
+bool frame_queue_peek(const frame_queue_t* queue, const uint8_t** data, uint16_t* len);
+
+/**
+ * @brief 移除队首帧（消费者，须在 frame_queue_peek() 返回 true 之后调用）
+ */
+void frame_queue_pop(frame_queue_t* queue);
+
+/**
+ * @brief 队列中是否没有已领取的帧（包括尚未发布的）
+ */
+bool frame_queue_is_empty(const frame_queue_t* queue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FRAME_POOL_H__ */
@@ -0,0 +1,72 @@
+#ifndef __IRQ_PRIO_H__
+#define __IRQ_PRIO_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/**
+ * @brief 中断优先级分配（NVIC_PRIORITYGROUP_4：只有抢占优先级，数值越小越高）
+ *
+ * 数值与 km1-one.ioc 及 Core/Src 中 CubeMX 生成的 HAL_NVIC_SetPriority() 一致，修改时三处同步。
+ *   0  TIM1_UP：舵机 1ms 插补，任何通信中断都不能推迟它
+ *   1  USART3、DMA1_Channel2/3：协议链路（接收事件中断里有急停快速通道）
+ *   2  USART1、DMA1_Channel4/5：调试日志
+ *   3  EXTI9_5、EXTI15_10：按键
+ *   15 PendSV：1ms tick 中推迟执行的通信部分（运动完成推送、遥测采样、协议计时）；SysTick 同级
+ *
+ * 需要与某一级中断互斥时用 irq_mask_from() 屏蔽该级及以下（BASEPRI），不用关全部中断，
+ * 插补 tick 不受影响。各队列 / 帧槽本身是无锁的，不需要屏蔽。
+ */
+#define IRQ_PRIO_MOTION_TICK 0U
+#define IRQ_PRIO_LINK        1U
+#define IRQ_PRIO_LOG         2U
+#define IRQ_PRIO_BUTTON      3U
+#define IRQ_PRIO_DEFERRED    15U
+
+#if defined(__arm__)
+
+#include "main.h"
+
+/**
+ * @brief 屏蔽优先级数值 >= prio 的中断，更高优先级的中断照常响应
+ * @param prio 1..15（0 表示不屏蔽，不能用来屏蔽最高级）
+ * @return 之前的屏蔽级别，交给 irq_unmask() 恢复
+ * @note  只会提高屏蔽级别（BASEPRI_MAX），可以嵌套，也可以在中断中调用
+ */
+static inline uint32_t irq_mask_from(uint32_t prio)
+{
+    uint32_t prev = __get_BASEPRI();
+    __set_BASEPRI_MAX(prio << (8U - __NVIC_PRIO_BITS));
+    __ISB();
+    return prev;
+}
+
+static inline void irq_unmask(uint32_t prev)
+{
+    __set_BASEPRI(prev);
+}
+
+#else
+
+// 主机构建（仿真）：没有中断嵌套
+static inline uint32_t irq_mask_from(uint32_t prio)
+{
+    (void)prio;
+    return 0;
+}
+
+static inline void irq_unmask(uint32_t prev)
+{
+    (void)prev;
+}
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IRQ_PRIO_H__ */
@@ -2,19 +2,112 @@
 
 #include <string.h>
 
-void ringbuffer_init(ringbuffer_t* rb, uint8_t* buffer, uint32_t size)
+// 生产者发布 head / 消费者发布 tail 时使用 release，读取对端索引时使用 acquire；
+// Cortex-M3 上编译为普通读写 + DMB，不需要关中断
+#define RB_LOAD(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define RB_STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+// ==================== 内部函数 ====================
+
+/**
+ * @brief 读指针到达已发布的跳过区时越过它
+ * @param head    已读取的写索引
+ * @param tail    读索引（输入/输出）
+ * @param pending 是否有未越过的跳过区（输入/输出）
+ * @note  head == tail 时不越过：此时跳过区后面的数据还没有发布
+ */
+static inline void rb_pass_skip(const ringbuffer_t* rb, uint32_t head, uint32_t* tail, bool* pending)
+{
+    if (*pending && *tail == rb->skip_at && head != *tail) {
+        *tail += rb->size - (*tail & rb->mask);
+        *pending = false;
+    }
+}
+
+/**
+ * @brief 从 tail 开始的连续可读字节数（到缓冲区末尾或跳过区为止）
+ */
+static inline uint32_t rb_linear(const ringbuffer_t* rb, uint32_t head, uint32_t tail, bool pending)
+{
+    uint32_t n    = head - tail;
+    uint32_t room = rb->size - (tail & rb->mask);
+    if (pending && rb->skip_at - tail < room) {
+        room = rb->skip_at - tail;
+    }
+    return (n < room) ? n : room;
+}
+
+/**
+ * @brief 是否有已发布但消费者还没越过的跳过区
+ */
+static inline bool rb_pending(const ringbuffer_t* rb)
+{
+    return RB_LOAD(&rb->skip_count) != rb->skip_seen;
+}
+
+/**
+ * @brief 消费者：读取或丢弃最多 len 字节
+ * @param buffer 输出缓冲区，NULL 表示只丢弃
+ * @param commit 是否移动读指针
+ */
+static uint32_t rb_consume(ringbuffer_t* rb, uint8_t* buffer, uint32_t len, bool commit)
+{
+    uint32_t head    = RB_LOAD(&rb->head);
+    uint32_t tail    = rb->tail;
+    bool     pending = rb_pending(rb);
+    bool     was     = pending;
+    uint32_t done    = 0;
+
+    while (done < len) {
+        rb_pass_skip(rb, head, &tail, &pending);
+        uint32_t n = rb_linear(rb, head, tail, pending);
+        if (n == 0) {
+            break;
+        }
+        if (n > len - done) {
+            n = len - done;
+        }
+        if (buffer != NULL) {
+            memcpy(buffer + done, &rb->buffer[tail & rb->mask], n);
+        }
+        tail += n;
+        done += n;
+    }
+
+    if (commit) {
+        RB_STORE(&rb->tail, tail);
+        if (was && !pending) {
+            RB_STORE(&rb->skip_seen, rb->skip_seen + 1U);
+        }
+    }
+    return done;
+}
+
+// ==================== 公共函数 ====================
+
+bool ringbuffer_init(ringbuffer_t* rb, uint8_t* buffer, uint32_t size)
 {
+    if (size == 0 || (size & (size - 1U)) != 0) {
+        return false;
+    }
+
     rb->buffer         = buffer;
     rb->size           = size;
+    rb->mask           = size - 1U;
     rb->head           = 0;
     rb->tail           = 0;
-    rb->count          = 0;
+    rb->skip_at        = 0;
+    rb->skip_count     = 0;
+    rb->skip_seen      = 0;
+    rb->resv_pos       = 0;
+    rb->resv_len       = 0;
     rb->overflow_count = 0;
+    return true;
 }
 
 uint32_t ringbuffer_write(ringbuffer_t* rb, const uint8_t* data, uint32_t len)
 {
-    if (len == 0 || data == NULL) {
+    if (len == 0 || data == NULL || rb->resv_len != 0) {
         return 0;
     }
 
@@ -29,23 +122,18 @@ uint32_t ringbuffer_write(ringbuffer_t* rb, const uint8_t* data, uint32_t len)
         return 0;
     }
 
-    // 写入数据
-    uint32_t first_part = rb->size - rb->head;
+    // 写入数据（最多分两段），最后再发布 head
+    uint32_t head       = rb->head;
+    uint32_t off        = head & rb->mask;
+    uint32_t first_part = rb->size - off;
     if (len <= first_part) {
-        // 可以一次性写入
-        memcpy(&rb->buffer[rb->head], data, len);
-        rb->head += len;
-        if (rb->head >= rb->size) {
-            rb->head = 0;
-        }
+        memcpy(&rb->buffer[off], data, len);
     } else {
-        // 需要分两次写入（环绕）
-        memcpy(&rb->buffer[rb->head], data, first_part);
+        memcpy(&rb->buffer[off], data, first_part);
         memcpy(rb->buffer, data + first_part, len - first_part);
-        rb->head = len - first_part;
     }
 
-    rb->count += len;
+    RB_STORE(&rb->head, head + len);
     return len;
 }
 
@@ -54,113 +142,131 @@ uint32_t ringbuffer_read(ringbuffer_t* rb, uint8_t* buffer, uint32_t len)
     if (len == 0 || buffer == NULL) {
         return 0;
     }
+    return rb_consume(rb, buffer, len, true);
+}
 
-    // 计算实际可读取的长度
-    uint32_t available = ringbuffer_available(rb);
-    if (len > available) {
-        len = available;
+uint32_t ringbuffer_peek(const ringbuffer_t* rb, uint8_t* buffer, uint32_t len)
+{
+    if (len == 0 || buffer == NULL) {
+        return 0;
     }
+    return rb_consume((ringbuffer_t*)rb, buffer, len, false);
+}
 
+uint32_t ringbuffer_skip(ringbuffer_t* rb, uint32_t len)
+{
     if (len == 0) {
         return 0;
     }
-
-    // 读取数据
-    uint32_t first_part = rb->size - rb->tail;
-    if (len <= first_part) {
-        // 可以一次性读取
-        memcpy(buffer, &rb->buffer[rb->tail], len);
-        rb->tail += len;
-        if (rb->tail >= rb->size) {
-            rb->tail = 0;
-        }
-    } else {
-        // 需要分两次读取（环绕）
-        memcpy(buffer, &rb->buffer[rb->tail], first_part);
-        memcpy(buffer + first_part, rb->buffer, len - first_part);
-        rb->tail = len - first_part;
-    }
-
-    rb->count -= len;
-    return len;
+    return rb_consume(rb, NULL, len, true);
 }
 
-uint32_t ringbuffer_peek(const ringbuffer_t* rb, uint8_t* buffer, uint32_t len)
+uint8_t* ringbuffer_reserve(ringbuffer_t* rb, uint32_t len)
 {
-    if (len == 0 || buffer == NULL) {
-        return 0;
+    if (len == 0 || len > rb->size || rb->resv_len != 0) {
+        return NULL;
     }
 
-    // 计算实际可查看的长度
-    uint32_t available = ringbuffer_available(rb);
-    if (len > available) {
-        len = available;
-    }
+    uint32_t head       = rb->head;
+    uint32_t free_space = rb->size - (head - RB_LOAD(&rb->tail));
+    uint32_t room       = rb->size - (head & rb->mask);
+    uint32_t pos        = head;
 
-    if (len == 0) {
-        return 0;
+    if (len > room) {
+        // 尾部放不下：从下一圈开头开始，尾部剩余部分作为跳过区。
+        // 同一时间只允许一个未越过的跳过区
+        if (RB_LOAD(&rb->skip_seen) != rb->skip_count) {
+            rb->overflow_count++;
+            return NULL;
+        }
+        pos += room;
+        len += room;  // 跳过区也占用空间，直到消费者越过它
     }
-
-    // 查看数据（不移动指针）
-    uint32_t first_part = rb->size - rb->tail;
-    if (len <= first_part) {
-        memcpy(buffer, &rb->buffer[rb->tail], len);
-    } else {
-        memcpy(buffer, &rb->buffer[rb->tail], first_part);
-        memcpy(buffer + first_part, rb->buffer, len - first_part);
+    if (len > free_space) {
+        rb->overflow_count++;
+        return NULL;
     }
 
-    return len;
+    rb->resv_pos = pos;
+    rb->resv_len = len - (pos - head);
+    return &rb->buffer[pos & rb->mask];
 }
 
-uint32_t ringbuffer_skip(ringbuffer_t* rb, uint32_t len)
+void ringbuffer_commit(ringbuffer_t* rb, uint32_t len)
 {
+    if (len > rb->resv_len) {
+        len = rb->resv_len;
+    }
+    rb->resv_len = 0;
     if (len == 0) {
-        return 0;
+        return;
     }
 
-    // 计算实际可跳过的长度
-    uint32_t available = ringbuffer_available(rb);
-    if (len > available) {
-        len = available;
+    uint32_t head = rb->head;
+    if (rb->resv_pos != head) {
+        // 先发布跳过区，再发布 head
+        rb->skip_at = head;
+        RB_STORE(&rb->skip_count, rb->skip_count + 1U);
     }
+    RB_STORE(&rb->head, rb->resv_pos + len);
+}
 
-    if (len == 0) {
-        return 0;
-    }
+bool ringbuffer_is_reserved(const ringbuffer_t* rb)
+{
+    return rb->resv_len != 0;
+}
 
-    // 移动读指针
-    rb->tail = (rb->tail + len) % rb->size;
-    rb->count -= len;
+uint32_t ringbuffer_read_span(ringbuffer_t* rb, const uint8_t** data)
+{
+    uint32_t head    = RB_LOAD(&rb->head);
+    uint32_t tail    = rb->tail;
+    bool     pending = rb_pending(rb);
 
-    return len;
+    if (pending) {
+        rb_pass_skip(rb, head, &tail, &pending);
+        if (!pending) {
+            // 越过跳过区：立即发布，之后生产者可以再次回绕
+            RB_STORE(&rb->tail, tail);
+            RB_STORE(&rb->skip_seen, rb->skip_seen + 1U);
+        }
+    }
+
+    *data = &rb->buffer[tail & rb->mask];
+    return rb_linear(rb, head, tail, pending);
 }
 
 uint32_t ringbuffer_available(const ringbuffer_t* rb)
 {
-    return rb->count;
+    uint32_t head  = RB_LOAD(&rb->head);
+    uint32_t tail  = rb->tail;
+    uint32_t avail = head - tail;
+
+    // 已发布的跳过区不算数据（head 仍停在跳过区起点时它还没有生效）
+    if (rb_pending(rb) && avail > rb->skip_at - tail) {
+        avail -= rb->size - (rb->skip_at & rb->mask);
+    }
+    return avail;
 }
 
 uint32_t ringbuffer_free_space(const ringbuffer_t* rb)
 {
-    return rb->size - rb->count;
+    return rb->size - (rb->head - RB_LOAD(&rb->tail));
 }
 
 bool ringbuffer_is_empty(const ringbuffer_t* rb)
 {
-    return rb->count == 0;
+    return RB_LOAD(&rb->head) == rb->tail;
 }
 
 bool ringbuffer_is_full(const ringbuffer_t* rb)
 {
-    return rb->count >= rb->size;
+    return ringbuffer_free_space(rb) == 0;
 }
 
 void ringbuffer_clear(ringbuffer_t* rb)
 {
-    rb->head  = 0;
-    rb->tail  = 0;
-    rb->count = 0;
+    // 按正常消费的方式丢弃，跳过区的计数保持一致
+    (void)rb_consume(rb, NULL, UINT32_MAX, true);
 }
 
 uint32_t ringbuffer_get_overflow_count(const ringbuffer_t* rb)
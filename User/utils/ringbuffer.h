@@ -9,25 +9,51 @@ extern "C" {
 #include <stddef.h>
 #include <stdint.h>
 
+/**
+ * @brief 单生产者 / 单消费者（SPSC）无锁字节队列
+ *
+ * - 容量必须是 2 的幂，head / tail 为自由递增的 32 位索引，下标用 & mask 得到
+ * - head 只由生产者写，tail 只由消费者写，没有两端共享写的字段，
+ *   生产者和消费者可以分别位于中断和主循环中，不需要关中断
+ * - 除逐字节读写外，还提供连续区间接口（reserve/commit、read_span/consume），
+ *   可以直接交给 DMA 或在其中原地组帧
+ * - ringbuffer_reserve() 的连续区间放不下缓冲区尾部时从开头开始，
+ *   尾部剩余部分记为跳过区，消费者读到这里时自动越过
+ *
+ * 目前用于日志输出（debug_output.c）：各上下文写入，read_span 直接交给 USART1 DMA 发送。
+ * 协议链路不经过它：接收在 DMA 缓冲区中原地解析（uart_driver_rx_peek），
+ * 发送在 frame_pool 帧槽中原地组帧。
+ */
 typedef struct {
     uint8_t*          buffer;
-    uint32_t          size;
-    volatile uint32_t head;   // 写指针
-    volatile uint32_t tail;   // 读指针
-    volatile uint32_t count;  // 当前数据量
-    volatile uint32_t overflow_count;
+    uint32_t          size;  // 2 的幂
+    uint32_t          mask;  // size - 1
+    volatile uint32_t head;  // 写索引（生产者）
+    volatile uint32_t tail;  // 读索引（消费者）
+
+    // 跳过区：[skip_at, 下一圈开头) 不含数据；skip_count != skip_seen 表示有未越过的跳过区
+    volatile uint32_t skip_at;     // 生产者写
+    volatile uint32_t skip_count;  // 生产者写
+    volatile uint32_t skip_seen;   // 消费者写
+
+    // 生产者私有：当前预留区
+    uint32_t resv_pos;
+    uint32_t resv_len;
+
+    volatile uint32_t overflow_count;  // 生产者写
 } ringbuffer_t;
 
 /**
  * @brief 初始化环形缓冲区
  * @param rb 缓冲区结构体指针
  * @param buffer 底层缓冲区指针
- * @param size 缓冲区大小
+ * @param size 缓冲区大小，必须是 2 的幂
+ * @return true:成功, false:size 不是 2 的幂
  */
-void ringbuffer_init(ringbuffer_t* rb, uint8_t* buffer, uint32_t size);
+bool ringbuffer_init(ringbuffer_t* rb, uint8_t* buffer, uint32_t size);
 
 /**
- * @brief 写入数据到环形缓冲区
+ * @brief 写入数据到环形缓冲区（生产者）
  * @param rb 缓冲区结构体指针
  * @param data 要写入的数据
  * @param len 数据长度
@@ -36,7 +62,7 @@ void ringbuffer_init(ringbuffer_t* rb, uint8_t* buffer, uint32_t size);
 uint32_t ringbuffer_write(ringbuffer_t* rb, const uint8_t* data, uint32_t len);
 
 /**
- * @brief 从环形缓冲区读取数据
+ * @brief 从环形缓冲区读取数据（消费者）
  * @param rb 缓冲区结构体指针
  * @param buffer 输出缓冲区
  * @param len 请求读取的长度
@@ -45,7 +71,7 @@ uint32_t ringbuffer_write(ringbuffer_t* rb, const uint8_t* data, uint32_t len);
 uint32_t ringbuffer_read(ringbuffer_t* rb, uint8_t* buffer, uint32_t len);
 
 /**
- * @brief 查看缓冲区中的数据（不移动读指针）
+ * @brief 查看缓冲区中的数据（不移动读指针，消费者）
  * @param rb 缓冲区结构体指针
  * @param buffer 输出缓冲区
  * @param len 请求查看的长度
@@ -54,13 +80,43 @@ uint32_t ringbuffer_read(ringbuffer_t* rb, uint8_t* buffer, uint32_t len);
 uint32_t ringbuffer_peek(const ringbuffer_t* rb, uint8_t* buffer, uint32_t len);
 
 /**
- * @brief 跳过指定长度的数据
+ * @brief 跳过指定长度的数据（消费者）
  * @param rb 缓冲区结构体指针
  * @param len 要跳过的长度
  * @return 实际跳过的字节数
  */
 uint32_t ringbuffer_skip(ringbuffer_t* rb, uint32_t len);
 
+/**
+ * @brief 预留一段连续的写入空间（生产者）
+ * @param rb 缓冲区结构体指针
+ * @param len 需要的字节数
+ * @return 预留区指针，空间不足时返回 NULL（并计入溢出次数）
+ * @note  写入后调用 ringbuffer_commit()；同一时间只能有一个预留
+ */
+uint8_t* ringbuffer_reserve(ringbuffer_t* rb, uint32_t len);
+
+/**
+ * @brief 提交预留区中实际写入的数据（生产者）
+ * @param rb 缓冲区结构体指针
+ * @param len 字节数，不超过预留长度（0 表示放弃预留）
+ */
+void ringbuffer_commit(ringbuffer_t* rb, uint32_t len);
+
+/**
+ * @brief 是否有未提交的预留
+ */
+bool ringbuffer_is_reserved(const ringbuffer_t* rb);
+
+/**
+ * @brief 获取从读指针开始的连续可读区间（消费者，不拷贝）
+ * @param rb 缓冲区结构体指针
+ * @param data 输出参数，指向第一个可读字节
+ * @return 连续字节数（0 表示无数据）
+ * @note  处理完后用 ringbuffer_skip() 释放
+ */
+uint32_t ringbuffer_read_span(ringbuffer_t* rb, const uint8_t** data);
+
 /**
  * @brief 获取缓冲区中可用数据量
  * @param rb 缓冲区结构体指针
@@ -90,7 +146,7 @@ bool ringbuffer_is_empty(const ringbuffer_t* rb);
 bool ringbuffer_is_full(const ringbuffer_t* rb);
 
 /**
- * @brief 清空缓冲区
+ * @brief 清空缓冲区（消费者调用：丢弃所有已写入的数据）
  * @param rb 缓冲区结构体指针
  */
 void ringbuffer_clear(ringbuffer_t* rb);
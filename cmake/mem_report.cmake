@@ -0,0 +1,319 @@
+# 内存报告：静态段大小、RAM 占用最大的符号、每个函数的栈帧，以及从 main 和各中断入口出发的最坏栈深度
+#
+# 由 CMakeLists.txt 在每次构建后调用（cmake -P），也可以手动执行：
+#   cmake -DELF=km1-one.elf -DSIZE_TOOL=arm-none-eabi-size -DNM_TOOL=arm-none-eabi-nm
+#         -DCI_DIR=CMakeFiles -DOUT=km1-one.mem.txt [-DTOP=20] [-DINDIRECT=...]
+#         -P cmake/mem_report.cmake
+#
+# 调用图来自 -fcallgraph-info=su 生成的 .ci 文件（每个函数的栈帧和直接调用）。
+# 经函数指针的调用在 .ci 中只是 "__indirect_call"，其目标由 INDIRECT 给出：
+#   "caller>callee1|callee2,caller2>callee3"（caller 为函数名，不含文件名）
+# 没有列出的间接调用、没有栈信息的函数（newlib 等未用 -fstack-usage 编译的库）
+# 和递归在报告中单独列出，对应路径的深度是下限。
+
+cmake_minimum_required(VERSION 3.22)
+
+foreach(var ELF SIZE_TOOL NM_TOOL CI_DIR OUT)
+    if(NOT DEFINED ${var})
+        message(FATAL_ERROR "mem_report: ${var} is not set")
+    endif()
+endforeach()
+if(NOT DEFINED TOP)
+    set(TOP 20)
+endif()
+
+# Cortex-M3 异常入栈（无 FPU）：R0-R3, R12, LR, PC, xPSR
+set(EXCEPTION_FRAME 32)
+
+set(report "")
+macro(out line)
+    string(APPEND report "${line}\n")
+endmacro()
+
+# 左对齐到 width 个字符（超出时原样输出）
+function(pad str width var)
+    string(LENGTH "${str}" len)
+    if(len LESS width)
+        math(EXPR n "${width} - ${len}")
+        string(REPEAT " " ${n} spaces)
+        set(str "${str}${spaces}")
+    endif()
+    set(${var} "${str}" PARENT_SCOPE)
+endfunction()
+
+# ==================== 静态段 ====================
+
+execute_process(COMMAND ${SIZE_TOOL} -A -d ${ELF}
+                OUTPUT_VARIABLE size_out
+                RESULT_VARIABLE size_rc)
+if(NOT size_rc EQUAL 0)
+    message(FATAL_ERROR "mem_report: ${SIZE_TOOL} failed on ${ELF}")
+endif()
+
+out("== Sections (${ELF})")
+set(ram_static 0)
+set(ram_reserved 0)
+string(REPLACE "\n" ";" size_lines "${size_out}")
+foreach(line IN LISTS size_lines)
+    if(line MATCHES "^(\\.[A-Za-z0-9_.]+) +([0-9]+) +([0-9]+)")
+        set(sec  "${CMAKE_MATCH_1}")
+        set(size "${CMAKE_MATCH_2}")
+        if(size EQUAL 0 OR sec MATCHES "^\\.(debug|comment|ARM\\.attributes)")
+            continue()
+        endif()
+        pad("${sec}" 20 col)
+        out("  ${col} ${size}")
+        if(sec STREQUAL ".data" OR sec STREQUAL ".bss")
+            math(EXPR ram_static "${ram_static} + ${size}")
+        elseif(sec STREQUAL "._user_heap_stack")
+            math(EXPR ram_reserved "${ram_reserved} + ${size}")
+        endif()
+    endif()
+endforeach()
+out("  static RAM (.data + .bss): ${ram_static}, heap + stack reserve: ${ram_reserved}")
+out("")
+
+# ==================== RAM 符号 ====================
+
+execute_process(COMMAND ${NM_TOOL} --size-sort --reverse-sort -S ${ELF}
+                OUTPUT_VARIABLE nm_out
+                RESULT_VARIABLE nm_rc)
+if(NOT nm_rc EQUAL 0)
+    message(FATAL_ERROR "mem_report: ${NM_TOOL} failed on ${ELF}")
+endif()
+
+out("== Largest RAM symbols")
+set(count 0)
+set(min_stack "")
+string(REPLACE "\n" ";" nm_lines "${nm_out}")
+foreach(line IN LISTS nm_lines)
+    if(NOT line MATCHES "^[0-9a-fA-F]+ ([0-9a-fA-F]+) ([bBdD]) (.+)$")
+        continue()
+    endif()
+    if(count LESS TOP)
+        math(EXPR size "0x${CMAKE_MATCH_1}" OUTPUT_FORMAT DECIMAL)
+        pad("${size}" 8 col)
+        out("  ${col} ${CMAKE_MATCH_3}")
+        math(EXPR count "${count} + 1")
+    endif()
+endforeach()
+execute_process(COMMAND ${NM_TOOL} ${ELF} OUTPUT_VARIABLE sym_out)
+if(sym_out MATCHES "([0-9a-fA-F]+) [aA] _Min_Stack_Size")
+    math(EXPR min_stack "0x${CMAKE_MATCH_1}" OUTPUT_FORMAT DECIMAL)
+endif()
+out("")
+
+# RAM 预算：.data 从 RAM 起点开始（_sdata），_estack 为 RAM 末尾（见链接脚本）
+set(ram_size "")
+if(sym_out MATCHES "([0-9a-fA-F]+) [A-Za-z] _sdata\n")
+    set(ram_start "${CMAKE_MATCH_1}")
+    if(sym_out MATCHES "([0-9a-fA-F]+) [A-Za-z] _estack\n")
+        math(EXPR ram_size "0x${CMAKE_MATCH_1} - 0x${ram_start}" OUTPUT_FORMAT DECIMAL)
+    endif()
+endif()
+if(NOT ram_size STREQUAL "")
+    math(EXPR ram_used "${ram_static} + ${ram_reserved}")
+    math(EXPR ram_free "${ram_size} - ${ram_used}")
+    out("== RAM budget")
+    out("  static ${ram_static} + heap/stack ${ram_reserved} = ${ram_used} of ${ram_size}, \
+free ${ram_free}")
+    out("")
+endif()
+
+# ==================== 调用图 ====================
+
+file(GLOB_RECURSE ci_files "${CI_DIR}/*.ci")
+if(ci_files STREQUAL "")
+    message(FATAL_ERROR "mem_report: no .ci files under ${CI_DIR} (build with -fcallgraph-info=su)")
+endif()
+
+# 节点名去掉文件名前缀（静态函数的 title 为 "path:name"），重名时按较大的栈帧计
+set(nodes "")
+set(frames "")
+foreach(ci IN LISTS ci_files)
+    file(STRINGS "${ci}" ci_lines REGEX "^(node|edge):")
+    foreach(line IN LISTS ci_lines)
+        if(line MATCHES "^node: { title: \"([^\"]+)\" label: \"([^\"]*)\"")
+            set(label "${CMAKE_MATCH_2}")
+            string(REGEX REPLACE "^.*:" "" name "${CMAKE_MATCH_1}")
+            if(label MATCHES "\\\\n([0-9]+) bytes \\(([a-z,]+)\\)")
+                set(bytes "${CMAKE_MATCH_1}")
+                set(qual  "${CMAKE_MATCH_2}")
+                if(NOT DEFINED SU_${name} OR bytes GREATER SU_${name})
+                    set(SU_${name} ${bytes})
+                    set(QUAL_${name} ${qual})
+                    string(REPLACE "\\n" ";" parts "${label}")
+                    list(GET parts 1 LOC_${name})
+                endif()
+                list(APPEND frames "${name}")
+            endif()
+        elseif(line MATCHES "^edge: { sourcename: \"([^\"]+)\" targetname: \"([^\"]+)\"")
+            set(to "${CMAKE_MATCH_2}")
+            string(REGEX REPLACE "^.*:" "" from "${CMAKE_MATCH_1}")
+            string(REGEX REPLACE "^.*:" "" to "${to}")
+            if(to STREQUAL "__indirect_call")
+                set(INDIRECT_${from} 1)
+            else()
+                list(APPEND CALLS_${from} "${to}")
+            endif()
+            list(APPEND nodes "${from}")
+        endif()
+    endforeach()
+endforeach()
+list(REMOVE_DUPLICATES frames)
+
+# 间接调用的目标
+set(unresolved "")
+if(DEFINED INDIRECT AND NOT INDIRECT STREQUAL "")
+    string(REPLACE "," ";" entries "${INDIRECT}")
+    foreach(entry IN LISTS entries)
+        if(NOT entry MATCHES "^([^>]+)>(.+)$")
+            message(FATAL_ERROR "mem_report: bad INDIRECT entry '${entry}'")
+        endif()
+        set(from "${CMAKE_MATCH_1}")
+        string(REPLACE "|" ";" targets "${CMAKE_MATCH_2}")
+        if(DEFINED INDIRECT_${from})
+            list(APPEND CALLS_${from} ${targets})
+            set(INDIRECT_${from} 2)
+        endif()
+    endforeach()
+endif()
+list(REMOVE_DUPLICATES nodes)
+foreach(name IN LISTS nodes)
+    if(DEFINED CALLS_${name})
+        list(REMOVE_DUPLICATES CALLS_${name})
+    endif()
+    if(INDIRECT_${name} EQUAL 1)
+        list(APPEND unresolved "${name}")
+    endif()
+endforeach()
+
+out("== Largest stack frames")
+set(sorted "")
+foreach(name IN LISTS frames)
+    # 按 "字节数补零:函数名" 排序
+    string(LENGTH "${SU_${name}}" len)
+    math(EXPR zeros "8 - ${len}")
+    string(REPEAT "0" ${zeros} prefix)
+    list(APPEND sorted "${prefix}${SU_${name}}:${name}")
+endforeach()
+list(SORT sorted ORDER DESCENDING)
+set(count 0)
+foreach(item IN LISTS sorted)
+    if(NOT count LESS TOP)
+        break()
+    endif()
+    string(REGEX REPLACE "^[0-9]+:" "" name "${item}")
+    pad("${SU_${name}}" 8 col1)
+    pad("${name}" 36 col2)
+    out("  ${col1} ${col2} ${QUAL_${name}}  ${LOC_${name}}")
+    math(EXPR count "${count} + 1")
+endforeach()
+out("")
+
+# ==================== 最坏栈深度 ====================
+
+# 深度优先，结果记在全局属性中（函数内设置的变量出不了作用域）。
+# 正在求值的函数再次出现即为递归：该边不计入，记录下来
+function(walk name)
+    get_property(done GLOBAL PROPERTY DEPTH_${name} SET)
+    if(done)
+        return()
+    endif()
+    set_property(GLOBAL PROPERTY ACTIVE_${name} 1)
+
+    set(best 0)
+    set(best_path "")
+    foreach(callee IN LISTS CALLS_${name})
+        get_property(active GLOBAL PROPERTY ACTIVE_${callee})
+        if(active)
+            set_property(GLOBAL APPEND PROPERTY RECURSION "${name} -> ${callee}")
+            continue()
+        endif()
+        walk(${callee})
+        get_property(depth GLOBAL PROPERTY DEPTH_${callee})
+        if(depth GREATER best OR best_path STREQUAL "")
+            set(best ${depth})
+            get_property(best_path GLOBAL PROPERTY PATH_${callee})
+        endif()
+    endforeach()
+
+    if(DEFINED SU_${name})
+        set(own ${SU_${name}})
+    else()
+        set(own 0)
+        set_property(GLOBAL APPEND PROPERTY NO_STACK_INFO "${name}")
+    endif()
+    math(EXPR depth "${own} + ${best}")
+    set_property(GLOBAL PROPERTY DEPTH_${name} ${depth})
+    set_property(GLOBAL PROPERTY PATH_${name} "${name};${best_path}")
+    set_property(GLOBAL PROPERTY ACTIVE_${name} 0)
+endfunction()
+
+set(roots "")
+foreach(name IN LISTS frames)
+    if(name STREQUAL "main" OR name MATCHES "_Handler$|_IRQHandler$")
+        list(APPEND roots "${name}")
+    endif()
+endforeach()
+list(SORT roots)
+
+out("== Worst-case stack depth (bytes, path)")
+set(main_depth 0)
+set(irq_sum 0)
+set(irq_max 0)
+foreach(root IN LISTS roots)
+    walk(${root})
+    get_property(depth GLOBAL PROPERTY DEPTH_${root})
+    get_property(path GLOBAL PROPERTY PATH_${root})
+    list(FILTER path EXCLUDE REGEX "^$")
+    list(JOIN path " > " path)
+    pad("${depth}" 8 col1)
+    pad("${root}" 28 col2)
+    out("  ${col1} ${col2} ${path}")
+    if(root STREQUAL "main")
+        set(main_depth ${depth})
+    elseif(depth GREATER 0)
+        math(EXPR frame "${depth} + ${EXCEPTION_FRAME}")
+        math(EXPR irq_sum "${irq_sum} + ${frame}")
+        if(frame GREATER irq_max)
+            set(irq_max ${frame})
+        endif()
+    endif()
+endforeach()
+
+# 中断能否嵌套取决于抢占优先级，这里给出两端：不嵌套（最深的一个中断）和全部嵌套
+math(EXPR no_nesting "${main_depth} + ${irq_max}")
+math(EXPR all_nested "${main_depth} + ${irq_sum}")
+out("  main + deepest interrupt: ${no_nesting}, main + all interrupts nested: ${all_nested} \
+(${EXCEPTION_FRAME} bytes exception frame each)")
+if(NOT min_stack STREQUAL "")
+    out("  reserved stack (_Min_Stack_Size): ${min_stack}")
+endif()
+
+get_property(recursion GLOBAL PROPERTY RECURSION)
+get_property(no_info GLOBAL PROPERTY NO_STACK_INFO)
+foreach(kind recursion unresolved no_info)
+    if(NOT "${${kind}}" STREQUAL "")
+        list(REMOVE_DUPLICATES ${kind})
+        list(SORT ${kind})
+        list(JOIN ${kind} ", " items)
+        if(kind STREQUAL "recursion")
+            out("  recursion (not counted): ${items}")
+        elseif(kind STREQUAL "unresolved")
+            out("  unresolved indirect calls in: ${items}")
+        else()
+            out("  no stack info (counted as 0): ${items}")
+        endif()
+    endif()
+endforeach()
+
+file(WRITE "${OUT}" "${report}")
+message(STATUS "Memory report: ${OUT}")
+if(NOT ram_size STREQUAL "" AND ram_free LESS 0)
+    message(WARNING "mem_report: RAM use ${ram_used} exceeds ${ram_size}")
+endif()
+if(NOT min_stack STREQUAL "" AND no_nesting GREATER min_stack)
+    message(WARNING
+            "mem_report: worst-case stack ${no_nesting} exceeds _Min_Stack_Size ${min_stack}")
+endif()